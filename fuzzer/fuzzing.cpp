@@ -14,6 +14,7 @@
 #include <mlt++/MltProducer.h>
 #include <mlt++/MltProfile.h>
 #include <mlt++/MltRepository.h>
+#include <chrono>
 #include <sstream>
 #define private public
 #define protected public
@@ -91,6 +92,18 @@ QString createProducerWithSound(Mlt::Profile &prof, std::shared_ptr<ProjectItemM
 
     return binId;
 }
+/** @brief Run @param operation and append its duration in microseconds to @param timings */
+template <typename F> void timed(ReplayTimings *timings, const std::string &name, F &&operation)
+{
+    if (!timings) {
+        operation();
+        return;
+    }
+    const auto start = std::chrono::steady_clock::now();
+    operation();
+    const auto end = std::chrono::steady_clock::now();
+    (*timings)[name].push_back(std::chrono::duration_cast<std::chrono::microseconds>(end - start).count());
+}
 inline int modulo(int a, int b)
 {
     const int result = a % b;
@@ -109,8 +122,10 @@ bool isIthParamARef(const rttr::method &method, size_t i)
 } // namespace
 } // namespace
 
-void fuzz(const std::string &input)
+void fuzz(const std::string &input, ReplayTimings *timings)
 {
+    // When replaying a recorded session, we want a quiet and representative workload
+    const bool replay = timings != nullptr;
     Logger::init();
     Logger::clear();
     std::stringstream ss;
@@ -243,15 +258,21 @@ void fuzz(const std::string &input)
         id = modulo(id, (int)all_tracks[timeline].size());
         return all_tracks[timeline][id];
     };
+    // Bin clips of a recorded session are not part of the trace, they are replaced by stand-in clips
+    std::unordered_map<std::string, QString> standInClips;
     std::string c;
 
     while (ss >> c) {
         if (c == "u") {
-            std::cout << "UNDOING" << std::endl;
-            undoStack->undo();
+            if (!replay) {
+                std::cout << "UNDOING" << std::endl;
+            }
+            timed(timings, "undo", [&]() { undoStack->undo(); });
         } else if (c == "r") {
-            std::cout << "REDOING" << std::endl;
-            undoStack->redo();
+            if (!replay) {
+                std::cout << "REDOING" << std::endl;
+            }
+            timed(timings, "redo", [&]() { undoStack->redo(); });
         } else if (Logger::back_translation_table.count(c) > 0) {
             // std::cout << "found=" << c;
             c = Logger::back_translation_table[c];
@@ -267,7 +288,12 @@ void fuzz(const std::string &input)
                 ss >> binId >> id >> state_id >> speed;
                 QString binClip = QString::fromStdString(binId);
                 bool valid = true;
-                if (!pCore->projectItemModel()->hasClip(binClip)) {
+                if (replay && !pCore->projectItemModel()->hasClip(binClip)) {
+                    if (standInClips.count(binId) == 0) {
+                        standInClips[binId] = createProducer(profile, "red", binModel, 100000, false);
+                    }
+                    binClip = standInClips[binId];
+                } else if (!pCore->projectItemModel()->hasClip(binClip)) {
                     if (pCore->projectItemModel()->getAllClipIds().size() == 0) {
                         valid = false;
                     } else {
@@ -452,7 +478,9 @@ void fuzz(const std::string &input)
                         }
                     }
                     if (valid) {
-                        std::cout << "VALID!!! " << target_method.get_name().to_string() << std::endl;
+                        if (!replay) {
+                            std::cout << "VALID!!! " << target_method.get_name().to_string() << std::endl;
+                        }
                         std::vector<rttr::argument> args;
                         args.reserve(arguments.size());
                         for (auto &a : arguments) {
@@ -462,17 +490,27 @@ void fuzz(const std::string &input)
                         for (const auto &p : target_method.get_parameter_infos()) {
                             // std::cout << "expected=" << p.get_type().get_name().to_string() << std::endl;
                         }
-                        rttr::variant res = target_method.invoke_variadic(ptr, args);
-                        if (res.is_valid()) {
-                            std::cout << "SUCCESS!!!" << std::endl;
-                        } else {
-                            std::cout << "!!!FAILLLLLL!!!" << std::endl;
+                        rttr::variant res;
+                        timed(timings, target_method.get_name().to_string(), [&]() { res = target_method.invoke_variadic(ptr, args); });
+                        if (!replay) {
+                            if (res.is_valid()) {
+                                std::cout << "SUCCESS!!!" << std::endl;
+                            } else {
+                                std::cout << "!!!FAILLLLLL!!!" << std::endl;
+                            }
                         }
                     }
                 }
             }
         }
         update_elems();
+        if (!replay) {
+            for (const auto &t : all_timelines) {
+                assert(t->checkConsistency());
+            }
+        }
+    }
+    if (replay) {
         for (const auto &t : all_timelines) {
             assert(t->checkConsistency());
         }
@@ -489,6 +527,9 @@ void fuzz(const std::string &input)
     pCore->m_projectManager = nullptr;
     Core::m_self.reset();
     MltConnection::m_self.reset();
+    if (replay) {
+        return;
+    }
     std::cout << "---------------------------------------------------------------------------------------------------------------------------------------------"
                  "---------------"
               << std::endl;
@@ -7,6 +7,14 @@
 
 #pragma once
 
+#include <map>
 #include <string>
+#include <vector>
 
-void fuzz(const std::string &input);
+/** @brief Durations in microseconds of the replayed operations, by method name ("undo" and "redo" for the undo stack) */
+using ReplayTimings = std::map<std::string, std::vector<long long>>;
+
+/** @brief Execute the operations of @param input, in the format of the fuzz_case files written by Logger::print_trace.
+ *  When @param timings is set, the input is replayed as a performance workload: the duration of every model operation is recorded,
+ *  bin clips missing from the trace are replaced by stand-in clips and the model consistency is only checked at the end. */
+void fuzz(const std::string &input, ReplayTimings *timings = nullptr);
@@ -0,0 +1,106 @@
+/*
+    SPDX-FileCopyrightText: 2026 Kdenlive contributors
+    This file is part of Kdenlive. See www.kdenlive.org.
+
+    SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+/* Replays editing sessions recorded by Logger::print_trace (fuzz_case_N.txt files, see KDENLIVE_RECORD_SESSION) as
+ * performance workloads, and reports the latency distribution of each timeline operation.
+ * Usage: fuzz_replay [--repeat N] [--trace trace.json] session.txt [session2.txt...]
+ * The session is read from the standard input if no file is given.
+ */
+
+#include "core.h"
+#include "fuzzing.hpp"
+#include "utils/tracing.h"
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QFile>
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+namespace {
+long long percentile(const std::vector<long long> &sorted, int percent)
+{
+    // Nearest rank
+    size_t rank = (sorted.size() * size_t(percent) + 99) / 100;
+    return sorted[std::max<size_t>(rank, 1) - 1];
+}
+
+void printReport(ReplayTimings &timings)
+{
+    std::cout << std::left << std::setw(36) << "operation" << std::right << std::setw(8) << "count" << std::setw(10) << "min" << std::setw(10) << "median"
+              << std::setw(10) << "p95" << std::setw(10) << "max" << std::setw(12) << "total" << std::endl;
+    for (auto &t : timings) {
+        std::vector<long long> &values = t.second;
+        if (values.empty()) {
+            continue;
+        }
+        std::sort(values.begin(), values.end());
+        long long total = 0;
+        for (long long v : values) {
+            total += v;
+        }
+        std::cout << std::left << std::setw(36) << t.first << std::right << std::setw(8) << values.size() << std::setw(10) << values.front()
+                  << std::setw(10) << percentile(values, 50) << std::setw(10) << percentile(values, 95) << std::setw(10) << values.back() << std::setw(12)
+                  << total << std::endl;
+    }
+    std::cout << "(durations in microseconds)" << std::endl;
+}
+} // namespace
+
+int main(int argc, char **argv)
+{
+    QApplication app(argc, argv);
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("Replay recorded timeline sessions and measure the latency of each operation"));
+    parser.addHelpOption();
+    QCommandLineOption repeatOption(QStringLiteral("repeat"), QStringLiteral("Number of times each session is replayed."), QStringLiteral("count"),
+                                    QStringLiteral("1"));
+    QCommandLineOption traceOption(QStringLiteral("trace"), QStringLiteral("Write a Chrome trace of the replay to this file."), QStringLiteral("file"));
+    parser.addOption(repeatOption);
+    parser.addOption(traceOption);
+    parser.addPositionalArgument(QStringLiteral("sessions"), QStringLiteral("Recorded sessions (fuzz_case files), read from stdin if empty."));
+    parser.process(app);
+
+    std::vector<std::string> sessions;
+    const QStringList files = parser.positionalArguments();
+    for (const QString &path : files) {
+        QFile file(path);
+        if (!file.open(QIODevice::ReadOnly)) {
+            std::cerr << "Cannot read session " << path.toStdString() << std::endl;
+            return EXIT_FAILURE;
+        }
+        sessions.push_back(file.readAll().toStdString());
+    }
+    if (files.isEmpty()) {
+        std::stringstream ss;
+        std::string str;
+        while (getline(std::cin, str)) {
+            ss << str << std::endl;
+        }
+        sessions.push_back(ss.str());
+    }
+    const int repeat = std::max(1, parser.value(repeatOption).toInt());
+    const QString traceFile = parser.value(traceOption);
+    if (!traceFile.isEmpty()) {
+        Tracing::setEnabled(true);
+    }
+
+    qputenv("MLT_TESTS", QByteArray("1"));
+    ReplayTimings timings;
+    for (int i = 0; i < repeat; ++i) {
+        for (const std::string &session : sessions) {
+            Core::build(false);
+            fuzz(session, &timings);
+        }
+    }
+    printReport(timings);
+    if (!traceFile.isEmpty() && !Tracing::exportChromeTrace(traceFile)) {
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
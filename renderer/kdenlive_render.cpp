@@ -165,6 +165,20 @@ int main(int argc, char **argv)
         QCommandLineOption subtitleOption("subtitle", "Subtitle file.", "file");
         parser.addOption(subtitleOption);
 
+        QCommandLineOption stemChannelsOption("stem-channels",
+                                              "The source is a stem render, the output file has this number of channels for the mix and for each stem.",
+                                              "channels");
+        parser.addOption(stemChannelsOption);
+
+        QCommandLineOption stemMasterOption("stem-master", "File to extract the mix of a stem render to.", "file");
+        parser.addOption(stemMasterOption);
+
+        QCommandLineOption stemOption("stem", "File to extract a stem to, in channel order. Can be repeated.", "file");
+        parser.addOption(stemOption);
+
+        QCommandLineOption stemCodecOption("stem-codec", "FFmpeg options used to encode the extracted files, separated by spaces.", "options");
+        parser.addOption(stemCodecOption);
+
         QCommandLineOption debugOption("debug", "Enable debug mode, doesn't delete log file on render success.");
         parser.addOption(debugOption);
 
@@ -237,6 +251,10 @@ int main(int argc, char **argv)
         bool debugMode = parser.isSet(debugOption);
 
         auto *rJob = new RenderJob(render, playlist, target, pid, in, out, subtitleFile, debugMode, &app);
+        if (parser.isSet(stemChannelsOption)) {
+            rJob->setStems(parser.value(stemChannelsOption).toInt(), parser.value(stemMasterOption), parser.values(stemOption),
+                           parser.value(stemCodecOption).split(QLatin1Char(' '), Qt::SkipEmptyParts));
+        }
         QObject::connect(rJob, &RenderJob::renderingFinished, rJob, [&]() {
             rJob->deleteLater();
             qApp->quit();
@@ -33,6 +33,7 @@ RenderJob::RenderJob(const QString &render, const QString &scenelist, const QStr
     , m_pid(pid)
     , m_dualpass(false)
     , m_subtitleFile(subtitleFile)
+    , m_stemChannels(0)
     , m_debugMode(debugMode)
     , m_renderProcess(&m_looper)
 {
@@ -271,6 +272,10 @@ void RenderJob::slotIsOver(int exitCode, QProcess::ExitStatus status)
                 errorMessage.append(QLatin1Char('\n'));
                 errorMessage.append(tr("Rendering of %1 aborted, resulting video will probably be corrupted.").arg(m_dest));
             }
+            if (error == -1 && m_stemChannels > 0 && !extractStems()) {
+                error = -2;
+                errorMessage = m_errorMessage;
+            }
             if (!m_subtitleFile.isEmpty()) {
                 // Embed subtitles
                 QString ffmpegExe = QStandardPaths::findExecutable(QStringLiteral("ffmpeg"));
@@ -298,6 +303,51 @@ void RenderJob::slotIsOver(int exitCode, QProcess::ExitStatus status)
     m_looper.quit();
 }
 
+void RenderJob::setStems(int channels, const QString &master, const QStringList &stems, const QStringList &codecArgs)
+{
+    m_stemChannels = channels;
+    m_stemMaster = master;
+    m_stemFiles = stems;
+    m_stemCodecArgs = codecArgs;
+}
+
+bool RenderJob::extractStems()
+{
+    const QString ffmpegExe = QStandardPaths::findExecutable(QStringLiteral("ffmpeg"));
+    if (ffmpegExe.isEmpty()) {
+        m_errorMessage.append(tr("FFmpeg is required to extract the audio tracks from %1.").arg(m_dest));
+        return false;
+    }
+    // The rendered file is decoded once, the first channels hold the mix, followed by the channels of each stem
+    QStringList args = {QStringLiteral("-y"), QStringLiteral("-v"), QStringLiteral("error"), QStringLiteral("-i"), m_dest};
+    QStringList files = {m_stemMaster};
+    files << m_stemFiles;
+    for (int slot = 0; slot < files.count(); ++slot) {
+        if (files.at(slot).isEmpty()) {
+            continue;
+        }
+        QStringList routes = {QStringLiteral("%1c").arg(m_stemChannels)};
+        for (int i = 0; i < m_stemChannels; ++i) {
+            routes << QStringLiteral("c%1=c%2").arg(i).arg(slot * m_stemChannels + i);
+        }
+        args << QStringLiteral("-map") << QStringLiteral("0:a") << QStringLiteral("-af") << QStringLiteral("pan=%1").arg(routes.join(QLatin1Char('|')));
+        args << m_stemCodecArgs << files.at(slot);
+    }
+    m_logstream << "Extracting audio tracks: " << args.join(QLatin1Char(' ')) << "\n";
+    QProcess process;
+    process.setProcessChannelMode(QProcess::MergedChannels);
+    process.start(ffmpegExe, args);
+    if (!process.waitForStarted(-1) || !process.waitForFinished(-1) || process.exitStatus() != QProcess::NormalExit || process.exitCode() != 0) {
+        m_errorMessage.append(QString::fromLocal8Bit(process.readAll()));
+        m_errorMessage.append(tr("Extracting the audio tracks from %1 failed.").arg(m_dest));
+        return false;
+    }
+    if (!m_debugMode) {
+        QFile::remove(m_dest);
+    }
+    return true;
+}
+
 void RenderJob::receivedSubtitleProgress()
 {
     QString outputData = QString::fromLocal8Bit(m_subsProcess.readAllStandardOutput()).simplified();
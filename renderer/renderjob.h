@@ -25,6 +25,10 @@ public:
               const QString &subtitleFile = QString(), bool debugMode = false, QObject *parent = nullptr);
     ~RenderJob() override;
 
+    /** @brief The render is a multichannel stem render, extract the mix to @param master and each track to @param stems, using @param channels
+     *  channels each and encoded with the FFmpeg options @param codecArgs, once rendering is finished */
+    void setStems(int channels, const QString &master, const QStringList &stems, const QStringList &codecArgs);
+
 public Q_SLOTS:
     void start();
 
@@ -57,6 +61,10 @@ private:
     int m_pid;
     bool m_dualpass;
     QString m_subtitleFile;
+    int m_stemChannels;
+    QString m_stemMaster;
+    QStringList m_stemFiles;
+    QStringList m_stemCodecArgs;
     bool m_debugMode;
     QString m_temporaryRenderFile;
     QProcess m_renderProcess;
@@ -71,6 +79,8 @@ private:
     void sendFinish(int status, const QString &error);
     void updateProgress();
     void sendProgress();
+    /** @brief Extract the stems from the rendered file, returns false on error */
+    bool extractStems();
 
 Q_SIGNALS:
     void renderingFinished();
@@ -6,6 +6,8 @@
 #pragma once
 
 #include "definitions.h"
+#include <QDataStream>
+#include <QDomDocument>
 #include <QSet>
 #include <memory>
 #include <mlt++/Mlt.h>
@@ -14,6 +16,8 @@
 
 /** @class AbstractAssetsRepository
     @brief This class is the base class for assets (transitions or effets) repositories
+    The parsed assets are cached on disk. At the next launch, only the MLT assets missing from the cache are parsed, and the custom XML files are
+    only parsed again if one of them changed. The cache is discarded when MLT, Kdenlive, the language or the include/exclude lists change.
  */
 template <typename AssetType> class AbstractAssetsRepository
 {
@@ -87,7 +91,15 @@ protected:
     /** @brief Retrieves additional info about asset from a custom XML file
        The resulting assets are stored in customAssets
      */
-    virtual void parseCustomAssetFile(const QString &file_name, std::unordered_map<QString, Info> &customAssets) const = 0;
+    void parseCustomAssetFile(const QString &file_name, std::unordered_map<QString, Info> &customAssets) const;
+
+    /** @brief Retrieves additional info about asset from the already loaded content @param doc of a custom XML file
+       The resulting assets are stored in customAssets
+     */
+    virtual void parseCustomAssetDocument(QDomDocument &doc, const QString &file_name, std::unordered_map<QString, Info> &customAssets) const = 0;
+
+    /** @brief Returns the name of the file caching the parsed assets between launches*/
+    virtual QString assetCacheName() const = 0;
 
     /** @brief Returns the path to custom XML description of the assets*/
     virtual QStringList assetDirs() const = 0;
@@ -107,6 +119,21 @@ protected:
     QSet<QString> m_includedList;
 
     QSet<QString> m_preferred_list;
+
+private:
+    static constexpr quint32 CacheMagic = 0x4b415343; // KASC
+    static constexpr qint32 CacheVersion = 1;
+    static constexpr QDataStream::Version CacheStreamVersion = QDataStream::Qt_6_0;
+
+    /** @brief Returns the key identifying the environment in which the cached assets were parsed */
+    QString cacheKey() const;
+    /** @brief Read the assets parsed at the previous launch, returns false if there is no cache or it was created for another environment
+       @param customSignature receives the list of custom XML files (with their modification time and size) that were parsed
+     */
+    bool loadCache(const QString &key, std::unordered_map<QString, Info> &mltAssets, QStringList &customSignature,
+                   std::unordered_map<QString, Info> &customAssets) const;
+    void saveCache(const QString &key, const std::unordered_map<QString, Info> &mltAssets, const QStringList &customSignature,
+                   const std::unordered_map<QString, Info> &customAssets) const;
 };
 
 #include "abstractassetsrepository.ipp"
@@ -7,11 +7,17 @@
 #include "kdenlivesettings.h"
 #include "core.h"
 
+#include <config-kdenlive.h>
+
+#include <QDataStream>
 #include <QDir>
 #include <QFile>
+#include <QLocale>
+#include <QSaveFile>
 #include <QStandardPaths>
 #include <QString>
 #include <QTextStream>
+#include <QtConcurrent/QtConcurrentMap>
 #include <KLocalizedString>
 
 #include <locale>
@@ -30,8 +36,16 @@ template <typename AssetType> void AbstractAssetsRepository<AssetType>::init()
     // Parse preferred list
     parseAssetList({assetPreferredListPath()}, m_preferred_list);
 
+    // Load the assets parsed at the previous launch
+    const QString key = cacheKey();
+    std::unordered_map<QString, Info> cachedAssets;
+    QStringList cachedSignature;
+    std::unordered_map<QString, Info> customAssets;
+    bool cacheChanged = !loadCache(key, cachedAssets, cachedSignature, customAssets);
+
     // Retrieve the list of MLT's available assets.
     QScopedPointer<Mlt::Properties> assets(retrieveListFromMlt());
+    std::unordered_map<QString, Info> mltAssets;
     QStringList emptyMetaAssets;
     int max = assets->count();
     QString sox = QStringLiteral("sox.");
@@ -44,17 +58,23 @@ template <typename AssetType> void AbstractAssetsRepository<AssetType>::init()
             continue;
         }
         if (!m_excludedList.contains(name)) {
-            if (parseInfoFromMlt(name, info)) {
-                m_assets[name] = info;
-                if (m_includedList.contains(name)) {
-                    info.included = true;
-                }
-                if (info.xml.isNull()) {
-                    // Metadata was invalid
-                    emptyMetaAssets << name;
-                }
+            auto cached = cachedAssets.find(name);
+            if (cached != cachedAssets.end()) {
+                info = cached->second;
+            } else if (parseInfoFromMlt(name, info)) {
+                cacheChanged = true;
             } else {
                 qWarning() << "Failed to parse" << name;
+                continue;
+            }
+            m_assets[name] = info;
+            mltAssets[name] = info;
+            if (m_includedList.contains(name)) {
+                info.included = true;
+            }
+            if (info.xml.isNull()) {
+                // Metadata was invalid
+                emptyMetaAssets << name;
             }
         }
     }
@@ -68,21 +88,41 @@ template <typename AssetType> void AbstractAssetsRepository<AssetType>::init()
        to the same tag, and in that case they must have different ids. We do the parsing in a map from ids to parse info, and then we add them to the asset
        list, while discarding the bare version of each tag (the one with no file associated)
     */
-    std::unordered_map<QString, Info> customAssets;
+    QStringList customFiles;
+    QStringList customSignature;
     // reverse order to prioritize local install
     QListIterator<QString> dirs_it(asset_dirs);
     for (dirs_it.toBack(); dirs_it.hasPrevious();) { auto dir=dirs_it.previous();
         QDir current_dir(dir);
         QStringList filter {QStringLiteral("*.xml")};
-        QStringList fileList = current_dir.entryList(filter, QDir::Files);
-        for (const auto &file : std::as_const(fileList)) {
-            QString path = current_dir.absoluteFilePath(file);
-            parseCustomAssetFile(path, customAssets);
+        const QFileInfoList fileList = current_dir.entryInfoList(filter, QDir::Files);
+        for (const auto &file : fileList) {
+            customFiles << file.absoluteFilePath();
+            customSignature << QStringLiteral("%1:%2:%3").arg(file.absoluteFilePath()).arg(file.lastModified().toMSecsSinceEpoch()).arg(file.size());
+        }
+    }
+    if (cacheChanged || customSignature != cachedSignature) {
+        // Reading the files is the slow part, do it in parallel. The assets are then parsed in order, as files can override or depend on each other
+        customAssets.clear();
+        QVector<QDomDocument> docs = QtConcurrent::blockingMapped<QVector<QDomDocument>>(customFiles, [](const QString &path) {
+            QDomDocument doc;
+            Xml::docContentFromFile(doc, path, false);
+            return doc;
+        });
+        for (int i = 0; i < docs.size(); ++i) {
+            if (!docs[i].isNull()) {
+                parseCustomAssetDocument(docs[i], customFiles.at(i), customAssets);
+            }
         }
+        cacheChanged = true;
+    }
+    if (cacheChanged) {
+        saveCache(key, mltAssets, customSignature, customAssets);
     }
 
     // We add the custom assets
     QStringList missingDependency;
+    QSet<QString> mltServices;
     for (const auto &custom : customAssets) {
         // Custom assets should override default ones
         if (emptyMetaAssets.contains(custom.second.mltId)) {
@@ -93,26 +133,18 @@ template <typename AssetType> void AbstractAssetsRepository<AssetType>::init()
 
         QString dependency = custom.second.xml.attribute(QStringLiteral("dependency"), QString());
         if(!dependency.isEmpty()) {
-            bool found = false;
-            QScopedPointer<Mlt::Properties> effects(pCore->getMltRepository()->filters());
-            for(int i = 0; i < effects->count(); ++i) {
-                if(effects->get_name(i) == dependency) {
-                    found = true;
-                    break;
-                }
-            }
-
-            if(!found) {
+            if (mltServices.isEmpty()) {
+                QScopedPointer<Mlt::Properties> effects(pCore->getMltRepository()->filters());
                 QScopedPointer<Mlt::Properties> transitions(pCore->getMltRepository()->transitions());
-                for(int i = 0; i < transitions->count(); ++i) {
-                    if(transitions->get_name(i) == dependency) {
-                        found = true;
-                        break;
-                    }
+                mltServices.reserve(effects->count() + transitions->count());
+                for (int i = 0; i < effects->count(); ++i) {
+                    mltServices.insert(QString::fromUtf8(effects->get_name(i)));
+                }
+                for (int i = 0; i < transitions->count(); ++i) {
+                    mltServices.insert(QString::fromUtf8(transitions->get_name(i)));
                 }
             }
-
-            if(!found) {
+            if (!mltServices.contains(dependency)) {
                 // asset depends on another asset that is invalid so remove this asset too
                 missingDependency << custom.first;
                 qDebug() << "Asset" << custom.first << "has invalid dependency" << dependency << "and is going to be removed";
@@ -128,6 +160,115 @@ template <typename AssetType> void AbstractAssetsRepository<AssetType>::init()
     }
 }
 
+template <typename AssetType> QString AbstractAssetsRepository<AssetType>::cacheKey() const
+{
+    QStringList excluded = m_excludedList.values();
+    QStringList included = m_includedList.values();
+    excluded.sort();
+    included.sort();
+    return QStringList({QStringLiteral(KDENLIVE_VERSION), QString::fromUtf8(mlt_version_get_string()), KLocalizedString::languages().join(QLatin1Char(',')),
+                        QLocale().name(), excluded.join(QLatin1Char(',')), included.join(QLatin1Char(','))})
+        .join(QLatin1Char('\n'));
+}
+
+template <typename AssetType>
+bool AbstractAssetsRepository<AssetType>::loadCache(const QString &key, std::unordered_map<QString, Info> &mltAssets, QStringList &customSignature,
+                                                    std::unordered_map<QString, Info> &customAssets) const
+{
+    QFile file(QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QStringLiteral("/assets/") + assetCacheName());
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    QDataStream stream(&file);
+    stream.setVersion(CacheStreamVersion);
+    quint32 magic;
+    qint32 version;
+    QString cachedKey;
+    stream >> magic >> version;
+    if (magic != CacheMagic || version != CacheVersion) {
+        return false;
+    }
+    stream >> cachedKey;
+    if (cachedKey != key) {
+        return false;
+    }
+    auto readAssets = [&stream](std::unordered_map<QString, Info> &destination) {
+        qint32 count;
+        stream >> count;
+        for (int i = 0; i < count && stream.status() == QDataStream::Ok; ++i) {
+            Info info;
+            qint32 type;
+            QString xml;
+            stream >> info.id >> info.mltId >> info.name >> info.description >> info.author >> info.version_str >> info.version >> info.included >> type >> xml;
+            info.type = AssetType(type);
+            if (!xml.isEmpty()) {
+                QDomDocument doc;
+                doc.setContent(xml);
+                info.xml = doc.documentElement();
+            }
+            destination[info.id] = info;
+        }
+    };
+    readAssets(mltAssets);
+    stream >> customSignature;
+    readAssets(customAssets);
+    if (stream.status() != QDataStream::Ok) {
+        mltAssets.clear();
+        customSignature.clear();
+        customAssets.clear();
+        return false;
+    }
+    return true;
+}
+
+template <typename AssetType>
+void AbstractAssetsRepository<AssetType>::saveCache(const QString &key, const std::unordered_map<QString, Info> &mltAssets, const QStringList &customSignature,
+                                                    const std::unordered_map<QString, Info> &customAssets) const
+{
+    QDir cacheDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation));
+    if (!cacheDir.mkpath(QStringLiteral("assets"))) {
+        return;
+    }
+    QSaveFile file(cacheDir.absoluteFilePath(QStringLiteral("assets/") + assetCacheName()));
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Cannot write asset cache" << file.fileName();
+        return;
+    }
+    QDataStream stream(&file);
+    stream.setVersion(CacheStreamVersion);
+    auto writeAssets = [&stream](const std::unordered_map<QString, Info> &source) {
+        stream << qint32(source.size());
+        for (const auto &asset : source) {
+            const Info &info = asset.second;
+            QString xml;
+            if (!info.xml.isNull()) {
+                QDomDocument doc;
+                doc.appendChild(doc.importNode(info.xml, true));
+                xml = doc.toString(-1);
+            }
+            stream << info.id << info.mltId << info.name << info.description << info.author << info.version_str << info.version << info.included
+                   << qint32(info.type) << xml;
+        }
+    };
+    stream << CacheMagic << CacheVersion << key;
+    writeAssets(mltAssets);
+    stream << customSignature;
+    writeAssets(customAssets);
+    if (stream.status() != QDataStream::Ok || !file.commit()) {
+        qWarning() << "Cannot write asset cache" << file.fileName();
+    }
+}
+
+template <typename AssetType>
+void AbstractAssetsRepository<AssetType>::parseCustomAssetFile(const QString &file_name, std::unordered_map<QString, Info> &customAssets) const
+{
+    QDomDocument doc;
+    if (!Xml::docContentFromFile(doc, file_name, false)) {
+        return;
+    }
+    parseCustomAssetDocument(doc, file_name, customAssets);
+}
+
 template <typename AssetType> void AbstractAssetsRepository<AssetType>::parseAssetList(const QStringList &filePaths, QSet<QString> &destination)
 {
     for (auto &filePath : filePaths) {
@@ -22,6 +22,7 @@
 
 // std::unordered_map and QHash could not be used here
 static QMap<KeyframeType::KeyframeEnum, QString> KeyframeTypeName;
+std::atomic<int> KeyframeModel::s_compiledGeneration{0};
 
 KeyframeModel::KeyframeModel(std::weak_ptr<AssetParameterModel> model, const QModelIndex &index, std::weak_ptr<DocUndoStack> undo_stack, int in, int out,
                              QObject *parent)
@@ -87,11 +88,15 @@ void KeyframeModel::setup()
         Q_EMIT modelChanged();
     });
     connect(this, &KeyframeModel::modelChanged, this, &KeyframeModel::sendModification);
+    // Interactive changes are sent at most once per frame at 25fps
+    m_modificationTimer.setSingleShot(true);
+    m_modificationTimer.setInterval(40);
+    connect(&m_modificationTimer, &QTimer::timeout, this, &KeyframeModel::sendModification);
 }
 
 bool KeyframeModel::addKeyframe(GenTime pos, KeyframeType::KeyframeEnum type, QVariant value, bool notify, Fun &undo, Fun &redo)
 {
-    qDebug() << "ADD keyframe" << pos.frames(pCore->getCurrentFps()); // << value << notify;
+    qDebug() << "ADD keyframe" << pos.frames(); // << value << notify;
     QWriteLocker locker(&m_lock);
     Fun local_undo = []() { return true; };
     Fun local_redo = []() { return true; };
@@ -127,7 +132,7 @@ bool KeyframeModel::addKeyframe(int frame, double normalizedValue)
     QVariant result = getNormalizedValue(normalizedValue);
     if (result.isValid()) {
         // TODO: Use default configurable kf type
-        return addKeyframe(GenTime(frame, pCore->getCurrentFps()), KeyframeType::Linear, result);
+        return addKeyframe(GenTime::fromFrames(frame), KeyframeType::Linear, result);
     }
     return false;
 }
@@ -147,7 +152,7 @@ bool KeyframeModel::addKeyframe(GenTime pos, KeyframeType::KeyframeEnum type, QV
 
 bool KeyframeModel::removeKeyframe(GenTime pos, Fun &undo, Fun &redo, bool notify, bool updateSelection, bool allowedToFail)
 {
-    qDebug() << "Going to remove keyframe at " << pos.frames(pCore->getCurrentFps()) << " NOTIFY: " << notify;
+    qDebug() << "Going to remove keyframe at " << pos.frames() << " NOTIFY: " << notify;
     qDebug() << "before" << getAnimProperty();
     QWriteLocker locker(&m_lock);
     if (!allowedToFail) {
@@ -217,7 +222,7 @@ bool KeyframeModel::duplicateKeyframe(GenTime srcPos, GenTime dstPos, Fun &undo,
 
 bool KeyframeModel::removeKeyframe(int frame)
 {
-    GenTime pos(frame, pCore->getCurrentFps());
+    GenTime pos = GenTime::fromFrames(frame);
     return removeKeyframe(pos);
 }
 
@@ -250,7 +255,7 @@ GenTime KeyframeModel::getPosAtIndex(int ix) const
 
 bool KeyframeModel::moveKeyframe(GenTime oldPos, GenTime pos, const QVariant &newVal, Fun &undo, Fun &redo, bool updateView, bool allowedToFail)
 {
-    qDebug() << "starting to move keyframe" << oldPos.frames(pCore->getCurrentFps()) << pos.frames(pCore->getCurrentFps());
+    qDebug() << "starting to move keyframe" << oldPos.frames() << pos.frames();
     QWriteLocker locker(&m_lock);
     // Check if we have several selected keyframes
     if (oldPos == pos) {
@@ -283,7 +288,7 @@ bool KeyframeModel::moveKeyframe(GenTime oldPos, GenTime pos, const QVariant &ne
                 GenTime test = positions.first();
                 auto next = getNextKeyframe(test, &ok);
                 if (ok) {
-                    delta = qMin(delta, next.first - GenTime(1, pCore->getCurrentFps()) - test);
+                    delta = qMin(delta, next.first - GenTime::fromFrames(1) - test);
                 }
             } else {
                 // Moving left
@@ -293,7 +298,7 @@ bool KeyframeModel::moveKeyframe(GenTime oldPos, GenTime pos, const QVariant &ne
                 GenTime test = positions.first();
                 auto next = getPrevKeyframe(test, &ok);
                 if (ok) {
-                    delta = qMax(delta, (next.first + GenTime(1, pCore->getCurrentFps())) - test);
+                    delta = qMax(delta, (next.first + GenTime::fromFrames(1)) - test);
                 }
             }
             if (delta == GenTime()) {
@@ -325,14 +330,14 @@ bool KeyframeModel::moveKeyframe(GenTime oldPos, GenTime pos, const QVariant &ne
                 bool ok = false;
                 auto next = getNextKeyframe(oldPos, &ok);
                 if (ok) {
-                    pos = qMin(pos, next.first - GenTime(1, pCore->getCurrentFps()));
+                    pos = qMin(pos, next.first - GenTime::fromFrames(1));
                 }
             } else {
                 // Moving left
                 bool ok = false;
                 auto next = getPrevKeyframe(oldPos, &ok);
                 if (ok) {
-                    pos = qMax(pos, next.first + GenTime(1, pCore->getCurrentFps()));
+                    pos = qMax(pos, next.first + GenTime::fromFrames(1));
                 }
             }
             return moveOneKeyframe(oldPos, pos, newVal, undo, redo, updateView, allowedToFail);
@@ -343,7 +348,7 @@ bool KeyframeModel::moveKeyframe(GenTime oldPos, GenTime pos, const QVariant &ne
 
 bool KeyframeModel::moveOneKeyframe(GenTime oldPos, GenTime pos, QVariant newVal, Fun &undo, Fun &redo, bool updateView, bool allowedToFail)
 {
-    qDebug() << "starting to move keyframe" << oldPos.frames(pCore->getCurrentFps()) << pos.frames(pCore->getCurrentFps());
+    qDebug() << "starting to move keyframe" << oldPos.frames() << pos.frames();
     QWriteLocker locker(&m_lock);
     if (!allowedToFail) {
         Q_ASSERT(m_keyframeList.count(oldPos) > 0);
@@ -371,32 +376,34 @@ bool KeyframeModel::moveOneKeyframe(GenTime oldPos, GenTime pos, QVariant newVal
     QVariant oldValue = m_keyframeList[oldPos].second;
     Fun local_undo = []() { return true; };
     Fun local_redo = []() { return true; };
-    qDebug() << getAnimProperty();
     // TODO: use the new Animation::key_set_frame to move a keyframe
-    bool res = removeKeyframe(oldPos, local_undo, local_redo, updateView, false);
-    qDebug() << "Move keyframe finished deletion:" << res;
-    qDebug() << getAnimProperty();
-    if (res) {
+    // Removal and insertion are batched so that the intermediate state is never sent to the asset
+    bool res = runBatched([&]() {
+        bool result = removeKeyframe(oldPos, local_undo, local_redo, updateView, false);
+        if (!result) {
+            return false;
+        }
         if (m_paramType == ParamType::AnimatedRect) {
             if (!newVal.isValid()) {
                 newVal = oldValue;
             }
-            res = addKeyframe(pos, oldType, newVal, updateView, local_undo, local_redo);
+            result = addKeyframe(pos, oldType, newVal, updateView, local_undo, local_redo);
         } else if (newVal.isValid()) {
-            QVariant result = getNormalizedValue(newVal.toDouble());
-            if (result.isValid()) {
-                res = addKeyframe(pos, oldType, result, updateView, local_undo, local_redo);
+            QVariant normalized = getNormalizedValue(newVal.toDouble());
+            if (normalized.isValid()) {
+                result = addKeyframe(pos, oldType, normalized, updateView, local_undo, local_redo);
             }
         } else {
-            res = addKeyframe(pos, oldType, oldValue, updateView, local_undo, local_redo);
+            result = addKeyframe(pos, oldType, oldValue, updateView, local_undo, local_redo);
         }
-        qDebug() << "Move keyframe finished insertion:" << res;
-        qDebug() << getAnimProperty();
-    }
+        return result;
+    });
     if (res) {
-        UPDATE_UNDO_REDO(local_redo, local_undo, undo, redo);
+        Fun batched_undo = [this, local_undo]() { return runBatched(local_undo); };
+        Fun batched_redo = [this, local_redo]() { return runBatched(local_redo); };
+        UPDATE_UNDO_REDO(batched_redo, batched_undo, undo, redo);
     } else {
-        bool undone = local_undo();
+        bool undone = runBatched(local_undo);
         Q_ASSERT(undone);
     }
     return res;
@@ -404,17 +411,17 @@ bool KeyframeModel::moveOneKeyframe(GenTime oldPos, GenTime pos, QVariant newVal
 
 bool KeyframeModel::moveKeyframe(int oldPos, int pos, bool logUndo)
 {
-    GenTime oPos(oldPos, pCore->getCurrentFps());
-    GenTime nPos(pos, pCore->getCurrentFps());
+    GenTime oPos = GenTime::fromFrames(oldPos);
+    GenTime nPos = GenTime::fromFrames(pos);
     return moveKeyframe(oPos, nPos, QVariant(), logUndo);
 }
 
 bool KeyframeModel::offsetKeyframes(int oldPos, int pos, bool logUndo)
 {
     if (oldPos == pos) return true;
-    GenTime oldFrame(oldPos, pCore->getCurrentFps());
+    GenTime oldFrame = GenTime::fromFrames(oldPos);
     Q_ASSERT(m_keyframeList.count(oldFrame) > 0);
-    GenTime diff(pos - oldPos, pCore->getCurrentFps());
+    GenTime diff = GenTime::fromFrames(pos - oldPos);
     QWriteLocker locker(&m_lock);
     Fun undo = []() { return true; };
     Fun redo = []() { return true; };
@@ -435,8 +442,8 @@ bool KeyframeModel::offsetKeyframes(int oldPos, int pos, bool logUndo)
 
 bool KeyframeModel::moveKeyframe(int oldPos, int pos, QVariant newVal)
 {
-    GenTime oPos(oldPos, pCore->getCurrentFps());
-    GenTime nPos(pos, pCore->getCurrentFps());
+    GenTime oPos = GenTime::fromFrames(oldPos);
+    GenTime nPos = GenTime::fromFrames(pos);
     return moveKeyframe(oPos, nPos, std::move(newVal), true);
 }
 
@@ -484,7 +491,7 @@ bool KeyframeModel::updateKeyframe(GenTime pos, const QVariant &value, Fun &undo
 
 bool KeyframeModel::updateKeyframe(int pos, double newVal)
 {
-    GenTime Pos(pos, pCore->getCurrentFps());
+    GenTime Pos = GenTime::fromFrames(pos);
     if (auto ptr = m_model.lock()) {
         double min = ptr->data(m_index, AssetParameterModel::VisualMinRole).toDouble();
         double max = ptr->data(m_index, AssetParameterModel::VisualMaxRole).toDouble();
@@ -585,11 +592,12 @@ Fun KeyframeModel::updateKeyframe_lambda(GenTime pos, KeyframeType::KeyframeEnum
 {
     QWriteLocker locker(&m_lock);
     return [this, pos, type, value, notify]() {
-        // qDebug() << "update lambda" << pos.frames(pCore->getCurrentFps()) << value << notify;
+        // qDebug() << "update lambda" << pos.frames() << value << notify;
         Q_ASSERT(m_keyframeList.count(pos) > 0);
         int row = static_cast<int>(std::distance(m_keyframeList.begin(), m_keyframeList.find(pos)));
         m_keyframeList[pos].first = type;
         m_keyframeList[pos].second = value;
+        invalidateCompiledKeyframes();
         if (notify) Q_EMIT dataChanged(index(row), index(row), {ValueRole, NormalizedValueRole, TypeRole});
         return true;
     };
@@ -599,7 +607,7 @@ Fun KeyframeModel::addKeyframe_lambda(GenTime pos, KeyframeType::KeyframeEnum ty
 {
     QWriteLocker locker(&m_lock);
     return [this, notify, pos, type, value]() {
-        qDebug() << "add lambda" << pos.frames(pCore->getCurrentFps()) << value << notify;
+        qDebug() << "add lambda" << pos.frames() << value << notify;
         Q_ASSERT(m_keyframeList.count(pos) == 0);
         // We determine the row of the newly added marker
         auto insertionIt = m_keyframeList.lower_bound(pos);
@@ -610,6 +618,7 @@ Fun KeyframeModel::addKeyframe_lambda(GenTime pos, KeyframeType::KeyframeEnum ty
         if (notify) beginInsertRows(QModelIndex(), insertionRow, insertionRow);
         m_keyframeList[pos].first = type;
         m_keyframeList[pos].second = value;
+        invalidateCompiledKeyframes();
         if (notify) endInsertRows();
         return true;
     };
@@ -619,15 +628,14 @@ Fun KeyframeModel::deleteKeyframe_lambda(GenTime pos, bool notify)
 {
     QWriteLocker locker(&m_lock);
     return [this, pos, notify]() {
-        qDebug() << "delete lambda" << pos.frames(pCore->getCurrentFps()) << notify;
-        qDebug() << "before" << getAnimProperty();
+        qDebug() << "delete lambda" << pos.frames() << notify;
         Q_ASSERT(m_keyframeList.count(pos) > 0);
         // Q_ASSERT(pos != GenTime()); // cannot delete initial point
         int row = static_cast<int>(std::distance(m_keyframeList.begin(), m_keyframeList.find(pos)));
         if (notify) beginRemoveRows(QModelIndex(), row, row);
         m_keyframeList.erase(pos);
+        invalidateCompiledKeyframes();
         if (notify) endRemoveRows();
-        qDebug() << "after" << getAnimProperty();
         return true;
     };
 }
@@ -715,7 +723,7 @@ QVariant KeyframeModel::data(const QModelIndex &index, int role) const
         return it->first.seconds();
     case FrameRole:
     case Qt::UserRole:
-        return it->first.frames(pCore->getCurrentFps());
+        return it->first.frames();
     case TypeRole:
         return QVariant::fromValue<KeyframeType::KeyframeEnum>(it->second.first);
     case SelectedRole:
@@ -808,7 +816,7 @@ Keyframe KeyframeModel::getClosestKeyframe(const GenTime &pos, bool *ok) const
 
 bool KeyframeModel::hasKeyframe(int frame) const
 {
-    return hasKeyframe(GenTime(frame, pCore->getCurrentFps()));
+    return hasKeyframe(GenTime::fromFrames(frame));
 }
 bool KeyframeModel::hasKeyframe(const GenTime &pos) const
 {
@@ -895,37 +903,77 @@ QString KeyframeModel::getAnimProperty() const
     if (m_paramType == ParamType::Roto_spline) {
         return getRotoProperty();
     }
+    QMutexLocker lk(&m_compiledMutex);
+    if (!m_animPropertyCache.isEmpty() && m_compiledGeneration == s_compiledGeneration.load()) {
+        return m_animPropertyCache;
+    }
+    const std::vector<CompiledKeyframe> &keyframes = compiledKeyframes();
+    if (keyframes.empty()) {
+        return QString();
+    }
     Mlt::Properties mlt_prop;
     if (auto ptr = m_model.lock()) {
         ptr->passProperties(mlt_prop);
     }
-    int ix = 0;
-    bool first = true;
-    std::shared_ptr<Mlt::Animation> anim(nullptr);
-    for (const auto &keyframe : m_keyframeList) {
-        switch (m_paramType) {
-        case ParamType::AnimatedRect:
-        case ParamType::Color:
-            mlt_prop.anim_set("key", keyframe.second.second.toString().toUtf8().constData(), keyframe.first.frames(pCore->getCurrentFps()));
-            break;
-        default:
-            mlt_prop.anim_set("key", keyframe.second.second.toDouble(), keyframe.first.frames(pCore->getCurrentFps()));
-            break;
+    bool textValues = hasTextValues();
+    for (const auto &keyframe : keyframes) {
+        if (textValues) {
+            mlt_prop.anim_set("key", keyframe.text.constData(), keyframe.frame);
+        } else {
+            mlt_prop.anim_set("key", keyframe.value, keyframe.frame, 0, keyframe.type);
         }
-        if (first) {
-            anim.reset(mlt_prop.get_anim("key"));
-            first = false;
+    }
+    Mlt::Animation anim = mlt_prop.get_animation("key");
+    if (textValues) {
+        for (int ix = 0; ix < int(keyframes.size()); ix++) {
+            anim.key_set_type(ix, keyframes.at(size_t(ix)).type);
         }
-        anim->key_set_type(ix, convertToMltType(keyframe.second.first));
-        ix++;
     }
-    QString ret;
-    if (anim) {
-        char *cut = anim->serialize_cut();
-        ret = QString(cut);
-        free(cut);
+    char *cut = anim.serialize_cut();
+    m_animPropertyCache = QString(cut);
+    free(cut);
+    return m_animPropertyCache;
+}
+
+bool KeyframeModel::hasTextValues() const
+{
+    return m_paramType == ParamType::AnimatedRect || m_paramType == ParamType::Color;
+}
+
+const std::vector<KeyframeModel::CompiledKeyframe> &KeyframeModel::compiledKeyframes() const
+{
+    const int generation = s_compiledGeneration.load();
+    if (m_compiledDirty || m_compiledGeneration != generation) {
+        double fps = pCore->getCurrentFps();
+        bool textValues = hasTextValues();
+        m_compiledKeyframes.clear();
+        m_compiledKeyframes.reserve(m_keyframeList.size());
+        for (const auto &keyframe : m_keyframeList) {
+            CompiledKeyframe compiled{keyframe.first.frames(fps), convertToMltType(keyframe.second.first), 0., QByteArray()};
+            if (textValues) {
+                compiled.text = keyframe.second.second.toString().toUtf8();
+            } else {
+                compiled.value = keyframe.second.second.toDouble();
+            }
+            m_compiledKeyframes.push_back(std::move(compiled));
+        }
+        m_compiledDirty = false;
+        m_compiledGeneration = generation;
+        m_animPropertyCache.clear();
     }
-    return ret;
+    return m_compiledKeyframes;
+}
+
+void KeyframeModel::invalidateAllCompiledKeyframes()
+{
+    s_compiledGeneration++;
+}
+
+void KeyframeModel::invalidateCompiledKeyframes()
+{
+    QMutexLocker lk(&m_compiledMutex);
+    m_compiledDirty = true;
+    m_animPropertyCache.clear();
 }
 
 QString KeyframeModel::getRotoProperty() const
@@ -936,7 +984,7 @@ QString KeyframeModel::getRotoProperty() const
         int out = in + ptr->data(m_index, AssetParameterModel::ParentDurationRole).toInt();
         QVariantMap map;
         for (const auto &keyframe : m_keyframeList) {
-            map.insert(QString::number(keyframe.first.frames(pCore->getCurrentFps())).rightJustified(int(log10(double(out))) + 1, '0'), keyframe.second.second);
+            map.insert(QString::number(keyframe.first.frames()).rightJustified(int(log10(double(out))) + 1, '0'), keyframe.second.second);
         }
         doc = QJsonDocument::fromVariant(map);
     }
@@ -1010,13 +1058,13 @@ void KeyframeModel::parseAnimProperty(const QString &prop, int in, int out)
         }
         if (i == 0 && frame > in) {
             // Always add a keyframe at start pos
-            addKeyframe(GenTime(in, pCore->getCurrentFps()), convertFromMltType(type), value, true, undo, redo);
+            addKeyframe(GenTime::fromFrames(in), convertFromMltType(type), value, true, undo, redo);
         } else if (frame == in && hasKeyframe(GenTime(in))) {
             // First keyframe already exists, adjust its value
-            updateKeyframe(GenTime(frame, pCore->getCurrentFps()), value, undo, redo, true);
+            updateKeyframe(GenTime::fromFrames(frame), value, undo, redo, true);
             continue;
         }
-        addKeyframe(GenTime(frame, pCore->getCurrentFps()), convertFromMltType(type), value, true, undo, redo);
+        addKeyframe(GenTime::fromFrames(frame), convertFromMltType(type), value, true, undo, redo);
     }
     connect(this, &KeyframeModel::modelChanged, this, &KeyframeModel::sendModification);
 }
@@ -1081,13 +1129,13 @@ void KeyframeModel::resetAnimProperty(const QString &prop)
         }
         if (i == 0 && frame > in) {
             // Always add a keyframe at start pos
-            addKeyframe(GenTime(in, pCore->getCurrentFps()), convertFromMltType(type), value, false, undo, redo);
+            addKeyframe(GenTime::fromFrames(in), convertFromMltType(type), value, false, undo, redo);
         } else if (frame == in && hasKeyframe(GenTime(in))) {
             // First keyframe already exists, adjust its value
-            updateKeyframe(GenTime(frame, pCore->getCurrentFps()), value, undo, redo, false);
+            updateKeyframe(GenTime::fromFrames(frame), value, undo, redo, false);
             continue;
         }
-        addKeyframe(GenTime(frame, pCore->getCurrentFps()), convertFromMltType(type), value, false, undo, redo);
+        addKeyframe(GenTime::fromFrames(frame), convertFromMltType(type), value, false, undo, redo);
     }
     QString effectName;
     if (auto ptr = m_model.lock()) {
@@ -1117,7 +1165,7 @@ void KeyframeModel::parseRotoProperty(const QString &prop)
         QMap<QString, QVariant> map = data.toMap();
         QMap<QString, QVariant>::const_iterator i = map.constBegin();
         while (i != map.constEnd()) {
-            addKeyframe(GenTime(i.key().toInt(), pCore->getCurrentFps()), KeyframeType::Linear, i.value(), false, undo, redo);
+            addKeyframe(GenTime::fromFrames(i.key().toInt()), KeyframeType::Linear, i.value(), false, undo, redo);
             ++i;
         }
     }
@@ -1125,17 +1173,15 @@ void KeyframeModel::parseRotoProperty(const QString &prop)
 
 QVariant KeyframeModel::getInterpolatedValue(int p) const
 {
-    auto pos = GenTime(p, pCore->getCurrentFps());
+    auto pos = GenTime::fromFrames(p);
     return getInterpolatedValue(pos);
 }
 
 QVariant KeyframeModel::updateInterpolated(const QVariant &interpValue, double val)
 {
-    QStringList vals = interpValue.toString().split(QLatin1Char(' '));
-    if (!vals.isEmpty()) {
-        vals[vals.size() - 1] = QString::number(val, 'f');
-    }
-    return vals.join(QLatin1Char(' '));
+    // Replace the last component of the value
+    const QString value = interpValue.toString();
+    return QString(value.left(value.lastIndexOf(QLatin1Char(' ')) + 1) + QString::number(val, 'f'));
 }
 
 QVariant KeyframeModel::getNormalizedValue(double newVal) const
@@ -1172,45 +1218,68 @@ QVariant KeyframeModel::getNormalizedValue(double newVal) const
 
 QVariant KeyframeModel::getInterpolatedValue(const GenTime &pos) const
 {
-    if (m_keyframeList.count(pos) > 0) {
-        return m_keyframeList.at(pos).second;
+    auto exact = m_keyframeList.find(pos);
+    if (exact != m_keyframeList.end()) {
+        return exact->second.second;
     }
     if (m_keyframeList.size() == 0) {
         return QVariant();
     }
     Mlt::Properties mlt_prop;
-    QString animData;
     int out = 0;
     bool useOpacity = false;
     if (auto ptr = m_model.lock()) {
         ptr->passProperties(mlt_prop);
         out = ptr->data(m_index, AssetParameterModel::ParentDurationRole).toInt();
         useOpacity = ptr->data(m_index, AssetParameterModel::OpacityRole).toBool();
-        animData = ptr->data(m_index, AssetParameterModel::ValueRole).toString();
     }
 
-    if (!animData.isEmpty() && (m_paramType == ParamType::KeyframeParam || m_paramType == ParamType::ColorWheel)) {
-        mlt_prop.set("key", animData.toUtf8().constData());
-        // This is a fake query to force the animation to be parsed
-        (void)mlt_prop.anim_get_double("key", 0, out);
-        return QVariant(mlt_prop.anim_get_double("key", pos.frames(pCore->getCurrentFps())));
+    bool animated = m_paramType == ParamType::KeyframeParam || m_paramType == ParamType::ColorWheel || m_paramType == ParamType::AnimatedRect ||
+                    m_paramType == ParamType::Color;
+    int frame = pos.frames();
+    if (animated) {
+        // Only the keyframes surrounding the position are passed to MLT: linear interpolation uses the previous and next keyframes,
+        // smooth curves one more keyframe on each side.
+        QMutexLocker lk(&m_compiledMutex);
+        const std::vector<CompiledKeyframe> &keyframes = compiledKeyframes();
+        auto next = std::upper_bound(keyframes.cbegin(), keyframes.cend(), frame, [](int f, const CompiledKeyframe &k) { return f < k.frame; });
+        auto first = next;
+        for (int i = 0; i < 2 && first != keyframes.cbegin(); i++) {
+            --first;
+        }
+        auto last = next;
+        for (int i = 0; i < 2 && last != keyframes.cend(); i++) {
+            ++last;
+        }
+        bool textValues = hasTextValues();
+        for (auto it = first; it != last; ++it) {
+            if (textValues) {
+                mlt_prop.anim_set("key", it->text.constData(), it->frame, out);
+            } else {
+                mlt_prop.anim_set("key", it->value, it->frame, out, it->type);
+            }
+        }
+        if (textValues) {
+            Mlt::Animation anim = mlt_prop.get_animation("key");
+            int ix = 0;
+            for (auto it = first; it != last; ++it, ++ix) {
+                anim.key_set_type(ix, it->type);
+            }
+        }
     }
-    if (!animData.isEmpty() && m_paramType == ParamType::AnimatedRect) {
-        mlt_prop.set("key", animData.toUtf8().constData());
-        // This is a fake query to force the animation to be parsed
-        (void)mlt_prop.anim_get_double("key", 0, out);
-        mlt_rect rect = mlt_prop.anim_get_rect("key", pos.frames(pCore->getCurrentFps()));
+    if (m_paramType == ParamType::KeyframeParam || m_paramType == ParamType::ColorWheel) {
+        return QVariant(mlt_prop.anim_get_double("key", frame));
+    }
+    if (m_paramType == ParamType::AnimatedRect) {
+        mlt_rect rect = mlt_prop.anim_get_rect("key", frame);
         QString res = QStringLiteral("%1 %2 %3 %4").arg(int(rect.x)).arg(int(rect.y)).arg(int(rect.w)).arg(int(rect.h));
         if (useOpacity) {
             res.append(QStringLiteral(" %1").arg(QString::number(rect.o, 'f')));
         }
         return QVariant(res);
     }
-    if (!animData.isEmpty() && m_paramType == ParamType::Color) {
-        mlt_prop.set("key", animData.toUtf8().constData());
-        // This is a fake query to force the animation to be parsed
-        (void)mlt_prop.anim_get_double("key", 0, out);
-        mlt_color mltColor = mlt_prop.anim_get_color("key", pos.frames(pCore->getCurrentFps()));
+    if (m_paramType == ParamType::Color) {
+        mlt_color mltColor = mlt_prop.anim_get_color("key", frame);
         QColor color(mltColor.r, mltColor.g, mltColor.b, mltColor.a);
         return QVariant(QColorUtils::colorToString(color, true));
     }
@@ -1235,8 +1304,8 @@ QVariant KeyframeModel::getInterpolatedValue(const GenTime &pos) const
         // - equal to 1 on next keyframe
         qreal relPos = 0;
         if (next->first != prev->first) {
-            relPos = (pos.frames(pCore->getCurrentFps()) - prev->first.frames(pCore->getCurrentFps())) /
-                     qreal(((next->first - prev->first).frames(pCore->getCurrentFps())));
+            relPos = (pos.frames() - prev->first.frames()) /
+                     qreal(((next->first - prev->first).frames()));
         }
         int count = qMin(p1.count(), p2.count());
         QList<QVariant> vlist;
@@ -1260,6 +1329,17 @@ QVariant KeyframeModel::getInterpolatedValue(const GenTime &pos) const
 
 void KeyframeModel::sendModification()
 {
+    if (m_batchDepth > 0) {
+        m_modificationPending = true;
+        return;
+    }
+    if (m_interactiveUpdate) {
+        if (!m_modificationTimer.isActive()) {
+            m_modificationTimer.start();
+        }
+        return;
+    }
+    m_modificationTimer.stop();
     if (auto ptr = m_model.lock()) {
         Q_ASSERT(m_index.isValid());
         const QString name = ptr->data(m_index, AssetParameterModel::NameRole).toString();
@@ -1272,6 +1352,23 @@ void KeyframeModel::sendModification()
     }
 }
 
+void KeyframeModel::setInteractiveUpdate(bool interactive)
+{
+    m_interactiveUpdate = interactive;
+}
+
+bool KeyframeModel::runBatched(const Fun &operation)
+{
+    m_batchDepth++;
+    bool res = operation();
+    m_batchDepth--;
+    if (m_batchDepth == 0 && m_modificationPending) {
+        m_modificationPending = false;
+        sendModification();
+    }
+    return res;
+}
+
 QString KeyframeModel::realValueFromInternal(double internalValue) const
 {
     if (auto ptr = m_model.lock()) {
@@ -11,13 +11,17 @@
 #include "utils/gentime.h"
 
 #include <QAbstractListModel>
+#include <QMutex>
 #include <QReadWriteLock>
+#include <QTimer>
 #include <QtGlobal>
 
 #include <framework/mlt_version.h>
 
+#include <atomic>
 #include <map>
 #include <memory>
+#include <vector>
 
 class AssetParameterModel;
 class DocUndoStack;
@@ -169,6 +173,8 @@ public:
     static const QString getIconByKeyframeType(KeyframeType::KeyframeEnum type);
     static void initKeyframeTypes();
     static const QMap<KeyframeType::KeyframeEnum, QString> getKeyframeTypes();
+    /** @brief The project fps changed, the frames of all compiled keyframes must be computed again */
+    static void invalidateAllCompiledKeyframes();
     /** @brief Used for testing */
     int keyframesCount() const;
     QList<QVariant> testSerializeKeyframes() const;
@@ -188,6 +194,11 @@ protected:
 
     /** @brief Commit the modification to the model */
     void sendModification();
+    /** @brief When enabled, modifications are sent to the model at most once per refresh interval.
+        This is used while interactively dragging keyframes, the final move is always sent directly */
+    void setInteractiveUpdate(bool interactive);
+    /** @brief Run an operation made of several keyframe changes, the model is only updated once at the end */
+    bool runBatched(const Fun &operation);
 
     /** @brief returns the keyframes as a Mlt Anim Property string.
         It is defined as pairs of frame and value, separated by ;
@@ -216,6 +227,34 @@ private:
     mutable QReadWriteLock m_lock;
 
     std::map<GenTime, std::pair<KeyframeType::KeyframeEnum, QVariant>> m_keyframeList;
+
+    /** @brief A keyframe converted to the MLT types, so that interpolation and serialization don't parse the QVariant values again */
+    struct CompiledKeyframe
+    {
+        int frame;
+        mlt_keyframe_type type;
+        double value;
+        QByteArray text;
+    };
+    /** @brief The keyframes of m_keyframeList in MLT format, rebuilt on first use after a change */
+    mutable std::vector<CompiledKeyframe> m_compiledKeyframes;
+    mutable bool m_compiledDirty{true};
+    /** @brief Value of s_compiledGeneration when the keyframes were compiled */
+    mutable int m_compiledGeneration{-1};
+    /** @brief Incremented when the project fps changes, invalidating the compiled keyframes of all models */
+    static std::atomic<int> s_compiledGeneration;
+    /** @brief The serialized animation, empty when it needs to be rebuilt */
+    mutable QString m_animPropertyCache;
+    mutable QMutex m_compiledMutex;
+    QTimer m_modificationTimer;
+    bool m_interactiveUpdate{false};
+    int m_batchDepth{0};
+    bool m_modificationPending{false};
+    /** @brief Returns the compiled keyframes, m_compiledMutex must be locked */
+    const std::vector<CompiledKeyframe> &compiledKeyframes() const;
+    void invalidateCompiledKeyframes();
+    /** @brief Returns true if the MLT animation of this parameter uses string values (rect and color) */
+    bool hasTextValues() const;
     bool moveOneKeyframe(GenTime oldPos, GenTime pos, QVariant newVal, Fun &undo, Fun &redo, bool updateView = true, bool allowedToFail = false);
 
 Q_SIGNALS:
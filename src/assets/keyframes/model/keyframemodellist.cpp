@@ -390,7 +390,14 @@ bool KeyframeModelList::moveKeyframe(GenTime oldPos, GenTime pos, bool logUndo,
     const QString opText = logUndo ? i18nc("@action", "Move keyframe") : QString();
     Fun undo = []() { return true; };
     Fun redo = []() { return true; };
+    // Moves without undo are interactive drags, throttle the updates sent to the asset
+    for (const auto &param : m_parameters) {
+        param.second->setInteractiveUpdate(!logUndo);
+    }
     bool res = applyOperation(op, undo, redo);
+    for (const auto &param : m_parameters) {
+        param.second->setInteractiveUpdate(false);
+    }
     if (res && KdenliveSettings::applyEffectParamsToGroup()) {
         ObjectId id = getOwnerId();
         double fps = pCore->getCurrentFps();
@@ -674,7 +681,7 @@ void KeyframeModelList::setParametersFromTask(const paramVector &params)
     paramVector previousParams;
     // Collect all parameters previous values for undo
     if (auto ptr = m_model.lock()) {
-        READ_LOCK();
+        READ_WRITE_LOCK();
         for (const auto &param : m_parameters) {
             const QString paramName = ptr->data(param.first, AssetParameterModel::NameRole).toString();
             QPair<QString, QVariant> val(paramName, ptr->getParamFromName(paramName));
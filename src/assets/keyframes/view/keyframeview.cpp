@@ -131,10 +131,10 @@ void KeyframeView::slotDuplicateKeyframe()
     if (m_model->activeKeyframe() > -1 && !m_model->hasKeyframe(m_position + offset)) {
         Fun undo = []() { return true; };
         Fun redo = []() { return true; };
-        int delta = offset + m_position - m_model->getPosAtIndex(m_model->activeKeyframe()).frames(pCore->getCurrentFps());
+        int delta = offset + m_position - m_model->getPosAtIndex(m_model->activeKeyframe()).frames();
         for (int &kf : m_model->selectedKeyframes()) {
-            int kfrPos = m_model->getPosAtIndex(kf).frames(pCore->getCurrentFps());
-            m_model->duplicateKeyframeWithUndo(GenTime(kfrPos, pCore->getCurrentFps()), GenTime(kfrPos + delta, pCore->getCurrentFps()), undo, redo);
+            int kfrPos = m_model->getPosAtIndex(kf).frames();
+            m_model->duplicateKeyframeWithUndo(GenTime::fromFrames(kfrPos), GenTime::fromFrames(kfrPos + delta), undo, redo);
         }
         pCore->pushUndo(undo, redo, i18n("Duplicate keyframe"));
     }
@@ -149,7 +149,7 @@ void KeyframeView::slotEditType(int type, const QPersistentModelIndex &index)
 {
     int offset = pCore->getItemIn(m_model->getOwnerId());
     if (m_model->hasKeyframe(m_position + offset)) {
-        m_model->updateKeyframeType(GenTime(m_position + offset, pCore->getCurrentFps()), type, index);
+        m_model->updateKeyframeType(GenTime::fromFrames(m_position + offset), type, index);
     }
 }
 
@@ -179,9 +179,9 @@ void KeyframeView::slotCenterKeyframe()
             updatedSelection << 0;
             continue;
         }
-        int kfPos = m_model->getPosAtIndex(kf).frames(pCore->getCurrentFps());
-        GenTime initPos(kfPos, pCore->getCurrentFps());
-        GenTime targetPos(kfPos + delta, pCore->getCurrentFps());
+        int kfPos = m_model->getPosAtIndex(kf).frames();
+        GenTime initPos = GenTime::fromFrames(kfPos);
+        GenTime targetPos = GenTime::fromFrames(kfPos + delta);
         m_model->moveKeyframeWithUndo(initPos, targetPos, undo, redo);
         break;
     }
@@ -215,17 +215,17 @@ void KeyframeView::mousePressEvent(QMouseEvent *event)
         if (event->position().y() < m_lineHeight) {
             // mouse click in keyframes area
             bool ok;
-            GenTime position(pos + offset, pCore->getCurrentFps());
+            GenTime position = GenTime::fromFrames(pos + offset);
             if (event->modifiers() & Qt::ShiftModifier) {
                 m_clickPoint = pos;
                 return;
             }
             m_keyframeZonePress = true;
             auto keyframe = m_model->getClosestKeyframe(position, &ok);
-            if (ok && qAbs(keyframe.first.frames(pCore->getCurrentFps()) - pos - offset) * m_scale * m_zoomFactor < QApplication::startDragDistance()) {
+            if (ok && qAbs(keyframe.first.frames() - pos - offset) * m_scale * m_zoomFactor < QApplication::startDragDistance()) {
                 // Select and seek to keyframe
                 int currentIx = m_model->getIndexForPos(keyframe.first);
-                m_currentKeyframeOriginal = keyframe.first.frames(pCore->getCurrentFps());
+                m_currentKeyframeOriginal = keyframe.first.frames();
                 if (m_currentKeyframeOriginal > -1) {
                     if (KdenliveSettings::keyframeseek()) {
                         Q_EMIT seekToPos(m_currentKeyframeOriginal - offset);
@@ -297,7 +297,7 @@ void KeyframeView::mouseMoveEvent(QMouseEvent *event)
         return;
     }
     pos = qBound(0, pos, m_duration - 1);
-    GenTime position(pos + offset, pCore->getCurrentFps());
+    GenTime position = GenTime::fromFrames(pos + offset);
     if ((event->buttons() & Qt::LeftButton) != 0u) {
         if (m_hoverZoomIn || m_hoverZoomOut || m_hoverZoom) {
             // Moving zoom handles
@@ -339,10 +339,10 @@ void KeyframeView::mouseMoveEvent(QMouseEvent *event)
              (qAbs(pos - (m_currentKeyframeOriginal - offset)) * m_scale * m_zoomFactor < QApplication::startDragDistance() && m_keyframeZonePress))) {
             m_moveKeyframeMode = true;
             if (!m_model->hasKeyframe(pos + offset)) {
-                int delta = pos - (m_model->getPosAtIndex(m_model->activeKeyframe()).frames(pCore->getCurrentFps()) - offset);
+                int delta = pos - (m_model->getPosAtIndex(m_model->activeKeyframe()).frames() - offset);
                 // Check that the move is possible
                 for (int &kf : m_model->selectedKeyframes()) {
-                    int updatedPos = m_model->getPosAtIndex(kf).frames(pCore->getCurrentFps()) + delta;
+                    int updatedPos = m_model->getPosAtIndex(kf).frames() + delta;
                     if (m_model->hasKeyframe(updatedPos)) {
                         // Don't allow moving over another keyframe
                         return;
@@ -353,9 +353,9 @@ void KeyframeView::mouseMoveEvent(QMouseEvent *event)
                         // Don't allow moving first keyframe
                         continue;
                     }
-                    int kfPos = m_model->getPosAtIndex(kf).frames(pCore->getCurrentFps());
-                    GenTime currentPos(kfPos, pCore->getCurrentFps());
-                    GenTime updatedPos(kfPos + delta, pCore->getCurrentFps());
+                    int kfPos = m_model->getPosAtIndex(kf).frames();
+                    GenTime currentPos = GenTime::fromFrames(kfPos);
+                    GenTime updatedPos = GenTime::fromFrames(kfPos + delta);
                     if (!m_model->moveKeyframe(currentPos, updatedPos, false)) {
                         qDebug() << "=== FAILED KF MOVE!!!";
                         Q_ASSERT(false);
@@ -385,7 +385,7 @@ void KeyframeView::mouseMoveEvent(QMouseEvent *event)
             }
             if (!m_model->selectedKeyframes().isEmpty()) {
                 m_model->setActiveKeyframe(m_model->selectedKeyframes().first());
-                m_currentKeyframeOriginal = m_model->getPosAtIndex(m_model->selectedKeyframes().first()).frames(pCore->getCurrentFps());
+                m_currentKeyframeOriginal = m_model->getPosAtIndex(m_model->selectedKeyframes().first()).frames();
             }
             update();
             return;
@@ -401,9 +401,9 @@ void KeyframeView::mouseMoveEvent(QMouseEvent *event)
     if (event->position().y() < m_lineHeight) {
         bool ok;
         auto keyframe = m_model->getClosestKeyframe(position, &ok);
-        if (ok && qAbs(((position.frames(pCore->getCurrentFps()) - keyframe.first.frames(pCore->getCurrentFps())) * m_scale) * m_zoomFactor) <
+        if (ok && qAbs(((position.frames() - keyframe.first.frames()) * m_scale) * m_zoomFactor) <
                       QApplication::startDragDistance()) {
-            m_hoverKeyframe = keyframe.first.frames(pCore->getCurrentFps()) - offset;
+            m_hoverKeyframe = keyframe.first.frames() - offset;
             setCursor(Qt::PointingHandCursor);
             setToolTip(KeyframeModel::getKeyframeTypes().value(keyframe.second));
             m_hoverZoomIn = false;
@@ -461,17 +461,17 @@ void KeyframeView::mouseReleaseEvent(QMouseEvent *event)
         update();
     }
     if (m_moveKeyframeMode && m_model->activeKeyframe() >= 0 &&
-        m_currentKeyframeOriginal != m_model->getPosAtIndex(m_model->activeKeyframe()).frames(pCore->getCurrentFps())) {
-        int delta = m_model->getPosAtIndex(m_model->activeKeyframe()).frames(pCore->getCurrentFps()) - m_currentKeyframeOriginal;
+        m_currentKeyframeOriginal != m_model->getPosAtIndex(m_model->activeKeyframe()).frames()) {
+        int delta = m_model->getPosAtIndex(m_model->activeKeyframe()).frames() - m_currentKeyframeOriginal;
         // Move back all keyframes to their initial positions
         for (int &kf : m_model->selectedKeyframes()) {
             if (kf == 0) {
                 // Don't allow moving first keyframe
                 continue;
             }
-            int kfPos = m_model->getPosAtIndex(kf).frames(pCore->getCurrentFps());
-            GenTime initPos(kfPos - delta, pCore->getCurrentFps());
-            GenTime targetPos(kfPos, pCore->getCurrentFps());
+            int kfPos = m_model->getPosAtIndex(kf).frames();
+            GenTime initPos = GenTime::fromFrames(kfPos - delta);
+            GenTime targetPos = GenTime::fromFrames(kfPos);
             m_model->moveKeyframe(targetPos, initPos, false, true);
             break;
         }
@@ -483,13 +483,13 @@ void KeyframeView::mouseReleaseEvent(QMouseEvent *event)
                 // Don't allow moving first keyframe
                 continue;
             }
-            int kfPos = m_model->getPosAtIndex(kf).frames(pCore->getCurrentFps());
-            GenTime initPos(kfPos, pCore->getCurrentFps());
-            GenTime targetPos(kfPos + delta, pCore->getCurrentFps());
+            int kfPos = m_model->getPosAtIndex(kf).frames();
+            GenTime initPos = GenTime::fromFrames(kfPos);
+            GenTime targetPos = GenTime::fromFrames(kfPos + delta);
             m_model->moveKeyframeWithUndo(initPos, targetPos, undo, redo);
             break;
         }
-        m_currentKeyframeOriginal = m_model->getPosAtIndex(m_model->activeKeyframe()).frames(pCore->getCurrentFps());
+        m_currentKeyframeOriginal = m_model->getPosAtIndex(m_model->activeKeyframe()).frames();
         pCore->pushUndo(undo, redo, i18np("Move keyframe", "Move keyframes", m_model->selectedKeyframes().size()));
         qDebug() << "RELEASING keyframe move" << delta;
     }
@@ -506,14 +506,14 @@ void KeyframeView::mouseDoubleClickEvent(QMouseEvent *event)
         double zoomFactor = (width() - 2 * m_offset) / (zoomEnd - zoomStart);
         int pos = int(((event->position().x() - m_offset) / zoomFactor + zoomStart) / m_scale);
         pos = qBound(0, pos, m_duration - 1);
-        GenTime position(pos + offset, pCore->getCurrentFps());
+        GenTime position = GenTime::fromFrames(pos + offset);
         bool ok;
         auto keyframe = m_model->getClosestKeyframe(position, &ok);
-        if (ok && qAbs(keyframe.first.frames(pCore->getCurrentFps()) - pos - offset) * m_scale * m_zoomFactor < QApplication::startDragDistance()) {
-            if (keyframe.first.frames(pCore->getCurrentFps()) != offset) {
+        if (ok && qAbs(keyframe.first.frames() - pos - offset) * m_scale * m_zoomFactor < QApplication::startDragDistance()) {
+            if (keyframe.first.frames() != offset) {
                 m_model->removeKeyframe(keyframe.first);
                 m_currentKeyframeOriginal = -1;
-                if (keyframe.first.frames(pCore->getCurrentFps()) == m_position + offset) {
+                if (keyframe.first.frames() == m_position + offset) {
                     Q_EMIT atKeyframe(false, m_model->singleKeyframe());
                 }
             }
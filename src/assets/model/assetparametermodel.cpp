@@ -1255,6 +1255,19 @@ QJsonDocument AssetParameterModel::toJson(QVector<int> selection, bool includeFi
     return QJsonDocument(list);
 }
 
+qint64 AssetParameterModel::memoryCost() const
+{
+    qint64 cost = 0;
+    // The values are stored in the MLT service and in the parameter rows
+    for (int i = 0; i < m_asset->count(); ++i) {
+        cost += qint64(qstrlen(m_asset->get_name(i)) + qstrlen(m_asset->get(i)));
+    }
+    for (const auto &param : m_params) {
+        cost += (param.first.size() + param.second.value.toString().size()) * qint64(sizeof(QChar));
+    }
+    return cost;
+}
+
 QJsonDocument AssetParameterModel::valueAsJson(int pos, bool includeFixed) const
 {
     QJsonArray list;
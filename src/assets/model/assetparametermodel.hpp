@@ -162,6 +162,8 @@ public:
      *  @param percentageExport if true, the animated rect parameters will be exported in percentage instead of pixel value
      */
     QJsonDocument toJson(QVector<int> selection = {}, bool includeFixed = true, bool percentageExport = false) const;
+    /** @brief Returns the size in bytes of the parameter names and values, kept by the undo commands that hold this asset */
+    qint64 memoryCost() const;
     /** @brief Returns the interpolated value at the given position with all param values as json*/
     QJsonDocument valueAsJson(int pos, bool includeFixed = true) const;
 
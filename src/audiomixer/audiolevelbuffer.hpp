@@ -0,0 +1,122 @@
+/*
+    SPDX-FileCopyrightText: 2026 Kdenlive contributors
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#pragma once
+
+#include <QVector>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <memory>
+
+/** @class AudioLevelBuffer
+    @brief Fixed size store of the audio levels of the last rendered frames of a mixer track.
+    The MLT consumer thread pushes the levels of each frame (single producer), the GUI thread fetches the levels of the displayed
+    frame (single consumer). No memory is allocated and no lock is taken once the buffer is constructed: each slot is guarded by a
+    sequence counter so that the reader detects, and ignores, a slot that was overwritten while it was read.
+ */
+class AudioLevelBuffer
+{
+public:
+    static constexpr int MaxChannels = 8;
+
+    AudioLevelBuffer(int capacity, int channels)
+        : m_slots(new Slot[size_t(std::max(1, capacity))])
+        , m_capacity(std::max(1, capacity))
+        , m_channels(qBound(1, channels, int(MaxChannels)))
+    {
+    }
+
+    int channels() const { return m_channels; }
+
+    /** @brief Store the levels of the frame at @param position, producer thread only
+     *  @returns false if the levels of this frame are already stored, they are then left unchanged */
+    bool push(int position, const double *levels)
+    {
+        const quint32 index = m_head.load(std::memory_order_relaxed);
+        if (isStored(index, position)) {
+            return false;
+        }
+        Slot &slot = m_slots[index % quint32(m_capacity)];
+        const quint32 sequence = slot.sequence.load(std::memory_order_relaxed);
+        // An odd sequence marks the slot as being written
+        slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.generation.store(m_generation.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        slot.position.store(position, std::memory_order_relaxed);
+        for (int i = 0; i < m_channels; ++i) {
+            slot.values[size_t(i)].store(levels[i], std::memory_order_relaxed);
+        }
+        slot.sequence.store(sequence + 2, std::memory_order_release);
+        m_head.store(index + 1, std::memory_order_release);
+        return true;
+    }
+
+    /** @brief Fetch the levels of the frame at @param position, consumer thread only
+     *  @returns false if this frame is not (or no longer) in the buffer */
+    bool levels(int position, QVector<double> &levels) const
+    {
+        const quint32 head = m_head.load(std::memory_order_acquire);
+        const quint32 generation = m_generation.load(std::memory_order_relaxed);
+        const quint32 count = std::min(head, quint32(m_capacity));
+        std::array<double, MaxChannels> values;
+        // Most recent frames first
+        for (quint32 i = 1; i <= count; ++i) {
+            const Slot &slot = m_slots[(head - i) % quint32(m_capacity)];
+            const quint32 sequence = slot.sequence.load(std::memory_order_acquire);
+            if (sequence & 1) {
+                continue;
+            }
+            if (slot.position.load(std::memory_order_relaxed) != position || slot.generation.load(std::memory_order_relaxed) != generation) {
+                continue;
+            }
+            for (int c = 0; c < m_channels; ++c) {
+                values[size_t(c)] = slot.values[size_t(c)].load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.sequence.load(std::memory_order_relaxed) != sequence) {
+                // Overwritten while reading
+                return false;
+            }
+            levels.resize(m_channels);
+            std::copy(values.begin(), values.begin() + m_channels, levels.begin());
+            return true;
+        }
+        return false;
+    }
+
+    /** @brief Discard all stored levels, for example after a volume change */
+    void clear() { m_generation.fetch_add(1, std::memory_order_relaxed); }
+
+private:
+    struct Slot
+    {
+        std::atomic<quint32> sequence{0};
+        std::atomic<quint32> generation{0};
+        std::atomic<int> position{-1};
+        std::array<std::atomic<double>, MaxChannels> values{};
+    };
+    /** @brief Check if the frame at @param position was pushed since the last clear(), producer thread only */
+    bool isStored(quint32 head, int position) const
+    {
+        const quint32 generation = m_generation.load(std::memory_order_relaxed);
+        const quint32 count = std::min(head, quint32(m_capacity));
+        for (quint32 i = 1; i <= count; ++i) {
+            const Slot &slot = m_slots[(head - i) % quint32(m_capacity)];
+            if (slot.position.load(std::memory_order_relaxed) == position && slot.generation.load(std::memory_order_relaxed) == generation) {
+                return true;
+            }
+        }
+        return false;
+    }
+    std::unique_ptr<Slot[]> m_slots;
+    const int m_capacity;
+    const int m_channels;
+    /** @brief Number of frames pushed since construction */
+    std::atomic<quint32> m_head{0};
+    /** @brief Slots written before the last clear() are ignored */
+    std::atomic<quint32> m_generation{0};
+};
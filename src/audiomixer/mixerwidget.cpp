@@ -36,17 +36,12 @@ void MixerWidget::property_changed(mlt_service, MixerWidget *widget, mlt_event_d
     if (widget && !strcmp(Mlt::EventData(data).to_string(), "_position")) {
         mlt_properties filter_props = MLT_FILTER_PROPERTIES(widget->m_monitorFilter->get_filter());
         int pos = mlt_properties_get_int(filter_props, "_position");
-        if (!widget->m_levels.contains(pos)) {
-            QVector<double> levels;
-            for (int i = 0; i < widget->m_channels; i++) {
-                // NOTE: this is an approximation. To get the real peak level, we need version 2 of audiolevel MLT filter, see property_changedV2
-                levels << log10(mlt_properties_get_double(filter_props, QStringLiteral("_audio_level.%1").arg(i).toUtf8().constData()) / 1.18) * 20;
-            }
-            widget->m_levels[pos] = std::move(levels);
-            if (widget->m_levels.size() > widget->m_maxLevels) {
-                widget->m_levels.erase(widget->m_levels.begin());
-            }
+        std::array<double, AudioLevelBuffer::MaxChannels> levels;
+        for (int i = 0; i < widget->m_levels.channels(); i++) {
+            // NOTE: this is an approximation. To get the real peak level, we need version 2 of audiolevel MLT filter, see property_changedV2
+            levels[size_t(i)] = log10(mlt_properties_get_double(filter_props, widget->m_levelKeys.at(i).constData()) / 1.18) * 20;
         }
+        widget->m_levels.push(pos, levels.data());
     }
 }
 
@@ -55,16 +50,11 @@ void MixerWidget::property_changedV2(mlt_service, MixerWidget *widget, mlt_event
     if (widget && !strcmp(Mlt::EventData(data).to_string(), "_position")) {
         mlt_properties filter_props = MLT_FILTER_PROPERTIES(widget->m_monitorFilter->get_filter());
         int pos = mlt_properties_get_int(filter_props, "_position");
-        if (!widget->m_levels.contains(pos)) {
-            QVector<double> levels;
-            for (int i = 0; i < widget->m_channels; i++) {
-                levels << mlt_properties_get_double(filter_props, QStringLiteral("_audio_level.%1").arg(i).toUtf8().constData());
-            }
-            widget->m_levels[pos] = std::move(levels);
-            if (widget->m_levels.size() > widget->m_maxLevels) {
-                widget->m_levels.erase(widget->m_levels.begin());
-            }
+        std::array<double, AudioLevelBuffer::MaxChannels> levels;
+        for (int i = 0; i < widget->m_levels.channels(); i++) {
+            levels[size_t(i)] = mlt_properties_get_double(filter_props, widget->m_levelKeys.at(i).constData());
         }
+        widget->m_levels.push(pos, levels.data());
     }
 }
 
@@ -79,6 +69,7 @@ MixerWidget::MixerWidget(int tid, Mlt::Tractor *service, QString trackTag, const
     , m_balanceSpin(nullptr)
     , m_balanceSlider(nullptr)
     , m_maxLevels(qMax(30, int(service->get_fps() * 1.5)))
+    , m_levels(m_maxLevels, m_channels)
     , m_solo(nullptr)
     , m_collapse(nullptr)
     , m_monitor(nullptr)
@@ -88,6 +79,10 @@ MixerWidget::MixerWidget(int tid, Mlt::Tractor *service, QString trackTag, const
     , m_trackTag(std::move(trackTag))
     , m_sliderHandleSize(sliderHandle)
 {
+    // Property names read by the MLT callbacks for each frame
+    for (int i = 0; i < m_levels.channels(); i++) {
+        m_levelKeys << QStringLiteral("_audio_level.%1").arg(i).toUtf8();
+    }
     buildUI(service, trackName);
 }
 
@@ -456,10 +451,8 @@ void MixerWidget::updateLabel()
 
 void MixerWidget::updateAudioLevel(int pos)
 {
-    QMutexLocker lk(&m_storeMutex);
-    if (m_levels.contains(pos)) {
-        m_audioMeterWidget->setAudioValues(m_levels.value(pos));
-        // m_levels.remove(pos);
+    if (m_levels.levels(pos, m_displayedLevels)) {
+        m_audioMeterWidget->setAudioValues(m_displayedLevels);
     } else {
         m_audioMeterWidget->setAudioValues(m_audioData);
     }
@@ -467,14 +460,12 @@ void MixerWidget::updateAudioLevel(int pos)
 
 void MixerWidget::reset()
 {
-    QMutexLocker lk(&m_storeMutex);
     m_levels.clear();
     m_audioMeterWidget->setAudioValues(m_audioData);
 }
 
 void MixerWidget::clear()
 {
-    QMutexLocker lk(&m_storeMutex);
     m_levels.clear();
 }
 
@@ -5,10 +5,10 @@
 
 #pragma once
 
+#include "audiolevelbuffer.hpp"
 #include "definitions.h"
 #include "mlt++/MltService.h"
 
-#include <QMutex>
 #include <QWidget>
 #include <memory>
 #include <unordered_map>
@@ -76,13 +76,16 @@ protected:
     std::shared_ptr<Mlt::Filter> m_levelFilter;
     std::shared_ptr<Mlt::Filter> m_monitorFilter;
     std::shared_ptr<Mlt::Filter> m_balanceFilter;
-    QMap<int, QVector<double>> m_levels;
     int m_channels;
     KDualAction *m_muteAction;
     QSpinBox *m_balanceSpin;
     QSlider *m_balanceSlider;
     QDoubleSpinBox *m_volumeSpin;
     int m_maxLevels;
+    /** @brief Audio levels of the last frames, filled by the MLT consumer thread and read by the GUI thread */
+    AudioLevelBuffer m_levels;
+    /** @brief Names of the level property of each channel, so that they are not built for each frame */
+    QVector<QByteArray> m_levelKeys;
 
 private:
     std::shared_ptr<AudioLevelWidget> m_audioMeterWidget;
@@ -91,9 +94,9 @@ private:
     QToolButton *m_collapse;
     QToolButton *m_monitor;
     KSqueezedTextLabel *m_trackLabel;
-    QMutex m_storeMutex;
     double m_lastVolume;
     QVector<double> m_audioData;
+    QVector<double> m_displayedLevels;
     Mlt::Event *m_listener;
     bool m_recording;
     const QString m_trackTag;
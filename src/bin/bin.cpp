@@ -1480,6 +1480,12 @@ Bin::Bin(std::shared_ptr<ProjectItemModel> model, QWidget *parent, bool isMainBi
     m_infoMessage->hide();
     connect(this, &Bin::requesteInvalidRemoval, this, &Bin::slotQueryRemoval);
     connect(pCore.get(), &Core::updatePalette, this, &Bin::slotUpdatePalette);
+    connect(pCore.get(), &Core::clipInstanceResized, this, [this](const QString &binId) {
+        std::shared_ptr<ProjectClip> clip = m_itemModel->getClipByBinID(binId);
+        if (clip) {
+            clip->checkProxyRanges();
+        }
+    });
     connect(m_itemModel.get(), &QAbstractItemModel::rowsInserted, this, &Bin::updateClipsCount);
     connect(m_itemModel.get(), &QAbstractItemModel::rowsRemoved, this, &Bin::updateClipsCount);
     connect(this, &Bin::displayBinMessage, this, &Bin::doDisplaySimpleMessage);
@@ -1790,15 +1796,22 @@ void Bin::slotDeleteClip()
     // std::sort(items.begin(), items.end(), [](std::shared_ptr<AbstractProjectItem> a, std::shared_ptr<AbstractProjectItem>b) { return a->depth() > b->depth();
     // });
     QStringList notDeleted;
+    // The undo lambdas keep the deleted items, estimate their memory with the size of their description
+    qint64 cost = 0;
     for (const auto &item : items) {
-        if (!m_itemModel->requestBinClipDeletion(item, undo, redo)) {
+        QDomDocument doc;
+        doc.appendChild(item->toXml(doc));
+        const qint64 itemCost = doc.toString(-1).size() * qint64(sizeof(QChar));
+        if (m_itemModel->requestBinClipDeletion(item, undo, redo)) {
+            cost += itemCost;
+        } else {
             notDeleted << item->name();
         }
     }
     if (!notDeleted.isEmpty()) {
         KMessageBox::errorList(this, i18n("Some items could not be deleted. Maybe there are instances on locked tracks?"), notDeleted);
     }
-    pCore->pushUndo(undo, redo, i18n("Delete bin Clips"));
+    pCore->pushUndo(undo, redo, i18n("Delete bin Clips"), cost);
 }
 
 void Bin::slotReloadClip()
@@ -6,87 +6,130 @@
 #include "filewatcher.hpp"
 
 #include <KDirWatch>
+#include <QDir>
 #include <QFileInfo>
 
+namespace {
+// Number of folders added to the watcher on each queue tick
+constexpr int directoriesPerBatch = 50;
+// A modified file is reloaded once no change was reported for this delay
+constexpr qint64 modificationQuietDelay = 1500;
+// Minimum age of the last modification of a file before it is reloaded
+constexpr qint64 modificationMinAge = 1000;
+} // namespace
+
 FileWatcher::FileWatcher(QObject *parent)
     : QObject(parent)
     , m_fileWatcher(new KDirWatch)
 {
     // Init clip modification tracker
-    m_modifiedTimer.setInterval(2000);
+    m_modifiedTimer.setInterval(500);
     connect(m_fileWatcher.get(), &KDirWatch::dirty, this, &FileWatcher::slotUrlModified);
     connect(m_fileWatcher.get(), &KDirWatch::deleted, this, &FileWatcher::slotUrlMissing);
     connect(m_fileWatcher.get(), &KDirWatch::created, this, &FileWatcher::slotUrlAdded);
     connect(&m_modifiedTimer, &QTimer::timeout, this, &FileWatcher::slotProcessModifiedUrls);
-    m_queueTimer.setInterval(300);
+    m_queueTimer.setInterval(100);
     m_queueTimer.setSingleShot(true);
     connect(&m_queueTimer, &QTimer::timeout, this, &FileWatcher::slotProcessQueue);
 }
 
 void FileWatcher::slotProcessQueue()
 {
-    if (m_pendingUrls.size() == 0) {
-        return;
+    int count = 0;
+    auto iter = m_pendingDirectories.begin();
+    while (iter != m_pendingDirectories.end() && count < directoriesPerBatch) {
+        // Files created, modified or deleted in the folder are reported with their own path
+        m_fileWatcher->addDir(*iter, KDirWatch::WatchFiles);
+        iter = m_pendingDirectories.erase(iter);
+        count++;
     }
-    auto iter = m_pendingUrls.begin();
-    doAddFile(iter->first, iter->second);
-    m_pendingUrls.erase(iter->first);
-    if (m_pendingUrls.size() > 0 && !m_queueTimer.isActive()) {
+    if (!m_pendingDirectories.empty() && !m_queueTimer.isActive()) {
         m_queueTimer.start();
     }
 }
 
-void FileWatcher::addFile(const QString &binId, const QString &url)
+// static
+QString FileWatcher::watchedPath(const QString &url)
 {
-    std::unordered_map<QString, std::unordered_set<QString>>::const_iterator pos = m_occurences.find(url);
-    if (pos != m_occurences.end()) {
-        // Url already queued, only add ref to binId if necessary
-        if (pos->second.find(binId) == pos->second.end()) {
-            m_occurences[url].insert(binId);
-            m_binClipPaths[binId] = url;
-        }
-        return;
-    }
-    m_pendingUrls[binId] = url;
-    if (!m_queueTimer.isActive()) {
-        m_queueTimer.start();
+    const QFileInfo info(url);
+    // KDirWatch reports the files with the path of the watched folder, which must be the same for all files of the folder
+    QString dir = QFileInfo(info.absolutePath()).canonicalFilePath();
+    if (dir.isEmpty()) {
+        dir = QDir::cleanPath(info.absolutePath());
     }
+    return QDir(dir).absoluteFilePath(info.fileName());
 }
 
-void FileWatcher::doAddFile(const QString &binId, const QString &url)
+void FileWatcher::addFile(const QString &binId, const QString &path)
 {
-    if (url.isEmpty()) {
+    if (path.isEmpty()) {
         return;
     }
-    if (m_occurences.count(url) == 0) {
-        // QtConcurrent::run([=] { KDirWatch::self()->addFile(url); });
-        m_fileWatcher->addFile(url);
+    const QString url = watchedPath(path);
+    auto pos = m_occurences.find(url);
+    if (pos != m_occurences.end()) {
+        // Url already watched, only add ref to binId
+        pos->second.insert(binId);
+        m_binClipPaths[binId] = url;
+        return;
     }
     m_occurences[url].insert(binId);
     m_binClipPaths[binId] = url;
+    const QString dir = QFileInfo(url).absolutePath();
+    if (m_directories[dir]++ > 0) {
+        // The folder is already watched or queued
+        return;
+    }
+    m_pendingDirectories.insert(dir);
+    if (!m_queueTimer.isActive()) {
+        m_queueTimer.start();
+    }
 }
 
 void FileWatcher::removeFile(const QString &binId)
 {
-    if (m_binClipPaths.count(binId) == 0) {
+    auto clipPath = m_binClipPaths.find(binId);
+    if (clipPath == m_binClipPaths.end()) {
+        return;
+    }
+    const QString url = clipPath->second;
+    m_binClipPaths.erase(clipPath);
+    auto pos = m_occurences.find(url);
+    if (pos == m_occurences.end()) {
+        return;
+    }
+    pos->second.erase(binId);
+    if (!pos->second.empty()) {
+        return;
+    }
+    m_occurences.erase(pos);
+    m_modifiedUrls.erase(url);
+    const QString dir = QFileInfo(url).absolutePath();
+    auto directory = m_directories.find(dir);
+    if (directory == m_directories.end() || --directory->second > 0) {
         return;
     }
-    QString url = m_binClipPaths[binId];
-    m_occurences[url].erase(binId);
-    m_binClipPaths.erase(binId);
-    if (m_occurences[url].empty()) {
-        m_fileWatcher->removeFile(url);
-        m_occurences.erase(url);
+    m_directories.erase(directory);
+    if (m_pendingDirectories.erase(dir) == 0) {
+        m_fileWatcher->removeDir(dir);
     }
 }
 
-void FileWatcher::slotUrlModified(const QString &path)
+void FileWatcher::slotUrlModified(const QString &changedPath)
 {
-    if (m_modifiedUrls.insert(path).second) {
-        for (const QString &id : m_occurences[path]) {
+    const QString path = QDir::cleanPath(changedPath);
+    // The watched folders also report changes on files that are not in the project
+    auto pos = m_occurences.find(path);
+    if (pos == m_occurences.end()) {
+        return;
+    }
+    QElapsedTimer &lastChange = m_modifiedUrls[path];
+    if (!lastChange.isValid()) {
+        for (const QString &id : pos->second) {
             Q_EMIT binClipWaiting(id);
         }
     }
+    lastChange.start();
     if (!m_modifiedTimer.isActive()) {
         m_modifiedTimer.start();
     }
@@ -94,42 +137,82 @@ void FileWatcher::slotUrlModified(const QString &path)
 
 void FileWatcher::slotUrlAdded(const QString &path)
 {
-    for (const QString &id : m_occurences[path]) {
-        Q_EMIT binClipModified(id);
-    }
+    // A file being created (like a render output) is usually written for a while, reload it once it is stable
+    slotUrlModified(path);
 }
 
-void FileWatcher::slotUrlMissing(const QString &path)
+void FileWatcher::slotUrlMissing(const QString &deletedPath)
 {
-    for (const QString &id : m_occurences[path]) {
+    const QString path = QDir::cleanPath(deletedPath);
+    if (m_directories.count(path) > 0) {
+        // A watched folder was deleted, all its files are missing
+        QStringList ids;
+        for (const auto &occurence : m_occurences) {
+            if (QFileInfo(occurence.first).absolutePath() == path) {
+                m_modifiedUrls.erase(occurence.first);
+                for (const QString &id : occurence.second) {
+                    ids << id;
+                }
+            }
+        }
+        for (const QString &id : std::as_const(ids)) {
+            Q_EMIT binClipMissing(id);
+        }
+        return;
+    }
+    auto pos = m_occurences.find(path);
+    if (pos == m_occurences.end()) {
+        return;
+    }
+    m_modifiedUrls.erase(path);
+    for (const QString &id : pos->second) {
         Q_EMIT binClipMissing(id);
     }
 }
 
 void FileWatcher::slotProcessModifiedUrls()
 {
-    auto checkList = m_modifiedUrls;
-    for (const QString &path : checkList) {
-        if (m_fileWatcher->ctime(path).msecsTo(QDateTime::currentDateTime()) > 2000) {
-            for (const QString &id : m_occurences[path]) {
-                Q_EMIT binClipModified(id);
-            }
-            m_modifiedUrls.erase(path);
+    const QDateTime now = QDateTime::currentDateTime();
+    QStringList readyUrls;
+    auto iter = m_modifiedUrls.begin();
+    while (iter != m_modifiedUrls.end()) {
+        if (iter->second.elapsed() >= modificationQuietDelay && QFileInfo(iter->first).lastModified().msecsTo(now) >= modificationMinAge) {
+            readyUrls << iter->first;
+            iter = m_modifiedUrls.erase(iter);
+        } else {
+            ++iter;
         }
     }
     if (m_modifiedUrls.empty()) {
         m_modifiedTimer.stop();
     }
+    // Reloading a clip updates the watched files, so collect the ids first
+    QStringList ids;
+    for (const QString &path : std::as_const(readyUrls)) {
+        auto pos = m_occurences.find(path);
+        if (pos != m_occurences.end()) {
+            for (const QString &id : pos->second) {
+                ids << id;
+            }
+        }
+    }
+    for (const QString &id : std::as_const(ids)) {
+        Q_EMIT binClipModified(id);
+    }
 }
 
 void FileWatcher::clear()
 {
     m_queueTimer.stop();
+    m_modifiedTimer.stop();
     m_fileWatcher->stopScan();
-    for (const auto &f : m_occurences) {
-        m_fileWatcher->removeFile(f.first);
+    for (const auto &d : m_directories) {
+        if (m_pendingDirectories.count(d.first) == 0) {
+            m_fileWatcher->removeDir(d.first);
+        }
     }
-    m_pendingUrls.clear();
+    m_pendingDirectories.clear();
+    m_directories.clear();
     m_occurences.clear();
     m_modifiedUrls.clear();
     m_binClipPaths.clear();
@@ -138,5 +221,10 @@ void FileWatcher::clear()
 
 bool FileWatcher::contains(const QString &path) const
 {
-    return m_fileWatcher->contains(path);
+    return m_occurences.count(watchedPath(path)) > 0;
+}
+
+int FileWatcher::directoryCount() const
+{
+    return int(m_directories.size());
 }
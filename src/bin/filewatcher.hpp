@@ -7,6 +7,7 @@
 
 #include "definitions.h"
 #include <KDirWatch>
+#include <QElapsedTimer>
 #include <QTimer>
 #include <unordered_map>
 #include <unordered_set>
@@ -14,6 +15,8 @@
 /** @class FileWatcher
     @brief This class is responsible for watching all files used in the project
     and triggers a reload notification when a file changes.
+    The parent folders of the files are watched instead of each file, so that a large project only needs a few system watches,
+    and events for files that are not used in the project are ignored.
  */
 class FileWatcher : public QObject
 {
@@ -22,18 +25,22 @@ class FileWatcher : public QObject
 public:
     // Constructor
     explicit FileWatcher(QObject *parent = nullptr);
-    /** @brief Add a file to the queue for watched items */
+    /** @brief Add a file to the list of watched items, its folder is queued for watching */
     void addFile(const QString &binId, const QString &url);
     /** @brief Remove a binId from the list of watched items */
     void removeFile(const QString &binId);
     /** @returns  True if this url is already watched */
     bool contains(const QString &path) const;
+    /** @returns The number of folders watched or queued for watching */
+    int directoryCount() const;
     /** @brief Reset all watched files */
     void clear();
+    /** @returns The path under which @param url is watched: the canonical path of its folder, followed by the file name */
+    static QString watchedPath(const QString &url);
 
 Q_SIGNALS:
-    /** @brief This signal is triggered whenever the file corresponding to a bin clip has been modified and should be reloaded. Note that this signal is sent no
-     * more than every 1500 ms. We also make sure that at least 1000ms has passed since the last modification of the file. */
+    /** @brief This signal is triggered whenever the file corresponding to a bin clip has been modified and should be reloaded. Rapid modifications
+     * are coalesced: the signal is sent once no change was reported for the file during 1500 ms, and at least 1000ms has passed since its last modification. */
     void binClipModified(const QString &binId);
     /** @brief Same signal than binClipModified, but triggers immediately. Can be useful to refresh UI without actually reloading the file (yet)*/
     void binClipWaiting(const QString &binId);
@@ -49,19 +56,19 @@ private Q_SLOTS:
 private:
     /// This is a handle to the watcher singleton, not owned by this class.
     std::unique_ptr<KDirWatch> m_fileWatcher;
-    /// A list with urls as keys, and the corresponding clip ids as value
+    /// A list with urls (see watchedPath) as keys, and the corresponding clip ids as value
     std::unordered_map<QString, std::unordered_set<QString>> m_occurences;
     /// keys are binId, keys are stored paths
     std::unordered_map<QString, QString> m_binClipPaths;
+    /// Watched folders, with the number of watched files they contain
+    std::unordered_map<QString, int> m_directories;
 
-    /// List of files for which we received an update since the last send
-    std::unordered_set<QString> m_modifiedUrls;
+    /// Files for which we received an update since the last send, with the time of their last update
+    std::unordered_map<QString, QElapsedTimer> m_modifiedUrls;
 
-    /// When loading a project or adding many clips, adding many files to the watcher causes a freeze, so queue them
-    std::unordered_map<QString, QString> m_pendingUrls;
+    /// When loading a project or adding many clips, adding many folders to the watcher causes a freeze, so queue them
+    std::unordered_set<QString> m_pendingDirectories;
 
     QTimer m_modifiedTimer;
     QTimer m_queueTimer;
-    /// Add a file to the list of watched items
-    void doAddFile(const QString &binId, const QString &url);
 };
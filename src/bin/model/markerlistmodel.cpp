@@ -187,7 +187,7 @@ int MarkerListModel::markerIdAtFrame(int pos) const
 
 bool MarkerListModel::hasMarker(GenTime pos) const
 {
-    int frame = pos.frames(pCore->getCurrentFps());
+    int frame = pos.frames();
     return hasMarker(frame);
 }
 
@@ -208,7 +208,7 @@ CommentedTime MarkerListModel::marker(int frame) const
 
 CommentedTime MarkerListModel::marker(GenTime pos) const
 {
-    int mid = markerIdAtFrame(pos.frames(pCore->getCurrentFps()));
+    int mid = markerIdAtFrame(pos.frames());
     if (mid > -1) {
         return m_markerList.at(mid);
     }
@@ -351,7 +351,7 @@ int MarkerListModel::getRowfromId(int mid) const
 
 int MarkerListModel::getIdFromPos(const GenTime &pos) const
 {
-    int frame = pos.frames(pCore->getCurrentFps());
+    int frame = pos.frames();
     return getIdFromPos(frame);
 }
 
@@ -372,10 +372,10 @@ bool MarkerListModel::moveMarker(int mid, GenTime pos)
         return false;
     }
     int row = getRowfromId(mid);
-    int oldPos = m_markerList.at(mid).time().frames(pCore->getCurrentFps());
+    int oldPos = m_markerList.at(mid).time().frames();
     m_markerList[mid].setTime(pos);
     m_markerPositions.remove(oldPos);
-    m_markerPositions.insert(pos.frames(pCore->getCurrentFps()), mid);
+    m_markerPositions.insert(pos.frames(), mid);
     Q_EMIT dataChanged(index(row), index(row), {FrameRole});
     return true;
 }
@@ -391,9 +391,9 @@ void MarkerListModel::moveMarkersWithoutUndo(const QVector<int> &markersId, int
     for (auto mid : markersId) {
         Q_ASSERT(m_markerList.count(mid) > 0);
         GenTime t = m_markerList.at(mid).time();
-        m_markerPositions.remove(t.frames(pCore->getCurrentFps()));
-        t += GenTime(offset, pCore->getCurrentFps());
-        m_markerPositions.insert(t.frames(pCore->getCurrentFps()), mid);
+        m_markerPositions.remove(t.frames());
+        t += GenTime::fromFrames(offset);
+        m_markerPositions.insert(t.frames(), mid);
         m_markerList[mid].setTime(t);
         if (!updateView) {
             continue;
@@ -465,7 +465,7 @@ Fun MarkerListModel::addMarker_lambda(GenTime pos, const QString &comment, int t
         int insertionRow = static_cast<int>(m_markerList.size());
         beginInsertRows(QModelIndex(), insertionRow, insertionRow);
         m_markerList[mid] = CommentedTime(pos, comment, type);
-        m_markerPositions.insert(pos.frames(pCore->getCurrentFps()), mid);
+        m_markerPositions.insert(pos.frames(), mid);
         endInsertRows();
         addSnapPoint(pos);
         return true;
@@ -481,7 +481,7 @@ Fun MarkerListModel::deleteMarker_lambda(GenTime pos)
         int row = getRowfromId(mid);
         beginRemoveRows(QModelIndex(), row, row);
         m_markerList.erase(mid);
-        m_markerPositions.remove(pos.frames(pCore->getCurrentFps()));
+        m_markerPositions.remove(pos.frames());
         endRemoveRows();
         removeSnapPoint(pos);
         return true;
@@ -512,7 +512,7 @@ void MarkerListModel::addSnapPoint(GenTime pos)
     for (const auto &snapModel : m_registeredSnaps) {
         if (auto ptr = snapModel.lock()) {
             validSnapModels.push_back(snapModel);
-            ptr->addPoint(pos.frames(pCore->getCurrentFps()));
+            ptr->addPoint(pos.frames());
         }
     }
     // Update the list of snapModel known to be valid
@@ -526,7 +526,7 @@ void MarkerListModel::removeSnapPoint(GenTime pos)
     for (const auto &snapModel : m_registeredSnaps) {
         if (auto ptr = snapModel.lock()) {
             validSnapModels.push_back(snapModel);
-            ptr->removePoint(pos.frames(pCore->getCurrentFps()));
+            ptr->removePoint(pos.frames());
         }
     }
     // Update the list of snapModel known to be valid
@@ -550,7 +550,7 @@ QVariant MarkerListModel::data(const QModelIndex &index, int role) const
         return it->second.time().seconds();
     case FrameRole:
     case Qt::UserRole:
-        return it->second.time().frames(pCore->getCurrentFps());
+        return it->second.time().frames();
     case ColorRole:
     case Qt::DecorationRole:
         return pCore->markerTypes.value(it->second.markerType()).color;
@@ -662,7 +662,7 @@ bool MarkerListModel::hasMarker(int frame) const
 
 void MarkerListModel::registerSnapModel(const std::weak_ptr<SnapInterface> &snapModel)
 {
-    READ_LOCK();
+    READ_WRITE_LOCK();
     // make sure ptr is valid
     if (auto ptr = snapModel.lock()) {
         // ptr is valid, we store it
@@ -742,13 +742,13 @@ bool MarkerListModel::importFromJson(const QString &data, bool ignoreConflicts,
             }
         }
         bool res = true;
-        if (!ignoreConflicts && hasMarker(GenTime(pos, pCore->getCurrentFps()))) {
+        if (!ignoreConflicts && hasMarker(GenTime::fromFrames(pos))) {
             // potential conflict found, checking
-            CommentedTime oldMarker = marker(GenTime(pos, pCore->getCurrentFps()));
+            CommentedTime oldMarker = marker(GenTime::fromFrames(pos));
             res = (oldMarker.comment() == comment) && (type == oldMarker.markerType());
         }
         qDebug() << "// ADDING MARKER AT POS: " << pos << ", FPS: " << pCore->getCurrentFps();
-        res = res && addMarker(GenTime(pos, pCore->getCurrentFps()), comment, type, undo, redo);
+        res = res && addMarker(GenTime::fromFrames(pos), comment, type, undo, redo);
         if (!res) {
             bool undone = undo();
             Q_ASSERT(undone);
@@ -831,7 +831,7 @@ QString MarkerListModel::toJson(QList<int> categories) const
     std::sort(markers.begin(), markers.end());
     for (const auto &marker : markers) {
         QJsonObject currentMarker;
-        currentMarker.insert(QLatin1String("pos"), QJsonValue(marker.time().frames(pCore->getCurrentFps())));
+        currentMarker.insert(QLatin1String("pos"), QJsonValue(marker.time().frames()));
         currentMarker.insert(QLatin1String("comment"), QJsonValue(marker.comment()));
         currentMarker.insert(QLatin1String("type"), QJsonValue(marker.markerType()));
         list.push_back(currentMarker);
@@ -8,6 +8,7 @@
 #include "config-kdenlive.h"
 #include "core.h"
 #include "doc/kdenlivedoc.h"
+#include "kdenlive_debug.h"
 #include "kdenlivesettings.h"
 #include "macros.hpp"
 #include "profiles/profilemodel.hpp"
@@ -26,9 +27,11 @@
 #include <QApplication>
 #include <QJsonArray>
 #include <QJsonDocument>
+#include <QCryptographicHash>
 #include <QJsonObject>
 #include <QRegularExpression>
 #include <QStringConverter>
+#include <algorithm>
 #include <utility>
 
 SubtitleModel::SubtitleModel(std::shared_ptr<TimelineItemModel> timeline, const std::weak_ptr<SnapInterface> &snapModel, QObject *parent)
@@ -45,7 +48,11 @@ SubtitleModel::SubtitleModel(std::shared_ptr<TimelineItemModel> timeline, const
         m_subtitleFilter->set("internal_added", 237);
     }
     setup();
-    connect(this, &SubtitleModel::modelChanged, [this]() { jsontoSubtitle(toJson()); });
+    // Edits are coalesced, the work file is only written and the filter reloaded once the changes settle
+    m_fileUpdateTimer.setSingleShot(true);
+    m_fileUpdateTimer.setInterval(200);
+    connect(&m_fileUpdateTimer, &QTimer::timeout, this, &SubtitleModel::updateSubtitleFile);
+    connect(this, &SubtitleModel::modelChanged, this, &SubtitleModel::scheduleFileUpdate);
 
     const QUuid timelineUuid = timeline->uuid();
     int id = pCore->currentDoc()->getSequenceProperty(timelineUuid, QStringLiteral("kdenlive:activeSubtitleIndex"), QStringLiteral("0")).toInt();
@@ -188,7 +195,7 @@ void SubtitleModel::importSubtitle(const QString &filePath, int offset, bool ext
         return true;
     };
     ulong initialCount = m_subtitleList.size();
-    GenTime subtitleOffset(offset, pCore->getCurrentFps());
+    GenTime subtitleOffset = GenTime::fromFrames(offset);
 
     if (!externalImport) {
         // initialize the subtitle
@@ -465,14 +472,14 @@ bool SubtitleModel::addSubtitle(std::pair<int, GenTime> start, const SubtitleEve
     int id = TimelineModel::getNextId();
     Fun local_redo = [this, id, start, event, updateFilter]() {
         addSubtitle(id, start, event, false, updateFilter);
-        QPair<int, int> range = {start.second.frames(pCore->getCurrentFps()), event.endTime().frames(pCore->getCurrentFps())};
+        QPair<int, int> range = {start.second.frames(), event.endTime().frames()};
         pCore->invalidateRange(range);
         pCore->refreshProjectRange(range);
         return true;
     };
     Fun local_undo = [this, id, start, event, updateFilter]() {
         removeSubtitle(id, false, updateFilter);
-        QPair<int, int> range = {start.second.frames(pCore->getCurrentFps()), event.endTime().frames(pCore->getCurrentFps())};
+        QPair<int, int> range = {start.second.frames(), event.endTime().frames()};
         pCore->invalidateRange(range);
         pCore->refreshProjectRange(range);
         return true;
@@ -484,19 +491,19 @@ bool SubtitleModel::addSubtitle(std::pair<int, GenTime> start, const SubtitleEve
 
 bool SubtitleModel::addSubtitle(int id, std::pair<int, GenTime> start, const SubtitleEvent &event, bool temporary, bool updateFilter)
 {
-    if (start.second.frames(pCore->getCurrentFps()) < 0 || event.endTime().frames(pCore->getCurrentFps()) < 0 || isLocked()) {
+    if (start.second.frames() < 0 || event.endTime().frames() < 0 || isLocked()) {
         qDebug() << "Time error: is negative";
         return false;
     }
-    if (start.second.frames(pCore->getCurrentFps()) > event.endTime().frames(pCore->getCurrentFps())) {
+    if (start.second.frames() > event.endTime().frames()) {
         qDebug() << "Time error: start should be less than end";
         return false;
     }
     // Don't allow 2 subtitles at same start pos
     if (m_subtitleList.count(start) > 0) {
         qDebug() << "already present in model"
-                 << "string :" << m_subtitleList[start].text() << " start time " << start.second.frames(pCore->getCurrentFps())
-                 << "end time : " << m_subtitleList[start].endTime().frames(pCore->getCurrentFps());
+                 << "string :" << m_subtitleList[start].text() << " start time " << start.second.frames()
+                 << "end time : " << m_subtitleList[start].endTime().frames();
         return false;
     }
     if (start.first > m_maxLayer) {
@@ -511,10 +518,11 @@ bool SubtitleModel::addSubtitle(int id, std::pair<int, GenTime> start, const Sub
     int row = getSubtitleIndex(id);
     beginInsertRows(QModelIndex(), row, row);
     m_subtitleList[start] = event;
+    updateSubtitleRange(start, event.endTime());
     endInsertRows();
     addSnapPoint(start.second);
     addSnapPoint(event.endTime()); // {layer, end}
-    if (!temporary && event.endTime().frames(pCore->getCurrentFps()) > m_timeline->duration()) {
+    if (!temporary && event.endTime().frames() > m_timeline->duration()) {
         m_timeline->updateDuration();
     }
     // qDebug() << "Added to model";
@@ -567,9 +575,9 @@ QVariant SubtitleModel::data(const QModelIndex &index, int role) const
     case EndPosRole:
         return m_subtitleList.at(subInfo.second).endTime().seconds();
     case StartFrameRole:
-        return subInfo.second.second.frames(pCore->getCurrentFps());
+        return subInfo.second.second.frames();
     case EndFrameRole:
-        return m_subtitleList.at(subInfo.second).endTime().frames(pCore->getCurrentFps());
+        return m_subtitleList.at(subInfo.second).endTime().frames();
     case StyleNameRole:
         return m_subtitleList.at(subInfo.second).styleName();
     case NameRole:
@@ -611,12 +619,8 @@ const QList<std::pair<std::pair<int, GenTime>, SubtitleEvent>> SubtitleModel::ge
 
 SubtitleEvent SubtitleModel::getSubtitle(int layer, GenTime startpos) const
 {
-    for (const auto &subtitles : m_subtitleList) {
-        if (subtitles.first == std::make_pair(layer, startpos)) {
-            return subtitles.second;
-        }
-    }
-    return SubtitleEvent();
+    auto it = m_subtitleList.find({layer, startpos});
+    return it == m_subtitleList.end() ? SubtitleEvent() : it->second;
 }
 
 QString SubtitleModel::getText(int id) const
@@ -639,14 +643,14 @@ bool SubtitleModel::setText(int id, const QString &text)
     m_subtitleList[start].setText(text);
     Fun local_redo = [this, start, id, end, text]() {
         editSubtitle(id, text);
-        QPair<int, int> range = {start.second.frames(pCore->getCurrentFps()), end.frames(pCore->getCurrentFps())};
+        QPair<int, int> range = {start.second.frames(), end.frames()};
         pCore->invalidateRange(range);
         pCore->refreshProjectRange(range);
         return true;
     };
     Fun local_undo = [this, start, id, end, oldText]() {
         editSubtitle(id, oldText);
-        QPair<int, int> range = {start.second.frames(pCore->getCurrentFps()), end.frames(pCore->getCurrentFps())};
+        QPair<int, int> range = {start.second.frames(), end.frames()};
         pCore->invalidateRange(range);
         pCore->refreshProjectRange(range);
         return true;
@@ -661,21 +665,26 @@ std::unordered_set<int> SubtitleModel::getItemsInRange(int layer, int startFrame
     if (isLocked()) {
         return {};
     }
-    GenTime startTime(startFrame, pCore->getCurrentFps());
-    GenTime endTime(endFrame, pCore->getCurrentFps());
+    return itemsInRange(layer, startFrame, endFrame);
+}
+
+std::unordered_set<int> SubtitleModel::itemsInRange(int layer, int startFrame, int endFrame) const
+{
+    GenTime startTime = GenTime::fromFrames(startFrame);
+    GenTime endTime = GenTime::fromFrames(endFrame);
     std::unordered_set<int> matching;
-    for (const auto &subtitles : m_subtitleList) {
-        // if layer is -1, we check all layers
-        if ((endFrame > -1 && subtitles.first.second > endTime) || (layer != -1 && subtitles.first.first != layer)) {
-            // Outside range
-            continue;
-        }
-        if (subtitles.first.second >= startTime || subtitles.second.endTime() > startTime) {
-            int sid = getIdForStartPos(layer, subtitles.first.second);
-            if (sid > -1) {
-                matching.emplace(sid);
-            } else {
-                qDebug() << "==== FOUND INVALID SUBTILE AT: " << subtitles.first.second.frames(pCore->getCurrentFps());
+    // if layer is -1, we check all layers
+    for (int l = layer == -1 ? 0 : layer; l <= (layer == -1 ? m_maxLayer : layer); l++) {
+        for (auto bin = m_durationBins.lower_bound({l, 0}); bin != m_durationBins.end() && bin->first.first == l; ++bin) {
+            // Subtitles in this bin are shorter than 2^bin ticks, the ones starting earlier cannot reach the range
+            auto it = bin->second.lower_bound({startTime - GenTime::fromTicks(qint64(1) << bin->first.second), -1});
+            for (; it != bin->second.end(); ++it) {
+                if (endFrame > -1 && it->first > endTime) {
+                    break;
+                }
+                if (it->first >= startTime || m_subtitleList.at({l, it->first}).endTime() > startTime) {
+                    matching.emplace(it->second);
+                }
             }
         }
     }
@@ -698,7 +707,7 @@ int SubtitleModel::cutSubtitle(int layer, int position, Fun &undo, Fun &redo)
     if (isLocked()) {
         return -1;
     }
-    GenTime pos(position, pCore->getCurrentFps());
+    GenTime pos = GenTime::fromFrames(position);
     GenTime start = GenTime(-1);
     for (const auto &subtitles : m_subtitleList) {
         if (subtitles.first.second <= pos && subtitles.second.endTime() > pos) {
@@ -731,7 +740,7 @@ int SubtitleModel::cutSubtitle(int layer, int position, Fun &undo, Fun &redo)
         }
 
         int subId = getIdForStartPos(layer, start);
-        int duration = position - start.frames(pCore->getCurrentFps());
+        int duration = position - start.frames();
         bool res = requestResize(subId, duration, true, undo, redo, false);
         if (res) {
             int id = TimelineModel::getNextId();
@@ -764,7 +773,7 @@ void SubtitleModel::registerSnap(const std::weak_ptr<SnapInterface> &snapModel)
         m_regSnaps.push_back(snapModel);
         // we now add the already existing subtitles to the snap
         for (const auto &subtitle : m_subtitleList) {
-            ptr->addPoint(subtitle.first.second.frames(pCore->getCurrentFps()));
+            ptr->addPoint(subtitle.first.second.frames());
         }
     } else {
         qDebug() << "Error: added snapmodel for subtitle is null";
@@ -779,7 +788,7 @@ void SubtitleModel::addSnapPoint(GenTime startpos)
     for (const auto &snapModel : m_regSnaps) {
         if (auto ptr = snapModel.lock()) {
             validSnapModels.push_back(snapModel);
-            ptr->addPoint(startpos.frames(pCore->getCurrentFps()));
+            ptr->addPoint(startpos.frames());
         }
     }
     // Update the list of snapModel known to be valid
@@ -792,7 +801,7 @@ void SubtitleModel::removeSnapPoint(GenTime startpos)
     for (const auto &snapModel : m_regSnaps) {
         if (auto ptr = snapModel.lock()) {
             validSnapModels.push_back(snapModel);
-            ptr->removePoint(startpos.frames(pCore->getCurrentFps()));
+            ptr->removePoint(startpos.frames());
         }
     }
     // Update the list of snapModel known to be valid
@@ -807,6 +816,7 @@ void SubtitleModel::editEndPos(int layer, GenTime startPos, GenTime newEndPos, b
         return;
     }
     m_subtitleList[{layer, startPos}].setEndTime(newEndPos);
+    updateSubtitleRange({layer, startPos}, newEndPos);
     // Trigger update of the qml view
     int id = getIdForStartPos(layer, startPos);
     int row = getSubtitleIndex(id);
@@ -814,7 +824,7 @@ void SubtitleModel::editEndPos(int layer, GenTime startPos, GenTime newEndPos, b
     if (refreshModel) {
         Q_EMIT modelChanged();
     }
-    qDebug() << startPos.frames(pCore->getCurrentFps()) << m_subtitleList[{layer, startPos}].endTime().frames(pCore->getCurrentFps());
+    qDebug() << startPos.frames() << m_subtitleList[{layer, startPos}].endTime().frames();
 }
 
 void SubtitleModel::switchGrab(int sid)
@@ -868,9 +878,10 @@ bool SubtitleModel::requestResize(int id, int size, bool right, Fun &undo, Fun &
     Fun operation = []() { return true; };
     Fun reverse = []() { return true; };
     if (right) {
-        GenTime newEndPos = startPos.second + GenTime(size, pCore->getCurrentFps());
+        GenTime newEndPos = startPos.second + GenTime::fromFrames(size);
         operation = [this, id, startPos, endPos, newEndPos, logUndo]() {
             m_subtitleList[startPos].setEndTime(newEndPos);
+            updateSubtitleRange(startPos, newEndPos);
             removeSnapPoint(endPos);
             addSnapPoint(newEndPos);
             // Trigger update of the qml view
@@ -880,9 +891,9 @@ bool SubtitleModel::requestResize(int id, int size, bool right, Fun &undo, Fun &
                 Q_EMIT modelChanged();
                 QPair<int, int> range;
                 if (endPos > newEndPos) {
-                    range = {newEndPos.frames(pCore->getCurrentFps()), endPos.frames(pCore->getCurrentFps())};
+                    range = {newEndPos.frames(), endPos.frames()};
                 } else {
-                    range = {endPos.frames(pCore->getCurrentFps()), newEndPos.frames(pCore->getCurrentFps())};
+                    range = {endPos.frames(), newEndPos.frames()};
                 }
                 pCore->invalidateRange(range);
                 pCore->refreshProjectRange(range);
@@ -891,6 +902,7 @@ bool SubtitleModel::requestResize(int id, int size, bool right, Fun &undo, Fun &
         };
         reverse = [this, id, startPos, endPos, newEndPos, logUndo]() {
             m_subtitleList[startPos].setEndTime(endPos);
+            updateSubtitleRange(startPos, endPos);
             removeSnapPoint(newEndPos);
             addSnapPoint(endPos);
             // Trigger update of the qml view
@@ -900,9 +912,9 @@ bool SubtitleModel::requestResize(int id, int size, bool right, Fun &undo, Fun &
                 Q_EMIT modelChanged();
                 QPair<int, int> range;
                 if (endPos > newEndPos) {
-                    range = {newEndPos.frames(pCore->getCurrentFps()), endPos.frames(pCore->getCurrentFps())};
+                    range = {newEndPos.frames(), endPos.frames()};
                 } else {
-                    range = {endPos.frames(pCore->getCurrentFps()), newEndPos.frames(pCore->getCurrentFps())};
+                    range = {endPos.frames(), newEndPos.frames()};
                 }
                 pCore->invalidateRange(range);
                 pCore->refreshProjectRange(range);
@@ -910,16 +922,17 @@ bool SubtitleModel::requestResize(int id, int size, bool right, Fun &undo, Fun &
             return true;
         };
     } else {
-        std::pair<int, GenTime> newStartPos = {startPos.first, endPos - GenTime(size, pCore->getCurrentFps())};
+        std::pair<int, GenTime> newStartPos = {startPos.first, endPos - GenTime::fromFrames(size)};
         if (m_subtitleList.count(newStartPos) > 0) {
             // There already is another subtitle at this position, abort
             return false;
         }
         const SubtitleEvent event = m_subtitleList.at(startPos);
         operation = [this, id, startPos, newStartPos, event, logUndo]() {
-            m_allSubtitles[id] = newStartPos;
+            updateSubtitlePosition(id, newStartPos);
             m_subtitleList.erase(startPos);
             m_subtitleList[newStartPos] = event;
+            updateSubtitleRange(newStartPos, event.endTime());
             // Trigger update of the qml view
             removeSnapPoint(startPos.second);
             addSnapPoint(newStartPos.second);
@@ -929,9 +942,9 @@ bool SubtitleModel::requestResize(int id, int size, bool right, Fun &undo, Fun &
                 Q_EMIT modelChanged();
                 QPair<int, int> range;
                 if (startPos > newStartPos) {
-                    range = {newStartPos.second.frames(pCore->getCurrentFps()), startPos.second.frames(pCore->getCurrentFps())};
+                    range = {newStartPos.second.frames(), startPos.second.frames()};
                 } else {
-                    range = {startPos.second.frames(pCore->getCurrentFps()), newStartPos.second.frames(pCore->getCurrentFps())};
+                    range = {startPos.second.frames(), newStartPos.second.frames()};
                 }
                 pCore->invalidateRange(range);
                 pCore->refreshProjectRange(range);
@@ -939,9 +952,10 @@ bool SubtitleModel::requestResize(int id, int size, bool right, Fun &undo, Fun &
             return true;
         };
         reverse = [this, id, startPos, newStartPos, event, logUndo]() {
-            m_allSubtitles[id] = startPos;
+            updateSubtitlePosition(id, startPos);
             m_subtitleList.erase(newStartPos);
             m_subtitleList[startPos] = event;
+            updateSubtitleRange(startPos, event.endTime());
             removeSnapPoint(newStartPos.second);
             addSnapPoint(startPos.second);
             // Trigger update of the qml view
@@ -951,9 +965,9 @@ bool SubtitleModel::requestResize(int id, int size, bool right, Fun &undo, Fun &
                 Q_EMIT modelChanged();
                 QPair<int, int> range;
                 if (startPos > newStartPos) {
-                    range = {newStartPos.second.frames(pCore->getCurrentFps()), startPos.second.frames(pCore->getCurrentFps())};
+                    range = {newStartPos.second.frames(), startPos.second.frames()};
                 } else {
-                    range = {startPos.second.frames(pCore->getCurrentFps()), newStartPos.second.frames(pCore->getCurrentFps())};
+                    range = {startPos.second.frames(), newStartPos.second.frames()};
                 }
                 pCore->invalidateRange(range);
                 pCore->refreshProjectRange(range);
@@ -1072,10 +1086,11 @@ bool SubtitleModel::moveSubtitle(int subId, int newLayer, GenTime newPos, bool u
     if (newLayer > m_maxLayer) {
         setMaxLayer(newLayer);
     }
-    m_allSubtitles[id] = {newLayer, newPos};
+    updateSubtitlePosition(id, {newLayer, newPos});
     m_subtitleList.erase({oldLayer, oldPos});
     m_subtitleList[{newLayer, newPos}] = event;
     m_subtitleList[{newLayer, newPos}].setEndTime(endPos);
+    updateSubtitleRange({newLayer, newPos}, endPos);
     addSnapPoint(newPos);
     addSnapPoint(endPos);
     setActiveSubLayer(newLayer);
@@ -1083,9 +1098,9 @@ bool SubtitleModel::moveSubtitle(int subId, int newLayer, GenTime newPos, bool u
         updateSub(id, {StartFrameRole, EndFrameRole, LayerRole});
         QPair<int, int> range;
         if (oldPos < newPos) {
-            range = {oldPos.frames(pCore->getCurrentFps()), endPos.frames(pCore->getCurrentFps())};
+            range = {oldPos.frames(), endPos.frames()};
         } else {
-            range = {newPos.frames(pCore->getCurrentFps()), (oldPos + duration).frames(pCore->getCurrentFps())};
+            range = {newPos.frames(), (oldPos + duration).frames()};
         }
         pCore->invalidateRange(range);
         pCore->refreshProjectRange(range);
@@ -1103,11 +1118,16 @@ bool SubtitleModel::moveSubtitle(int subId, int newLayer, GenTime newPos, bool u
 
 int SubtitleModel::getIdForStartPos(int layer, GenTime startTime) const
 {
-    auto findResult = std::find_if(std::begin(m_allSubtitles), std::end(m_allSubtitles), [&](const std::pair<int, std::pair<int, GenTime>> &pair) {
-        return pair.second.second == startTime && (pair.second.first == layer || layer == -1);
-    });
-    if (findResult != std::end(m_allSubtitles)) {
-        return findResult->first;
+    if (layer > -1) {
+        auto it = m_subtitleIds.find({layer, startTime});
+        return it == m_subtitleIds.end() ? -1 : it->second;
+    }
+    // Any layer, return the first match
+    for (int l = 0; l <= m_maxLayer; l++) {
+        auto it = m_subtitleIds.find({l, startTime});
+        if (it != m_subtitleIds.end()) {
+            return it->second;
+        }
     }
     return -1;
 }
@@ -1130,32 +1150,29 @@ GenTime SubtitleModel::getStartPosForId(int id) const
 
 int SubtitleModel::getPreviousSub(int id) const
 {
-    GenTime start = getStartPosForId(id);
-    int layer = getLayerForId(id);
-    int row = static_cast<int>(std::distance(m_subtitleList.begin(), m_subtitleList.find({layer, start})));
-    if (row > 0) {
-        row--;
-        auto it = m_subtitleList.begin();
-        std::advance(it, row);
-        const GenTime res = it->first.second;
-        return getIdForStartPos(layer, res);
+    auto pos = m_allSubtitles.find(id);
+    if (pos == m_allSubtitles.end()) {
+        return -1;
     }
-    return -1;
+    auto it = m_subtitleIds.find(pos->second);
+    if (it == m_subtitleIds.end() || it == m_subtitleIds.begin()) {
+        return -1;
+    }
+    --it;
+    return it->first.first == pos->second.first ? it->second : -1;
 }
 
 int SubtitleModel::getNextSub(int id) const
 {
-    GenTime start = getStartPosForId(id);
-    int layer = getLayerForId(id);
-    int row = static_cast<int>(std::distance(m_subtitleList.begin(), m_subtitleList.find({layer, start})));
-    if (row < static_cast<int>(m_subtitleList.size()) - 1) {
-        row++;
-        auto it = m_subtitleList.begin();
-        std::advance(it, row);
-        const GenTime res = it->first.second;
-        return getIdForStartPos(layer, res);
+    auto pos = m_allSubtitles.find(id);
+    if (pos == m_allSubtitles.end()) {
+        return -1;
     }
-    return -1;
+    auto it = m_subtitleIds.find(pos->second);
+    if (it == m_subtitleIds.end() || ++it == m_subtitleIds.end()) {
+        return -1;
+    }
+    return it->first.first == pos->second.first ? it->second : -1;
 }
 
 void SubtitleModel::subtitleFileFromZone(int in, int out, const QString &outFile)
@@ -1212,6 +1229,7 @@ const QJsonArray SubtitleModel::toJson()
 
 void SubtitleModel::copySubtitle(const QString &path, int ix, bool checkOverwrite, bool updateFilter)
 {
+    flushSubtitleFile();
     QFile srcFile(pCore->currentDoc()->subTitlePath(m_timeline->uuid(), ix, false));
     if (srcFile.exists()) {
         QFile prev(path);
@@ -1249,7 +1267,6 @@ void SubtitleModel::jsontoSubtitle(const QJsonArray &data)
         m_subtitleFilter->set("av.filename", outFile.toUtf8().constData());
     }
     int line = saveSubtitleData(data, outFile);
-    qDebug() << "Saving subtitle filter: " << outFile;
     if (line > 0) {
         m_subtitleFilter->set("av.filename", outFile.toUtf8().constData());
         m_timeline->tractor()->attach(*m_subtitleFilter.get());
@@ -1258,6 +1275,38 @@ void SubtitleModel::jsontoSubtitle(const QJsonArray &data)
     }
 }
 
+void SubtitleModel::writeAssHeader(QTextStream &out) const
+{
+    out << QStringLiteral("[Script Info]\n; Script generated by Kdenlive %1\n").arg(KDENLIVE_VERSION);
+    for (const auto &entry : std::as_const(m_scriptInfo)) {
+        out << entry.first + ": " + entry.second + '\n';
+    }
+    out << '\n';
+
+    out << "[Kdenlive Extradata]\n";
+    out << "MaxLayer: " + QString::number(getMaxLayer()) + '\n';
+    QString defaultStyles;
+    for (const auto &style : m_defaultStyles) {
+        defaultStyles += style + ',';
+    }
+    defaultStyles.chop(1);
+    out << "DefaultStyles: " + defaultStyles + '\n';
+
+    out << '\n';
+
+    out << QStringLiteral("[V4+ Styles]\nFormat: Name, Fontname, Fontsize, PrimaryColour, SecondaryColour, OutlineColour, BackColour, Bold, "
+                          "Italic, Underline, StrikeOut, "
+                          "ScaleX, ScaleY, Spacing, Angle, BorderStyle, Outline, Shadow, Alignment, MarginL, MarginR, MarginV, Encoding\n");
+    for (const auto &entry : std::as_const(m_subtitleStyles)) {
+        out << entry.second.toString(entry.first) << '\n';
+    }
+    out << '\n';
+
+    if (!fontSection.isEmpty()) out << fontSection << '\n';
+
+    out << QStringLiteral("[Events]\nFormat: Layer, Start, End, Style, Name, MarginL, MarginR, MarginV, Effect, Text\n");
+}
+
 int SubtitleModel::saveSubtitleData(const QJsonArray &list, const QString &outFile)
 {
     bool assFormat = outFile.endsWith(".ass");
@@ -1276,34 +1325,7 @@ int SubtitleModel::saveSubtitleData(const QJsonArray &list, const QString &outFi
     if (outF.open(QIODevice::WriteOnly)) {
         QTextStream out(&outF);
         if (assFormat) {
-            out << QStringLiteral("[Script Info]\n; Script generated by Kdenlive %1\n").arg(KDENLIVE_VERSION);
-            for (const auto &entry : std::as_const(m_scriptInfo)) {
-                out << entry.first + ": " + entry.second + '\n';
-            }
-            out << '\n';
-
-            out << "[Kdenlive Extradata]\n";
-            out << "MaxLayer: " + QString::number(getMaxLayer()) + '\n';
-            QString defaultStyles;
-            for (const auto &style : m_defaultStyles) {
-                defaultStyles += style + ',';
-            }
-            defaultStyles.chop(1);
-            out << "DefaultStyles: " + defaultStyles + '\n';
-
-            out << '\n';
-
-            out << QStringLiteral("[V4+ Styles]\nFormat: Name, Fontname, Fontsize, PrimaryColour, SecondaryColour, OutlineColour, BackColour, Bold, "
-                                  "Italic, Underline, StrikeOut, "
-                                  "ScaleX, ScaleY, Spacing, Angle, BorderStyle, Outline, Shadow, Alignment, MarginL, MarginR, MarginV, Encoding\n");
-            for (const auto &entry : std::as_const(m_subtitleStyles)) {
-                out << entry.second.toString(entry.first) << '\n';
-            }
-            out << '\n';
-
-            if (!fontSection.isEmpty()) out << fontSection << '\n';
-
-            out << QStringLiteral("[Events]\nFormat: Layer, Start, End, Style, Name, MarginL, MarginR, MarginV, Effect, Text\n");
+            writeAssHeader(out);
         }
         for (const auto &entry : std::as_const(list)) {
             if (!entry.isObject()) {
@@ -1340,6 +1362,144 @@ int SubtitleModel::saveSubtitleData(const QJsonArray &list, const QString &outFi
     return line;
 }
 
+int SubtitleModel::writeSubtitleEvents(QTextStream &out, bool assFormat) const
+{
+    // Events are written directly from the model, without the json round trip and without re-parsing each event
+    int line = 0;
+    for (const auto &subtitle : m_subtitleList) {
+        line++;
+        if (assFormat) {
+            QString dialogue = subtitle.second.toString(subtitle.first.first, subtitle.first.second);
+            dialogue.replace(QLatin1Char('\n'), QStringLiteral("\\N"));
+            out << dialogue << '\n';
+        } else {
+            out << line << '\n'
+                << SubtitleEvent::timeToString(subtitle.first.second, 1) << " --> " << SubtitleEvent::timeToString(subtitle.second.endTime(), 1) << '\n'
+                << subtitle.second.text() << '\n'
+                << '\n';
+        }
+    }
+    return line;
+}
+
+void SubtitleModel::scheduleFileUpdate()
+{
+    m_fileDirty = true;
+    m_fileUpdateTimer.start();
+}
+
+void SubtitleModel::flushSubtitleFile()
+{
+    if (m_fileDirty) {
+        updateSubtitleFile();
+    }
+}
+
+bool SubtitleModel::hasPendingFileUpdate() const
+{
+    return m_fileDirty && m_fileUpdateTimer.isActive();
+}
+
+QByteArray SubtitleModel::renderData() const
+{
+    QByteArray data;
+    for (int i = 0; i < m_subtitleFilter->count(); i++) {
+        const QString name = m_subtitleFilter->get_name(i);
+        // The work file path changes between sessions, its content is hashed through the events
+        if (name.startsWith(QLatin1Char('_')) || name.startsWith(QLatin1String("kdenlive:")) || name == QLatin1String("av.filename")) {
+            continue;
+        }
+        data.append(name.toUtf8());
+        data.append('=');
+        data.append(m_subtitleFilter->get(i));
+        data.append('\n');
+    }
+    QString header;
+    QTextStream out(&header);
+    QReadLocker locker(&m_lock);
+    writeAssHeader(out);
+    out.flush();
+    data.append(header.toUtf8());
+    return data;
+}
+
+QByteArray SubtitleModel::rangeData(int startFrame, int endFrame) const
+{
+    const double fps = pCore->getCurrentFps();
+    QByteArray data;
+    QReadLocker locker(&m_lock);
+    std::vector<std::pair<int, GenTime>> positions;
+    for (int id : itemsInRange(-1, startFrame, endFrame)) {
+        positions.push_back(m_allSubtitles.at(id));
+    }
+    // Sort so that the data does not depend on the hash set order
+    std::sort(positions.begin(), positions.end());
+    for (const auto &position : positions) {
+        const SubtitleEvent &subtitle = m_subtitleList.at(position);
+        // Times are stored relative to the range so that identical content at another position gives the same data
+        SubtitleEvent event = subtitle;
+        event.setEndTime(GenTime());
+        data.append(QStringLiteral("subtitle %1 %2 ")
+                        .arg(position.second.frames(fps) - startFrame)
+                        .arg(subtitle.endTime().frames(fps) - startFrame)
+                        .toUtf8());
+        data.append(event.toString(position.first, GenTime()).toUtf8());
+        data.append('\n');
+    }
+    return data;
+}
+
+void SubtitleModel::updateSubtitleFile()
+{
+    m_fileUpdateTimer.stop();
+    if (!m_fileDirty || m_timeline == nullptr) {
+        return;
+    }
+    m_fileDirty = false;
+    int ix = pCore->currentDoc()->getSequenceProperty(m_timeline->uuid(), QStringLiteral("kdenlive:activeSubtitleIndex"), QStringLiteral("0")).toInt();
+    const QString outFile = pCore->currentDoc()->subTitlePath(m_timeline->uuid(), ix, false);
+    const QString masterFile = m_subtitleFilter->get("av.filename");
+    if (masterFile.isEmpty()) {
+        m_subtitleFilter->set("av.filename", outFile.toUtf8().constData());
+    }
+    QString content;
+    content.reserve(m_fileSize);
+    int line = 0;
+    {
+        QReadLocker locker(&m_lock);
+        QTextStream out(&content);
+        if (outFile.endsWith(QLatin1String(".ass"))) {
+            writeAssHeader(out);
+        }
+        line = writeSubtitleEvents(out, outFile.endsWith(QLatin1String(".ass")));
+    }
+    if (line == 0) {
+        m_fileHash.clear();
+        m_timeline->tractor()->detach(*m_subtitleFilter.get());
+        pCore->refreshProjectMonitorOnce();
+        return;
+    }
+    const QByteArray data = content.toUtf8();
+    m_fileSize = int(content.size());
+    const QByteArray hash = QCryptographicHash::hash(data, QCryptographicHash::Md5);
+    if (hash == m_fileHash && masterFile == outFile && QFile::exists(outFile)) {
+        // Nothing changed for the renderer
+        m_timeline->tractor()->attach(*m_subtitleFilter.get());
+        return;
+    }
+    QFile outF(outFile);
+    if (!outF.open(QIODevice::WriteOnly)) {
+        qCWarning(KDENLIVE_LOG) << "Cannot write subtitle file" << outFile;
+        return;
+    }
+    outF.write(data);
+    outF.close();
+    m_fileHash = hash;
+    m_subtitleFilter->set("av.filename", outFile.toUtf8().constData());
+    m_timeline->tractor()->attach(*m_subtitleFilter.get());
+    pCore->refreshProjectMonitorOnce();
+}
+
 void SubtitleModel::updateSub(int id, const QVector<int> &roles)
 {
     int row = getSubtitleIndex(id);
@@ -1359,7 +1519,7 @@ int SubtitleModel::getRowForId(int id) const
 int SubtitleModel::getSubtitlePlaytime(int id) const
 {
     std::pair<int, GenTime> startPos = m_allSubtitles.at(id);
-    return m_subtitleList.at(startPos).endTime().frames(pCore->getCurrentFps()) - startPos.second.frames(pCore->getCurrentFps());
+    return m_subtitleList.at(startPos).endTime().frames() - startPos.second.frames();
 }
 
 GenTime SubtitleModel::getSubtitlePosition(int sid) const
@@ -1377,13 +1537,13 @@ int SubtitleModel::getSubtitleFakePosition(int sid) const
 int SubtitleModel::getSubtitleEnd(int id) const
 {
     std::pair<int, GenTime> startPos = m_allSubtitles.at(id);
-    return m_subtitleList.at(startPos).endTime().frames(pCore->getCurrentFps());
+    return m_subtitleList.at(startPos).endTime().frames();
 }
 
 QPair<int, int> SubtitleModel::getInOut(int sid) const
 {
     std::pair<int, GenTime> startPos = m_allSubtitles.at(sid);
-    return {startPos.second.frames(pCore->getCurrentFps()), m_subtitleList.at(startPos).endTime().frames(pCore->getCurrentFps())};
+    return {startPos.second.frames(), m_subtitleList.at(startPos).endTime().frames()};
 }
 
 void SubtitleModel::setSelected(int id, bool select)
@@ -1409,7 +1569,7 @@ int SubtitleModel::trackDuration() const
     if (m_subtitleList.empty()) {
         return 0;
     }
-    return m_subtitleList.rbegin()->second.endTime().frames(pCore->getCurrentFps());
+    return m_subtitleList.rbegin()->second.endTime().frames();
 }
 
 void SubtitleModel::switchDisabled()
@@ -1429,13 +1589,13 @@ void SubtitleModel::switchLocked()
             validSnapModels.push_back(snapModel);
             if (isLocked) {
                 for (const auto &subtitle : m_subtitleList) {
-                    ptr->addPoint(subtitle.first.frames(pCore->getCurrentFps()));
-                    ptr->addPoint(subtitle.second.second.frames(pCore->getCurrentFps()));
+                    ptr->addPoint(subtitle.first.frames());
+                    ptr->addPoint(subtitle.second.second.frames());
                 }
             } else {
                 for (const auto &subtitle : m_subtitleList) {
-                    ptr->removePoint(subtitle.first.frames(pCore->getCurrentFps()));
-                    ptr->removePoint(subtitle.second.second.frames(pCore->getCurrentFps()));
+                    ptr->removePoint(subtitle.first.frames());
+                    ptr->removePoint(subtitle.second.second.frames());
                 }
             }
         }
@@ -1490,8 +1650,8 @@ void SubtitleModel::loadProperties(const QMap<QString, QString> &subProperties)
 void SubtitleModel::allSnaps(std::vector<int> &snaps)
 {
     for (const auto &subtitle : m_subtitleList) {
-        snaps.push_back(subtitle.first.second.frames(pCore->getCurrentFps()));
-        snaps.push_back(subtitle.second.endTime().frames(pCore->getCurrentFps()));
+        snaps.push_back(subtitle.first.second.frames());
+        snaps.push_back(subtitle.second.endTime().frames());
     }
 }
 
@@ -1501,15 +1661,15 @@ QDomElement SubtitleModel::toXml(int sid, QDomDocument &document)
     GenTime endPos = m_subtitleList.at(startPos).endTime();
     QDomElement container = document.createElement(QStringLiteral("subtitle"));
     container.setAttribute(QStringLiteral("layer"), startPos.first);
-    container.setAttribute(QStringLiteral("in"), startPos.second.frames(pCore->getCurrentFps()));
-    container.setAttribute(QStringLiteral("out"), endPos.frames(pCore->getCurrentFps()));
+    container.setAttribute(QStringLiteral("in"), startPos.second.frames());
+    container.setAttribute(QStringLiteral("out"), endPos.frames());
     container.setAttribute(QStringLiteral("event_text"), m_subtitleList.at(startPos).toString(startPos.first, startPos.second));
     return container;
 }
 
 bool SubtitleModel::isBlankAt(int layer, int pos) const
 {
-    GenTime matchPos(pos, pCore->getCurrentFps());
+    GenTime matchPos = GenTime::fromFrames(pos);
     for (const auto &subtitles : m_subtitleList) {
         // if layer is -1, we check all layers
         if (layer == -1 || subtitles.first.first == layer) {
@@ -1526,7 +1686,7 @@ bool SubtitleModel::isBlankAt(int layer, int pos) const
 
 int SubtitleModel::getBlankEnd(int layer, int pos) const
 {
-    GenTime matchPos(pos, pCore->getCurrentFps());
+    GenTime matchPos = GenTime::fromFrames(pos);
     bool found = false;
     GenTime min;
     for (const auto &subtitles : m_subtitleList) {
@@ -1536,7 +1696,7 @@ int SubtitleModel::getBlankEnd(int layer, int pos) const
             found = true;
         }
     }
-    return found ? min.frames(pCore->getCurrentFps()) : 0;
+    return found ? min.frames() : 0;
 }
 
 int SubtitleModel::getBlankSizeAtPos(int layer, int frame) const
@@ -1548,7 +1708,7 @@ int SubtitleModel::getBlankSizeAtPos(int layer, int frame) const
 
 int SubtitleModel::getBlankStart(int layer, int pos) const
 {
-    GenTime matchPos(pos, pCore->getCurrentFps());
+    GenTime matchPos = GenTime::fromFrames(pos);
     bool found = false;
     GenTime min;
     for (const auto &subtitles : m_subtitleList) {
@@ -1559,7 +1719,7 @@ int SubtitleModel::getBlankStart(int layer, int pos) const
             found = true;
         }
     }
-    return found ? min.frames(pCore->getCurrentFps()) : 0;
+    return found ? min.frames() : 0;
 }
 
 int SubtitleModel::getNextBlankStart(int layer, int pos) const
@@ -1603,7 +1763,9 @@ void SubtitleModel::editSubtitle(int id, const QString &newText, const QString &
         return true;
     };
     local_redo();
-    pCore->pushUndo(local_undo, local_redo, i18n("Edit subtitle"));
+    // Successive edits of the text are merged in one undo command
+    pCore->pushMergeableUndo(local_undo, local_redo, i18n("Edit subtitle"), QStringLiteral("subtitle-text-%1").arg(id),
+                             (oldText.size() + newText.size()) * qint64(sizeof(QChar)));
 }
 
 void SubtitleModel::resizeSubtitle(int layer, int startFrame, int endFrame, int oldEndFrame, bool refreshModel)
@@ -1611,12 +1773,12 @@ void SubtitleModel::resizeSubtitle(int layer, int startFrame, int endFrame, int
     qDebug() << "Editing existing subtitle in controller at:" << startFrame;
     int max = qMax(endFrame, oldEndFrame);
     Fun local_redo = [this, layer, startFrame, endFrame, max, refreshModel]() {
-        editEndPos(layer, GenTime(startFrame, pCore->getCurrentFps()), GenTime(endFrame, pCore->getCurrentFps()), refreshModel);
+        editEndPos(layer, GenTime::fromFrames(startFrame), GenTime::fromFrames(endFrame), refreshModel);
         pCore->refreshProjectRange({startFrame, max});
         return true;
     };
     Fun local_undo = [this, layer, startFrame, oldEndFrame, max, refreshModel]() {
-        editEndPos(layer, GenTime(startFrame, pCore->getCurrentFps()), GenTime(oldEndFrame, pCore->getCurrentFps()), refreshModel);
+        editEndPos(layer, GenTime::fromFrames(startFrame), GenTime::fromFrames(oldEndFrame), refreshModel);
         pCore->refreshProjectRange({startFrame, max});
         return true;
     };
@@ -1644,8 +1806,8 @@ void SubtitleModel::addSubtitle(int startframe, int layer, QString text)
         return true;
     };
     Fun local_redo = [this, layer, id, startframe, endframe, text]() {
-        if (addSubtitle(id, {layer, GenTime(startframe, pCore->getCurrentFps())},
-                        SubtitleEvent(true, GenTime(endframe, pCore->getCurrentFps()), getLayerDefaultStyle(layer), "", 0, 0, 0, "", text))) {
+        if (addSubtitle(id, {layer, GenTime::fromFrames(startframe)},
+                        SubtitleEvent(true, GenTime::fromFrames(endframe), getLayerDefaultStyle(layer), "", 0, 0, 0, "", text))) {
             QPair<int, int> range = {startframe, endframe};
             pCore->invalidateRange(range);
             pCore->refreshProjectRange(range);
@@ -1667,7 +1829,7 @@ void SubtitleModel::doCutSubtitle(int id, int cursorPos)
     Q_ASSERT(m_timeline->isSubTitle(id));
     // Cut subtitle at edit position
     int timelinePos = pCore->getMonitorPosition();
-    GenTime position(timelinePos, pCore->getCurrentFps());
+    GenTime position = GenTime::fromFrames(timelinePos);
     GenTime start = getStartPosForId(id);
     int layer = getLayerForId(id);
     SubtitleEvent event = getSubtitle(layer, start);
@@ -1698,15 +1860,15 @@ void SubtitleModel::doCutSubtitle(int id, int cursorPos)
 
 void SubtitleModel::deleteSubtitle(int layer, int startframe, int endframe, const QString &text)
 {
-    int id = getIdForStartPos(layer, GenTime(startframe, pCore->getCurrentFps()));
+    int id = getIdForStartPos(layer, GenTime::fromFrames(startframe));
     Fun local_redo = [this, id, startframe, endframe]() {
         removeSubtitle(id);
         pCore->refreshProjectRange({startframe, endframe});
         return true;
     };
     Fun local_undo = [this, layer, id, startframe, endframe, text]() {
-        addSubtitle(id, {layer, GenTime(startframe, pCore->getCurrentFps())},
-                    SubtitleEvent(true, GenTime(endframe, pCore->getCurrentFps()), "Default", "", 0, 0, 0, "", text));
+        addSubtitle(id, {layer, GenTime::fromFrames(startframe)},
+                    SubtitleEvent(true, GenTime::fromFrames(endframe), "Default", "", 0, 0, 0, "", text));
         pCore->refreshProjectRange({startframe, endframe});
         return true;
     };
@@ -1926,6 +2088,7 @@ int SubtitleModel::createNewSubtitle(const QString subtitleName, int id)
     m_subtitlesList.insert({maxIx, newName}, newPath);
     if (id >= 0) {
         // Duplicate existing subtitle
+        flushSubtitleFile();
         QString source = pCore->currentDoc()->subTitlePath(m_timeline->uuid(), id, false);
         if (!QFile::exists(source)) {
             source = pCore->currentDoc()->subTitlePath(m_timeline->uuid(), id, true);
@@ -1938,6 +2101,7 @@ int SubtitleModel::createNewSubtitle(const QString subtitleName, int id)
 
 bool SubtitleModel::deleteSubtitle(int ix)
 {
+    flushSubtitleFile();
     QMapIterator<std::pair<int, QString>, QString> i(m_subtitlesList);
     bool success = false;
     std::pair<int, QString> matchingItem = {-1, QString()};
@@ -1999,6 +2163,7 @@ void SubtitleModel::activateSubtitle(int ix)
     // QStringLiteral("0")).toInt(); if (currentIx == ix) {
     //     return;
     // }
+    flushSubtitleFile();
     const QString workPath = pCore->currentDoc()->subTitlePath(m_timeline->uuid(), ix, false);
     const QString finalPath = pCore->currentDoc()->subTitlePath(m_timeline->uuid(), ix, true);
     if (!QFile::exists(workPath) && QFile::exists(finalPath)) {
@@ -2036,7 +2201,25 @@ void SubtitleModel::setMaxLayer(int layer)
 void SubtitleModel::registerSubtitle(int id, std::pair<int, GenTime> startpos, bool temporary)
 {
     Q_ASSERT(m_allSubtitles.count(id) == 0);
+    Q_ASSERT(id >= 0);
     m_allSubtitles.emplace(id, startpos);
+    m_subtitleIds[startpos] = id;
+    if (id + 1 < int(m_rowTree.size())) {
+        updateRowTree(id, 1);
+    } else {
+        // Grow the tree and rebuild it in linear time from the registered ids
+        m_rowTree.assign(size_t(std::max({2 * int(m_rowTree.size()), id + 2, 64})), 0);
+        const int size = int(m_rowTree.size());
+        for (const auto &sub : m_allSubtitles) {
+            m_rowTree[size_t(sub.first + 1)] = 1;
+        }
+        for (int i = 1; i < size; ++i) {
+            int parent = i + (i & -i);
+            if (parent < size) {
+                m_rowTree[size_t(parent)] += m_rowTree[size_t(i)];
+            }
+        }
+    }
     if (!temporary) {
         m_timeline->m_groups->createGroupItem(id);
     }
@@ -2048,15 +2231,85 @@ void SubtitleModel::deregisterSubtitle(int id, bool temporary)
     if (!temporary && isSelected(id)) {
         m_timeline->requestClearSelection(true);
     }
+    const std::pair<int, GenTime> startpos = m_allSubtitles.at(id);
+    auto pos = m_subtitleIds.find(startpos);
+    if (pos != m_subtitleIds.end() && pos->second == id) {
+        m_subtitleIds.erase(pos);
+    }
+    auto bin = m_subtitleBins.find(id);
+    if (bin != m_subtitleBins.end()) {
+        auto binItems = m_durationBins.find({startpos.first, bin->second});
+        binItems->second.erase({startpos.second, id});
+        if (binItems->second.empty()) {
+            m_durationBins.erase(binItems);
+        }
+        m_subtitleBins.erase(bin);
+    }
+    updateRowTree(id, -1);
     m_allSubtitles.erase(id);
     if (!temporary) {
         m_timeline->m_groups->destructGroupItem(id);
     }
 }
 
+void SubtitleModel::updateSubtitlePosition(int id, std::pair<int, GenTime> startpos)
+{
+    const std::pair<int, GenTime> oldpos = m_allSubtitles.at(id);
+    auto pos = m_subtitleIds.find(oldpos);
+    if (pos != m_subtitleIds.end() && pos->second == id) {
+        m_subtitleIds.erase(pos);
+    }
+    m_allSubtitles[id] = startpos;
+    m_subtitleIds[startpos] = id;
+    // Moving keeps the duration, so the subtitle stays in the same bin
+    auto bin = m_subtitleBins.find(id);
+    if (bin != m_subtitleBins.end()) {
+        auto binItems = m_durationBins.find({oldpos.first, bin->second});
+        binItems->second.erase({oldpos.second, id});
+        if (binItems->second.empty()) {
+            m_durationBins.erase(binItems);
+        }
+        m_durationBins[{startpos.first, bin->second}].emplace(startpos.second, id);
+    }
+}
+
+void SubtitleModel::updateSubtitleRange(const std::pair<int, GenTime> &startpos, GenTime endpos)
+{
+    auto pos = m_subtitleIds.find(startpos);
+    if (pos == m_subtitleIds.end()) {
+        return;
+    }
+    const int id = pos->second;
+    // Bit length of the duration: every subtitle in bin b is shorter than 2^b ticks
+    int newBin = 0;
+    for (quint64 ticks = quint64(std::max<qint64>(0, (endpos - startpos.second).ticks())); ticks > 0; ticks >>= 1) {
+        newBin++;
+    }
+    auto bin = m_subtitleBins.find(id);
+    if (bin != m_subtitleBins.end()) {
+        if (bin->second == newBin) {
+            return;
+        }
+        auto binItems = m_durationBins.find({startpos.first, bin->second});
+        binItems->second.erase({startpos.second, id});
+        if (binItems->second.empty()) {
+            m_durationBins.erase(binItems);
+        }
+    }
+    m_subtitleBins[id] = newBin;
+    m_durationBins[{startpos.first, newBin}].emplace(startpos.second, id);
+}
+
+void SubtitleModel::updateRowTree(int id, int delta)
+{
+    for (int i = id + 1; i < int(m_rowTree.size()); i += i & -i) {
+        m_rowTree[size_t(i)] += delta;
+    }
+}
+
 int SubtitleModel::positionForIndex(int id) const
 {
-    return int(std::distance(m_allSubtitles.begin(), m_allSubtitles.find(id)));
+    return getSubtitleIndex(id);
 }
 
 bool SubtitleModel::hasSubtitle(int id) const
@@ -2079,30 +2332,43 @@ int SubtitleModel::getSubtitleIndex(int subId) const
     if (m_allSubtitles.count(subId) == 0) {
         return -1;
     }
-    auto it = m_allSubtitles.find(subId);
-    return int(std::distance(m_allSubtitles.begin(), it));
+    // Number of registered ids lower than subId
+    int row = 0;
+    for (int i = subId; i > 0; i -= i & -i) {
+        row += m_rowTree[size_t(i)];
+    }
+    return row;
 }
 
 std::pair<int, std::pair<int, GenTime>> SubtitleModel::getSubtitleIdFromIndex(int index) const
 {
-    if (index >= static_cast<int>(m_allSubtitles.size())) {
+    if (index < 0 || index >= static_cast<int>(m_allSubtitles.size())) {
         return {-1, {-1, GenTime()}};
     }
-    auto it = m_allSubtitles.begin();
-    std::advance(it, index);
-    return {it->first, it->second};
+    // Descend the tree to the last position whose prefix count is index, the next one holds the id
+    const int size = int(m_rowTree.size());
+    int step = 1;
+    while (step * 2 < size) {
+        step *= 2;
+    }
+    int position = 0;
+    int remaining = index;
+    for (; step > 0; step /= 2) {
+        if (position + step < size && m_rowTree[size_t(position + step)] <= remaining) {
+            position += step;
+            remaining -= m_rowTree[size_t(position)];
+        }
+    }
+    // Tree position p counts id p - 1, so the id at position + 1 is position
+    int id = position;
+    return {id, m_allSubtitles.at(id)};
 }
 
 int SubtitleModel::getSubtitleIdByPosition(int layer, int pos)
 {
-    GenTime startTime(pos, pCore->getCurrentFps());
-    auto findResult = std::find_if(std::begin(m_allSubtitles), std::end(m_allSubtitles), [&](const std::pair<int, std::pair<int, GenTime>> &pair) {
-        return pair.second.second == startTime && pair.second.first == layer;
-    });
-    if (findResult != std::end(m_allSubtitles)) {
-        return findResult->first;
-    }
-    return -1;
+    GenTime startTime = GenTime::fromFrames(pos);
+    auto it = m_subtitleIds.find({layer, startTime});
+    return it == m_subtitleIds.end() ? -1 : it->second;
 }
 
 int SubtitleModel::getSubtitleIdAtPosition(int layer, int pos)
@@ -12,13 +12,17 @@
 
 #include <QAbstractListModel>
 #include <QReadWriteLock>
+#include <QTimer>
 
 #include <array>
 #include <map>
 #include <memory>
+#include <set>
 #include <mlt++/Mlt.h>
 #include <mlt++/MltProperties.h>
+#include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 class DocUndoStack;
 class SnapInterface;
@@ -31,6 +35,7 @@ class TimelineItemModel;
 class SubtitleModel : public QAbstractListModel
 {
     Q_OBJECT
+    friend class KdenliveTests;
 
 public:
     static const int RAZOR_MODE_DUPLICATE = 0;
@@ -283,6 +288,14 @@ public:
     /** @brief Get default styles for subtitle layers */
     const QString getLayerDefaultStyle(int layer) const;
     int saveSubtitleData(const QJsonArray &data, const QString &outFile);
+    /** @brief Write pending subtitle changes to the work file now instead of waiting for the update timer */
+    void flushSubtitleFile();
+    /** @brief Returns true if model changes wait for the update timer to be written */
+    bool hasPendingFileUpdate() const;
+    /** @brief Returns the filter properties and styles that apply to every rendered frame, used to hash timeline preview chunks */
+    QByteArray renderData() const;
+    /** @brief Returns the subtitles displayed from @param startFrame to @param endFrame, with positions relative to @param startFrame */
+    QByteArray rangeData(int startFrame, int endFrame) const;
 
 public Q_SLOTS:
     /** @brief Function that parses through a subtitle file */
@@ -290,6 +303,8 @@ public Q_SLOTS:
 
     /** @brief Import model to a temporary subtitle file to which the Subtitle effect is applied*/
     void jsontoSubtitle(const QJsonArray &data);
+    /** @brief Mark the subtitle work file as outdated, it will be written once edits have settled */
+    void scheduleFileUpdate();
     /** @brief Update a subtitle text*/
     bool setText(int id, const QString &text);
 
@@ -304,6 +319,15 @@ private:
     QMap<std::pair<int, QString>, QString> m_subtitlesList;
     /** @brief A list of subtitles as: item id, layer, start time */
     std::map<int, std::pair<int, GenTime>> m_allSubtitles;
+    /** @brief Reverse index of m_allSubtitles as: layer, start time, item id */
+    std::map<std::pair<int, GenTime>, int> m_subtitleIds;
+    /** @brief Fenwick tree counting the registered ids, maps model rows (ids in increasing order) to ids and back in logarithmic time */
+    std::vector<int> m_rowTree;
+    /** @brief Subtitles sorted by start time, grouped by layer and duration bin. The bin is the bit length of the duration ticks,
+     *  so a range lookup only walks, for each bin, the subtitles starting less than the bin's longest duration before the range */
+    std::map<std::pair<int, int>, std::set<std::pair<GenTime, int>>> m_durationBins;
+    /** @brief The duration bin of each subtitle as: item id, bin */
+    std::unordered_map<int, int> m_subtitleBins;
     /** @brief The max layer in the subtitle model */
     int m_maxLayer{0};
     /** @brief Default styles for subtitle layers */
@@ -328,6 +352,20 @@ private:
     QVector<int> m_selected;
     QVector<int> m_grabbedIds;
     int m_activeSubLayer{0};
+    /** @brief Coalesces model changes before the work file is written and the subtitle filter reloaded */
+    QTimer m_fileUpdateTimer;
+    bool m_fileDirty{false};
+    /** @brief Hash of the last content written to the work file, so that the filter is only reloaded on real changes */
+    QByteArray m_fileHash;
+    /** @brief Size of the last written content, used to preallocate the next one */
+    int m_fileSize{0};
+
+    /** @brief Write the model to the active work file and reload the subtitle filter if the content changed */
+    void updateSubtitleFile();
+    /** @brief Write the ass header sections (script info, styles, fonts) */
+    void writeAssHeader(QTextStream &out) const;
+    /** @brief Write all events of the model, returns the number of written events */
+    int writeSubtitleEvents(QTextStream &out, bool assFormat) const;
 
 Q_SIGNALS:
     void modelChanged();
@@ -344,6 +382,14 @@ protected:
     void setup();
     void registerSubtitle(int id, std::pair<int, GenTime> startpos, bool temporary = false);
     void deregisterSubtitle(int id, bool temporary = false);
+    /** @brief Move a registered subtitle to a new layer / start position, keeping the id indexes in sync */
+    void updateSubtitlePosition(int id, std::pair<int, GenTime> startpos);
+    /** @brief Index the duration of a subtitle for the range lookups */
+    void updateSubtitleRange(const std::pair<int, GenTime> &startpos, GenTime endpos);
+    /** @brief Returns all subtitle ids in a range, even if the subtitle track is locked */
+    std::unordered_set<int> itemsInRange(int layer, int startFrame, int endFrame) const;
+    /** @brief Add delta to the count of subtitle id in the row tree */
+    void updateRowTree(int id, int delta);
     /** @brief Returns the index for a subtitle's id (it's position in the list
      */
     int positionForIndex(int id) const;
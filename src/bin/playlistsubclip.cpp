@@ -202,8 +202,9 @@ void PlaylistSubClip::getThumbFromPercent(int percent)
     int steps = qCeil(qMax(pCore->getCurrentFps(), double(duration) / 30));
     int framePos = duration * percent / 100;
     framePos -= framePos % steps;
-    if (ThumbnailCache::get()->hasThumbnail(m_parentClipId, m_inPoint + framePos)) {
-        setThumbnail(ThumbnailCache::get()->getThumbnail(m_parentClipId, m_inPoint + framePos));
+    QImage thumb = ThumbnailCache::get()->getKeyframeThumbnail(m_parentClipId, m_inPoint + framePos);
+    if (!thumb.isNull()) {
+        setThumbnail(thumb);
     } else {
         // Generate percent thumbs
         CacheTask::start(ObjectId(KdenliveObjectType::BinClip, m_parentClipId.toInt(), QUuid()), 30, m_inPoint, m_outPoint, this);
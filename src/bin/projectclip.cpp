@@ -8,6 +8,7 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 
 #include "projectclip.h"
 #include "audio/audioInfo.h"
+#include "audio/audioLevels.h"
 #include "bin.h"
 #include "clipcreator.hpp"
 #include "core.h"
@@ -18,6 +19,7 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include "jobs/audiolevelstask.h"
 #include "jobs/cachetask.h"
 #include "jobs/cliploadtask.h"
+#include "jobs/keyframestask.h"
 #include "jobs/proxytask.h"
 #include "kdenlivesettings.h"
 #include "lib/audio/audioStreamInfo.h"
@@ -31,6 +33,7 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include "projectitemmodel.h"
 #include "projectsubclip.h"
 #include "timeline2/model/snapmodel.hpp"
+#include "utils/cachemanager.h"
 #include "utils/thumbnailcache.hpp"
 #include "utils/timecode.h"
 #include "xml/xml.hpp"
@@ -107,6 +110,9 @@ ProjectClip::ProjectClip(const QString &id, const QIcon &thumb, const std::share
     hash();
     m_boundaryTimer.setSingleShot(true);
     m_boundaryTimer.setInterval(500);
+    m_proxyRangeTimer.setSingleShot(true);
+    m_proxyRangeTimer.setInterval(2000);
+    connect(&m_proxyRangeTimer, &QTimer::timeout, this, [this]() { ProxyTask::start(ObjectId(KdenliveObjectType::BinClip, m_binId.toInt(), QUuid()), this); });
     if (hasLimitedDuration()) {
         connect(&m_boundaryTimer, &QTimer::timeout, this, &ProjectClip::refreshBounds);
     }
@@ -189,6 +195,9 @@ ProjectClip::ProjectClip(const QString &id, const QDomElement &description, cons
     m_date = QFileInfo(m_temporaryUrl).lastModified();
     m_boundaryTimer.setSingleShot(true);
     m_boundaryTimer.setInterval(500);
+    m_proxyRangeTimer.setSingleShot(true);
+    m_proxyRangeTimer.setInterval(2000);
+    connect(&m_proxyRangeTimer, &QTimer::timeout, this, [this]() { ProxyTask::start(ObjectId(KdenliveObjectType::BinClip, m_binId.toInt(), QUuid()), this); });
     connect(m_markerModel.get(), &MarkerListModel::modelChanged, this,
             [&]() { setProducerProperty(QStringLiteral("kdenlive:markers"), m_markerModel->toJson()); });
 }
@@ -282,8 +291,13 @@ void ProjectClip::updateAudioThumbnail(bool cachedThumb)
                     st.next();
                     int channels = channelsList.value(st.key());
                     double channelHeight = double(streamHeight) / channels;
-                    const QVector<uint8_t> audioLevels = audioFrameCache(st.key());
-                    qreal indicesPrPixel = qreal(audioLevels.length()) / img.width();
+                    const std::shared_ptr<AudioLevels> levels = audioLevels(st.key());
+                    if (levels == nullptr) {
+                        streamCount++;
+                        continue;
+                    }
+                    const AudioLevels::Snapshot snapshot = levels->snapshot();
+                    qreal indicesPrPixel = qreal(snapshot.count()) / img.width();
                     int idx;
                     for (int channel = 0; channel < channels; channel++) {
                         double y = (streamHeight * streamCount) + (channel * channelHeight) + channelHeight / 2;
@@ -291,10 +305,10 @@ void ProjectClip::updateAudioThumbnail(bool cachedThumb)
                             idx = int(ceil(i * indicesPrPixel));
                             idx += idx % channels;
                             idx += channel;
-                            if (idx >= audioLevels.length() || idx < 0) {
+                            if (idx >= snapshot.count() || idx < 0) {
                                 break;
                             }
-                            double level = audioLevels.at(idx) * channelHeight / 510.; // divide height by 510 (2*255) to get height
+                            double level = snapshot.at(idx) * channelHeight / 510.; // divide height by 510 (2*255) to get height
                             painter.drawLine(i, int(y - level), i, int(y + level));
                         }
                     }
@@ -312,11 +326,9 @@ void ProjectClip::updateAudioThumbnail(bool cachedThumb)
     if (!KdenliveSettings::audiothumbnails()) {
         return;
     }
+    // Timeline waveforms were already refreshed as the levels were generated
+    Q_UNUSED(cachedThumb)
     m_audioThumbCreated = true;
-    if (!cachedThumb) {
-        // Audio was just created
-        updateTimelineClips({TimelineModel::ReloadAudioThumbRole});
-    }
 }
 
 bool ProjectClip::audioThumbCreated() const
@@ -742,6 +754,15 @@ void ProjectClip::checkProxy(bool rebuildProxy)
     }
 }
 
+void ProjectClip::checkProxyRanges()
+{
+    // Only range limited proxies, stored as a playlist, need to follow the timeline usage
+    if (!KdenliveSettings::proxyusedranges() || !hasProxy() || !getProducerProperty(QStringLiteral("kdenlive:proxy")).endsWith(QLatin1String(".mlt"))) {
+        return;
+    }
+    m_proxyRangeTimer.start();
+}
+
 // static
 const QString ProjectClip::getOriginalFromProxy(QString proxyPath)
 {
@@ -855,6 +876,74 @@ std::unique_ptr<Mlt::Producer> ProjectClip::getThumbProducer(const QUuid &)
     return thumbProd;
 }
 
+std::unique_ptr<Mlt::Producer> ProjectClip::getKeyframeThumbProducer()
+{
+    if ((m_clipType != ClipType::AV && m_clipType != ClipType::Video) || m_masterProducer == nullptr || m_clipStatus == FileStatus::StatusWaiting ||
+        m_clipStatus == FileStatus::StatusMissing || KdenliveSettings::gpu_accel()) {
+        return nullptr;
+    }
+    const QString mltService = m_masterProducer->get("mlt_service");
+    const QString mltResource = m_masterProducer->get("resource");
+    if (!mltService.startsWith(QLatin1String("avformat")) || !loadVideoKeyframes(mltResource)) {
+        return nullptr;
+    }
+    // Not built from m_thumbXml: the xml producer does not pass the decoder options to the avformat producer
+    std::unique_ptr<Mlt::Producer> thumbProd(new Mlt::Producer(pCore->thumbProfile(), "avformat-novalidate", mltResource.toUtf8().constData()));
+    if (!thumbProd->is_valid()) {
+        return nullptr;
+    }
+    Mlt::Properties original(m_masterProducer->get_properties());
+    Mlt::Properties cloneProps(thumbProd->get_properties());
+    cloneProps.pass_list(original, ClipController::getPassPropertiesList());
+    thumbProd->set("audio_index", -1);
+    thumbProd->set("astream", -1);
+    thumbProd->set("out", thumbProd->get_length() - 1);
+    // FFmpeg decoder option, applied by the avformat producer when it opens the video codec for the first fetched frame.
+    // Non key frames are dropped without being decoded, so a seek costs a single keyframe decode instead of up to a whole GOP
+    thumbProd->set("skip_frame", "nokey");
+    return thumbProd;
+}
+
+int ProjectClip::keyframeBefore(int position)
+{
+    QMutexLocker lk(&m_keyframesMutex);
+    auto it = std::upper_bound(m_videoKeyframes.cbegin(), m_videoKeyframes.cend(), position);
+    if (it == m_videoKeyframes.cbegin()) {
+        return -1;
+    }
+    return *(it - 1);
+}
+
+bool ProjectClip::loadVideoKeyframes(const QString &resource)
+{
+    QMutexLocker lk(&m_keyframesMutex);
+    if (resource == m_keyframesResource) {
+        return !m_videoKeyframes.isEmpty();
+    }
+    m_keyframesResource = resource;
+    m_videoKeyframes.clear();
+    lk.unlock();
+    // Probing reads the whole file, exact thumbnails are used until the task is done
+    KeyframesTask::start(ObjectId(KdenliveObjectType::BinClip, m_binId.toInt(), QUuid()), resource, this);
+    return false;
+}
+
+void ProjectClip::setVideoKeyframes(const QString &resource, const QVector<double> &times)
+{
+    const double fps = pCore->getCurrentFps();
+    QVector<int> keyframes;
+    keyframes.reserve(times.size());
+    for (double time : times) {
+        keyframes << qRound(time * fps);
+    }
+    std::sort(keyframes.begin(), keyframes.end());
+    keyframes.erase(std::unique(keyframes.begin(), keyframes.end()), keyframes.end());
+    QMutexLocker lk(&m_keyframesMutex);
+    if (resource == m_keyframesResource) {
+        m_videoKeyframes = keyframes;
+    }
+}
+
 void ProjectClip::createDisabledMasterProducer()
 {
     if (!m_disabledProducer) {
@@ -1591,6 +1680,41 @@ const QString ProjectClip::hashForThumbs()
     return clipHash;
 }
 
+QByteArray ProjectClip::renderData()
+{
+    QByteArray data = hashForThumbs().toUtf8();
+    if (m_masterProducer) {
+        Mlt::Properties props(m_masterProducer->get_properties());
+        for (int i = 0; i < props.count(); i++) {
+            const QString name = props.get_name(i);
+            // Metadata and internal properties do not change the rendered frames
+            if (name.startsWith(QLatin1Char('_')) || name.startsWith(QLatin1String("kdenlive:")) || name.startsWith(QLatin1String("meta."))) {
+                continue;
+            }
+            data.append(name.toUtf8());
+            data.append('=');
+            data.append(props.get(i));
+            data.append('\n');
+        }
+    }
+    if (m_effectStack && m_effectStack->rowCount() > 0) {
+        QDomDocument doc;
+        doc.appendChild(m_effectStack->toXml(doc));
+        data.append(doc.toByteArray());
+    }
+    return data;
+}
+
+QByteArray ProjectClip::sequenceRenderData(int in, int out)
+{
+    // The content of a sequence changes without changing its producer
+    auto sequence = pCore->currentDoc()->getTimeline(getSequenceUuid());
+    if (!sequence || out < in) {
+        return QByteArray();
+    }
+    return sequence->chunkHashes({in}, out - in + 1).value(in);
+}
+
 const QByteArray ProjectClip::getFolderHash(const QDir &dir, QString fileName)
 {
     QStringList files = dir.entryList(QDir::Files);
@@ -1978,6 +2102,13 @@ void ProjectClip::deleteProxy(bool reloadClip)
     QDir dir = pCore->currentDoc()->getCacheDir(CacheProxy, &ok);
     if (ok && proxy.length() > 2) {
         proxy = QFileInfo(proxy).fileName();
+        if (proxy.endsWith(QLatin1String(".mlt"))) {
+            // Range limited proxy
+            const auto segments = ProxyTask::rangeSegments(dir.absoluteFilePath(proxy));
+            for (const auto &segment : segments) {
+                QFile::remove(segment.second);
+            }
+        }
         if (dir.exists(proxy)) {
             dir.remove(proxy);
         }
@@ -2274,6 +2405,7 @@ void ProjectClip::registerTimelineClip(std::weak_ptr<TimelineModel> timeline, in
     }
     setRefCount(currentCount, totalCount);
     Q_EMIT registeredClipChanged();
+    checkProxyRanges();
 }
 
 void ProjectClip::checkClipBounds()
@@ -2361,6 +2493,38 @@ QMap<QUuid, QList<int>> ProjectClip::getAllTimelineInstances() const
     return m_registeredClipsByUuid;
 }
 
+QVector<QPoint> ProjectClip::usedRanges(int handles) const
+{
+    QVector<QPoint> ranges;
+    const int maxFrame = getFramePlaytime() - 1;
+    QMapIterator<QUuid, QList<int>> i(m_registeredClipsByUuid);
+    while (i.hasNext()) {
+        i.next();
+        auto timeline = pCore->currentDoc()->getTimeline(i.key(), true);
+        if (!timeline) {
+            continue;
+        }
+        for (int cid : i.value()) {
+            QPoint inDuration = timeline->getClipInDuration(cid);
+            // Timeline in and out of speed changed clips are expressed in the speed producer frames
+            const double speed = qAbs(timeline->getClipSpeed(cid));
+            int in = int(inDuration.x() * speed);
+            int out = qCeil((inDuration.x() + inDuration.y()) * speed) - 1;
+            ranges << QPoint(qMax(0, in - handles), qMin(maxFrame, out + handles));
+        }
+    }
+    std::sort(ranges.begin(), ranges.end(), [](const QPoint &a, const QPoint &b) { return a.x() < b.x(); });
+    QVector<QPoint> merged;
+    for (const QPoint &range : std::as_const(ranges)) {
+        if (!merged.isEmpty() && range.x() <= merged.last().y() + 1) {
+            merged.last().setY(qMax(merged.last().y(), range.y()));
+        } else {
+            merged << range;
+        }
+    }
+    return merged;
+}
+
 QStringList ProjectClip::timelineSequenceExtraResources() const
 {
     QStringList urls;
@@ -2685,7 +2849,7 @@ int ProjectClip::getThumbFromPercent(int percent, bool storeFrame)
     int steps = qCeil(qMax(pCore->getCurrentFps(), double(duration) / 30));
     int framePos = duration * percent / 100;
     framePos -= framePos % steps;
-    QImage thumb = ThumbnailCache::get()->getThumbnail(hashForThumbs(), m_binId, framePos);
+    QImage thumb = ThumbnailCache::get()->getKeyframeThumbnail(m_binId, framePos);
     if (!thumb.isNull()) {
         setThumbnail(thumb, -1, -1);
     } else {
@@ -2714,69 +2878,34 @@ int ProjectClip::getAudioMax(int stream)
     if (m_masterProducer->property_exists(key.toUtf8().constData())) {
         return m_masterProducer->get_int(key.toUtf8().constData());
     }
-    // Process audio max for the stream
-    const QString key2 = QStringLiteral("_kdenlive:audio%1").arg(stream);
-    if (!m_masterProducer->property_exists(key2.toUtf8().constData())) {
+    // The levels are still generated, use the highest level so far
+    const std::shared_ptr<AudioLevels> levels = audioLevels(stream);
+    if (levels == nullptr) {
         return 0;
     }
-    const QVector<uint8_t> audioData = *static_cast<QVector<uint8_t> *>(m_masterProducer->get_data(key2.toUtf8().constData()));
-    if (audioData.isEmpty()) {
-        return 0;
-    }
-    uint max = *std::max_element(audioData.constBegin(), audioData.constEnd());
-    m_masterProducer->set(key.toUtf8().constData(), int(max));
-    return int(max);
+    return int(levels->maxLevel());
 }
 
-const QVector<uint8_t> ProjectClip::audioFrameCache(int stream)
+std::shared_ptr<AudioLevels> ProjectClip::audioLevels(int stream)
 {
-    QVector<uint8_t> audioLevels;
     if (stream == -1) {
         if (m_audioInfo) {
             stream = m_audioInfo->ffmpeg_audio_index();
         } else {
-            return audioLevels;
+            return nullptr;
         }
     }
     const QString key = QStringLiteral("_kdenlive:audio%1").arg(stream);
-    if (m_masterProducer->get_data(key.toUtf8().constData())) {
-        const QVector<uint8_t> audioData = *static_cast<QVector<uint8_t> *>(m_masterProducer->get_data(key.toUtf8().constData()));
-        return audioData;
-    } else {
-        qDebug() << "=== AUDIO NOT FOUND ";
+    auto *levels = static_cast<std::shared_ptr<AudioLevels> *>(m_masterProducer->get_data(key.toUtf8().constData()));
+    if (levels == nullptr) {
+        return nullptr;
     }
-    return QVector<uint8_t>();
+    return *levels;
+}
 
-    // TODO
-    /*QString key = QStringLiteral("%1:%2").arg(m_binId).arg(stream);
-    QByteArray audioData;
-    if (pCore->audioThumbCache.find(key, &audioData)) {
-        if (audioData != QByteArray("-")) {
-            QDataStream in(audioData);
-            in >> audioLevels;
-            return audioLevels;
-        }
-    }
-    // convert cached image
-    const QString cachePath = getAudioThumbPath(stream);
-    // checking for cached thumbs
-    QImage image(cachePath);
-    if (!image.isNull()) {
-        int channels = m_audioInfo->channelsForStream(stream);
-        int n = image.width() * image.height();
-        for (int i = 0; i < n; i++) {
-            QRgb p = image.pixel(i / channels, i % channels);
-            audioLevels << uint8_t(qRed(p));
-            audioLevels << uint8_t(qGreen(p));
-            audioLevels << uint8_t(qBlue(p));
-            audioLevels << uint8_t(qAlpha(p));
-        }
-        // populate vector
-        QDataStream st(&audioData, QIODevice::WriteOnly);
-        st << audioLevels;
-        pCore->audioThumbCache.insert(key, audioData);
-    }
-    return audioLevels;*/
+void ProjectClip::updateAudioLevels(int stream, int first, int last)
+{
+    Q_EMIT pCore->projectItemModel()->audioLevelsChanged(m_binId, stream, first, last);
 }
 
 void ProjectClip::setClipStatus(FileStatus::ClipStatus status)
@@ -3019,7 +3148,14 @@ void ProjectClip::setInvalid()
 void ProjectClip::updateProxyProducer(const QString &path)
 {
     resetProducerProperty(QStringLiteral("_overwriteproxy"));
+    if (getProducerProperty(QStringLiteral("kdenlive:proxy")) != path) {
+        // Range limited proxies are stored as a playlist next to the requested proxy path
+        setProducerProperty(QStringLiteral("kdenlive:proxy"), path);
+    }
     setProducerProperty(QStringLiteral("resource"), path);
+    // The proxy was just created or reused, measure it for the cache quotas
+    CacheManager::get()->recordAccess(path);
+    CacheManager::get()->refresh(path);
     reloadProducer(false, true);
 }
 
@@ -20,6 +20,7 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include <QUuid>
 #include <memory>
 
+class AudioLevels;
 class ClipPropertiesController;
 class ProjectFolder;
 class ProjectSubClip;
@@ -148,6 +149,10 @@ public:
 
     /** @brief The clip hash created from the clip's resource, plus the video stream in case of multi-stream clips. */
     virtual const QString hashForThumbs();
+    /** @brief Data identifying what this clip renders: its file, the producer properties and the bin effects. Used to address cached preview chunks. */
+    QByteArray renderData();
+    /** @brief Data identifying what a sequence clip renders between frames @param in and @param out of the sequence. */
+    QByteArray sequenceRenderData(int in, int out);
     /** @brief Get the frame position used for Bin clip thumbnail
      */
     virtual int getThumbFrame() const;
@@ -167,6 +172,13 @@ public:
 
     /** @brief Returns this clip's producer. */
     std::unique_ptr<Mlt::Producer> getThumbProducer(const QUuid &uuid = QUuid()) override;
+    /** @brief Returns a thumbnail producer that only decodes keyframes, for fast approximate thumbnails, or nullptr if the keyframe
+     *  positions of the clip are unknown. Seeking it returns the first keyframe at or after the requested position, so seek to keyframeBefore(). */
+    std::unique_ptr<Mlt::Producer> getKeyframeThumbProducer();
+    /** @brief Returns the position of the last video keyframe at or before @param position, -1 if there is none. */
+    int keyframeBefore(int position);
+    /** @brief Set the probed video keyframe times of @param resource, in seconds from the stream start. */
+    void setVideoKeyframes(const QString &resource, const QVector<double> &times);
 
     /** @brief Recursively disable/enable bin effects. */
     void setBinEffectsEnabled(bool enabled) override;
@@ -211,6 +223,8 @@ public:
     /** @brief Returns a list of all timeline clip ids for this bin clip */
     QList<int> timelineInstances(QUuid activeUuid = QUuid()) const;
     QMap<QUuid, QList<int>> getAllTimelineInstances() const;
+    /** @brief Returns the source ranges used by the timeline instances of this clip, extended by @param handles frames and merged */
+    QVector<QPoint> usedRanges(int handles) const;
     /** @brief This function returns a cut to the master producer associated to the timeline clip with given ID.
         Each clip must have a different master producer (see comment of the class)
     */
@@ -239,9 +253,9 @@ public:
      */
     virtual int getThumbFromPercent(int percent, bool storeFrame = false);
 
-    /** @brief Return audio cache for a stream
+    /** @brief Return the audio levels of a stream, they may still be generated
      */
-    const QVector <uint8_t> audioFrameCache(int stream = -1);
+    std::shared_ptr<AudioLevels> audioLevels(int stream = -1);
     /** @brief Return FFmpeg's audio stream index for an MLT audio stream index
      */
     int getAudioStreamFfmpegIndex(int mltStream);
@@ -346,6 +360,8 @@ public Q_SLOTS:
     /** @brief Store the audio thumbnails once computed. Note that the parameter is a value and not a reference, fill free to use it as a sink (use std::move to
      * avoid copy). */
     void updateAudioThumbnail(bool cachedThumb);
+    /** @brief The audio levels of @param stream, from value @param first to @param last (excluded), are available */
+    void updateAudioLevels(int stream, int first, int last);
     /** @brief Delete the proxy file */
     void deleteProxy(bool reloadClip = true);
     /** @brief A clip job progressed, update display */
@@ -383,10 +399,18 @@ public Q_SLOTS:
     void checkClipBounds();
     /** @brief Check if proxy clip should be build for this clip. */
     void checkProxy(bool rebuildProxy = false);
+    /** @brief The timeline usage of this clip changed, extend its range limited proxy if needed. */
+    void checkProxyRanges();
 
 private:
     QMutex m_producerMutex;
     QByteArray m_thumbXml;
+    /** @brief Video keyframe positions of m_keyframesResource, probed once by a KeyframesTask for keyframe thumbnails */
+    QMutex m_keyframesMutex;
+    QString m_keyframesResource;
+    QVector<int> m_videoKeyframes;
+    /** @brief Returns true if the keyframe positions of @param resource are known, otherwise starts a task to probe them */
+    bool loadVideoKeyframes(const QString &resource);
     const QString geometryWithOffset(const QString &data, int offset);
     QMap <QString, QByteArray> m_audioLevels;
     /** @brief If true, all timeline occurrences of this clip will be replaced from a fresh producer on reload. */
@@ -394,6 +418,8 @@ private:
 
     QMap<QUuid, QList<int>> m_registeredClipsByUuid;
     QTimer m_boundaryTimer;
+    /** @brief Groups timeline changes before extending a range limited proxy */
+    QTimer m_proxyRangeTimer;
 
     // A temporary uuid used to reset thumbnails on producer change
     QUuid m_uuid;
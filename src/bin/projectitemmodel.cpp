@@ -502,14 +502,14 @@ std::shared_ptr<ProjectClip> ProjectItemModel::getClipByBinID(const QString &bin
     return nullptr;
 }
 
-const QVector<uint8_t> ProjectItemModel::getAudioLevelsByBinID(const QString &binId, int stream)
+std::shared_ptr<AudioLevels> ProjectItemModel::getAudioLevelsByBinID(const QString &binId, int stream)
 {
     READ_LOCK();
     auto search = m_allClipItems.find(binId.toInt());
     if (search != m_allClipItems.end()) {
-        return search->second->audioFrameCache(stream);
+        return search->second->audioLevels(stream);
     }
-    return QVector<uint8_t>();
+    return nullptr;
 }
 
 double ProjectItemModel::getAudioMaxLevel(const QString &binId, int stream)
@@ -1213,7 +1213,7 @@ std::vector<QString> ProjectItemModel::getAllClipIds() const
 
 void ProjectItemModel::updateCacheThumbnail(std::unordered_map<QString, std::vector<int>> &thumbData)
 {
-    READ_LOCK();
+    READ_WRITE_LOCK();
     for (const auto &clip : m_allItems) {
         auto c = std::static_pointer_cast<AbstractProjectItem>(clip.second.lock());
         if (c->itemType() == AbstractProjectItem::ClipItem) {
@@ -1657,36 +1657,22 @@ std::shared_ptr<Mlt::Tractor> ProjectItemModel::projectTractor()
     return m_projectTractor;
 }
 
-const std::pair<QString, QString> ProjectItemModel::sceneList(const QString &root, const QString &filterData, Mlt::Tractor *activeTractor, int duration,
-                                                              const QString &aspectRatio)
+std::unique_ptr<Mlt::Consumer> ProjectItemModel::runXmlConsumer(const QString &resource, const QString &root, const QString &filterData,
+                                                                 Mlt::Tractor *activeTractor, int duration)
 {
-    QWriteLocker lock(&pCore->xmlMutex);
-    LocaleHandling::resetLocale();
-    QString playlist;
-
-    QTemporaryFile tempFile;
-    if (!aspectRatio.isEmpty()) {
-        tempFile.setFileTemplate(QDir::temp().absoluteFilePath(QStringLiteral("kdenlive-XXXXXX.kdenlive")));
-        if (!tempFile.open()) {
-            qDebug() << "Could not open temporary file for writing";
-            return {};
-        }
-    }
-
-    tempFile.setAutoRemove(false);
-
-    Mlt::Consumer xmlConsumer(pCore->getProjectProfile(), "xml", aspectRatio.isEmpty() ? "kdenlive_playlist" : tempFile.fileName().toUtf8().constData());
-    if (!root.isEmpty()) {
-        xmlConsumer.set("root", root.toUtf8().constData());
+    auto xmlConsumer = std::make_unique<Mlt::Consumer>(pCore->getProjectProfile(), "xml", resource.toUtf8().constData());
+    if (!xmlConsumer->is_valid()) {
+        return nullptr;
     }
-    if (!xmlConsumer.is_valid()) {
-        return {};
+    if (!root.isEmpty() || resource != QLatin1String("kdenlive_playlist")) {
+        // When writing to a file without root, the xml consumer would make paths relative to the file's folder
+        xmlConsumer->set("root", root.toUtf8().constData());
     }
-    xmlConsumer.set("store", "kdenlive");
-    xmlConsumer.set("time_format", "clock");
+    xmlConsumer->set("store", "kdenlive");
+    xmlConsumer->set("time_format", "clock");
     // Disabling meta creates cleaner files, but then we don't have access to metadata on the fly (meta channels, etc)
     // And we must use "avformat" instead of "avformat-novalidate" on project loading which causes a big delay on project opening
-    // xmlConsumer.set("no_meta", 1);
+    // xmlConsumer->set("no_meta", 1);
     // Add active timeline as playlist of the main tractor so that when played through melt, the .kdenlive file reads the playlist
     if (m_projectTractor->count() > 0) {
         m_projectTractor->remove_track(0);
@@ -1702,13 +1688,46 @@ const std::pair<QString, QString> ProjectItemModel::sceneList(const QString &roo
         filter->set("bgcolour", "#bb333333");
         s.attach(*filter.get());
     }
-    xmlConsumer.connect(s);
-    xmlConsumer.run();
+    xmlConsumer->connect(s);
+    xmlConsumer->run();
     if (filter) {
         s.detach(*filter.get());
     }
+    return xmlConsumer;
+}
+
+bool ProjectItemModel::sceneListToFile(const QString &root, Mlt::Tractor *activeTractor, int duration, const QString &fileName)
+{
+    QWriteLocker lock(&pCore->xmlMutex);
+    LocaleHandling::resetLocale();
+    return runXmlConsumer(fileName, root, QString(), activeTractor, duration) != nullptr;
+}
+
+const std::pair<QString, QString> ProjectItemModel::sceneList(const QString &root, const QString &filterData, Mlt::Tractor *activeTractor, int duration,
+                                                              const QString &aspectRatio)
+{
+    QWriteLocker lock(&pCore->xmlMutex);
+    LocaleHandling::resetLocale();
+    QString playlist;
+
+    QTemporaryFile tempFile;
+    if (!aspectRatio.isEmpty()) {
+        tempFile.setFileTemplate(QDir::temp().absoluteFilePath(QStringLiteral("kdenlive-XXXXXX.kdenlive")));
+        if (!tempFile.open()) {
+            qDebug() << "Could not open temporary file for writing";
+            return {};
+        }
+    }
+
+    tempFile.setAutoRemove(false);
+
+    std::unique_ptr<Mlt::Consumer> xmlConsumer =
+        runXmlConsumer(aspectRatio.isEmpty() ? QStringLiteral("kdenlive_playlist") : tempFile.fileName(), root, filterData, activeTractor, duration);
+    if (!xmlConsumer) {
+        return {};
+    }
     if (aspectRatio.isEmpty()) {
-        playlist = QString::fromUtf8(xmlConsumer.get("kdenlive_playlist"));
+        playlist = QString::fromUtf8(xmlConsumer->get("kdenlive_playlist"));
         return {playlist, QString()};
     }
 
@@ -1842,7 +1861,7 @@ void ProjectItemModel::setClipInvalid(const QString &binId)
 
 void ProjectItemModel::slotUpdateInvalidCount()
 {
-    READ_LOCK();
+    READ_WRITE_LOCK();
     int missingCount = 0;
     int missingUsed = 0;
     for (const auto &clip : m_allItems) {
@@ -21,6 +21,7 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include <QTimer>
 #include <QUuid>
 
+class AudioLevels;
 class BinPlaylist;
 class FileWatcher;
 class MarkerListModel;
@@ -30,6 +31,7 @@ class EffectStackModel;
 class QProgressDialog;
 
 namespace Mlt {
+class Consumer;
 class Producer;
 class Properties;
 class Tractor;
@@ -63,7 +65,7 @@ public:
     /** @brief Returns a clip from the hierarchy, given its id */
     std::shared_ptr<ProjectClip> getClipByBinID(const QString &binId) const;
     /** @brief Returns audio levels for a clip from its id */
-    const QVector <uint8_t>getAudioLevelsByBinID(const QString &binId, int stream);
+    std::shared_ptr<AudioLevels> getAudioLevelsByBinID(const QString &binId, int stream);
     double getAudioMaxLevel(const QString &binId, int stream);
 
     /** @brief Returns a list of clips using the given url */
@@ -248,6 +250,8 @@ public:
      * file's path as second parameter */
     const std::pair<QString, QString> sceneList(const QString &root, const QString &filterData, Mlt::Tractor *activeTractor, int duration,
                                                 const QString &aspectRatio = QString());
+    /** @brief Write the main sequence's xml to the file @param fileName, without keeping it in memory */
+    bool sceneListToFile(const QString &root, Mlt::Tractor *activeTractor, int duration, const QString &fileName);
     /** @brief Ensure that sequence @destUuid is not embedded in any dependency of sequence @srcUuid */
     bool canBeEmbeded(const QUuid destUuid, const QUuid srcUuid);
     /** @brief Store a newly created sequence tractor for reuse */
@@ -307,6 +311,9 @@ private:
     int mapToColumn(int column) const;
     /** @brief Return column number(s) responsible for a specific data type*/
     QList<int> mapDataToColumn(AbstractProjectItem::DataType type) const;
+    /** @brief Serialize the main sequence with an MLT xml consumer writing to @param resource, returns the consumer or nullptr on error */
+    std::unique_ptr<Mlt::Consumer> runXmlConsumer(const QString &resource, const QString &root, const QString &filterData, Mlt::Tractor *activeTractor,
+                                                  int duration);
 
     mutable QReadWriteLock m_lock; // This is a lock that ensures safety in case of concurrent access
 
@@ -344,4 +351,6 @@ Q_SIGNALS:
     void addTag(const QString &, const QModelIndex &);
     void addClipCut(const QString &, int, int);
     void resetPlayOrLoopZone(const QString &id);
+    /** @brief The audio levels of a clip stream, from value @param first to @param last (excluded), are available */
+    void audioLevelsChanged(const QString &binId, int stream, int first, int last);
 };
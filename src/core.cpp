@@ -8,6 +8,7 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include "audiomixer/mixermanager.hpp"
 #include "bin/bin.h"
 #include "bin/mediabrowser.h"
+#include "bin/projectclip.h"
 #include "bin/projectitemmodel.h"
 #include "capture/mediacapture.h"
 #include "dialogs/proxytest.h"
@@ -30,6 +31,7 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include "timeline2/model/timelineitemmodel.hpp"
 #include "timeline2/view/timelinecontroller.h"
 #include "timeline2/view/timelinewidget.h"
+#include "utils/cachemanager.h"
 #include <mlt++/MltRepository.h>
 
 #include <KIO/OpenFileManagerWindowJob>
@@ -593,8 +595,9 @@ const QString &Core::getCurrentProfilePath() const
 bool Core::setCurrentProfile(const QString profilePath)
 {
     if (m_currentProfile == profilePath) {
-        // no change required, ensure timecode has correct fps
+        // no change required, ensure timecode and time conversions have correct fps
         m_timecode.setFormat(getCurrentProfile()->fps());
+        profileChanged();
         Q_EMIT updateProjectTimecode();
         return true;
     }
@@ -965,12 +968,24 @@ int Core::projectDuration() const
 
 void Core::profileChanged()
 {
-    GenTime::setFps(getCurrentFps());
+    GenTime::setFps(getCurrentProfile()->frame_rate_num(), getCurrentProfile()->frame_rate_den());
+    // Compiled keyframes store frame positions at the previous fps
+    KeyframeModel::invalidateAllCompiledKeyframes();
+}
+
+void Core::pushUndo(const Fun &undo, const Fun &redo, const QString &text, qint64 memoryCost)
+{
+    auto *command = new FunctionalUndoCommand(undo, redo, text);
+    command->setMemoryCost(memoryCost);
+    undoStack()->push(command);
 }
 
-void Core::pushUndo(const Fun &undo, const Fun &redo, const QString &text)
+void Core::pushMergeableUndo(const Fun &undo, const Fun &redo, const QString &text, const QString &mergeKey, qint64 memoryCost)
 {
-    undoStack()->push(new FunctionalUndoCommand(undo, redo, text));
+    auto *command = new FunctionalUndoCommand(undo, redo, text);
+    command->setMemoryCost(memoryCost);
+    command->setMergeKey(mergeKey);
+    undoStack()->push(command);
 }
 
 void Core::pushUndo(QUndoCommand *command)
@@ -1081,6 +1096,8 @@ void Core::invalidateRange(QPair<int, int> range)
 
 void Core::invalidateItem(ObjectId itemId)
 {
+    // The frames cached by the project monitor are outdated, even without timeline preview
+    invalidateMonitorFrames(itemId);
     if (!m_guiConstructed || !m_mainWindow->getCurrentTimeline() || m_mainWindow->getCurrentTimeline()->loading) return;
     auto tl = m_mainWindow->getTimeline(itemId.uuid);
     switch (itemId.type) {
@@ -1109,6 +1126,46 @@ void Core::invalidateItem(ObjectId itemId)
     }
 }
 
+void Core::invalidateMonitorFrames(const ObjectId &itemId)
+{
+    KdenliveDoc *doc = currentDoc();
+    if (doc == nullptr) {
+        return;
+    }
+    switch (itemId.type) {
+    case KdenliveObjectType::TimelineClip:
+    case KdenliveObjectType::TimelineComposition:
+    case KdenliveObjectType::TimelineTrack:
+        if (auto tl = doc->getTimeline(itemId.uuid, true)) {
+            tl->invalidateItemFrames(itemId.itemId);
+        }
+        break;
+    case KdenliveObjectType::BinClip: {
+        std::shared_ptr<ProjectClip> clip = m_projectItemModel->getClipByBinID(QString::number(itemId.itemId));
+        if (!clip) {
+            break;
+        }
+        // Audio clips are included, the monitor caches the audio of its frames too
+        const QMap<QUuid, QList<int>> instances = clip->getAllTimelineInstances();
+        for (auto i = instances.cbegin(); i != instances.cend(); ++i) {
+            if (auto tl = doc->getTimeline(i.key(), true)) {
+                for (int cid : i.value()) {
+                    tl->invalidateItemFrames(cid);
+                }
+            }
+        }
+        break;
+    }
+    case KdenliveObjectType::Master:
+        if (auto tl = doc->getTimeline(itemId.uuid, true)) {
+            Q_EMIT tl->invalidateFrames(0, -1);
+        }
+        break;
+    default:
+        break;
+    }
+}
+
 double Core::getClipSpeed(ObjectId id) const
 {
     auto tl = m_mainWindow->getTimeline(id.uuid);
@@ -1516,6 +1573,7 @@ void Core::cleanup()
 {
     audioThumbCache.clear();
     taskManager.slotCancelJobs();
+    CacheManager::get()->save();
     if (timeRemapWidget()) {
         timeRemapWidget()->selectedClip(-1, QUuid());
     }
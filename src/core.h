@@ -193,7 +193,10 @@ public:
 
     /** @brief Create and push and undo object based on the corresponding functions
         Note that if you class permits and requires it, you should use the macro PUSH_UNDO instead*/
-    void pushUndo(const Fun &undo, const Fun &redo, const QString &text);
+    void pushUndo(const Fun &undo, const Fun &redo, const QString &text, qint64 memoryCost = 0);
+    /** @brief Same as pushUndo, the command is merged with the previous one if it has the same @param mergeKey and was pushed a few seconds before.
+        The merged command keeps the first undo and the last redo, see FunctionalUndoCommand::setMergeKey */
+    void pushMergeableUndo(const Fun &undo, const Fun &redo, const QString &text, const QString &mergeKey, qint64 memoryCost = 0);
     void pushUndo(QUndoCommand *command);
     /** @brief display a user info/warning message in statusbar */
     void displayMessage(const QString &message, MessageType type, int timeout = -1);
@@ -357,6 +360,8 @@ private:
 
     /** @brief Makes sure Qt's locale and system locale settings match. */
     void initLocale();
+    /** @brief Discard the frames cached by the project monitor for the range of an item */
+    void invalidateMonitorFrames(const ObjectId &itemId);
 
     MainWindow *m_mainWindow{nullptr};
     ProjectManager *m_projectManager{nullptr};
@@ -24,6 +24,7 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include "pythoninterfaces/speechtotextwhisper.h"
 #include "timeline2/view/timelinecontroller.h"
 #include "timeline2/view/timelinewidget.h"
+#include "utils/cachemanager.h"
 #include "wizard.h"
 
 #ifdef USE_V4L
@@ -1109,6 +1110,13 @@ void KdenliveSettingsDialog::updateSettings()
         KdenliveSettings::setFullscreen_monitor(m_configSdl.fullscreen_monitor->currentData().toString());
     }
 
+    // Apply the cache limits now, the cleanup runs in the background
+    KdenliveSettings::setCachequota(m_configEnv.kcfg_cachequota->value());
+    KdenliveSettings::setPreviewcachequota(m_configEnv.kcfg_previewcachequota->value());
+    KdenliveSettings::setProxycachequota(m_configEnv.kcfg_proxycachequota->value());
+    KdenliveSettings::setThumbscachequota(m_configEnv.kcfg_thumbscachequota->value());
+    CacheManager::get()->enforceQuotas();
+
     if (m_configEnv.capturefolderurl->url().toLocalFile() != KdenliveSettings::capturefolder()) {
         KdenliveSettings::setCapturefolder(m_configEnv.capturefolderurl->url().toLocalFile());
     }
@@ -191,6 +191,9 @@ RenderWidget::RenderWidget(bool enableProxy, QWidget *parent)
     connect(m_view.out_file, &KUrlRequester::textChanged, this, static_cast<void (RenderWidget::*)()>(&RenderWidget::slotUpdateButtons));
     connect(m_view.out_file, &KUrlRequester::urlSelected, this, static_cast<void (RenderWidget::*)(const QUrl &)>(&RenderWidget::slotUpdateButtons));
 
+    connect(m_view.stemAudioExport, &QAbstractButton::toggled, m_view.stemAudioMode, &QWidget::setEnabled);
+    m_view.stemAudioMode->setEnabled(m_view.stemAudioExport->isChecked());
+
     connect(m_view.guide_multi_box, &QGroupBox::toggled, this, &RenderWidget::slotRenderModeChanged);
     connect(m_view.render_guide, &QAbstractButton::clicked, this, &RenderWidget::slotRenderModeChanged);
     connect(m_view.render_zone, &QAbstractButton::clicked, this, &RenderWidget::slotRenderModeChanged);
@@ -719,6 +722,7 @@ void RenderWidget::slotPrepareExport2(bool delayedRendering)
     request->setEmbedSubtitles(m_view.embed_subtitles->isEnabled() && m_view.embed_subtitles->isChecked());
     request->setTwoPass(m_view.checkTwoPass->isChecked());
     request->setAudioFilePerTrack(m_view.stemAudioExport->isChecked() && m_view.stemAudioExport->isEnabled());
+    request->setStemMode(RenderRequest::StemMode(m_view.stemAudioMode->currentIndex()));
 
     bool guideMultiExport = m_view.guide_multi_box->isChecked();
     int guideCategory = m_view.guideCategoryChooser->currentCategory();
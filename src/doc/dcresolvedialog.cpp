@@ -54,17 +54,27 @@ DCResolveDialog::DCResolveDialog(std::vector<DocumentChecker::DocumentResource>
     connect(m_model.get(), &DocumentCheckerTreeModel::searchProgress, this, [&](int current, int total) {
         setEnableChangeItems(false);
         progressBox->setVisible(true);
-        progressLabel->setText(i18n("Recursive search: processing clips"));
+        if (total == 0) {
+            progressLabel->setText(i18n("Recursive search: indexing folder"));
+        } else {
+            progressLabel->setText(i18n("Recursive search: processing clips"));
+        }
         progressBar->setMinimum(0);
         progressBar->setMaximum(total);
         progressBar->setValue(current);
     });
+    connect(abortSearch, &QPushButton::clicked, m_model.get(), &DocumentCheckerTreeModel::abortSearch);
 
-    connect(m_model.get(), &DocumentCheckerTreeModel::searchDone, this, [&]() {
+    connect(m_model.get(), &DocumentCheckerTreeModel::searchDone, this, [&](bool completed) {
         setEnableChangeItems(true);
         progressBox->hide();
-        infoLabel->setText(i18n("Recursive search: done in %1 s", QString::number(m_searchTimer.elapsed() / 1000., 'f', 2)));
-        infoLabel->setMessageType(KMessageWidget::MessageType::Positive);
+        if (completed) {
+            infoLabel->setText(i18n("Recursive search: done in %1 s", QString::number(m_searchTimer.elapsed() / 1000., 'f', 2)));
+            infoLabel->setMessageType(KMessageWidget::MessageType::Positive);
+        } else {
+            infoLabel->setText(i18n("Recursive search aborted"));
+            infoLabel->setMessageType(KMessageWidget::MessageType::Warning);
+        }
         infoLabel->animatedShow();
         infoLabel->setCloseButtonVisible(true);
     });
@@ -179,12 +179,14 @@ bool DocumentChecker::hasErrorInProject()
 
     QString storageFolder;
     QDir projectDir(m_url.adjusted(QUrl::RemoveFilename).toLocalFile());
-    QDomNodeList playlists = m_doc.elementsByTagName(QStringLiteral("playlist"));
+    // Index all the elements we check in a single pass. The index is not invalidated when we fix elements, unlike elementsByTagName
+    const Xml::TagIndex index(m_doc, {QStringLiteral("playlist"), QStringLiteral("tractor"), QStringLiteral("producer"), QStringLiteral("chain"),
+                                      QStringLiteral("entry")});
     QDomElement mainBinPlaylist;
-    for (int i = 0; i < playlists.count(); ++i) {
-        if (playlists.at(i).toElement().attribute(QStringLiteral("id")) == BinPlaylist::binPlaylistId) {
+    for (const QDomElement &playlist : index.elements(QStringLiteral("playlist"))) {
+        if (playlist.attribute(QStringLiteral("id")) == BinPlaylist::binPlaylistId) {
             // This is the bin playlist
-            mainBinPlaylist = playlists.at(i).toElement();
+            mainBinPlaylist = playlist;
             // ensure the documentid is valid
             m_documentid = Xml::getXmlProperty(mainBinPlaylist, QStringLiteral("kdenlive:docproperties.documentid"));
             if (m_documentid.isEmpty()) {
@@ -221,10 +223,10 @@ bool DocumentChecker::hasErrorInProject()
         }
     }
 
-    QDomNodeList documentTractors = m_doc.elementsByTagName(QStringLiteral("tractor"));
-    QDomNodeList documentProducers = m_doc.elementsByTagName(QStringLiteral("producer"));
-    QDomNodeList documentChains = m_doc.elementsByTagName(QStringLiteral("chain"));
-    QDomNodeList entries = m_doc.elementsByTagName(QStringLiteral("entry"));
+    const QVector<QDomElement> &documentTractors = index.elements(QStringLiteral("tractor"));
+    const QVector<QDomElement> &documentProducers = index.elements(QStringLiteral("producer"));
+    const QVector<QDomElement> &documentChains = index.elements(QStringLiteral("chain"));
+    const QVector<QDomElement> &entries = index.elements(QStringLiteral("entry"));
     QDomNodeList transitions = m_doc.elementsByTagName(QStringLiteral("transition"));
     QDomNodeList filts = m_doc.elementsByTagName(QStringLiteral("filter"));
     QMap<QString, QString> renamedEffects;
@@ -244,7 +246,7 @@ bool DocumentChecker::hasErrorInProject()
     QMap<int, std::pair<QString, QString>> timelineProducers;
     QMap<int, QUuid> binClipsMap;
     for (int i = 0; i < max; ++i) {
-        QDomElement e = documentProducers.item(i).toElement();
+        QDomElement e = documentProducers.at(i);
         if (Xml::hasXmlProperty(e, QStringLiteral("kdenlive:playlistid"))) {
             // Black track producer, ignore
             continue;
@@ -271,7 +273,7 @@ bool DocumentChecker::hasErrorInProject()
     }
     max = documentChains.count();
     for (int i = 0; i < max; ++i) {
-        QDomElement e = documentChains.item(i).toElement();
+        QDomElement e = documentChains.at(i);
         int kid = Xml::getXmlProperty(e, QStringLiteral("kdenlive:id")).toInt();
         const QString id = e.attribute(QLatin1String("id"));
         const QString resource = Xml::getXmlProperty(e, QStringLiteral("resource"));
@@ -295,7 +297,7 @@ bool DocumentChecker::hasErrorInProject()
 
     max = documentTractors.count();
     for (int i = 0; i < max; ++i) {
-        QDomElement e = documentTractors.item(i).toElement();
+        QDomElement e = documentTractors.at(i);
         const QString resource = Xml::getXmlProperty(e, QStringLiteral("kdenlive:uuid"));
         if (Xml::hasXmlProperty(e, QStringLiteral("kdenlive:projectTractor")) || resource.isEmpty()) {
             // We don't want to touch the project tractor or tracks tractors
@@ -347,19 +349,19 @@ bool DocumentChecker::hasErrorInProject()
     QStringList verifiedPaths;
     max = documentProducers.count();
     for (int i = 0; i < max; ++i) {
-        QDomElement e = documentProducers.item(i).toElement();
+        QDomElement e = documentProducers.at(i);
         verifiedPaths << getMissingProducers(e, entries, storageFolder);
         Q_EMIT pCore->loadingMessageIncrease();
     }
     max = documentChains.count();
     for (int i = 0; i < max; ++i) {
-        QDomElement e = documentChains.item(i).toElement();
+        QDomElement e = documentChains.at(i);
         verifiedPaths << getMissingProducers(e, entries, storageFolder);
         Q_EMIT pCore->loadingMessageIncrease();
     }
     max = documentTractors.count();
     for (int i = 0; i < max; ++i) {
-        QDomElement e = documentTractors.item(i).toElement();
+        QDomElement e = documentTractors.at(i);
         if (Xml::hasXmlProperty(e, QStringLiteral("kdenlive:projectTractor"))) {
             // We don't want to touch the project tractor
             continue;
@@ -376,7 +378,7 @@ bool DocumentChecker::hasErrorInProject()
     QStringList circularRefs;
     for (int i = 0; i < max; ++i) {
         Q_EMIT pCore->loadingMessageIncrease();
-        QDomElement e = documentTractors.item(i).toElement();
+        QDomElement e = documentTractors.at(i);
         if (Xml::hasXmlProperty(e, QStringLiteral("kdenlive:projectTractor"))) {
             // We don't want to touch the project tractor
             continue;
@@ -590,7 +592,7 @@ const QString DocumentChecker::relocateResource(QString sourceResource)
     return QString();
 }
 
-bool DocumentChecker::ensureProducerHasId(QDomElement &producer, const QDomNodeList &entries)
+bool DocumentChecker::ensureProducerHasId(QDomElement &producer, const QVector<QDomElement> &entries)
 {
     if (!Xml::getXmlProperty(producer, QStringLiteral("kdenlive:id")).isEmpty()) {
         // id is there, everything is fine
@@ -598,10 +600,8 @@ bool DocumentChecker::ensureProducerHasId(QDomElement &producer, const QDomNodeL
     }
 
     // This should not happen, try to recover the producer id
-    int max = entries.count();
     QString producerName = producer.attribute(QStringLiteral("id"));
-    for (int j = 0; j < max; j++) {
-        QDomElement e = entries.item(j).toElement();
+    for (const QDomElement &e : entries) {
         if (e.attribute(QStringLiteral("producer")) == producerName) {
             // Match found
             QString entryName = Xml::getXmlProperty(e, QStringLiteral("kdenlive:id"));
@@ -840,7 +840,7 @@ bool DocumentChecker::ensureControlIdForItem(QDomElement &e, bool isBinClip)
     return true;
 }
 
-QString DocumentChecker::getMissingProducers(QDomElement &e, const QDomNodeList &entries, const QString &storageFolder)
+QString DocumentChecker::getMissingProducers(QDomElement &e, const QVector<QDomElement> &entries, const QString &storageFolder)
 {
     bool isBinClip = m_binIds.contains(e.attribute(QLatin1String("id")));
     // Ensure each timeline producer is connected to a bin clip
@@ -1147,151 +1147,6 @@ QString DocumentChecker::fixLumaPath(const QString &file)
     return QString();
 }
 
-QString DocumentChecker::searchLuma(const QDir &dir, const QString &file)
-{
-    // Try in user's chosen folder
-    QString result = fixLumaPath(file);
-    return result.isEmpty() ? searchPathRecursively(dir, QFileInfo(file).fileName()) : result;
-}
-
-QString DocumentChecker::searchPathRecursively(const QDir &dir, const QString &fileName, ClipType::ProducerType type)
-{
-    QString foundFileName;
-    bool patternSlideshow = true;
-    QDir searchDir(dir);
-    QStringList filesAndDirs;
-    qApp->processEvents();
-    /*if (m_abortSearch) {
-        return QString();
-    }*/
-    if (type == ClipType::SlideShow) {
-        if (fileName.contains(QLatin1Char('%'))) {
-            searchDir.setNameFilters({fileName.section(QLatin1Char('%'), 0, -2) + QLatin1Char('*')});
-            filesAndDirs = searchDir.entryList(QDir::Files | QDir::Readable);
-
-        } else {
-            patternSlideshow = false;
-            QString slideDirName = QFileInfo(fileName).dir().dirName();
-            searchDir.setNameFilters({slideDirName});
-            filesAndDirs = searchDir.entryList(QDir::Dirs | QDir::Readable);
-        }
-    } else {
-        searchDir.setNameFilters({fileName});
-        filesAndDirs = searchDir.entryList(QDir::Files | QDir::Readable);
-    }
-    if (!filesAndDirs.isEmpty()) {
-        // File Found
-        if (type == ClipType::SlideShow) {
-            if (patternSlideshow) {
-                return searchDir.absoluteFilePath(fileName);
-            } else {
-                // mime type slideshow
-                searchDir.cd(filesAndDirs.first());
-                return searchDir.absoluteFilePath(QFileInfo(fileName).fileName());
-            }
-        } else {
-            return searchDir.absoluteFilePath(filesAndDirs.first());
-        }
-    }
-    searchDir.setNameFilters(QStringList());
-    filesAndDirs = searchDir.entryList(QDir::Dirs | QDir::Readable | QDir::Executable | QDir::NoDotAndDotDot);
-    for (int i = 0; i < filesAndDirs.size() && foundFileName.isEmpty(); ++i) {
-        foundFileName = searchPathRecursively(searchDir.absoluteFilePath(filesAndDirs.at(i)), fileName, type);
-        if (!foundFileName.isEmpty()) {
-            break;
-        }
-    }
-    return foundFileName;
-}
-
-QString DocumentChecker::searchDirRecursively(const QDir &dir, const QString &matchHash, const QString &fullName)
-{
-    qApp->processEvents();
-    /*if (m_abortSearch) {
-        return QString();
-    }*/
-    // Q_EMIT showScanning(i18n("Scanning %1", dir.absolutePath()));
-    QString fileName = QFileInfo(fullName).fileName();
-    // Check main dir
-    QString fileHash = ProjectClip::getFolderHash(dir, fileName).toHex();
-    if (fileHash == matchHash) {
-        return dir.absoluteFilePath(fileName);
-    }
-    // Search subfolders
-    const QStringList subDirs = dir.entryList(QDir::AllDirs | QDir::NoDot | QDir::NoDotDot);
-    for (const QString &sub : subDirs) {
-        QDir subFolder(dir.absoluteFilePath(sub));
-        fileHash = ProjectClip::getFolderHash(subFolder, fileName).toHex();
-        if (fileHash == matchHash) {
-            return subFolder.absoluteFilePath(fileName);
-        }
-    }
-    /*if (m_abortSearch) {
-        return QString();
-    }*/
-    // Search inside subfolders
-    for (const QString &sub : subDirs) {
-        QDir subFolder(dir.absoluteFilePath(sub));
-        const QStringList subSubDirs = subFolder.entryList(QDir::AllDirs | QDir::NoDot | QDir::NoDotDot);
-        for (const QString &subsub : subSubDirs) {
-            QDir subDir(subFolder.absoluteFilePath(subsub));
-            QString result = searchDirRecursively(subDir, matchHash, fullName);
-            if (!result.isEmpty()) {
-                return result;
-            }
-        }
-    }
-    return QString();
-}
-
-QString DocumentChecker::searchFileRecursively(const QDir &dir, const QString &matchSize, const QString &matchHash, const QString &fileName)
-{
-    if (matchSize.isEmpty() && matchHash.isEmpty()) {
-        return searchPathRecursively(dir, QUrl::fromLocalFile(fileName).fileName());
-    }
-    QString foundFileName;
-    QByteArray fileData;
-    QByteArray fileHash;
-    QStringList filesAndDirs = dir.entryList(QDir::Files | QDir::Readable);
-    for (int i = 0; i < filesAndDirs.size() && foundFileName.isEmpty(); ++i) {
-        qApp->processEvents();
-        /*if (m_abortSearch) {
-            return QString();
-        }*/
-        QFile file(dir.absoluteFilePath(filesAndDirs.at(i)));
-        if (QString::number(file.size()) == matchSize) {
-            if (file.open(QIODevice::ReadOnly)) {
-                /*
-                 * 1 MB = 1 second per 450 files (or faster)
-                 * 10 MB = 9 seconds per 450 files (or faster)
-                 */
-                if (file.size() > 1000000 * 2) {
-                    fileData = file.read(1000000);
-                    if (file.seek(file.size() - 1000000)) {
-                        fileData.append(file.readAll());
-                    }
-                } else {
-                    fileData = file.readAll();
-                }
-                file.close();
-                fileHash = QCryptographicHash::hash(fileData, QCryptographicHash::Md5);
-                if (QString::fromLatin1(fileHash.toHex()) == matchHash) {
-                    return file.fileName();
-                }
-            }
-        }
-        ////qCDebug(KDENLIVE_LOG) << filesAndDirs.at(i) << file.size() << fileHash.toHex();
-    }
-    filesAndDirs = dir.entryList(QDir::Dirs | QDir::Readable | QDir::Executable | QDir::NoDotAndDotDot);
-    for (int i = 0; i < filesAndDirs.size() && foundFileName.isEmpty(); ++i) {
-        foundFileName = searchFileRecursively(dir.absoluteFilePath(filesAndDirs.at(i)), matchSize, matchHash, fileName);
-        if (!foundFileName.isEmpty()) {
-            break;
-        }
-    }
-    return foundFileName;
-}
-
 QString DocumentChecker::ensureAbsolutePath(QString filepath)
 {
     bool platformChange = false;
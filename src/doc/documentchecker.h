@@ -43,16 +43,11 @@ public:
     bool hasErrorInProject();
     static QString fixLutFile(const QString &file);
     static QString fixLumaPath(const QString &file);
-    static QString searchLuma(const QDir &dir, const QString &file);
 
     static QString readableNameForClipType(ClipType::ProducerType type);
     static QString readableNameForMissingType(MissingType type);
     static QString readableNameForMissingStatus(MissingStatus type);
 
-    static QString searchPathRecursively(const QDir &dir, const QString &fileName, ClipType::ProducerType type = ClipType::Unknown);
-    static QString searchFileRecursively(const QDir &dir, const QString &matchSize, const QString &matchHash, const QString &fileName);
-    static QString searchDirRecursively(const QDir &dir, const QString &matchHash, const QString &fullName);
-
     bool resolveProblemsWithGUI();
     /** @brief Get a count of missing items in each category */
     QMap<DocumentChecker::MissingType, int> getCheckResults();
@@ -93,7 +88,7 @@ private:
     /** @brief Check if the producer has an id. If not (should not happen, but...) try to recover it
      *  @returns true if the producer has been changed (id recovered), false if it was either already okay or could not be recovered
      */
-    bool ensureProducerHasId(QDomElement &producer, const QDomNodeList &entries);
+    bool ensureProducerHasId(QDomElement &producer, const QVector<QDomElement> &entries);
     bool ensureControlIdForItem(QDomElement &e, bool isBinClip);
     /** @brief Check if the producer represents an "invalid" placeholder (project saved with missing source). If such a placeholder is detected, it tries to
      * recover the original clip.
@@ -102,7 +97,7 @@ private:
     bool ensureProducerIsNotPlaceholder(QDomElement &producer);
 
     /** @brief Check for various missing elements */
-    QString getMissingProducers(QDomElement &e, const QDomNodeList &entries, const QString &storageFolder);
+    QString getMissingProducers(QDomElement &e, const QVector<QDomElement> &entries, const QString &storageFolder);
     /** @brief Check if images and fonts in this clip exists, returns a list of images that do exist so we don't check twice. */
     void checkMissingImagesAndFonts(const QStringList &images, const QStringList &fonts, const QString &id);
     /** @brief If project path changed, try to relocate its resources */
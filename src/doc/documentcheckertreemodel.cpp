@@ -6,9 +6,15 @@
 #include "documentcheckertreemodel.h"
 
 #include "abstractmodel/treeitem.hpp"
+#include "doc/filesearchindex.h"
 
 #include <KColorScheme>
 
+#include <QApplication>
+#include <QEventLoop>
+#include <QFutureWatcher>
+#include <QtConcurrent>
+
 DocumentCheckerTreeModel::DocumentCheckerTreeModel(QObject *parent)
     : AbstractTreeModel{parent}
     , m_resourceItems()
@@ -65,7 +71,34 @@ void DocumentCheckerTreeModel::removeItem(const QModelIndex &ix)
 
 void DocumentCheckerTreeModel::slotSearchRecursively(const QString &newpath)
 {
-    QDir searchDir(newpath);
+    m_abortSearch = false;
+    // Walk the search folder only once, all missing items are then resolved against the index
+    FileSearchIndex index(newpath);
+    QList<qint64> sizes;
+    for (const auto &item : std::as_const(m_resourceItems)) {
+        if (item.type == DocumentChecker::MissingType::Clip && !item.fileSize.isEmpty() &&
+            (item.status == DocumentChecker::MissingStatus::Missing || item.status == DocumentChecker::MissingStatus::MissingButProxy)) {
+            sizes << item.fileSize.toLongLong();
+        }
+    }
+    Q_EMIT searchProgress(0, 0);
+    QFutureWatcher<bool> watcher;
+    QEventLoop loop;
+    connect(&watcher, &QFutureWatcher<bool>::finished, &loop, &QEventLoop::quit);
+    watcher.setFuture(QtConcurrent::run([&index, &sizes, this]() {
+        if (!index.scan(m_abortSearch)) {
+            return false;
+        }
+        // Hash all files with a matching size in parallel
+        index.hashFilesWithSize(sizes, m_abortSearch);
+        return !m_abortSearch;
+    }));
+    loop.exec();
+    if (!watcher.result()) {
+        Q_EMIT searchDone(false);
+        return;
+    }
+
     QMap<QModelIndex, QString> fixedMap;
     QMapIterator<int, DocumentChecker::DocumentResource> i(m_resourceItems);
     int counter = 1;
@@ -73,6 +106,10 @@ void DocumentCheckerTreeModel::slotSearchRecursively(const QString &newpath)
         i.next();
         Q_EMIT searchProgress(counter, m_resourceItems.count());
         counter++;
+        qApp->processEvents();
+        if (m_abortSearch) {
+            break;
+        }
         if (i.value().status != DocumentChecker::MissingStatus::Missing && i.value().status != DocumentChecker::MissingStatus::MissingButProxy) {
             continue;
         }
@@ -81,21 +118,24 @@ void DocumentCheckerTreeModel::slotSearchRecursively(const QString &newpath)
             ClipType::ProducerType type = i.value().clipType;
             if (type == ClipType::SlideShow) {
                 // Slideshows cannot be found with hash / size
-                newPath = DocumentChecker::searchDirRecursively(searchDir, i.value().hash, i.value().originalFilePath);
+                newPath = index.findFolder(i.value().hash, i.value().originalFilePath, m_abortSearch);
             } else {
-                newPath = DocumentChecker::searchFileRecursively(searchDir, i.value().fileSize, i.value().hash, i.value().originalFilePath);
+                newPath = index.findFile(i.value().fileSize, i.value().hash, i.value().originalFilePath);
             }
             if (newPath.isEmpty()) {
-                newPath = DocumentChecker::searchPathRecursively(searchDir, QUrl::fromLocalFile(i.value().originalFilePath).fileName(), type);
+                newPath = index.findPath(QUrl::fromLocalFile(i.value().originalFilePath).fileName(), type);
             }
         } else if (i.value().type == DocumentChecker::MissingType::Luma) {
-            newPath = DocumentChecker::searchLuma(searchDir, i.value().originalFilePath);
+            newPath = DocumentChecker::fixLumaPath(i.value().originalFilePath);
+            if (newPath.isEmpty()) {
+                newPath = index.findPath(QFileInfo(i.value().originalFilePath).fileName());
+            }
 
         } else if (i.value().type == DocumentChecker::MissingType::AssetFile) {
-            newPath = DocumentChecker::searchPathRecursively(searchDir, QFileInfo(i.value().originalFilePath).fileName());
+            newPath = index.findPath(QFileInfo(i.value().originalFilePath).fileName());
 
         } else if (i.value().type == DocumentChecker::MissingType::TitleImage) {
-            newPath = DocumentChecker::searchPathRecursively(searchDir, QFileInfo(i.value().originalFilePath).fileName());
+            newPath = index.findPath(QFileInfo(i.value().originalFilePath).fileName());
         }
         if (!newPath.isEmpty()) {
             fixedMap.insert(getIndexFromId(i.key()), newPath);
@@ -107,7 +147,12 @@ void DocumentCheckerTreeModel::slotSearchRecursively(const QString &newpath)
         setItemsNewFilePath(j.key(), j.value(), DocumentChecker::MissingStatus::Fixed, false);
     }
     Q_EMIT dataChanged(QModelIndex(), QModelIndex());
-    Q_EMIT searchDone();
+    Q_EMIT searchDone(!m_abortSearch);
+}
+
+void DocumentCheckerTreeModel::abortSearch()
+{
+    m_abortSearch = true;
 }
 
 void DocumentCheckerTreeModel::usePlaceholdersForMissing()
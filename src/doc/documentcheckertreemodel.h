@@ -9,6 +9,7 @@
 
 #include "doc/documentchecker.h"
 
+#include <atomic>
 #include <vector>
 
 class DocumentCheckerTreeModel : public AbstractTreeModel
@@ -22,7 +23,9 @@ public:
     static std::shared_ptr<DocumentCheckerTreeModel> construct(const std::vector<DocumentChecker::DocumentResource> &items, QObject *parent = nullptr);
 
     void removeItem(const QModelIndex &ix);
+    /** @brief Search all missing items in a folder. The folder is indexed only once, and the search can be interrupted with abortSearch() */
     void slotSearchRecursively(const QString &newpath);
+    void abortSearch();
     void usePlaceholdersForMissing();
     void setItemsNewFilePath(const QModelIndex &ix, const QString &url, DocumentChecker::MissingStatus status, bool refresh = true);
     void setItemsFileHash(const QModelIndex &index, const QString &hash);
@@ -38,8 +41,10 @@ public:
 
 private:
     QMap<int, DocumentChecker::DocumentResource> m_resourceItems;
+    std::atomic_bool m_abortSearch{false};
 
 Q_SIGNALS:
+    /** @brief Search progress, total is 0 while the search folder is being indexed */
     void searchProgress(int current, int total);
-    void searchDone();
+    void searchDone(bool completed);
 };
@@ -52,24 +52,18 @@ QPair<bool, QString> DocumentValidator::validate(const double currentVersion)
     }
     QDomElement kdenliveDoc = mlt.firstChildElement(QStringLiteral("kdenlivedoc"));
     QString rootDir = mlt.attribute(QStringLiteral("root"));
-    if (rootDir == QLatin1String("$CURRENTPATH")) {
-        // The document was extracted from a Kdenlive archived project, fix root directory
-        QString playlist = m_doc.toString();
-        playlist.replace(QLatin1String("$CURRENTPATH"), m_url.adjusted(QUrl::RemoveFilename | QUrl::StripTrailingSlash).toLocalFile());
-        m_doc.setContent(playlist);
-        mlt = m_doc.firstChildElement(QStringLiteral("mlt"));
-        kdenliveDoc = mlt.firstChildElement(QStringLiteral("kdenlivedoc"));
-    } else if (rootDir.isEmpty()) {
+    // Archived projects ($CURRENTPATH root) are relocated by KdenliveDoc::Open while streaming the file
+    if (rootDir.isEmpty()) {
         mlt.setAttribute(QStringLiteral("root"), m_url.adjusted(QUrl::RemoveFilename | QUrl::StripTrailingSlash).toLocalFile());
     }
 
     QLocale documentLocale = QLocale::c(); // Document locale for conversion. Previous MLT / Kdenlive versions used C locale by default
+    // Index the elements we need in a single pass instead of walking the whole tree for each tag
+    const Xml::TagIndex index(m_doc, {QStringLiteral("playlist"), QStringLiteral("producer"), QStringLiteral("chain")});
     QDomElement main_playlist;
-    QDomNodeList playlists = m_doc.elementsByTagName(QStringLiteral("playlist"));
-    for (int i = 0; i < playlists.count(); i++) {
-        if (playlists.at(i).toElement().attribute(QStringLiteral("id")) == QLatin1String("main bin") ||
-            playlists.at(i).toElement().attribute(QStringLiteral("id")) == QLatin1String("main_bin")) {
-            main_playlist = playlists.at(i).toElement();
+    for (const QDomElement &playlist : index.elements(QStringLiteral("playlist"))) {
+        if (playlist.attribute(QStringLiteral("id")) == QLatin1String("main bin") || playlist.attribute(QStringLiteral("id")) == QLatin1String("main_bin")) {
+            main_playlist = playlist;
             break;
         }
     }
@@ -141,16 +135,10 @@ QPair<bool, QString> DocumentValidator::validate(const double currentVersion)
     qDebug() << "FOUND MLT PROJECT VERSION: " << mltMajorVersion << " / " << mltServiceVersion << " / " << mltPatchVersion;
     if (mltMajorVersion <= 7 && mltServiceVersion <= 15) {
         // MLT <= 7.15.0 used the mute_on_pause property that is now deprecated and breaks audio playback so remove it
-        QDomNodeList producers = m_doc.elementsByTagName(QStringLiteral("producer"));
-        QDomNodeList chains = m_doc.elementsByTagName(QStringLiteral("chain"));
-        int max = producers.count();
-        for (int i = 0; i < max; ++i) {
-            QDomElement t = producers.at(i).toElement();
+        for (const QDomElement &t : index.elements(QStringLiteral("producer"))) {
             Xml::removeXmlProperty(t, QStringLiteral("mute_on_pause"));
         }
-        max = chains.count();
-        for (int i = 0; i < max; ++i) {
-            QDomElement t = chains.at(i).toElement();
+        for (const QDomElement &t : index.elements(QStringLiteral("chain"))) {
             Xml::removeXmlProperty(t, QStringLiteral("mute_on_pause"));
         }
     }
@@ -2250,11 +2238,12 @@ auto DocumentValidator::upgradeTo100(const QLocale &documentLocale) -> QString
         };
 
         // Fix properties just by name, anywhere in the file
-        auto props = m_doc.elementsByTagName(QStringLiteral("property"));
+        const Xml::TagIndex index(m_doc, {QStringLiteral("property"), QStringLiteral("filter"), QStringLiteral("producer"), QStringLiteral("tractor"),
+                                          QStringLiteral("entry"), QStringLiteral("transition"), QStringLiteral("blank")});
+        const QVector<QDomElement> &props = index.elements(QStringLiteral("property"));
         qDebug() << "Found " << props.count() << " properties.";
-        for (int i = 0; i < props.count(); i++) {
-            QString propName = props.at(i).attributes().namedItem("name").nodeValue();
-            QDomElement element = props.at(i).toElement();
+        for (const QDomElement &element : props) {
+            QString propName = element.attribute(QStringLiteral("name"));
             if (element.childNodes().size() == 1) {
                 QDomText text = element.firstChild().toText();
                 if (!text.isNull()) {
@@ -2297,10 +2286,9 @@ auto DocumentValidator::upgradeTo100(const QLocale &documentLocale) -> QString
         // Fix filter properties.
         // Note that effect properties will be fixed when the effect is loaded
         // as there is more information available about the parameter type.
-        auto filters = m_doc.elementsByTagName(QStringLiteral("filter"));
+        const QVector<QDomElement> &filters = index.elements(QStringLiteral("filter"));
         qDebug() << "Found" << filters.count() << "filters.";
-        for (int i = 0; i < filters.count(); i++) {
-            QDomElement filter = filters.at(i).toElement();
+        for (const QDomElement &filter : filters) {
             QString mltService = Xml::getXmlProperty(filter, "mlt_service");
 
             QList<QString> propertiesToFix;
@@ -2339,9 +2327,7 @@ auto DocumentValidator::upgradeTo100(const QLocale &documentLocale) -> QString
         // Fix attributes
         QList<QString> tagsToFix = {"producer", "filter", "tractor", "entry", "transition", "blank"};
         for (const QString &tag : tagsToFix) {
-            QDomNodeList elements = m_doc.elementsByTagName(tag);
-            for (int i = 0; i < elements.count(); i++) {
-                QDomElement el = elements.at(i).toElement();
+            for (QDomElement el : index.elements(tag)) {
                 fixAttribute(el, "in");
                 fixAttribute(el, "out");
                 fixAttribute(el, "length");
@@ -2503,8 +2489,16 @@ bool DocumentValidator::isModified() const
 
 bool DocumentValidator::checkMovit()
 {
-    QString playlist = m_doc.toString();
-    if (!playlist.contains(QStringLiteral("movit."))) {
+    // Look for Movit services without serializing the whole document
+    bool usesMovit = false;
+    const Xml::TagIndex index(m_doc, {QStringLiteral("property")});
+    for (const QDomElement &property : index.elements(QStringLiteral("property"))) {
+        if (property.text().contains(QLatin1String("movit."))) {
+            usesMovit = true;
+            break;
+        }
+    }
+    if (!usesMovit) {
         // Project does not use Movit GLSL effects, we can load it
         return true;
     }
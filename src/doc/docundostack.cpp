@@ -4,12 +4,21 @@
 */
 
 #include "docundostack.hpp"
+#include "kdenlivesettings.h"
+#include "undohelper.hpp"
+#include <KLocalizedString>
 #include <QUndoCommand>
 #include <QUndoGroup>
 
+namespace {
+/** @brief Estimated memory used by a command that does not report it */
+constexpr qint64 defaultCommandCost = 512;
+} // namespace
+
 DocUndoStack::DocUndoStack(QUndoGroup *parent)
     : QUndoStack(parent)
 {
+    connect(this, &QUndoStack::indexChanged, this, &DocUndoStack::checkIndex);
 }
 
 // TODO: custom undostack everywhere do that
@@ -19,4 +28,99 @@ void DocUndoStack::push(QUndoCommand *cmd)
         Q_EMIT invalidate(index());
     }
     QUndoStack::push(cmd);
+    updateMemoryUsage();
+    enforceBudget();
+}
+
+qint64 DocUndoStack::memoryUsage() const
+{
+    return m_memoryUsage;
+}
+
+int DocUndoStack::discardedCount() const
+{
+    return m_discarded;
+}
+
+qint64 DocUndoStack::commandCost(const QUndoCommand *command)
+{
+    qint64 cost = defaultCommandCost;
+    if (auto *functional = dynamic_cast<const FunctionalUndoCommand *>(command)) {
+        cost = functional->memoryCost();
+    }
+    for (int i = 0; i < command->childCount(); ++i) {
+        cost += commandCost(command->child(i));
+    }
+    return cost;
+}
+
+void DocUndoStack::updateMemoryUsage()
+{
+    // Commands are removed without notification when pushing over undone commands, or by clear(), so sum them again
+    qint64 usage = 0;
+    for (int i = 0; i < count(); ++i) {
+        usage += commandCost(command(i));
+    }
+    m_countedCommands = count();
+    m_discarded = qMin(m_discarded, count());
+    if (usage != m_memoryUsage) {
+        m_memoryUsage = usage;
+        Q_EMIT memoryUsageChanged(m_memoryUsage);
+    }
+}
+
+void DocUndoStack::enforceBudget()
+{
+    const qint64 budget = qint64(KdenliveSettings::undomemorybudget()) * 1048576;
+    if (budget <= 0 || m_memoryUsage <= budget) {
+        return;
+    }
+    // Always keep the last command undoable
+    const qint64 previousUsage = m_memoryUsage;
+    while (m_memoryUsage > budget && m_discarded < index() - 1) {
+        m_memoryUsage -= discard(command(m_discarded));
+        m_discarded++;
+    }
+    if (previousUsage != m_memoryUsage) {
+        Q_EMIT memoryUsageChanged(m_memoryUsage);
+    }
+}
+
+qint64 DocUndoStack::discard(const QUndoCommand *command)
+{
+    // QUndoStack only gives const access to its commands
+    auto *cmd = const_cast<QUndoCommand *>(command);
+    qint64 released = 0;
+    if (auto *functional = dynamic_cast<FunctionalUndoCommand *>(cmd)) {
+        if (!functional->isDiscarded()) {
+            const qint64 previous = functional->memoryCost();
+            functional->discard();
+            released = previous - functional->memoryCost();
+        }
+    }
+    if (command->parent() == nullptr && !cmd->text().isEmpty()) {
+        cmd->setText(i18nc("@item undo history entry that can no longer be undone", "%1 (discarded)", cmd->text()));
+    }
+    for (int i = 0; i < command->childCount(); ++i) {
+        released += discard(command->child(i));
+    }
+    return released;
+}
+
+void DocUndoStack::checkIndex()
+{
+    if (count() != m_countedCommands) {
+        updateMemoryUsage();
+    }
+    if (index() < m_discarded) {
+        // Undoing discarded commands does nothing, go back to the last state that can be undone
+        QMetaObject::invokeMethod(
+            this,
+            [this]() {
+                if (index() < m_discarded) {
+                    setIndex(m_discarded);
+                }
+            },
+            Qt::QueuedConnection);
+    }
 }
@@ -10,12 +10,36 @@
 class QUndoGroup;
 class QUndoCommand;
 
+/** @class DocUndoStack
+    @brief The undo stack of a project. It keeps an estimate of the memory used by its commands, and when it exceeds the undo memory budget
+    set in the settings, the lambdas of the oldest commands are discarded. The history cannot be undone past a discarded command.
+ */
 class DocUndoStack : public QUndoStack
 {
     Q_OBJECT
 public:
     explicit DocUndoStack(QUndoGroup *parent = Q_NULLPTR);
     void push(QUndoCommand *cmd);
+    /** @brief Estimated memory used by the commands, in bytes */
+    qint64 memoryUsage() const;
+    /** @brief Number of commands at the bottom of the stack that were discarded to respect the memory budget */
+    int discardedCount() const;
+    /** @brief Estimated memory used by @param command and its children, in bytes */
+    static qint64 commandCost(const QUndoCommand *command);
+
 Q_SIGNALS:
     void invalidate(int ix);
+    void memoryUsageChanged(qint64 bytes);
+
+private:
+    qint64 m_memoryUsage{0};
+    int m_discarded{0};
+    /** @brief Number of commands when the memory usage was computed */
+    int m_countedCommands{0};
+    void updateMemoryUsage();
+    /** @brief Discard the oldest commands until the memory usage fits in the budget */
+    void enforceBudget();
+    /** @brief Discard the lambdas of @param command and its children, returns the memory released */
+    static qint64 discard(const QUndoCommand *command);
+    void checkIndex();
 };
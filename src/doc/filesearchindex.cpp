@@ -0,0 +1,209 @@
+/*
+    SPDX-FileCopyrightText: 2026 Kdenlive contributors
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#include "filesearchindex.h"
+#include "bin/projectclip.h"
+
+#include <QDir>
+#include <QDirIterator>
+#include <QFileInfo>
+#include <QUrl>
+#include <QtConcurrent>
+
+namespace {
+struct ScanResult
+{
+    QList<QPair<QString, qint64>> files;
+    QStringList dirs;
+};
+
+ScanResult scanFolder(const QString &path, bool recursive, const std::atomic_bool &abort)
+{
+    ScanResult result;
+    if (recursive) {
+        result.dirs << path;
+    }
+    QDirIterator it(path, QDir::Files | QDir::Dirs | QDir::Readable | QDir::NoDotAndDotDot,
+                    recursive ? QDirIterator::Subdirectories : QDirIterator::NoIteratorFlags);
+    while (it.hasNext()) {
+        if (abort) {
+            break;
+        }
+        it.next();
+        const QFileInfo info = it.fileInfo();
+        if (info.isDir()) {
+            if (recursive) {
+                result.dirs << info.absoluteFilePath();
+            }
+        } else {
+            result.files << qMakePair(info.absoluteFilePath(), info.size());
+        }
+    }
+    return result;
+}
+
+/** @brief Sort paths so that the least nested match comes first, like the previous depth-first search did */
+void sortByDepth(QStringList &paths)
+{
+    std::sort(paths.begin(), paths.end(), [](const QString &a, const QString &b) {
+        int depthA = a.count(QLatin1Char('/'));
+        int depthB = b.count(QLatin1Char('/'));
+        return depthA == depthB ? a < b : depthA < depthB;
+    });
+}
+} // namespace
+
+FileSearchIndex::FileSearchIndex(const QString &root)
+    : m_root(QDir(root).absolutePath())
+{
+}
+
+bool FileSearchIndex::scan(const std::atomic_bool &abort)
+{
+    m_filesByName.clear();
+    m_filesBySize.clear();
+    m_dirsByName.clear();
+    m_dirsWithFiles.clear();
+    m_hashes.clear();
+    // Files of the root folder are listed directly, each subfolder tree is then walked in its own thread
+    ScanResult rootContent = scanFolder(m_root, false, abort);
+    const QStringList subDirs = QDir(m_root).entryList(QDir::Dirs | QDir::Readable | QDir::Executable | QDir::NoDotAndDotDot);
+    QStringList subPaths;
+    for (const QString &sub : subDirs) {
+        subPaths << QDir(m_root).absoluteFilePath(sub);
+    }
+    QList<ScanResult> results = QtConcurrent::blockingMapped<QList<ScanResult>>(subPaths, [&abort](const QString &path) { return scanFolder(path, true, abort); });
+    if (abort) {
+        return false;
+    }
+    results.prepend(rootContent);
+    QSet<QString> dirsWithFiles;
+    for (const ScanResult &res : std::as_const(results)) {
+        for (const auto &file : res.files) {
+            const int pos = file.first.lastIndexOf(QLatin1Char('/'));
+            m_filesByName[file.first.mid(pos + 1)] << file.first;
+            m_filesBySize[file.second] << file.first;
+            dirsWithFiles.insert(file.first.left(pos));
+        }
+        for (const QString &dir : res.dirs) {
+            m_dirsByName[dir.section(QLatin1Char('/'), -1)] << dir;
+        }
+    }
+    for (auto it = m_filesByName.begin(); it != m_filesByName.end(); ++it) {
+        sortByDepth(it.value());
+    }
+    for (auto it = m_filesBySize.begin(); it != m_filesBySize.end(); ++it) {
+        sortByDepth(it.value());
+    }
+    for (auto it = m_dirsByName.begin(); it != m_dirsByName.end(); ++it) {
+        sortByDepth(it.value());
+    }
+    m_dirsWithFiles = dirsWithFiles.values();
+    sortByDepth(m_dirsWithFiles);
+    return true;
+}
+
+void FileSearchIndex::hashFilesWithSize(const QList<qint64> &sizes, const std::atomic_bool &abort)
+{
+    QSet<QString> uniquePaths;
+    for (qint64 size : sizes) {
+        const QStringList paths = m_filesBySize.value(size);
+        QMutexLocker lk(&m_hashMutex);
+        for (const QString &path : paths) {
+            if (!m_hashes.contains(path)) {
+                uniquePaths.insert(path);
+            }
+        }
+    }
+    QStringList candidates = uniquePaths.values();
+    QtConcurrent::blockingMap(candidates, [this, &abort](const QString &path) {
+        if (abort) {
+            return;
+        }
+        const QByteArray hash = ProjectClip::calculateHash(path).first.toHex();
+        QMutexLocker lk(&m_hashMutex);
+        m_hashes.insert(path, hash);
+    });
+}
+
+QString FileSearchIndex::findFile(const QString &matchSize, const QString &matchHash, const QString &fileName) const
+{
+    if (matchSize.isEmpty() && matchHash.isEmpty()) {
+        return findPath(QUrl::fromLocalFile(fileName).fileName());
+    }
+    const QStringList paths = m_filesBySize.value(matchSize.toLongLong());
+    QMutexLocker lk(&m_hashMutex);
+    for (const QString &path : paths) {
+        auto hash = m_hashes.constFind(path);
+        if (hash == m_hashes.constEnd()) {
+            // Hash not prepared, compute it now
+            lk.unlock();
+            const QByteArray fileHash = ProjectClip::calculateHash(path).first.toHex();
+            lk.relock();
+            if (QString::fromLatin1(fileHash) == matchHash) {
+                return path;
+            }
+        } else if (QString::fromLatin1(hash.value()) == matchHash) {
+            return path;
+        }
+    }
+    return QString();
+}
+
+QString FileSearchIndex::findPath(const QString &fileName, ClipType::ProducerType type) const
+{
+    if (type != ClipType::SlideShow) {
+        const QStringList paths = m_filesByName.value(fileName);
+        return paths.isEmpty() ? QString() : paths.first();
+    }
+    if (fileName.contains(QLatin1Char('%'))) {
+        // Pattern slideshow, find a folder containing a file with the same prefix
+        const QString prefix = fileName.section(QLatin1Char('%'), 0, -2);
+        QStringList matches;
+        for (auto it = m_filesByName.constBegin(); it != m_filesByName.constEnd(); ++it) {
+            if (it.key().startsWith(prefix)) {
+                matches << it.value().first();
+            }
+        }
+        if (matches.isEmpty()) {
+            return QString();
+        }
+        sortByDepth(matches);
+        return QFileInfo(matches.first()).dir().absoluteFilePath(fileName);
+    }
+    // Mime type slideshow, find a folder with the same name
+    const QStringList dirs = m_dirsByName.value(QFileInfo(fileName).dir().dirName());
+    if (dirs.isEmpty()) {
+        return QString();
+    }
+    return QDir(dirs.first()).absoluteFilePath(QFileInfo(fileName).fileName());
+}
+
+QString FileSearchIndex::findFolder(const QString &matchHash, const QString &fullName, const std::atomic_bool &abort) const
+{
+    const QString fileName = QFileInfo(fullName).fileName();
+    // Folders are checked in parallel, the least nested match wins
+    const QList<bool> matches = QtConcurrent::blockingMapped<QList<bool>>(m_dirsWithFiles, [&](const QString &dir) {
+        if (abort) {
+            return false;
+        }
+        return QString::fromLatin1(ProjectClip::getFolderHash(QDir(dir), fileName).toHex()) == matchHash;
+    });
+    for (int i = 0; i < matches.size(); ++i) {
+        if (matches.at(i)) {
+            return QDir(m_dirsWithFiles.at(i)).absoluteFilePath(fileName);
+        }
+    }
+    return QString();
+}
+
+int FileSearchIndex::fileCount() const
+{
+    int count = 0;
+    for (auto it = m_filesBySize.constBegin(); it != m_filesBySize.constEnd(); ++it) {
+        count += it.value().size();
+    }
+    return count;
+}
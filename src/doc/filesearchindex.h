@@ -0,0 +1,54 @@
+/*
+    SPDX-FileCopyrightText: 2026 Kdenlive contributors
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#pragma once
+
+#include "definitions.h"
+
+#include <QHash>
+#include <QMutex>
+#include <QStringList>
+
+#include <atomic>
+
+/** @class FileSearchIndex
+    @brief In-memory index of all files and folders below a search root.
+    The root folder is walked only once (top level subfolders are scanned in parallel), and missing
+    resources are then resolved against the index by name, size and partial hash. File hashes are
+    only computed for files whose size matches one of the requested resources.
+ */
+class FileSearchIndex
+{
+public:
+    explicit FileSearchIndex(const QString &root);
+
+    /** @brief Walk the search root and build the index.
+     *  @returns false if the scan was aborted */
+    bool scan(const std::atomic_bool &abort);
+    /** @brief Compute the partial hash of all indexed files matching one of the sizes, in parallel */
+    void hashFilesWithSize(const QList<qint64> &sizes, const std::atomic_bool &abort);
+    /** @brief Find a file by size and partial hash, falling back to its file name if no size / hash is known */
+    QString findFile(const QString &matchSize, const QString &matchHash, const QString &fileName) const;
+    /** @brief Find a file by name, or the folder of a slideshow */
+    QString findPath(const QString &fileName, ClipType::ProducerType type = ClipType::Unknown) const;
+    /** @brief Find the folder of a slideshow by its folder hash (see ProjectClip::getFolderHash) */
+    QString findFolder(const QString &matchHash, const QString &fullName, const std::atomic_bool &abort) const;
+    /** @brief Number of files in the index */
+    int fileCount() const;
+
+private:
+    QString m_root;
+    /** @brief File name -> absolute paths, sorted so that the shallowest match comes first */
+    QHash<QString, QStringList> m_filesByName;
+    /** @brief File size -> absolute paths */
+    QHash<qint64, QStringList> m_filesBySize;
+    /** @brief Folder name -> absolute paths */
+    QHash<QString, QStringList> m_dirsByName;
+    /** @brief All folders containing at least one file */
+    QStringList m_dirsWithFiles;
+    /** @brief Path -> partial hash, filled by hashFilesWithSize */
+    QHash<QString, QByteArray> m_hashes;
+    mutable QMutex m_hashMutex;
+};
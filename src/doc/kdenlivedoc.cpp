@@ -7,7 +7,6 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include "kdenlivedoc.h"
 #include "bin/bin.h"
 #include "bin/bincommands.h"
-#include "bin/binplaylist.hpp"
 #include "bin/clipcreator.hpp"
 #include "bin/mediabrowser.h"
 #include "bin/model/markerlistmodel.hpp"
@@ -30,6 +29,8 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include "timeline2/model/timelineitemmodel.hpp"
 #include "titler/titlewidget.h"
 #include "transitions/transitionsrepository.hpp"
+#include "utils/cachemanager.h"
+#include "xml/xml.hpp"
 #include <config-kdenlive.h>
 
 #include <KBookmark>
@@ -41,6 +42,7 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include <KMessageBox>
 
 #include "kdenlive_debug.h"
+#include <QBuffer>
 #include <QCryptographicHash>
 #include <QDomImplementation>
 #include <QFile>
@@ -170,6 +172,29 @@ DocOpenResult KdenliveDoc::Open(const QUrl &url, const QString &projectFolder, Q
         return result;
     }
 
+    // Read the root element in streaming mode before building the DOM, so that we can reject non project files early
+    // and relocate archived projects without a second DOM parse
+    QBuffer relocatedDocument;
+    QIODevice *source = &file;
+    const Xml::StreamInfo streamInfo = Xml::scanDocument(&file, true);
+    file.seek(0);
+    if (streamInfo.valid) {
+        if (streamInfo.rootTag != QLatin1String("mlt")) {
+            result.setError(i18n("File %1 is not a Kdenlive project file", url.toLocalFile()));
+            return result;
+        }
+        if (streamInfo.rootAttributes.value(QStringLiteral("root")) == QLatin1String("$CURRENTPATH")) {
+            // The document was extracted from a Kdenlive archived project, fix root directory
+            relocatedDocument.open(QIODevice::ReadWrite);
+            if (Xml::streamReplace(&file, &relocatedDocument, QStringLiteral("$CURRENTPATH"),
+                                   url.adjusted(QUrl::RemoveFilename | QUrl::StripTrailingSlash).toLocalFile())) {
+                relocatedDocument.seek(0);
+                source = &relocatedDocument;
+            }
+            file.seek(0);
+        }
+    }
+
     QDomDocument domDoc{};
     QString domErrorMessage;
     if (recoverCorruption) {
@@ -178,14 +203,18 @@ DocOpenResult KdenliveDoc::Open(const QUrl &url, const QString &projectFolder, Q
         QDomImplementation::setInvalidDataPolicy(QDomImplementation::DropInvalidChars);
         result.setModified(true);
     }
-    QDomDocument::ParseResult parseResult = domDoc.setContent(&file);
+    QDomDocument::ParseResult parseResult = domDoc.setContent(source);
     //, false, &domErrorMessage, &line, &col);
 
     if (!parseResult) {
         if (recoverCorruption) {
             // Try to recover broken file produced by Kdenlive 0.9.4
             int correction = 0;
-            QString playlist = QString::fromUtf8(file.readAll());
+            source->seek(0);
+            QString playlist = QString::fromUtf8(source->readAll());
+            if (source == &file && streamInfo.rootAttributes.value(QStringLiteral("root")) == QLatin1String("$CURRENTPATH")) {
+                playlist.replace(QLatin1String("$CURRENTPATH"), url.adjusted(QUrl::RemoveFilename | QUrl::StripTrailingSlash).toLocalFile());
+            }
             while (!parseResult && correction < 2) {
                 int errorPos = 0;
                 int line = parseResult.errorLine;
@@ -569,7 +598,7 @@ bool KdenliveDoc::autoGenerateImageProxy(int width) const
            (width < 0 || width > m_documentProperties.value(QStringLiteral("proxyimageminsize")).toInt());
 }
 
-void KdenliveDoc::slotAutoSave(const QString &scene)
+void KdenliveDoc::slotAutoSave(QIODevice *scene, const QMap<QString, QString> &replacements)
 {
     if (m_autosave != nullptr) {
         if (!m_autosave->isOpen() && !m_autosave->open(QIODevice::ReadWrite)) {
@@ -578,13 +607,8 @@ void KdenliveDoc::slotAutoSave(const QString &scene)
             pCore->displayMessage(i18n("Cannot create autosave file %1", m_autosave->fileName()), ErrorMessage);
             return;
         }
-        if (scene.isEmpty()) {
-            // Make sure we don't save if scenelist is corrupted
-            KMessageBox::error(QApplication::activeWindow(), i18n("Cannot write to file %1, scene list is corrupted.", m_autosave->fileName()));
-            return;
-        }
         m_autosave->resize(0);
-        if (m_autosave->write(scene.toUtf8()) < 0) {
+        if (!Xml::streamSceneList(scene, m_autosave, replacements)) {
             pCore->displayMessage(i18n("Cannot create autosave file %1", m_autosave->fileName()), ErrorMessage);
         }
         m_autosave->flush();
@@ -633,90 +657,17 @@ QPair<int, int> KdenliveDoc::targetTracks(const QUuid &uuid) const
     return {getSequenceProperty(uuid, QStringLiteral("videoTarget")).toInt(), getSequenceProperty(uuid, QStringLiteral("audioTarget")).toInt()};
 }
 
-QDomDocument KdenliveDoc::xmlSceneList(const QString &scene)
+bool KdenliveDoc::checkSceneList(QIODevice *scene)
 {
-    QDomDocument sceneList;
-    sceneList.setContent(scene);
-    QDomElement mlt = sceneList.firstChildElement(QStringLiteral("mlt"));
-    if (mlt.isNull() || !mlt.hasChildNodes()) {
-        // scenelist is corrupted
-        return QDomDocument();
-    }
-
-    // Set playlist audio volume to 100%
-    QDomNodeList tractors = mlt.elementsByTagName(QStringLiteral("tractor"));
-    for (int i = 0; i < tractors.count(); ++i) {
-        if (tractors.at(i).toElement().hasAttribute(QStringLiteral("global_feed"))) {
-            // This is our main tractor
-            QDomElement tractor = tractors.at(i).toElement();
-            if (Xml::hasXmlProperty(tractor, QLatin1String("meta.volume"))) {
-                Xml::setXmlProperty(tractor, QStringLiteral("meta.volume"), QStringLiteral("1"));
-            }
-            break;
-        }
-    }
-    QDomNodeList tracks = mlt.elementsByTagName(QStringLiteral("track"));
-    if (tracks.isEmpty()) {
-        // Something is very wrong, inform user.
-        qDebug() << " = = = =  = =  CORRUPTED DOC\n" << scene;
-        return QDomDocument();
-    }
-
-    QDomNodeList pls = mlt.elementsByTagName(QStringLiteral("playlist"));
-    QDomElement mainPlaylist;
-    for (int i = 0; i < pls.count(); ++i) {
-        if (pls.at(i).toElement().attribute(QStringLiteral("id")) == BinPlaylist::binPlaylistId) {
-            mainPlaylist = pls.at(i).toElement();
-            break;
-        }
-    }
-
-    // check if project contains custom effects to embed them in project file
-    QDomNodeList effects = mlt.elementsByTagName(QStringLiteral("filter"));
-    int maxEffects = effects.count();
-    // qCDebug(KDENLIVE_LOG) << "// FOUD " << maxEffects << " EFFECTS+++++++++++++++++++++";
-    QMap<QString, QString> effectIds;
-    for (int i = 0; i < maxEffects; ++i) {
-        QDomNode m = effects.at(i);
-        QDomNodeList params = m.childNodes();
-        QString id;
-        QString tag;
-        for (int j = 0; j < params.count(); ++j) {
-            QDomElement e = params.item(j).toElement();
-            if (e.attribute(QStringLiteral("name")) == QLatin1String("kdenlive_id")) {
-                id = e.firstChild().nodeValue();
-            }
-            if (e.attribute(QStringLiteral("name")) == QLatin1String("tag")) {
-                tag = e.firstChild().nodeValue();
-            }
-            if (!id.isEmpty() && !tag.isEmpty()) {
-                effectIds.insert(id, tag);
-            }
-        }
-    }
-    // TODO: find a way to process this before rendering MLT scenelist to xml
-    /*QDomDocument customeffects = initEffects::getUsedCustomEffects(effectIds);
-    if (!customeffects.documentElement().childNodes().isEmpty()) {
-        Xml::setXmlProperty(mainPlaylist, QStringLiteral("kdenlive:customeffects"), customeffects.toString());
-    }*/
-    // addedXml.appendChild(sceneList.importNode(customeffects.documentElement(), true));
-
-    // TODO: move metadata to previous step in saving process
-    QDomElement docmetadata = sceneList.createElement(QStringLiteral("documentmetadata"));
-    QMapIterator<QString, QString> j(m_documentMetadata);
-    while (j.hasNext()) {
-        j.next();
-        docmetadata.setAttribute(j.key(), j.value());
-    }
-    // addedXml.appendChild(docmetadata);
-
-    return sceneList;
+    const Xml::StreamInfo info = Xml::scanDocument(scene);
+    scene->seek(0);
+    // In some unexplained cases, the MLT playlist is corrupted and all tracks are deleted
+    return info.valid && info.rootTag == QLatin1String("mlt") && info.tagCount.value(QStringLiteral("track")) > 0;
 }
 
-bool KdenliveDoc::saveSceneList(const QString &path, const QString &scene, bool saveOverExistingFile)
+bool KdenliveDoc::saveSceneList(const QString &path, QIODevice *scene, const QMap<QString, QString> &replacements, bool saveOverExistingFile)
 {
-    QDomDocument sceneList = xmlSceneList(scene);
-    if (sceneList.isNull()) {
+    if (!checkSceneList(scene)) {
         // Make sure we don't save if scenelist is corrupted
         KMessageBox::error(QApplication::activeWindow(), i18n("Cannot write to file %1, scene list is corrupted.", path));
         return false;
@@ -761,9 +712,9 @@ bool KdenliveDoc::saveSceneList(const QString &path, const QString &scene, bool
         return false;
     }
 
-    const QByteArray sceneData = sceneList.toString().toUtf8();
-
-    file.write(sceneData);
+    if (!Xml::streamSceneList(scene, &file, replacements)) {
+        file.cancelWriting();
+    }
     if (!file.commit()) {
         KMessageBox::error(QApplication::activeWindow(), i18n("Cannot write to file %1", path));
         return false;
@@ -893,6 +844,7 @@ void KdenliveDoc::setProjectFolder(const QUrl &url)
     /*if (KMessageBox::questionYesNo(QApplication::activeWindow(), i18n("You have changed the project folder. Do you want to copy the cached data from %1 to the
      * new folder %2?", m_projectFolder, url.path())) == KMessageBox::Yes) moveProjectData(url);*/
     m_projectFolder = url.toLocalFile();
+    initCacheDirs();
 
     updateProjectFolderPlacesEntry();
 }
@@ -978,6 +930,8 @@ void KdenliveDoc::setUrl(const QUrl &url)
 
 QStringList KdenliveDoc::getAllSubtitlesPath(bool final)
 {
+    // Make sure the work files match the subtitle models before their paths are used
+    flushSubtitleFiles();
     QStringList result;
     QMapIterator<QUuid, std::shared_ptr<TimelineItemModel>> j(m_timelines);
     while (j.hasNext()) {
@@ -994,6 +948,15 @@ QStringList KdenliveDoc::getAllSubtitlesPath(bool final)
     return result;
 }
 
+void KdenliveDoc::flushSubtitleFiles()
+{
+    for (const auto &timeline : std::as_const(m_timelines)) {
+        if (timeline->hasSubtitleModel()) {
+            timeline->getSubtitleModel()->flushSubtitleFile();
+        }
+    }
+}
+
 void KdenliveDoc::prepareRenderAssets(const QDir &destFolder)
 {
     // Copy current subtitles to assets render folder
@@ -1648,13 +1611,7 @@ void KdenliveDoc::slotProxyCurrentItem(bool doProxy, QList<std::shared_ptr<Proje
         qDebug() << "::::: CANNOT GET CACHE DIR!!!!";
         return;
     }
-    QString extension = getDocumentProperty(QStringLiteral("proxyextension"));
-    if (extension.isEmpty()) {
-        if (m_proxyExtension.isEmpty()) {
-            initProxySettings();
-        }
-        extension = m_proxyExtension;
-    }
+    QString extension = proxyExtension();
     extension.prepend(QLatin1Char('.'));
 
     // Prepare updated properties
@@ -1752,7 +1709,7 @@ void KdenliveDoc::slotProxyCurrentItem(bool doProxy, QList<std::shared_ptr<Proje
     }
 }
 
-double KdenliveDoc::getDocumentVersion() const
+double KdenliveDoc::getDocumentVersion()
 {
     return DOCUMENTVERSION;
 }
@@ -2149,6 +2106,18 @@ QString KdenliveDoc::getAutoProxyProfile()
     return m_proxyParams;
 }
 
+QString KdenliveDoc::proxyExtension()
+{
+    QString extension = getDocumentProperty(QStringLiteral("proxyextension"));
+    if (extension.isEmpty()) {
+        if (m_proxyExtension.isEmpty()) {
+            initProxySettings();
+        }
+        extension = m_proxyExtension;
+    }
+    return extension;
+}
+
 void KdenliveDoc::initProxySettings()
 {
     // Read preview profiles and find the best match
@@ -2199,6 +2168,9 @@ void KdenliveDoc::initCacheDirs()
     dir.mkdir(QStringLiteral("videothumbs"));
     QDir cacheDir(kdenliveCacheDir);
     cacheDir.mkdir(QStringLiteral("proxy"));
+    // The cached data of the open project must not be deleted to meet the cache quotas
+    CacheManager::get()->addRoot(kdenliveCacheDir);
+    CacheManager::get()->recordAccess(basePath);
 }
 
 const QDir KdenliveDoc::getCacheDir(CacheType type, bool *ok, const QUuid uuid) const
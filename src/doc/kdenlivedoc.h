@@ -40,6 +40,7 @@ class MarkerSortModel;
 
 class QUndoGroup;
 class QUndoCommand;
+class QIODevice;
 class DocUndoStack;
 
 namespace Mlt {
@@ -161,10 +162,12 @@ public:
     void setZoom(const QUuid &uuid, int horizontal, int vertical = -1);
     QPoint zoom(const QUuid &uuid) const;
     double dar() const;
-    /** @brief Returns the project file xml. */
-    QDomDocument xmlSceneList(const QString &scene);
-    /** @brief Saves the project file xml to a file. */
-    bool saveSceneList(const QString &path, const QString &scene, bool saveOverExistingFile = true);
+    /** @brief Returns true if the MLT xml read from @param scene has tracks and can be saved as a project file. The device is rewound. */
+    static bool checkSceneList(QIODevice *scene);
+    /** @brief Saves the project file xml read from @param scene to a file, in a single streaming pass.
+     *  @param replacements the paths to replace, see Xml::streamSceneList() */
+    bool saveSceneList(const QString &path, QIODevice *scene, const QMap<QString, QString> &replacements = QMap<QString, QString>(),
+                       bool saveOverExistingFile = true);
     void setProjectFolder(const QUrl &url);
     void setZone(const QUuid &uuid, int start, int end);
     QPoint zone(const QUuid &uuid) const;
@@ -255,6 +258,8 @@ public:
     bool updatePreviewSettings(const QString &profile);
     /** @brief Returns the recommended proxy profile parameters */
     QString getAutoProxyProfile();
+    /** @brief Returns the file extension of proxy clips, without the dot */
+    QString proxyExtension();
     /** @brief Returns the number of clips in this project (useful to show loading progress) */
     int clipsCount() const;
     int updateClipsCount();
@@ -286,10 +291,12 @@ public:
     const QString subTitlePath(const QUuid &uuid, int ix, bool final, bool restoreFromBackup = false);
     /** @brief Returns the list of all used subtitles paths. */
     QStringList getAllSubtitlesPath(bool final);
+    /** @brief Write the pending subtitle edits of all timelines to their work files. */
+    void flushSubtitleFiles();
     /** @brief Creates a new project. */
     QDomDocument createEmptyDocument(int videotracks, int audiotracks, bool disableProfile = true);
     /** @brief Return the document version. */
-    double getDocumentVersion() const;
+    static double getDocumentVersion();
 
     /** @brief Returns true if this project has subtitles. */
     bool hasSubtitles() const;
@@ -420,8 +427,9 @@ public Q_SLOTS:
                               QUndoCommand *masterCommand = nullptr);
     /** @brief Saves the current project at the autosave location.
      *
-     * The autosave files are in ~/.kde/data/stalefiles/kdenlive/ */
-    void slotAutoSave(const QString &scene);
+     * The autosave files are in ~/.kde/data/stalefiles/kdenlive/
+     * @param scene the MLT xml, already validated with checkSceneList() */
+    void slotAutoSave(QIODevice *scene, const QMap<QString, QString> &replacements);
     void switchProfile(ProfileParam* pf, const QString &clipName);
 
 private Q_SLOTS:
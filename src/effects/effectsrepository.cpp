@@ -55,13 +55,8 @@ Mlt::Properties *EffectsRepository::getMetadata(const QString &effectId) const
     return pCore->getMltRepository()->metadata(mlt_service_filter_type, effectId.toLatin1().data());
 }
 
-void EffectsRepository::parseCustomAssetFile(const QString &file_name, std::unordered_map<QString, Info> &customAssets) const
+void EffectsRepository::parseCustomAssetDocument(QDomDocument &doc, const QString &file_name, std::unordered_map<QString, Info> &customAssets) const
 {
-    QDomDocument doc;
-    if (!Xml::docContentFromFile(doc, file_name, false)) {
-        return;
-    }
-
     QDomElement base = doc.documentElement();
     if (base.tagName() == QLatin1String("effectgroup")) {
         QDomNodeList effects = base.elementsByTagName(QStringLiteral("effect"));
@@ -190,6 +185,11 @@ void EffectsRepository::parseCustomAssetFile(const QString &file_name, std::unor
     }
 }
 
+QString EffectsRepository::assetCacheName() const
+{
+    return QStringLiteral("effects");
+}
+
 std::unique_ptr<EffectsRepository> &EffectsRepository::get()
 {
     std::call_once(m_onceFlag, [] { instance.reset(new EffectsRepository()); });
@@ -54,7 +54,9 @@ protected:
     /** @brief Retrieves additional info about effects from a custom XML file
        The resulting assets are stored in customAssets
     */
-    void parseCustomAssetFile(const QString &file_name, std::unordered_map<QString, Info> &customAssets) const override;
+    void parseCustomAssetDocument(QDomDocument &doc, const QString &file_name, std::unordered_map<QString, Info> &customAssets) const override;
+
+    QString assetCacheName() const override;
 
     /** @brief Returns the path to the effects that will be displayed*/
     QStringList assetIncludedPath() const override;
@@ -189,8 +189,10 @@ void EffectStackModel::removeEffect(const std::shared_ptr<EffectItemModel> &effe
     Fun undo = []() { return true; };
     Fun redo = []() { return true; };
     QString effectName;
+    // The undo lambda keeps the removed effect
+    const qint64 cost = effect->memoryCost();
     removeEffectWithUndo(effect, effectName, undo, redo);
-    PUSH_UNDO(undo, redo, i18n("Delete effect %1", effectName));
+    PUSH_UNDO_WITH_COST(undo, redo, i18n("Delete effect %1", effectName), cost);
 }
 
 void EffectStackModel::removeEffectWithUndo(const QString &assetId, QString &effectName, int assetRow, Fun &undo, Fun &redo)
@@ -290,9 +292,10 @@ bool EffectStackModel::copyXmlEffect(const QDomElement &effect)
 {
     std::function<bool(void)> undo = []() { return true; };
     std::function<bool(void)> redo = []() { return true; };
+    const int firstRow = rowCount();
     bool result = fromXml(effect, undo, redo);
     if (result) {
-        PUSH_UNDO(undo, redo, i18n("Copy effect"));
+        PUSH_UNDO_WITH_COST(undo, redo, i18n("Copy effect"), memoryCost(firstRow));
     }
     return result;
 }
@@ -643,9 +646,10 @@ bool EffectStackModel::copyEffect(const std::shared_ptr<AbstractEffectItem> &sou
 {
     Fun undo = []() { return true; };
     Fun redo = []() { return true; };
+    const int firstRow = rowCount();
     bool res = copyEffectWithUndo(sourceItem, state, undo, redo);
     if (res && logUndo) {
-        pCore->pushUndo(undo, redo, i18n("Paste effect"));
+        pCore->pushUndo(undo, redo, i18n("Paste effect"), memoryCost(firstRow));
     }
     return res;
 }
@@ -659,9 +663,10 @@ bool EffectStackModel::appendEffect(const QString &effectId, bool makeCurrent, s
 {
     Fun undo = []() { return true; };
     Fun redo = []() { return true; };
+    const int firstRow = rowCount();
     bool result = doAppendEffect(effectId, makeCurrent, params, undo, redo).first;
     if (result) {
-        PUSH_UNDO(undo, redo, i18n("Add effect %1", EffectsRepository::get()->getName(effectId)));
+        PUSH_UNDO_WITH_COST(undo, redo, i18n("Add effect %1", EffectsRepository::get()->getName(effectId)), memoryCost(firstRow));
     }
     return result;
 }
@@ -1721,6 +1726,20 @@ bool EffectStackModel::hasFilter(const QString &effectId) const
     });
 }
 
+bool EffectStackModel::hasKeyframes() const
+{
+    READ_LOCK();
+    return rootItem->accumulate_const(false, [](bool b, std::shared_ptr<const TreeItem> it) {
+        if (b) return true;
+        auto item = std::static_pointer_cast<const AbstractEffectItem>(it);
+        if (item->effectItemType() == EffectItemType::Group) {
+            return false;
+        }
+        auto sourceEffect = std::static_pointer_cast<const EffectItemModel>(it);
+        return sourceEffect->hasMoreThanOneKeyframe();
+    });
+}
+
 double EffectStackModel::getFilterParam(const QString &effectId, const QString &paramName)
 {
     READ_LOCK();
@@ -1843,6 +1862,16 @@ bool EffectStackModel::hasBuiltInEffect(const QString effectId) const
     return false;
 }
 
+qint64 EffectStackModel::memoryCost(int firstRow) const
+{
+    READ_LOCK();
+    qint64 cost = 0;
+    for (int i = qMax(0, firstRow); i < rootItem->childCount(); ++i) {
+        cost += std::static_pointer_cast<EffectItemModel>(rootItem->child(i))->memoryCost();
+    }
+    return cost;
+}
+
 QStringList EffectStackModel::externalFiles() const
 {
     QStringList urls;
@@ -90,6 +90,8 @@ public:
 
     /** @brief Returns true if the stack contains an effect with the given Id */
     Q_INVOKABLE bool hasFilter(const QString &effectId) const;
+    /** @brief Returns true if an effect of the stack is animated (has more than one keyframe) */
+    bool hasKeyframes() const;
     // TODO: this break the encapsulation, remove
     Q_INVOKABLE double getFilterParam(const QString &effectId, const QString &paramName);
     /** @brief get the active effect's keyframe model */
@@ -125,6 +127,8 @@ public:
 
     /** @brief Returns a list of external file urls used by the effects (e.g. LUTs) */
     QStringList externalFiles() const;
+    /** @brief Returns the size in bytes of the parameters of the effects starting at @param firstRow */
+    qint64 memoryCost(int firstRow = 0) const;
 
     bool isStackEnabled() const;
     int getFadeMethod(bool fromStart);
@@ -11,6 +11,7 @@
 #include "bin/projectitemmodel.h"
 #include "core.h"
 #include "kdenlivesettings.h"
+#include "utils/tracing.h"
 
 #ifdef Q_OS_UNIX
 // on Unix systems we can use setpriority() to make proxy-rendering tasks lower
@@ -128,6 +129,50 @@ void AbstractTask::setPreferredPriority(qint64 pid)
 #endif
 }
 
+namespace {
+const char *jobTypeName(AbstractTask::JOBTYPE type)
+{
+    switch (type) {
+    case AbstractTask::PROXYJOB:
+        return "ProxyTask";
+    case AbstractTask::CUTJOB:
+        return "CutTask";
+    case AbstractTask::STABILIZEJOB:
+        return "StabilizeTask";
+    case AbstractTask::TRANSCODEJOB:
+        return "TranscodeTask";
+    case AbstractTask::FILTERCLIPJOB:
+        return "FilterTask";
+    case AbstractTask::THUMBJOB:
+        return "ThumbnailTask";
+    case AbstractTask::ANALYSECLIPJOB:
+        return "AnalyseTask";
+    case AbstractTask::LOADJOB:
+        return "ClipLoadTask";
+    case AbstractTask::AUDIOTHUMBJOB:
+        return "AudioLevelsTask";
+    case AbstractTask::SPEEDJOB:
+        return "SpeedTask";
+    case AbstractTask::CACHEJOB:
+        return "CacheTask";
+    case AbstractTask::KEYFRAMESJOB:
+        return "KeyframesTask";
+    default:
+        return "Task";
+    }
+}
+} // namespace
+
+AbstractTaskDone::AbstractTaskDone(int cid, AbstractTask *task)
+    : m_cid(cid)
+    , m_task(task)
+    , m_traceStart(Tracing::isEnabled() ? Tracing::timestamp() : -1)
+{
+}
+
 AbstractTaskDone::~AbstractTaskDone() {
+    if (m_traceStart >= 0) {
+        Tracing::completeSpan("job", jobTypeName(m_task->m_type), m_traceStart);
+    }
     pCore->taskManager.taskDone(m_cid, m_task);
 }
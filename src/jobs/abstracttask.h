@@ -18,6 +18,7 @@ class AbstractTask : public QObject, public QRunnable
 {
     Q_OBJECT
     friend class TaskManager;
+    friend class AbstractTaskDone;
 
 public:
     enum JOBTYPE {
@@ -32,7 +33,8 @@ public:
         LOADJOB = 8,
         AUDIOTHUMBJOB = 9,
         SPEEDJOB = 10,
-        CACHEJOB = 11
+        CACHEJOB = 11,
+        KEYFRAMESJOB = 12
     };
     AbstractTask(const ObjectId &owner, JOBTYPE type, QObject* object);
     ~AbstractTask() override;
@@ -69,14 +71,14 @@ Q_SIGNALS:
 
 /**
  * @brief When destroyed, notifies the taskManager that this task is done.
+ * The task execution is also recorded as a span when tracing is enabled.
  */
 class AbstractTaskDone {
 public:
-    AbstractTaskDone(int cid, AbstractTask *task)
-        : m_cid(cid)
-        , m_task(task) {}
+    AbstractTaskDone(int cid, AbstractTask *task);
     ~AbstractTaskDone();
 private:
     int m_cid;
     AbstractTask *m_task;
+    qint64 m_traceStart;
 };
@@ -6,14 +6,15 @@
 */
 
 #include "audiolevelstask.h"
+#include "audio/audioLevels.h"
 #include "audio/audioStreamInfo.h"
 #include "bin/projectclip.h"
 #include "bin/projectitemmodel.h"
 #include "core.h"
+#include "utils/cachemanager.h"
 
 #include <KLocalizedString>
 #include <KMessageWidget>
-#include <QElapsedTimer>
 #include <QFile>
 #include <QImage>
 #include <QList>
@@ -24,9 +25,9 @@
 #include <QTime>
 #include <QVariantList>
 
-static void deleteQVariantList(QVector<uint8_t> *list)
+static void deleteAudioLevels(std::shared_ptr<AudioLevels> *levels)
 {
-    delete list;
+    delete levels;
 }
 
 AudioLevelsTask::AudioLevelsTask(const ObjectId &owner, QObject *object)
@@ -48,6 +49,24 @@ void AudioLevelsTask::start(const ObjectId &owner, QObject *object, bool force)
     pCore->taskManager.startTask(owner.itemId, task);
 }
 
+void AudioLevelsTask::publishLevels(const std::shared_ptr<ProjectClip> &binClip, int stream, const std::shared_ptr<AudioLevels> &levels)
+{
+    std::shared_ptr<Mlt::Producer> producer = binClip->originalProducer();
+    producer->lock();
+    const QString key = QStringLiteral("_kdenlive:audio%1").arg(stream);
+    producer->set(key.toUtf8().constData(), new std::shared_ptr<AudioLevels>(levels), 0, (mlt_destructor)deleteAudioLevels);
+    producer->unlock();
+}
+
+void AudioLevelsTask::unpublishLevels(const std::shared_ptr<ProjectClip> &binClip, int stream)
+{
+    std::shared_ptr<Mlt::Producer> producer = binClip->originalProducer();
+    producer->lock();
+    const QString key = QStringLiteral("_kdenlive:audio%1").arg(stream);
+    producer->set(key.toUtf8().constData(), nullptr, 0);
+    producer->unlock();
+}
+
 void AudioLevelsTask::run()
 {
     AbstractTaskDone whenFinished(m_owner.itemId, this);
@@ -109,28 +128,24 @@ void AudioLevelsTask::run()
         streamIndex++;
         // Generate one thumb per stream
         const QString cachePath = binClip->getAudioThumbPath(stream);
-        QVector<uint8_t> mltLevels;
         if (!m_isForce && QFile::exists(cachePath)) {
             // Audio thumb already exists
             QImage image(cachePath);
             if (!m_isCanceled && !image.isNull()) {
                 // convert cached image
+                auto levels = std::make_shared<AudioLevels>(channels);
                 int n = image.width() * image.height();
                 for (int i = 0; n > 1 && i < n; i++) {
                     QRgb p = image.pixel(i / channels, i % channels);
-                    mltLevels << qRed(p);
-                    mltLevels << qGreen(p);
-                    mltLevels << qBlue(p);
-                    mltLevels << qAlpha(p);
+                    levels->append(uint8_t(qRed(p)));
+                    levels->append(uint8_t(qGreen(p)));
+                    levels->append(uint8_t(qBlue(p)));
+                    levels->append(uint8_t(qAlpha(p)));
                 }
-                if (mltLevels.size() > 0) {
-                    QVector<uint8_t> *levelsCopy = new QVector<uint8_t>(mltLevels);
-                    producer = binClip->originalProducer();
-                    producer->lock();
-                    QString key = QStringLiteral("_kdenlive:audio%1").arg(stream);
-                    producer->set(key.toUtf8().constData(), levelsCopy, 0, (mlt_destructor)deleteQVariantList);
-                    producer->unlock();
-                    producer.reset();
+                levels->finish();
+                if (levels->count() > 0) {
+                    publishLevels(binClip, stream, levels);
+                    QMetaObject::invokeMethod(m_object, "updateAudioLevels", Q_ARG(int, stream), Q_ARG(int, 0), Q_ARG(int, levels->count()));
                     continue;
                 }
             }
@@ -163,9 +178,17 @@ void AudioLevelsTask::run()
         for (int i = 0; i < channels; i++) {
             keys << "meta.media.audio_level." + QString::number(i);
         }
-        uint maxLevel = 1;
-        QElapsedTimer updateTime;
-        updateTime.start();
+        // The levels are published to the clip when generation starts, waveforms are then notified of each completed block
+        auto audioLevels = std::make_shared<AudioLevels>(channels);
+        publishLevels(binClip, stream, audioLevels);
+        QVector<uint8_t> lastLevels(channels, 0);
+        bool hasLevels = false;
+        auto appendLevel = [this, &audioLevels, stream](uint8_t level) {
+            if (audioLevels->append(level)) {
+                const int count = audioLevels->count();
+                QMetaObject::invokeMethod(m_object, "updateAudioLevels", Q_ARG(int, stream), Q_ARG(int, count - AudioLevels::BlockSize), Q_ARG(int, count));
+            }
+        };
         for (int z = 0; z < lengthInFrames && !m_isCanceled; ++z) {
             int val = int(100.0 * z / lengthInFrames);
             if (m_progress != val) {
@@ -177,72 +200,65 @@ void AudioLevelsTask::run()
                 int samples = mlt_audio_calculate_frame_samples(float(framesPerSecond), frequency, z);
                 mltFrame->get_audio(audioFormat, frequency, channels, samples);
                 for (int channel = 0; channel < channels; ++channel) {
-                    uint lev = 256 * qMin(mltFrame->get_double(keys.at(channel).toUtf8().constData()) * 0.9, 1.0);
-                    mltLevels << lev;
-                    // double lev = mltFrame->get_double(keys.at(channel).toUtf8().constData());
-                    // mltLevels << lev;
-                    maxLevel = qMax(lev, maxLevel);
+                    uint8_t lev = uint8_t(256 * qMin(mltFrame->get_double(keys.at(channel).toUtf8().constData()) * 0.9, 1.0));
+                    lastLevels[channel] = lev;
+                    appendLevel(lev);
                 }
-            } else if (!mltLevels.isEmpty()) {
+                hasLevels = true;
+            } else if (hasLevels) {
                 for (int channel = 0; channel < channels; channel++) {
-                    mltLevels << mltLevels.last();
+                    appendLevel(lastLevels.at(channel));
                 }
             }
-            // Incrementally update the audio levels every 3 seconds.
-            if (updateTime.elapsed() > 3000 && !m_isCanceled) {
-                updateTime.restart();
-                QVector<uint8_t> *levelsCopy = new QVector<uint8_t>(mltLevels);
-                producer = binClip->originalProducer();
-                producer->lock();
-                QString key = QStringLiteral("_kdenlive:audio%1").arg(stream);
-                producer->set(key.toUtf8().constData(), levelsCopy, 0, (mlt_destructor)deleteQVariantList);
-                producer->unlock();
-                producer.reset();
-                QMetaObject::invokeMethod(m_object, "updateAudioThumbnail", Q_ARG(bool, false));
-            }
         }
 
-        /*// Normalize
-        for (double &v : mltLevels) {
-            m_audioLevels << uchar(255 * v / maxLevel);
-        }*/
         if (m_isCanceled) {
-            mltLevels.clear();
+            // Partial levels must not stay attached to the clip, waveforms then redraw without them
+            const int published = audioLevels->count();
+            unpublishLevels(binClip, stream);
+            if (published > 0) {
+                QMetaObject::invokeMethod(m_object, "updateAudioLevels", Q_ARG(int, stream), Q_ARG(int, 0), Q_ARG(int, published));
+            }
             m_progress = 100;
             QMetaObject::invokeMethod(m_object, "updateJobProgress");
+            continue;
+        }
+        const int published = audioLevels->count();
+        audioLevels->finish();
+        const AudioLevels::Snapshot snapshot = audioLevels->snapshot();
+        if (snapshot.count() > published) {
+            QMetaObject::invokeMethod(m_object, "updateAudioLevels", Q_ARG(int, stream), Q_ARG(int, published), Q_ARG(int, snapshot.count()));
         }
-        if (mltLevels.size() > 0) {
-            QVector<uint8_t> *levelsCopy = new QVector<uint8_t>(mltLevels);
+        if (!snapshot.isEmpty()) {
             producer = binClip->originalProducer();
             producer->lock();
-            QString key = QStringLiteral("_kdenlive:audio%1").arg(stream);
             QString key2 = QStringLiteral("kdenlive:audio_max%1").arg(stream);
-            producer->set(key2.toUtf8().constData(), int(maxLevel));
-            producer->set(key.toUtf8().constData(), levelsCopy, 0, (mlt_destructor)deleteQVariantList);
+            producer->set(key2.toUtf8().constData(), qMax(1, int(audioLevels->maxLevel())));
             producer->unlock();
             producer.reset();
-            // qDebug()<<"=== FINISHED PRODUCING AUDIO FOR: "<<key<<", SIZE: "<<levelsCopy->size();
             m_progress = 100;
             QMetaObject::invokeMethod(m_object, "updateJobProgress");
             // Put into an image for caching.
-            int count = mltLevels.size();
+            int count = snapshot.count();
             QImage image((count + 3) / 4 / channels, channels, QImage::Format_ARGB32);
             int n = image.width() * image.height();
+            const int last = snapshot.at(count - 1);
             for (int i = 0; i < n; i++) {
                 QRgb p;
                 if ((4 * i + 3) < count) {
-                    p = qRgba(mltLevels.at(4 * i), mltLevels.at(4 * i + 1), mltLevels.at(4 * i + 2), mltLevels.at(4 * i + 3));
+                    p = qRgba(snapshot.at(4 * i), snapshot.at(4 * i + 1), snapshot.at(4 * i + 2), snapshot.at(4 * i + 3));
                 } else {
-                    int last = mltLevels.last();
-                    int r = (4 * i + 0) < count ? mltLevels.at(4 * i + 0) : last;
-                    int g = (4 * i + 1) < count ? mltLevels.at(4 * i + 1) : last;
-                    int b = (4 * i + 2) < count ? mltLevels.at(4 * i + 2) : last;
+                    int r = (4 * i + 0) < count ? snapshot.at(4 * i + 0) : last;
+                    int g = (4 * i + 1) < count ? snapshot.at(4 * i + 1) : last;
+                    int b = (4 * i + 2) < count ? snapshot.at(4 * i + 2) : last;
                     int a = last;
                     p = qRgba(r, g, b, a);
                 }
                 image.setPixel(i / channels, i % channels, p);
             }
-            image.save(cachePath);
+            if (image.save(cachePath)) {
+                CacheManager::get()->recordWrite(cachePath);
+            }
             audioCreated = true;
             QMetaObject::invokeMethod(m_object, "updateAudioThumbnail", Q_ARG(bool, false));
         }
@@ -13,6 +13,9 @@
 #include <QRunnable>
 #include <QObject>
 
+class AudioLevels;
+class ProjectClip;
+
 class AudioLevelsTask : public AbstractTask
 {
 public:
@@ -22,4 +25,10 @@ public:
 protected:
     void run() override;
 
+private:
+    /** @brief Attach the levels of @param stream to the clip, where waveforms read them */
+    static void publishLevels(const std::shared_ptr<ProjectClip> &binClip, int stream, const std::shared_ptr<AudioLevels> &levels);
+    /** @brief Detach the levels of @param stream from the clip, so that a later task regenerates them */
+    static void unpublishLevels(const std::shared_ptr<ProjectClip> &binClip, int stream);
+
 };
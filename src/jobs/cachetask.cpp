@@ -52,6 +52,7 @@ void CacheTask::generateThumbnail(std::shared_ptr<ProjectClip> binClip)
     // Fetch thumbnail
     if (binClip->clipType() != ClipType::Audio) {
         std::unique_ptr<Mlt::Producer> thumbProd(nullptr);
+        bool keyframes = false;
         int duration = m_out > 0 ? m_out - m_in : binClip->getFramePlaytime();
         std::set<int> frames;
         int steps = qCeil(qMax(pCore->getCurrentFps(), double(duration) / m_thumbsCount));
@@ -73,17 +74,23 @@ void CacheTask::generateThumbnail(std::shared_ptr<ProjectClip> binClip)
             if (m_isCanceled || pCore->taskManager.isBlocked()) {
                 break;
             }
-            if (ThumbnailCache::get()->hasThumbnail(clipId, i)) {
+            if (ThumbnailCache::get()->hasKeyframeThumbnail(clipId, i)) {
                 continue;
             }
             if (thumbProd == nullptr) {
-                thumbProd = binClip->getThumbProducer();
+                // These thumbnails are only used to preview the clip content, decode the keyframe before each position instead of exact frames
+                thumbProd = binClip->getKeyframeThumbProducer();
+                keyframes = thumbProd != nullptr;
+                if (!keyframes) {
+                    thumbProd = binClip->getThumbProducer();
+                }
             }
             if (thumbProd == nullptr) {
                 // Thumb producer not available
                 break;
             }
-            thumbProd->seek(i);
+            const int keyframe = keyframes ? binClip->keyframeBefore(i) : -1;
+            thumbProd->seek(keyframe >= 0 ? keyframe : i);
             QScopedPointer<Mlt::Frame> frame(thumbProd->get_frame());
             if (frame != nullptr && frame->is_valid()) {
                 frame->set("consumer.deinterlacer", "onefield");
@@ -92,7 +99,11 @@ void CacheTask::generateThumbnail(std::shared_ptr<ProjectClip> binClip)
                 QImage result = KThumb::getFrame(frame.data(), 0, 0, m_fullWidth);
                 if (!result.isNull() && !m_isCanceled) {
                     qDebug() << "==== CACHING FRAME: " << i;
-                    ThumbnailCache::get()->storeThumbnail(clipId, i, result, true);
+                    if (keyframes) {
+                        ThumbnailCache::get()->storeKeyframeThumbnail(clipId, i, result, true);
+                    } else {
+                        ThumbnailCache::get()->storeThumbnail(clipId, i, result, true);
+                    }
                 }
             }
         }
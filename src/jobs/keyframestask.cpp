@@ -0,0 +1,176 @@
+/*
+    SPDX-FileCopyrightText: 2026 Kdenlive contributors
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#include "keyframestask.h"
+#include "bin/projectclip.h"
+#include "bin/projectitemmodel.h"
+#include "core.h"
+#include "kdenlivesettings.h"
+#include "project/projectmanager.h"
+#include "utils/cachemanager.h"
+
+#include <KLocalizedString>
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QProcess>
+
+KeyframesTask::KeyframesTask(const ObjectId &owner, const QString &resource, QObject *object)
+    : AbstractTask(owner, AbstractTask::KEYFRAMESJOB, object)
+    , m_resource(resource)
+{
+    m_description = i18n("Video keyframes");
+}
+
+void KeyframesTask::start(const ObjectId &owner, const QString &resource, QObject *object)
+{
+    if (pCore->taskManager.hasPendingJob(owner, AbstractTask::KEYFRAMESJOB)) {
+        return;
+    }
+    KeyframesTask *task = new KeyframesTask(owner, resource, object);
+    pCore->taskManager.startTask(owner.itemId, task);
+}
+
+// static
+QVector<double> KeyframesTask::parseProbe(const QString &output)
+{
+    // Lines are "packet,<pts_time>,<flags>", followed by "stream,<start_time>"
+    double startTime = 0.;
+    QVector<double> times;
+    const QStringList lines = output.split(QLatin1Char('\n'), Qt::SkipEmptyParts);
+    for (const QString &line : lines) {
+        const QStringList fields = line.trimmed().split(QLatin1Char(','));
+        bool ok = false;
+        if (fields.size() >= 3 && fields.at(0) == QLatin1String("packet") && fields.at(2).startsWith(QLatin1Char('K'))) {
+            double time = fields.at(1).toDouble(&ok);
+            if (ok) {
+                times << time;
+            }
+        } else if (fields.size() >= 2 && fields.at(0) == QLatin1String("stream")) {
+            double time = fields.at(1).toDouble(&ok);
+            if (ok) {
+                startTime = time;
+            }
+        }
+    }
+    for (double &time : times) {
+        time -= startTime;
+    }
+    std::sort(times.begin(), times.end());
+    return times;
+}
+
+// static
+QString KeyframesTask::indexPath(const QString &resource)
+{
+    bool ok = false;
+    QDir folder = pCore->projectManager()->cacheDir(false, &ok);
+    if (!ok) {
+        return QString();
+    }
+    // The index is only valid for this version of the file
+    const QFileInfo info(resource);
+    const QByteArray key = QStringLiteral("%1 %2 %3").arg(info.absoluteFilePath()).arg(info.size()).arg(info.lastModified().toMSecsSinceEpoch()).toUtf8();
+    return folder.absoluteFilePath(QString::fromLatin1(QCryptographicHash::hash(key, QCryptographicHash::Md5).toHex()) + QStringLiteral(".keyframes"));
+}
+
+// static
+bool KeyframesTask::readIndex(const QString &path, QVector<double> &times)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    times.clear();
+    const QList<QByteArray> lines = file.readAll().split('\n');
+    for (const QByteArray &line : lines) {
+        if (line.isEmpty()) {
+            continue;
+        }
+        bool ok = false;
+        double time = line.toDouble(&ok);
+        if (!ok) {
+            return false;
+        }
+        times << time;
+    }
+    return !times.isEmpty();
+}
+
+// static
+bool KeyframesTask::writeIndex(const QString &path, const QVector<double> &times)
+{
+    QFile file(path);
+    const qint64 previousSize = file.size();
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    for (double time : times) {
+        file.write(QByteArray::number(time, 'f', 6));
+        file.write("\n");
+    }
+    file.close();
+    CacheManager::get()->recordWrite(path, previousSize);
+    return true;
+}
+
+bool KeyframesTask::probe(QVector<double> &times)
+{
+    if (!QFileInfo(KdenliveSettings::ffprobepath()).isFile()) {
+        return false;
+    }
+    // Only the packets of the first video stream are read, nothing is decoded
+    QProcess probe;
+    probe.start(KdenliveSettings::ffprobepath(), {QStringLiteral("-v"), QStringLiteral("error"), QStringLiteral("-select_streams"), QStringLiteral("v:0"),
+                                                  QStringLiteral("-show_entries"), QStringLiteral("stream=start_time:packet=pts_time,flags"),
+                                                  QStringLiteral("-of"), QStringLiteral("csv"), m_resource});
+    if (!probe.waitForStarted()) {
+        return false;
+    }
+    QByteArray output;
+    while (!probe.waitForFinished(500)) {
+        output.append(probe.readAllStandardOutput());
+        if (m_isCanceled || probe.state() == QProcess::NotRunning) {
+            break;
+        }
+    }
+    if (probe.state() != QProcess::NotRunning) {
+        probe.kill();
+        probe.waitForFinished();
+        return false;
+    }
+    if (probe.exitStatus() != QProcess::NormalExit || probe.exitCode() != 0) {
+        return false;
+    }
+    output.append(probe.readAllStandardOutput());
+    times = parseProbe(QString::fromUtf8(output));
+    return !times.isEmpty();
+}
+
+void KeyframesTask::run()
+{
+    AbstractTaskDone whenFinished(m_owner.itemId, this);
+    if (m_isCanceled || pCore->taskManager.isBlocked()) {
+        return;
+    }
+    QMutexLocker lock(&m_runMutex);
+    m_running = true;
+    auto binClip = pCore->projectItemModel()->getClipByBinID(QString::number(m_owner.itemId));
+    if (binClip == nullptr) {
+        return;
+    }
+    const QString path = indexPath(m_resource);
+    QVector<double> times;
+    if (path.isEmpty() || !readIndex(path, times)) {
+        if (!probe(times)) {
+            return;
+        }
+        if (!path.isEmpty()) {
+            writeIndex(path, times);
+        }
+    }
+    binClip->setVideoKeyframes(m_resource, times);
+}
@@ -0,0 +1,38 @@
+/*
+    SPDX-FileCopyrightText: 2026 Kdenlive contributors
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#pragma once
+
+#include "abstracttask.h"
+
+#include <QObject>
+#include <QString>
+#include <QVector>
+
+/** @class KeyframesTask
+    @brief Lists the video keyframe positions of a clip, used by the keyframe thumbnails.
+    Probing reads all the packets of the file, so the result is stored in the thumbnails cache folder and only probed
+    again when the file changes.
+ */
+class KeyframesTask : public AbstractTask
+{
+public:
+    KeyframesTask(const ObjectId &owner, const QString &resource, QObject *object);
+    static void start(const ObjectId &owner, const QString &resource, QObject *object);
+    /** @brief Returns the keyframe times, in seconds from the stream start, listed in a csv ffprobe output of packets and stream */
+    static QVector<double> parseProbe(const QString &output);
+    /** @brief Path of the stored keyframe index of @param resource, empty if there is no cache folder */
+    static QString indexPath(const QString &resource);
+    static bool readIndex(const QString &path, QVector<double> &times);
+    static bool writeIndex(const QString &path, const QVector<double> &times);
+
+protected:
+    void run() override;
+
+private:
+    QString m_resource;
+    /** @brief Run ffprobe on the resource, returns false if it failed or was canceled */
+    bool probe(QVector<double> &times);
+};
@@ -13,14 +13,20 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include "kdenlive_debug.h"
 #include "kdenlivesettings.h"
 #include "macros.hpp"
+#include "xml/xml.hpp"
 
+#include <QDir>
 #include <QImageReader>
 #include <QProcess>
+#include <QRegularExpression>
+#include <QSemaphore>
 #include <QTemporaryFile>
 #include <QThread>
 
 #include <KLocalizedString>
 
+#include <limits>
+
 ProxyTask::ProxyTask(const ObjectId &owner, QObject *object)
     : AbstractTask(owner, AbstractTask::PROXYJOB, object)
     , m_jobDuration(0)
@@ -37,6 +43,13 @@ void ProxyTask::start(const ObjectId &owner, QObject *object, bool force)
         return;
     }
     ProxyTask *task = new ProxyTask(owner, object);
+    if (KdenliveSettings::proxyusedranges()) {
+        // Timeline usage is collected here, in the main thread
+        auto binClip = pCore->projectItemModel()->getClipByBinID(QString::number(owner.itemId));
+        if (binClip) {
+            task->m_ranges = binClip->usedRanges(qRound(KdenliveSettings::proxyrangehandles() * pCore->getCurrentFps()));
+        }
+    }
     // Otherwise, start a new proxy generation thread.
     task->m_isForce = force;
     pCore->taskManager.startTask(owner.itemId, task);
@@ -54,9 +67,39 @@ void ProxyTask::run()
     if (binClip == nullptr) {
         return;
     }
-    const QString dest = binClip->getProducerProperty(QStringLiteral("kdenlive:proxy"));
+    QString dest = binClip->getProducerProperty(QStringLiteral("kdenlive:proxy"));
+    ClipType::ProducerType type = binClip->clipType();
+    // Long video clips can be proxied only on the ranges used in the timelines, the proxy is then a playlist of segments
+    const bool rangeProxy = KdenliveSettings::proxyusedranges() && (type == ClipType::AV || type == ClipType::Video) &&
+                            !binClip->hasProducerProperty(QStringLiteral("kdenlive:camcorderproxy")) && !binClip->hasAlpha() &&
+                            binClip->audioStreamsCount() <= 1;
     QFileInfo fInfo(dest);
-    if (binClip->getProducerIntProperty(QStringLiteral("_overwriteproxy")) == 0 && fInfo.exists() && fInfo.size() > 0) {
+    if (rangeProxy && fInfo.suffix() != QLatin1String("mlt")) {
+        dest = fInfo.dir().absoluteFilePath(fInfo.completeBaseName() + QStringLiteral(".mlt"));
+    } else if (!rangeProxy && fInfo.suffix() == QLatin1String("mlt") && (type == ClipType::AV || type == ClipType::Video)) {
+        dest = fInfo.dir().absoluteFilePath(fInfo.completeBaseName() + QLatin1Char('.') + pCore->currentDoc()->proxyExtension());
+    }
+    fInfo.setFile(dest);
+    const bool overwrite = binClip->getProducerIntProperty(QStringLiteral("_overwriteproxy")) != 0;
+    if (rangeProxy && overwrite) {
+        for (const auto &segment : rangeSegments(dest)) {
+            QFile::remove(segment.second);
+        }
+    } else if (rangeProxy && fInfo.exists()) {
+        QVector<QPoint> covered;
+        for (const auto &segment : rangeSegments(dest)) {
+            covered << segment.first;
+        }
+        if (missingRanges(m_ranges, covered).isEmpty()) {
+            // All used ranges are already proxied
+            m_progress = 100;
+            QMetaObject::invokeMethod(m_object, "updateJobProgress");
+            if (binClip->getProducerProperty(QStringLiteral("resource")) != dest) {
+                QMetaObject::invokeMethod(binClip.get(), "updateProxyProducer", Qt::QueuedConnection, Q_ARG(QString, dest));
+            }
+            return;
+        }
+    } else if (!overwrite && fInfo.exists() && fInfo.size() > 0) {
         // Proxy clip already created
         m_progress = 100;
         QMetaObject::invokeMethod(m_object, "updateJobProgress");
@@ -64,7 +107,6 @@ void ProxyTask::run()
         return;
     }
 
-    ClipType::ProducerType type = binClip->clipType();
     m_progress = 0;
     bool result = false;
     QString source = binClip->getProducerProperty(QStringLiteral("kdenlive:originalurl"));
@@ -352,14 +394,33 @@ void ProxyTask::run()
             parameters << dest;
             qDebug() << "/// FULL PROXY PARAMS:\n" << parameters << "\n------";
         }
-        m_jobProcess.reset(new QProcess);
-        // m_jobProcess->setProcessChannelMode(QProcess::MergedChannels);
-        QObject::connect(m_jobProcess.get(), &QProcess::readyReadStandardError, this, &ProxyTask::processLogInfo);
-        QObject::connect(this, &ProxyTask::jobCanceled, m_jobProcess.get(), &QProcess::kill, Qt::DirectConnection);
-        m_jobProcess->start(KdenliveSettings::ffmpegpath(), parameters, QIODevice::ReadOnly);
-        AbstractTask::setPreferredPriority(m_jobProcess->processId());
-        m_jobProcess->waitForFinished(-1);
-        result = m_jobProcess->exitStatus() == QProcess::NormalExit;
+        // Long clips are split in segments encoded in parallel when the transcode pool has several threads,
+        // the segments are split at keyframes and the joined proxy is checked, both need ffprobe
+        const bool segmented = !rangeProxy && KdenliveSettings::proxysegmented() && KdenliveSettings::proxythreads() > 1 &&
+                               (type == ClipType::AV || type == ClipType::Video) && !binClip->hasProducerProperty(QStringLiteral("kdenlive:camcorderproxy")) &&
+                               binClip->duration().seconds() >= KdenliveSettings::proxysegmentminduration() * 60 &&
+                               QFileInfo(KdenliveSettings::ffprobepath()).isFile();
+        if (rangeProxy) {
+            result = createRangeProxy(parameters, source, dest, binClip->frameDuration());
+        } else if (segmented) {
+            result = createSegmentedProxy(parameters, source, dest, binClip->frameDuration());
+        }
+        if (!rangeProxy && !result && !m_isCanceled) {
+            if (segmented) {
+                // Encode the whole clip at once if the segments could not be encoded or joined exactly
+                QFile::remove(dest);
+                m_progress = 0;
+                QMetaObject::invokeMethod(m_object, "updateJobProgress");
+            }
+            m_jobProcess.reset(new QProcess);
+            // m_jobProcess->setProcessChannelMode(QProcess::MergedChannels);
+            QObject::connect(m_jobProcess.get(), &QProcess::readyReadStandardError, this, &ProxyTask::processLogInfo);
+            QObject::connect(this, &ProxyTask::jobCanceled, m_jobProcess.get(), &QProcess::kill, Qt::DirectConnection);
+            m_jobProcess->start(KdenliveSettings::ffmpegpath(), parameters, QIODevice::ReadOnly);
+            AbstractTask::setPreferredPriority(m_jobProcess->processId());
+            m_jobProcess->waitForFinished(-1);
+            result = m_jobProcess->exitStatus() == QProcess::NormalExit;
+        }
     }
     // remove temporary playlist if it exists
     m_progress = 100;
@@ -379,7 +440,10 @@ void ProxyTask::run()
         }
     } else {
         // Proxy process crashed
-        QFile::remove(dest);
+        if (!rangeProxy) {
+            // A range limited proxy keeps its previous playlist and segments
+            QFile::remove(dest);
+        }
         if (!m_isCanceled) {
             QMetaObject::invokeMethod(pCore.get(), "displayBinLogMessage", Qt::QueuedConnection, Q_ARG(QString, i18n("Failed to create proxy clip.")),
                                       Q_ARG(int, int(KMessageWidget::Warning)), Q_ARG(QString, m_logDetails));
@@ -389,6 +453,507 @@ void ProxyTask::run()
     return;
 }
 
+bool ProxyTask::createRangeProxy(const QStringList &parameters, const QString &source, const QString &playlistPath, int length)
+{
+    QVector<QPoint> covered;
+    for (const auto &segment : rangeSegments(playlistPath)) {
+        covered << segment.first;
+    }
+    const QString extension = pCore->currentDoc()->proxyExtension();
+    QFileInfo info(playlistPath);
+    QVector<QPair<QPoint, QString>> segments;
+    for (const QPoint &range : missingRanges(m_ranges, covered)) {
+        segments.append(
+            {range, info.dir().absoluteFilePath(QStringLiteral("%1_%2_%3.%4").arg(info.completeBaseName()).arg(range.x()).arg(range.y()).arg(extension))});
+    }
+    if (!transcodeSegments(parameters, source, segments, length)) {
+        return false;
+    }
+    if (QFileInfo(KdenliveSettings::ffprobepath()).isFile()) {
+        // The encoder may output less frames than requested, for example at the end of a broken file
+        for (const auto &segment : std::as_const(segments)) {
+            const int frames = probeFrameCount(segment.second);
+            if (!fitSegment(segment, frames, length)) {
+                m_logDetails.append(QStringLiteral("Discarding the unreadable proxy segment %1\n").arg(segment.second));
+            } else if (frames < qMin(segment.first.y(), length - 1) - segment.first.x() + 1) {
+                m_logDetails.append(QStringLiteral("The proxy segment %1 only has %2 frames\n").arg(segment.second).arg(frames));
+            }
+        }
+    }
+    return writeRangePlaylist(playlistPath, source, length);
+}
+
+bool ProxyTask::createSegmentedProxy(const QStringList &parameters, const QString &source, const QString &dest, int length)
+{
+    // Two segments per transcode thread, so that the threads are not left idle while the slowest segment finishes
+    const int count = KdenliveSettings::proxythreads() * 2;
+    QVector<int> positions;
+    for (int i = 1; i < count; ++i) {
+        positions << int(qint64(length) * i / count);
+    }
+    QFileInfo info(dest);
+    QVector<QPair<QPoint, QString>> segments;
+    for (const QPoint &range : splitRanges(keyframePositions(source, positions), length)) {
+        segments.append({range, info.dir().absoluteFilePath(
+                                    QStringLiteral("%1_part%2.%3").arg(info.completeBaseName()).arg(segments.size()).arg(info.suffix()))});
+    }
+    bool result = transcodeSegments(parameters, source, segments, length);
+    if (result) {
+        // Join the segments without re-encoding, each segment starts with a keyframe
+        QTemporaryFile list;
+        if (list.open()) {
+            QTextStream out(&list);
+            for (const auto &segment : std::as_const(segments)) {
+                QString path = segment.second;
+                out << QStringLiteral("file '%1'\n").arg(path.replace(QLatin1Char('\''), QStringLiteral("'\\''")));
+            }
+            out.flush();
+            list.close();
+            const QStringList concatParameters = {QStringLiteral("-hide_banner"), QStringLiteral("-y"), QStringLiteral("-v"), QStringLiteral("error"),
+                                                  QStringLiteral("-f"), QStringLiteral("concat"), QStringLiteral("-safe"), QStringLiteral("0"),
+                                                  QStringLiteral("-i"), list.fileName(), QStringLiteral("-map"), QStringLiteral("0"),
+                                                  QStringLiteral("-c"), QStringLiteral("copy"), dest};
+            QProcess concat;
+            QObject::connect(this, &ProxyTask::jobCanceled, &concat, &QProcess::kill, Qt::DirectConnection);
+            concat.start(KdenliveSettings::ffmpegpath(), concatParameters, QIODevice::ReadOnly);
+            concat.waitForFinished(-1);
+            m_logDetails.append(QString::fromUtf8(concat.readAllStandardError()));
+            result = !m_isCanceled && concat.exitStatus() == QProcess::NormalExit && concat.exitCode() == 0;
+            if (result && !matchesSourceTiming(source, dest)) {
+                m_logDetails.append(QStringLiteral("The joined proxy segments do not match the timing of the source\n"));
+                result = false;
+            }
+        } else {
+            result = false;
+        }
+    }
+    for (const auto &segment : std::as_const(segments)) {
+        QFile::remove(segment.second);
+    }
+    return result;
+}
+
+bool ProxyTask::transcodeSegments(const QStringList &parameters, const QString &source, const QVector<QPair<QPoint, QString>> &segments, int length)
+{
+    // The source is the argument of the last -i, the destination is the last argument
+    const int sourceIndex = int(parameters.lastIndexOf(source));
+    if (sourceIndex < 1 || parameters.at(sourceIndex - 1) != QLatin1String("-i")) {
+        m_logDetails.append(QStringLiteral("Cannot find the source in the proxy parameters\n"));
+        return false;
+    }
+    m_segmentsLength = 0;
+    for (const auto &segment : segments) {
+        m_segmentsLength += (segment.first.y() < 0 ? length - 1 : segment.first.y()) - segment.first.x() + 1;
+    }
+    m_segmentsLength = qMax(1, m_segmentsLength);
+    m_segmentProgress = QVector<int>(segments.size(), 0);
+    // Share the cores between the encodes running in parallel instead of letting each of them use all cores
+    const int parallel = qMax(1, qMin(int(segments.size()), KdenliveSettings::proxythreads()));
+    const QStringList segmentParameters = limitThreads(parameters, sourceIndex, qMax(1, QThread::idealThreadCount() / parallel));
+    QAtomicInt next(0);
+    QAtomicInt failed(0);
+    auto work = [&]() {
+        int index = next.fetchAndAddOrdered(1);
+        while (index < segments.size() && failed.loadRelaxed() == 0 && !m_isCanceled) {
+            if (!transcodeSegment(segmentParameters, sourceIndex, segments.at(index), index)) {
+                failed.storeRelaxed(1);
+            }
+            index = next.fetchAndAddOrdered(1);
+        }
+    };
+    // Use the free threads of the transcode pool, this thread encodes segments too so the proxy progresses when the pool is busy
+    QSemaphore helpersDone;
+    int helpers = 0;
+    while (helpers < segments.size() - 1 && pCore->taskManager.tryStartTranscode([&work, &helpersDone]() {
+        work();
+        helpersDone.release();
+    })) {
+        helpers++;
+    }
+    work();
+    helpersDone.acquire(helpers);
+    return failed.loadRelaxed() == 0 && !m_isCanceled;
+}
+
+bool ProxyTask::transcodeSegment(const QStringList &parameters, int sourceIndex, const QPair<QPoint, QString> &segment, int index)
+{
+    const double fps = pCore->getCurrentFps();
+    const QPoint &range = segment.first;
+    QStringList segmentParameters = parameters;
+    segmentParameters.removeLast();
+    if (range.y() >= 0) {
+        const int frames = range.y() - range.x() + 1;
+        segmentParameters << QStringLiteral("-frames:v") << QString::number(frames) << QStringLiteral("-t") << QString::number(frames / fps, 'f', 6);
+    }
+    segmentParameters << segment.second;
+    if (range.x() > 0) {
+        // Seek before the input so that ffmpeg does not decode the skipped part
+        segmentParameters.insert(sourceIndex - 1, QString::number(range.x() / fps, 'f', 6));
+        segmentParameters.insert(sourceIndex - 1, QStringLiteral("-ss"));
+    }
+    QProcess process;
+    QObject::connect(this, &ProxyTask::jobCanceled, &process, &QProcess::kill, Qt::DirectConnection);
+    // Called in this thread while waiting for the process
+    QObject::connect(&process, &QProcess::readyReadStandardError, &process, [this, &process, index, fps]() {
+        const QString buffer = QString::fromUtf8(process.readAllStandardError());
+        const int seconds = ffmpegStatsTime(buffer);
+        QMutexLocker lock(&m_segmentsMutex);
+        m_logDetails.append(buffer);
+        if (seconds < 0) {
+            return;
+        }
+        m_segmentProgress[index] = int(seconds * fps);
+        int done = 0;
+        for (int frames : std::as_const(m_segmentProgress)) {
+            done += frames;
+        }
+        const int val = qMin(99, int(100 * qint64(done) / m_segmentsLength));
+        if (m_progress != val) {
+            m_progress = val;
+            QMetaObject::invokeMethod(m_object, "updateJobProgress");
+        }
+    });
+    if (m_isCanceled) {
+        return false;
+    }
+    process.start(KdenliveSettings::ffmpegpath(), segmentParameters, QIODevice::ReadOnly);
+    AbstractTask::setPreferredPriority(process.processId());
+    process.waitForFinished(-1);
+    if (process.exitStatus() != QProcess::NormalExit || process.exitCode() != 0 || QFileInfo(segment.second).size() == 0) {
+        // Don't keep incomplete segments, they would be reused
+        QFile::remove(segment.second);
+        return false;
+    }
+    return true;
+}
+
+// static
+QVector<int> ProxyTask::keyframePositions(const QString &source, const QVector<int> &positions)
+{
+    const double fps = pCore->getCurrentFps();
+    if (positions.isEmpty() || !QFileInfo(KdenliveSettings::ffprobepath()).isFile()) {
+        return positions;
+    }
+    // Seeking reaches the keyframe before each position, read only its first packet
+    QStringList intervals;
+    for (int position : positions) {
+        intervals << QStringLiteral("%1%+#1").arg(position / fps, 0, 'f', 3);
+    }
+    QProcess probe;
+    probe.start(KdenliveSettings::ffprobepath(), {QStringLiteral("-v"), QStringLiteral("error"), QStringLiteral("-select_streams"), QStringLiteral("v:0"),
+                                                  QStringLiteral("-read_intervals"), intervals.join(QLatin1Char(',')), QStringLiteral("-show_entries"),
+                                                  QStringLiteral("stream=start_time:packet=pts_time,flags"), QStringLiteral("-of"),
+                                                  QStringLiteral("default=noprint_wrappers=1"), source});
+    if (!probe.waitForFinished(30000) || probe.exitStatus() != QProcess::NormalExit || probe.exitCode() != 0) {
+        probe.kill();
+        return positions;
+    }
+    // The stream section is printed after the packets
+    double startTime = 0.;
+    double time = -1.;
+    QVector<double> keyframeTimes;
+    const QStringList lines = QString::fromUtf8(probe.readAllStandardOutput()).split(QLatin1Char('\n'), Qt::SkipEmptyParts);
+    for (const QString &line : lines) {
+        const QString key = line.section(QLatin1Char('='), 0, 0);
+        const QString value = line.section(QLatin1Char('='), 1).trimmed();
+        if (key == QLatin1String("start_time")) {
+            startTime = value.toDouble();
+        } else if (key == QLatin1String("pts_time")) {
+            bool ok;
+            time = value.toDouble(&ok);
+            if (!ok) {
+                time = -1.;
+            }
+        } else if (key == QLatin1String("flags")) {
+            if (time >= 0. && value.startsWith(QLatin1Char('K'))) {
+                keyframeTimes << time;
+            }
+            time = -1.;
+        }
+    }
+    QVector<int> keyframes;
+    for (double keyframeTime : std::as_const(keyframeTimes)) {
+        keyframes << qRound((keyframeTime - startTime) * fps);
+    }
+    if (keyframes.size() != positions.size()) {
+        // Unexpected output, split at the requested positions
+        return positions;
+    }
+    std::sort(keyframes.begin(), keyframes.end());
+    return keyframes;
+}
+
+// static
+QStringList ProxyTask::limitThreads(const QStringList &parameters, int sourceIndex, int threads)
+{
+    QStringList result = parameters;
+    bool encoderThreads = false;
+    for (int i = 0; i < result.size() - 1; ++i) {
+        if (result.at(i) == QLatin1String("-threads")) {
+            result[i + 1] = QString::number(threads);
+            encoderThreads |= i > sourceIndex;
+        }
+    }
+    if (!encoderThreads && !result.isEmpty()) {
+        // The destination is the last argument
+        result.insert(result.size() - 1, QStringLiteral("-threads"));
+        result.insert(result.size() - 1, QString::number(threads));
+    }
+    return result;
+}
+
+bool ProxyTask::matchesSourceTiming(const QString &source, const QString &proxy)
+{
+    double sourceDuration = 0.;
+    double proxyDuration = 0.;
+    QMap<QString, QVector<double>> sourceStarts;
+    QMap<QString, QVector<double>> proxyStarts;
+    if (!probeTiming(source, sourceDuration, sourceStarts) || !probeTiming(proxy, proxyDuration, proxyStarts)) {
+        return false;
+    }
+    // The joins may add or drop up to an audio frame per segment, allow a drift of 2 video frames
+    const double tolerance = 2. / pCore->getCurrentFps();
+    if (qAbs(sourceDuration - proxyDuration) > tolerance) {
+        return false;
+    }
+    // Compare the offsets of the streams to the first one, the proxy may start at another time than the source
+    auto offsets = [](const QMap<QString, QVector<double>> &starts) {
+        double first = std::numeric_limits<double>::max();
+        for (const QVector<double> &times : starts) {
+            for (double time : times) {
+                first = qMin(first, time);
+            }
+        }
+        QMap<QString, QVector<double>> result;
+        for (auto it = starts.cbegin(); it != starts.cend(); ++it) {
+            for (double time : it.value()) {
+                result[it.key()] << time - first;
+            }
+        }
+        return result;
+    };
+    const QMap<QString, QVector<double>> sourceOffsets = offsets(sourceStarts);
+    const QMap<QString, QVector<double>> proxyOffsets = offsets(proxyStarts);
+    for (const QString &type : {QStringLiteral("video"), QStringLiteral("audio")}) {
+        const QVector<double> expected = sourceOffsets.value(type);
+        const QVector<double> found = proxyOffsets.value(type);
+        if (expected.size() != found.size()) {
+            return false;
+        }
+        for (int i = 0; i < expected.size(); ++i) {
+            if (qAbs(expected.at(i) - found.at(i)) > tolerance) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// static
+bool ProxyTask::probeTiming(const QString &path, double &duration, QMap<QString, QVector<double>> &startTimes)
+{
+    QProcess probe;
+    probe.start(KdenliveSettings::ffprobepath(), {QStringLiteral("-v"), QStringLiteral("error"), QStringLiteral("-show_entries"),
+                                                  QStringLiteral("format=duration:stream=codec_type,start_time"), QStringLiteral("-of"),
+                                                  QStringLiteral("default"), path});
+    if (!probe.waitForFinished(30000) || probe.exitStatus() != QProcess::NormalExit || probe.exitCode() != 0) {
+        probe.kill();
+        return false;
+    }
+    duration = -1.;
+    startTimes.clear();
+    QString codecType;
+    const QStringList lines = QString::fromUtf8(probe.readAllStandardOutput()).split(QLatin1Char('\n'), Qt::SkipEmptyParts);
+    for (const QString &line : lines) {
+        const QString key = line.section(QLatin1Char('='), 0, 0).trimmed();
+        const QString value = line.section(QLatin1Char('='), 1).trimmed();
+        bool ok = false;
+        if (key == QLatin1String("[STREAM]")) {
+            codecType.clear();
+        } else if (key == QLatin1String("codec_type")) {
+            codecType = value;
+        } else if (key == QLatin1String("start_time")) {
+            const double time = value.toDouble(&ok);
+            if (ok && !codecType.isEmpty()) {
+                startTimes[codecType] << time;
+            }
+        } else if (key == QLatin1String("duration")) {
+            const double time = value.toDouble(&ok);
+            if (ok) {
+                duration = time;
+            }
+        }
+    }
+    return duration >= 0.;
+}
+
+bool ProxyTask::writeRangePlaylist(const QString &playlistPath, const QString &source, int length)
+{
+    QDomDocument doc;
+    QDomElement mlt = doc.createElement(QStringLiteral("mlt"));
+    mlt.setAttribute(QStringLiteral("LC_NUMERIC"), QStringLiteral("C"));
+    doc.appendChild(mlt);
+    QDomElement playlist = doc.createElement(QStringLiteral("playlist"));
+    playlist.setAttribute(QStringLiteral("id"), QStringLiteral("proxy"));
+    auto addProducer = [&doc, &mlt](const QString &id, const QString &resource) {
+        QDomElement producer = doc.createElement(QStringLiteral("producer"));
+        producer.setAttribute(QStringLiteral("id"), id);
+        Xml::addXmlProperties(producer, QMap<QString, QString>{{QStringLiteral("resource"), resource},
+                                                               {QStringLiteral("mlt_service"), QStringLiteral("avformat-novalidate")}});
+        mlt.appendChild(producer);
+    };
+    auto addEntry = [&doc, &playlist](const QString &id, int in, int out) {
+        QDomElement entry = doc.createElement(QStringLiteral("entry"));
+        entry.setAttribute(QStringLiteral("producer"), id);
+        entry.setAttribute(QStringLiteral("in"), in);
+        entry.setAttribute(QStringLiteral("out"), out);
+        playlist.appendChild(entry);
+    };
+    // Parts of the clip that are not used in a timeline are read from the original file
+    addProducer(QStringLiteral("source"), source);
+    int position = 0;
+    int ix = 0;
+    const auto segments = rangeSegments(playlistPath);
+    for (const auto &segment : segments) {
+        if (segment.first.x() >= length) {
+            break;
+        }
+        if (segment.first.x() > position) {
+            addEntry(QStringLiteral("source"), position, segment.first.x() - 1);
+        }
+        const QString id = QStringLiteral("segment%1").arg(ix++);
+        addProducer(id, segment.second);
+        addEntry(id, 0, qMin(segment.first.y(), length - 1) - segment.first.x());
+        position = segment.first.y() + 1;
+    }
+    if (position < length) {
+        addEntry(QStringLiteral("source"), position, length - 1);
+    }
+    mlt.appendChild(playlist);
+    return Xml::docContentToFile(doc, playlistPath);
+}
+
+// static
+bool ProxyTask::fitSegment(const QPair<QPoint, QString> &segment, int frames, int length)
+{
+    const int expected = qMin(segment.first.y(), length - 1) - segment.first.x() + 1;
+    if (frames >= expected) {
+        // Extra frames are not played, the playlist entry has the length of the range
+        return true;
+    }
+    if (frames <= 0) {
+        QFile::remove(segment.second);
+        return false;
+    }
+    // The rest of the range is read from the source, and encoded again on the next proxy update
+    const QFileInfo info(segment.second);
+    const QString baseName = info.completeBaseName().section(QLatin1Char('_'), 0, -3);
+    const QString path = info.dir().absoluteFilePath(
+        QStringLiteral("%1_%2_%3.%4").arg(baseName).arg(segment.first.x()).arg(segment.first.x() + frames - 1).arg(info.suffix()));
+    QFile::remove(path);
+    if (!QFile::rename(segment.second, path)) {
+        QFile::remove(segment.second);
+        return false;
+    }
+    return true;
+}
+
+// static
+int ProxyTask::probeFrameCount(const QString &path)
+{
+    QProcess probe;
+    // Counting the packets does not decode the frames
+    probe.start(KdenliveSettings::ffprobepath(), {QStringLiteral("-v"), QStringLiteral("error"), QStringLiteral("-select_streams"), QStringLiteral("v:0"),
+                                                  QStringLiteral("-count_packets"), QStringLiteral("-show_entries"), QStringLiteral("stream=nb_read_packets"),
+                                                  QStringLiteral("-of"), QStringLiteral("default=noprint_wrappers=1:nokey=1"), path});
+    if (!probe.waitForFinished(30000) || probe.exitStatus() != QProcess::NormalExit || probe.exitCode() != 0) {
+        probe.kill();
+        return -1;
+    }
+    bool ok = false;
+    const int frames = QString::fromUtf8(probe.readAllStandardOutput()).trimmed().toInt(&ok);
+    return ok ? frames : -1;
+}
+
+// static
+QVector<QPoint> ProxyTask::missingRanges(const QVector<QPoint> &needed, const QVector<QPoint> &covered)
+{
+    QVector<QPoint> missing;
+    auto cover = covered.cbegin();
+    for (const QPoint &range : needed) {
+        int position = range.x();
+        // Skip the covered ranges ending before this one
+        while (cover != covered.cend() && cover->y() < position) {
+            ++cover;
+        }
+        for (auto it = cover; it != covered.cend() && it->x() <= range.y(); ++it) {
+            if (it->x() > position) {
+                missing << QPoint(position, it->x() - 1);
+            }
+            position = qMax(position, it->y() + 1);
+        }
+        if (position <= range.y()) {
+            missing << QPoint(position, range.y());
+        }
+    }
+    return missing;
+}
+
+// static
+QVector<QPair<QPoint, QString>> ProxyTask::rangeSegments(const QString &playlistPath)
+{
+    QFileInfo info(playlistPath);
+    const QString baseName = info.completeBaseName();
+    const QDir dir = info.dir();
+    // Segments are named after the playlist and their source range: hash_in_out.ext
+    const QRegularExpression pattern(QStringLiteral("^%1_(\\d+)_(\\d+)\\.").arg(QRegularExpression::escape(baseName)));
+    QVector<QPair<QPoint, QString>> segments;
+    const QStringList files = dir.entryList({baseName + QStringLiteral("_*_*.*")}, QDir::Files);
+    for (const QString &file : files) {
+        const QRegularExpressionMatch match = pattern.match(file);
+        if (match.hasMatch()) {
+            segments.append({QPoint(match.captured(1).toInt(), match.captured(2).toInt()), dir.absoluteFilePath(file)});
+        }
+    }
+    std::sort(segments.begin(), segments.end(), [](const QPair<QPoint, QString> &a, const QPair<QPoint, QString> &b) { return a.first.x() < b.first.x(); });
+    return segments;
+}
+
+// static
+QVector<QPoint> ProxyTask::splitRanges(const QVector<int> &splits, int length)
+{
+    QVector<QPoint> ranges;
+    int start = 0;
+    for (int position : splits) {
+        if (position <= start || position >= length) {
+            // Several positions snapped to the same keyframe
+            continue;
+        }
+        ranges << QPoint(start, position - 1);
+        start = position;
+    }
+    // The last segment is not limited, the clip duration is not always exact
+    ranges << QPoint(start, -1);
+    return ranges;
+}
+
+// static
+int ProxyTask::ffmpegStatsTime(const QString &buffer)
+{
+    if (!buffer.contains(QLatin1String("time="))) {
+        return -1;
+    }
+    QString time = buffer.section(QStringLiteral("time="), 1, 1).simplified().section(QLatin1Char(' '), 0, 0);
+    if (time.isEmpty()) {
+        return -1;
+    }
+    QStringList numbers = time.split(QLatin1Char(':'));
+    if (numbers.size() < 3) {
+        return time.toInt();
+    }
+    return numbers.at(0).toInt() * 3600 + numbers.at(1).toInt() * 60 + qRound(numbers.at(2).toDouble());
+}
+
 void ProxyTask::processLogInfo()
 {
     const QString buffer = QString::fromUtf8(m_jobProcess->readAllStandardError());
@@ -406,19 +971,10 @@ void ProxyTask::processLogInfo()
                     m_jobDuration = numbers.at(0).toInt() * 3600 + numbers.at(1).toInt() * 60 + numbers.at(2).toInt();
                 }
             }
-        } else if (buffer.contains(QLatin1String("time="))) {
-            int progress = 0;
-            QString time = buffer.section(QStringLiteral("time="), 1, 1).simplified().section(QLatin1Char(' '), 0, 0);
-            if (!time.isEmpty()) {
-                QStringList numbers = time.split(QLatin1Char(':'));
-                if (numbers.size() < 3) {
-                    progress = time.toInt();
-                    if (progress == 0) {
-                        return;
-                    }
-                } else {
-                    progress = numbers.at(0).toInt() * 3600 + numbers.at(1).toInt() * 60 + qRound(numbers.at(2).toDouble());
-                }
+        } else {
+            const int progress = ffmpegStatsTime(buffer);
+            if (progress <= 0) {
+                return;
             }
             int val = 100 * progress / m_jobDuration;
             if (m_progress != val) {
@@ -8,6 +8,11 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 
 #include "abstracttask.h"
 
+#include <QMap>
+#include <QMutex>
+#include <QPoint>
+#include <QVector>
+
 class QProcess;
 
 class ProxyTask : public AbstractTask
@@ -15,6 +20,22 @@ class ProxyTask : public AbstractTask
 public:
     ProxyTask(const ObjectId &owner, QObject* object);
     static void start(const ObjectId &owner, QObject* object, bool force = false);
+    /** @brief Returns the parts of the @param needed ranges that are not in the @param covered ranges, both sorted and not overlapping */
+    static QVector<QPoint> missingRanges(const QVector<QPoint> &needed, const QVector<QPoint> &covered);
+    /** @brief Returns the source range and path of the segment files of a range limited proxy, sorted by position */
+    static QVector<QPair<QPoint, QString>> rangeSegments(const QString &playlistPath);
+    /** @brief Make the @param segment of a range limited proxy of a clip of @param length frames match its @param frames encoded frames, so that
+     *  it does not shift the following playlist entries: a shorter segment is renamed to the range it covers, an empty one is removed.
+     *  Returns false if the segment was removed */
+    static bool fitSegment(const QPair<QPoint, QString> &segment, int frames, int length);
+    /** @brief Returns the source ranges of the segments of a clip of @param length frames split before the sorted positions @param splits.
+     *  The last range ends at -1, it goes to the end of the clip */
+    static QVector<QPoint> splitRanges(const QVector<int> &splits, int length);
+    /** @brief Parse the encoded duration in seconds from FFmpeg's stats output, returns -1 if not found */
+    static int ffmpegStatsTime(const QString &buffer);
+    /** @brief Returns the FFmpeg @param parameters with the decoding and encoding threads set to @param threads.
+     *  @param sourceIndex is the index of the source argument, the destination is the last argument */
+    static QStringList limitThreads(const QStringList &parameters, int sourceIndex, int threads);
 
 protected:
     void run() override;
@@ -28,4 +49,27 @@ private:
     std::unique_ptr<QProcess> m_jobProcess;
     QString m_errorMessage;
     QString m_logDetails;
+    /** @brief Source ranges used in the timelines, with handles */
+    QVector<QPoint> m_ranges;
+    /** @brief Frames encoded in each segment and in total, when the proxy is encoded in segments */
+    QMutex m_segmentsMutex;
+    QVector<int> m_segmentProgress;
+    int m_segmentsLength{1};
+    /** @brief Transcode the missing used ranges of the clip, then write the playlist stitching the segments with the original clip */
+    bool createRangeProxy(const QStringList &parameters, const QString &source, const QString &playlistPath, int length);
+    static bool writeRangePlaylist(const QString &playlistPath, const QString &source, int length);
+    /** @brief Transcode the clip in segments split at keyframes, encoded in parallel, then join them without re-encoding */
+    bool createSegmentedProxy(const QStringList &parameters, const QString &source, const QString &dest, int length);
+    /** @brief Transcode the source range of each segment to its path, a range ending at -1 goes to the end of the clip.
+     *  The segments are shared between this thread and the free threads of the transcode pool */
+    bool transcodeSegments(const QStringList &parameters, const QString &source, const QVector<QPair<QPoint, QString>> &segments, int length);
+    bool transcodeSegment(const QStringList &parameters, int sourceIndex, const QPair<QPoint, QString> &segment, int index);
+    /** @brief Returns true if the @param proxy has the duration and the stream offsets of the @param source, up to 2 frames */
+    static bool matchesSourceTiming(const QString &source, const QString &proxy);
+    /** @brief Count the video frames of @param path with ffprobe, returns -1 if it cannot be read */
+    static int probeFrameCount(const QString &path);
+    /** @brief Read the duration and the start time of the streams, by codec type, of @param path with ffprobe */
+    static bool probeTiming(const QString &path, double &duration, QMap<QString, QVector<double>> &startTimes);
+    /** @brief Returns the keyframe positions of @param source closest before the frames @param positions, or the positions if the source cannot be probed */
+    static QVector<int> keyframePositions(const QString &source, const QVector<int> &positions);
 };
@@ -0,0 +1,223 @@
+/*
+    SPDX-FileCopyrightText: 2026 Kdenlive contributors
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#include "scenedetector.h"
+
+#include <QDataStream>
+#include <QFile>
+#include <QMutex>
+#include <QSaveFile>
+#include <QThread>
+#include <QtConcurrent/QtConcurrentMap>
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <mlt++/MltFrame.h>
+#include <mlt++/MltProducer.h>
+
+namespace {
+// Segments shorter than this are not worth the cost of opening and seeking another producer
+constexpr int minSegmentLength = 500;
+constexpr quint32 cacheMagic = 0x4b534344; // KSCD
+constexpr qint32 cacheVersion = 1;
+
+struct Segment
+{
+    std::unique_ptr<Mlt::Producer> producer;
+    int in;
+    int out;
+};
+
+/** @brief Fill the metrics of the frames from @param segment.in to @param segment.out. The frame before the segment is decoded too, as the
+ *  reference of its first frame */
+void analyseSegment(Segment &segment, float *histogramMetrics, float *lumaMetrics, const QAtomicInt &abort, const std::function<void()> &frameDone)
+{
+    const int start = qMax(0, segment.in - 1);
+    segment.producer->seek(start);
+    mlt_profile profile = segment.producer->get_profile();
+    QVector<uint8_t> previous;
+    QVector<uint8_t> current;
+    SceneDetector::Histogram previousHistogram{};
+    SceneDetector::Histogram histogram{};
+    for (int pos = start; pos <= segment.out && abort.loadRelaxed() == 0; ++pos) {
+        std::unique_ptr<Mlt::Frame> frame(segment.producer->get_frame());
+        current.clear();
+        if (frame && frame->is_valid()) {
+            frame->set("consumer.rescale", "nearest");
+            frame->set("consumer.deinterlacer", "onefield");
+            mlt_image_format format = mlt_image_yuv420p;
+            int width = profile->width;
+            int height = profile->height;
+            const uint8_t *image = frame->get_image(format, width, height);
+            if (image && format == mlt_image_yuv420p && width > 0 && height > 0) {
+                // The luma plane comes first
+                current.resize(width * height);
+                memcpy(current.data(), image, size_t(current.size()));
+            }
+        }
+        if (!current.isEmpty()) {
+            SceneDetector::lumaHistogram(current.constData(), int(current.size()), histogram);
+        }
+        if (pos >= segment.in) {
+            if (pos > 0 && !current.isEmpty() && previous.size() == current.size()) {
+                histogramMetrics[pos] = SceneDetector::histogramDistance(previousHistogram, histogram, int(current.size()));
+                lumaMetrics[pos] = SceneDetector::lumaDifference(previous.constData(), current.constData(), int(current.size()));
+            }
+            frameDone();
+        }
+        if (!current.isEmpty()) {
+            std::swap(previous, current);
+            std::swap(previousHistogram, histogram);
+        }
+    }
+}
+} // namespace
+
+bool SceneDetector::analyse(const std::function<std::unique_ptr<Mlt::Producer>()> &createProducer, int length, Metrics &metrics, const QAtomicInt &abort,
+                            const std::function<void(int)> &progress)
+{
+    metrics.histogram.fill(0.f, length);
+    metrics.luma.fill(0.f, length);
+    if (length <= 0) {
+        return false;
+    }
+    const int count = qBound(1, length / minSegmentLength, QThread::idealThreadCount());
+    std::vector<Segment> segments;
+    segments.reserve(size_t(count));
+    for (int i = 0; i < count; ++i) {
+        std::unique_ptr<Mlt::Producer> producer = createProducer();
+        if (!producer || !producer->is_valid()) {
+            return false;
+        }
+        segments.push_back({std::move(producer), int(qint64(length) * i / count), int(qint64(length) * (i + 1) / count) - 1});
+    }
+    std::atomic<int> processed{0};
+    int reported = -1;
+    QMutex progressMutex;
+    auto frameDone = [&]() {
+        const int percent = int(100 * qint64(processed.fetch_add(1, std::memory_order_relaxed) + 1) / length);
+        QMutexLocker lk(&progressMutex);
+        if (percent > reported) {
+            reported = percent;
+            progress(percent);
+        }
+    };
+    // Each frame is written by a single segment, the vectors were allocated above so they are not detached while analysing
+    float *histogramMetrics = metrics.histogram.data();
+    float *lumaMetrics = metrics.luma.data();
+    QtConcurrent::blockingMap(segments, [&](Segment &segment) { analyseSegment(segment, histogramMetrics, lumaMetrics, abort, frameDone); });
+    return abort.loadRelaxed() == 0;
+}
+
+QVector<float> SceneDetector::sceneScores(const Metrics &metrics)
+{
+    QVector<float> scores(metrics.size(), 0.f);
+    float previous = 0.f;
+    for (int i = 1; i < metrics.size(); ++i) {
+        const float difference = (metrics.histogram.at(i) + metrics.luma.at(i)) / 2.f;
+        scores[i] = qMin(difference, qAbs(difference - previous));
+        previous = difference;
+    }
+    return scores;
+}
+
+QVector<int> SceneDetector::detectCuts(const Metrics &metrics, double threshold)
+{
+    const QVector<float> scores = sceneScores(metrics);
+    QVector<int> cuts;
+    for (int i = 1; i < scores.size(); ++i) {
+        if (scores.at(i) > threshold) {
+            cuts << i;
+        }
+    }
+    return cuts;
+}
+
+bool SceneDetector::load(const QString &path, int length, Metrics &metrics)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    QDataStream stream(&file);
+    quint32 magic;
+    qint32 version;
+    stream >> magic >> version;
+    if (magic != cacheMagic || version != cacheVersion) {
+        return false;
+    }
+    Metrics cached;
+    stream >> cached.histogram >> cached.luma;
+    if (stream.status() != QDataStream::Ok || cached.size() != length || cached.histogram.size() != cached.luma.size()) {
+        return false;
+    }
+    metrics = cached;
+    return true;
+}
+
+bool SceneDetector::save(const QString &path, const Metrics &metrics)
+{
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    QDataStream stream(&file);
+    stream << cacheMagic << cacheVersion << metrics.histogram << metrics.luma;
+    return stream.status() == QDataStream::Ok && file.commit();
+}
+
+void SceneDetector::lumaHistogram(const uint8_t *luma, int count, Histogram &histogram)
+{
+    // Four partial histograms break the dependency between consecutive increments of the same bin
+    std::array<Histogram, 4> partial{};
+    constexpr int shift = 8 - 6; // 256 luma levels in 64 bins
+    static_assert(HistogramBins == 1 << (8 - shift), "Histogram bins do not match the luma shift");
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        partial[0][luma[i] >> shift]++;
+        partial[1][luma[i + 1] >> shift]++;
+        partial[2][luma[i + 2] >> shift]++;
+        partial[3][luma[i + 3] >> shift]++;
+    }
+    for (; i < count; ++i) {
+        partial[0][luma[i] >> shift]++;
+    }
+    for (int bin = 0; bin < HistogramBins; ++bin) {
+        histogram[bin] = partial[0][bin] + partial[1][bin] + partial[2][bin] + partial[3][bin];
+    }
+}
+
+float SceneDetector::histogramDistance(const Histogram &a, const Histogram &b, int count)
+{
+    if (count <= 0) {
+        return 0.f;
+    }
+    quint32 sum = 0;
+    for (int bin = 0; bin < HistogramBins; ++bin) {
+        sum += a[bin] > b[bin] ? a[bin] - b[bin] : b[bin] - a[bin];
+    }
+    // Each moved pixel is counted twice
+    return float(sum) / float(2 * qint64(count));
+}
+
+float SceneDetector::lumaDifference(const uint8_t *a, const uint8_t *b, int count)
+{
+    if (count <= 0) {
+        return 0.f;
+    }
+    // Accumulate in 32 bit over blocks of pixels so the compiler can vectorise the loop (psadbw on x86), without overflowing on large frames
+    constexpr int block = 1 << 16;
+    quint64 total = 0;
+    for (int start = 0; start < count; start += block) {
+        const int end = qMin(count, start + block);
+        quint32 sum = 0;
+        for (int i = start; i < end; ++i) {
+            sum += quint32(std::abs(int(a[i]) - int(b[i])));
+        }
+        total += sum;
+    }
+    return float(double(total) / (255. * count));
+}
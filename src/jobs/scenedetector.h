@@ -0,0 +1,63 @@
+/*
+    SPDX-FileCopyrightText: 2026 Kdenlive contributors
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#pragma once
+
+#include <QAtomicInt>
+#include <QString>
+#include <QVector>
+
+#include <array>
+#include <functional>
+#include <memory>
+
+namespace Mlt {
+class Producer;
+}
+
+/** @class SceneDetector
+    @brief Native scene change detection on downscaled frames decoded by MLT.
+    For each frame, two metrics are computed against the previous frame: the distance between the luma histograms and the
+    mean absolute luma difference. The clip is split in segments that are decoded and analysed in parallel. The metrics are
+    stored per frame, so that the cuts for another threshold are computed without decoding the clip again.
+ */
+class SceneDetector
+{
+public:
+    static constexpr int HistogramBins = 64;
+    using Histogram = std::array<quint32, HistogramBins>;
+
+    /** @brief Per frame difference with the previous frame, in the [0, 1] range. The values of the first frame are 0 */
+    struct Metrics
+    {
+        QVector<float> histogram;
+        QVector<float> luma;
+        int size() const { return int(luma.size()); }
+    };
+
+    /** @brief Analyse the @param length first frames of a clip
+     *  @param createProducer returns a new producer of the clip with a low resolution profile, one is created per segment
+     *  @param abort stops the analysis when non zero
+     *  @param progress is called with the percentage of analysed frames, never concurrently
+     *  @returns false if the analysis was aborted or the clip could not be opened */
+    static bool analyse(const std::function<std::unique_ptr<Mlt::Producer>()> &createProducer, int length, Metrics &metrics, const QAtomicInt &abort,
+                        const std::function<void(int)> &progress);
+    /** @brief Scene change score of each frame. Like FFmpeg's scene score, a frame that differs as much from its previous frame
+     *  as the previous frame did from its own (fast motion) gets a low score */
+    static QVector<float> sceneScores(const Metrics &metrics);
+    /** @brief First frame of each scene whose score is above @param threshold */
+    static QVector<int> detectCuts(const Metrics &metrics, double threshold);
+
+    /** @brief Read cached metrics, returns false if the file is missing or was not created for a clip of @param length frames */
+    static bool load(const QString &path, int length, Metrics &metrics);
+    static bool save(const QString &path, const Metrics &metrics);
+
+    /** @brief Luma histogram of @param count pixels */
+    static void lumaHistogram(const uint8_t *luma, int count, Histogram &histogram);
+    /** @brief Normalized L1 distance between the histograms of two images of @param count pixels */
+    static float histogramDistance(const Histogram &a, const Histogram &b, int count);
+    /** @brief Mean absolute difference between two luma planes of @param count pixels */
+    static float lumaDifference(const uint8_t *a, const uint8_t *b, int count);
+};
@@ -17,15 +17,15 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include "kdenlivesettings.h"
 #include "macros.hpp"
 #include "mainwindow.h"
+#include "mltcontroller/clipcontroller.h"
+#include "scenedetector.h"
 #include "ui_scenecutdialog_ui.h"
 
 #include <QJsonArray>
 #include <QJsonDocument>
 #include <QJsonObject>
+#include <QDir>
 #include <QPointer>
-#include <QProcess>
-#include <QTemporaryFile>
-#include <QThread>
 
 #include <KLocalizedString>
 #include <project/projectmanager.h>
@@ -33,11 +33,9 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 SceneSplitTask::SceneSplitTask(const ObjectId &owner, double threshold, int markersCategory, bool addSubclips, int minDuration, QObject *object)
     : AbstractTask(owner, AbstractTask::ANALYSECLIPJOB, object)
     , m_threshold(threshold)
-    , m_jobDuration(0)
     , m_markersType(markersCategory)
     , m_subClips(addSubclips)
     , m_minInterval(minDuration)
-    , m_jobProcess(nullptr)
 {
     m_description = i18n("Detecting scene change");
     qDebug() << "Threshold is" << threshold << QString::number(threshold);
@@ -109,7 +107,6 @@ void SceneSplitTask::run()
     QMutexLocker lock(&m_runMutex);
     m_running = true;
     auto binClip = pCore->projectItemModel()->getClipByBinID(QString::number(m_owner.itemId));
-    const QString source = binClip->url();
     ClipType::ProducerType type = binClip->clipType();
     bool result;
     if (type != ClipType::AV && type != ClipType::Video) {
@@ -119,62 +116,44 @@ void SceneSplitTask::run()
         qDebug() << "=== ABORT 1";
         return;
     }
-    if (KdenliveSettings::ffmpegpath().isEmpty()) {
-        // FFmpeg not detected, cannot process the Job
-        QMetaObject::invokeMethod(pCore.get(), "displayBinMessage", Qt::QueuedConnection,
-                                  Q_ARG(QString, i18n("FFmpeg not found, please set path in Kdenlive's settings Environment.")),
-                                  Q_ARG(int, int(KMessageWidget::Warning)));
-        qDebug() << "=== ABORT 2";
-        return;
-    }
-    m_jobDuration = int(binClip->duration().seconds());
     int producerDuration = binClip->frameDuration();
-    // QStringList parameters =
-    // {QStringLiteral("-loglevel"),QStringLiteral("info"),QStringLiteral("-i"),source,QStringLiteral("-filter:v"),QStringLiteral("scdet"),QStringLiteral("-f"),QStringLiteral("null"),QStringLiteral("-")};
-    QStringList parameters = {QStringLiteral("-y"),
-                              QStringLiteral("-loglevel"),
-                              QStringLiteral("info"),
-                              QStringLiteral("-i"),
-                              source,
-                              QStringLiteral("-filter:v"),
-                              QStringLiteral("select='gt(scene,%1)',showinfo").arg(m_threshold),
-                              QStringLiteral("-vsync"),
-                              QStringLiteral("vfr"),
-                              QStringLiteral("-f"),
-                              QStringLiteral("null"),
-                              QStringLiteral("-")};
-
-    m_jobProcess.reset(new QProcess);
-    // m_jobProcess->setStandardErrorFile("/tmp/test_settings.txt");
-    m_jobProcess->setProcessChannelMode(QProcess::MergedChannels);
-    qDebug() << "=== READY TO START JOB:" << parameters;
-    QObject::connect(this, &SceneSplitTask::jobCanceled, m_jobProcess.get(), &QProcess::kill, Qt::DirectConnection);
-    QObject::connect(m_jobProcess.get(), &QProcess::readyReadStandardOutput, this, &SceneSplitTask::processLogInfo);
-    QObject::connect(m_jobProcess.get(), &QProcess::readyReadStandardError, this, &SceneSplitTask::processLogErr);
-    m_jobProcess->start(KdenliveSettings::ffmpegpath(), parameters);
-    // m_jobProcess->closeReadChannel(QProcess::StandardError);
-    m_jobProcess->waitForStarted();
-    // QString data;
-    /*while(m_jobProcess->waitForReadyRead()) {
-        //data.append(m_jobProcess->readAll());
-        qDebug()<<"???? READ: \n"<<m_jobProcess->readAll();
-    }*/
-    m_jobProcess->waitForFinished(-1);
-    result = m_jobProcess->exitStatus() == QProcess::NormalExit;
-
-    // remove temporary playlist if it exists
+    // The per frame metrics are cached, so that running the detection again with another threshold does not decode the clip
+    QString metricsPath;
+    bool ok;
+    QDir thumbFolder = pCore->projectManager()->cacheDir(false, &ok);
+    const QString clipHash = binClip->hash(false);
+    if (ok && !clipHash.isEmpty()) {
+        metricsPath = thumbFolder.absoluteFilePath(QStringLiteral("%1_%2_scenes.dat").arg(clipHash).arg(int(pCore->getCurrentFps())));
+    }
+    SceneDetector::Metrics metrics;
+    result = !m_isForce && !metricsPath.isEmpty() && SceneDetector::load(metricsPath, producerDuration, metrics);
+    if (!result) {
+        auto createProducer = [binClip]() {
+            // Decode downscaled frames, without audio
+            std::unique_ptr<Mlt::Producer> producer = binClip->softClone(ClipController::getPassPropertiesList());
+            producer->set("audio_index", -1);
+            producer->set("astream", -1);
+            return producer;
+        };
+        auto progress = [this](int percent) {
+            m_progress = percent;
+            QMetaObject::invokeMethod(m_object, "updateJobProgress");
+        };
+        result = SceneDetector::analyse(createProducer, producerDuration, metrics, m_isCanceled, progress);
+        if (result && !metricsPath.isEmpty() && !SceneDetector::save(metricsPath, metrics)) {
+            qWarning() << "Cannot write scene detection data" << metricsPath;
+        }
+    }
     m_progress = 100;
     QMetaObject::invokeMethod(m_object, "updateJobProgress");
     if (result && !m_isCanceled) {
-        qDebug() << "========================\n\nGOR RESULTS: " << m_results << "\n\n=========";
-        auto binClip = pCore->projectItemModel()->getClipByBinID(QString::number(m_owner.itemId));
+        m_results = SceneDetector::detectCuts(metrics, m_threshold);
         if (m_markersType >= 0) {
             // Build json data for markers
             QJsonArray list;
             int ix = 1;
             int lastCut = 0;
-            for (auto &marker : m_results) {
-                int pos = GenTime(marker).frames(pCore->getCurrentFps());
+            for (int pos : std::as_const(m_results)) {
                 if (m_minInterval > 0 && ix > 1 && pos - lastCut < m_minInterval) {
                     continue;
                 }
@@ -195,8 +174,7 @@ void SceneSplitTask::run()
             int lastCut = 0;
             QJsonArray list;
             QJsonDocument json;
-            for (double &marker : m_results) {
-                int pos = GenTime(marker).frames(pCore->getCurrentFps());
+            for (int pos : std::as_const(m_results)) {
                 if (pos <= lastCut + 1 || pos - lastCut < m_minInterval) {
                     continue;
                 }
@@ -222,72 +200,8 @@ void SceneSplitTask::run()
                                           Q_ARG(QString, dataMap), Q_ARG(bool, true));
             }
         }
-    } else {
-        // Proxy process crashed
-        QMetaObject::invokeMethod(pCore.get(), "displayBinLogMessage", Qt::QueuedConnection, Q_ARG(QString, i18n("Failed to analyse clip.")),
-                                  Q_ARG(int, int(KMessageWidget::Warning)), Q_ARG(QString, m_logDetails));
-    }
-}
-
-void SceneSplitTask::processLogErr()
-{
-    const QString buffer = QString::fromUtf8(m_jobProcess->readAllStandardError());
-    qDebug() << "ERROR: ----\n" << buffer;
-}
-
-void SceneSplitTask::processLogInfo()
-{
-    const QString buffer = QString::fromUtf8(m_jobProcess->readAllStandardOutput());
-    m_logDetails.append(buffer);
-    int progress = 0;
-    // Parse FFmpeg output
-    qDebug() << "-------------\n" << buffer;
-    if (buffer.contains(QLatin1String("[Parsed_showinfo"))) {
-        QString timeMarker("pts_time:");
-        bool ok;
-        QStringList output = buffer.split("[Parsed_showinfo");
-        output.removeFirst();
-        for (const QString &o : std::as_const(output)) {
-            if (o.contains(timeMarker)) {
-                double res = o.section(timeMarker, 1).section(QLatin1Char(' '), 0, 0).toDouble(&ok);
-                if (ok) {
-                    m_results << res;
-                }
-            }
-        }
-    }
-    if (m_jobDuration == 0) {
-        qDebug() << "=== NO DURATION!!!";
-        if (buffer.contains(QLatin1String("Duration:"))) {
-            QString data = buffer.section(QStringLiteral("Duration:"), 1, 1).section(QLatin1Char(','), 0, 0).simplified();
-            if (!data.isEmpty()) {
-                qDebug() << "==== GOT DURATION:" << data;
-                QStringList numbers = data.split(QLatin1Char(':'));
-                if (numbers.size() < 3) {
-                    return;
-                }
-                m_jobDuration = numbers.at(0).toInt() * 3600 + numbers.at(1).toInt() * 60 + numbers.at(2).toInt();
-            }
-        }
-    } else if (buffer.contains(QLatin1String("time="))) {
-        QString time = buffer.section(QStringLiteral("time="), 1, 1).simplified().section(QLatin1Char(' '), 0, 0);
-        qDebug() << "=== GOT PROGRESS TIME: " << time;
-        if (!time.isEmpty()) {
-            QStringList numbers = time.split(QLatin1Char(':'));
-            if (numbers.size() < 3) {
-                progress = time.toInt();
-                if (progress == 0) {
-                    return;
-                }
-            } else {
-                progress = numbers.at(0).toInt() * 3600 + numbers.at(1).toInt() * 60 + qRound(numbers.at(2).toDouble());
-            }
-        }
-        int val = 100 * progress / m_jobDuration;
-        if (m_progress != val) {
-            m_progress = val;
-            QMetaObject::invokeMethod(m_object, "updateJobProgress");
-        }
-        // Q_EMIT jobProgress(int(100.0 * progress / m_jobDuration));
+    } else if (!m_isCanceled) {
+        QMetaObject::invokeMethod(pCore.get(), "displayBinMessage", Qt::QueuedConnection, Q_ARG(QString, i18n("Failed to analyse clip.")),
+                                  Q_ARG(int, int(KMessageWidget::Warning)));
     }
 }
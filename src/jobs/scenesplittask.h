@@ -8,8 +8,6 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 
 #include "abstracttask.h"
 
-class QProcess;
-
 class SceneSplitTask : public AbstractTask
 {
 public:
@@ -19,18 +17,11 @@ public:
 protected:
     void run() override;
 
-private Q_SLOTS:
-    void processLogInfo();
-    void processLogErr();
-
 private:
     double m_threshold;
-    int m_jobDuration;
     int m_markersType;
     bool m_subClips;
     int m_minInterval;
-    std::unique_ptr<QProcess> m_jobProcess;
-    QString m_errorMessage;
-    QString m_logDetails;
-    QList<double> m_results;
+    /** @brief First frame of each detected scene */
+    QVector<int> m_results;
 };
@@ -13,6 +13,7 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include "kdenlivesettings.h"
 #include "macros.hpp"
 #include "undohelper.hpp"
+#include "utils/tracing.h"
 
 #include <KMessageWidget>
 #include <QFuture>
@@ -205,6 +206,7 @@ void TaskManager::taskDone(int cid, AbstractTask *task)
     }
     m_tasksListLock.unlock();
     // Set jobs count
+    TRACE_COUNTER("jobs", count);
     Q_EMIT jobCount(count);
     task->deleteLater();
 }
@@ -306,6 +308,7 @@ void TaskManager::startTask(int ownerId, AbstractTask *task)
     }
     m_tasksListLock.unlock();
     // Set jobs count
+    TRACE_COUNTER("jobs", count);
     Q_EMIT jobCount(count);
     if (task->m_type == AbstractTask::TRANSCODEJOB || task->m_type == AbstractTask::PROXYJOB) {
         // We only want a limited concurrent jobs for those as for example GPU usually only accept 2 concurrent encoding jobs
@@ -315,6 +318,14 @@ void TaskManager::startTask(int ownerId, AbstractTask *task)
     }
 }
 
+bool TaskManager::tryStartTranscode(std::function<void()> function)
+{
+    if (m_blockUpdates) {
+        return false;
+    }
+    return m_transcodePool.tryStart(std::move(function));
+}
+
 int TaskManager::getJobProgressForClip(const ObjectId &owner)
 {
     QStringList jobNames;
@@ -17,6 +17,7 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include <QReadWriteLock>
 #include <QThreadPool>
 #include <QUuid>
+#include <functional>
 #include <map>
 #include <memory>
 #include <unordered_map>
@@ -59,6 +60,10 @@ public:
     /** @brief Add a task in the list and push it on the thread pool */
     void startTask(int ownerId, AbstractTask *task);
 
+    /** @brief Run @param function on a free thread of the transcode pool, used by tasks to process parts of a job in parallel.
+     *  Returns false without queueing if all its threads are busy */
+    bool tryStartTranscode(std::function<void()> function);
+
     /** @brief Remove a finished task */
     void taskDone(int cid, AbstractTask *task);
 
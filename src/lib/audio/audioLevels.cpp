@@ -0,0 +1,83 @@
+/*
+    SPDX-FileCopyrightText: 2026 Kdenlive contributors
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#include "audioLevels.h"
+
+#include <QMutexLocker>
+
+AudioLevels::AudioLevels(int channels)
+    : m_channels(qMax(1, channels))
+{
+    m_pending.reserve(BlockSize);
+}
+
+std::shared_ptr<AudioLevels> AudioLevels::fromVector(const QVector<uint8_t> &levels, int channels)
+{
+    auto result = std::make_shared<AudioLevels>(channels);
+    for (uint8_t value : levels) {
+        result->append(value);
+    }
+    result->finish();
+    return result;
+}
+
+bool AudioLevels::append(uint8_t value)
+{
+    m_pending.append(value);
+    m_pendingMax = qMax(m_pendingMax, value);
+    if (m_pending.size() < BlockSize) {
+        return false;
+    }
+    publish();
+    return true;
+}
+
+void AudioLevels::publish()
+{
+    auto block = std::make_shared<const QVector<uint8_t>>(std::move(m_pending));
+    m_pending = QVector<uint8_t>();
+    m_pending.reserve(BlockSize);
+    QMutexLocker lock(&m_mutex);
+    m_count += block->size();
+    m_blocks.push_back(std::move(block));
+    m_max = qMax(m_max, m_pendingMax);
+}
+
+void AudioLevels::finish()
+{
+    if (!m_pending.isEmpty()) {
+        publish();
+    }
+    m_pending.squeeze();
+    QMutexLocker lock(&m_mutex);
+    m_complete = true;
+}
+
+bool AudioLevels::isComplete() const
+{
+    QMutexLocker lock(&m_mutex);
+    return m_complete;
+}
+
+int AudioLevels::count() const
+{
+    QMutexLocker lock(&m_mutex);
+    return m_count;
+}
+
+AudioLevels::Snapshot AudioLevels::snapshot() const
+{
+    Snapshot result;
+    QMutexLocker lock(&m_mutex);
+    result.m_blocks = m_blocks;
+    result.m_count = m_count;
+    return result;
+}
+
+uint8_t AudioLevels::maxLevel() const
+{
+    QMutexLocker lock(&m_mutex);
+    return m_max;
+}
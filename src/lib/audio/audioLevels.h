@@ -0,0 +1,70 @@
+/*
+    SPDX-FileCopyrightText: 2026 Kdenlive contributors
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#pragma once
+
+#include <QMutex>
+#include <QVector>
+#include <memory>
+#include <vector>
+
+/** @class AudioLevels
+    @brief The audio levels of a clip stream, used to draw its waveform.
+    Levels are channel interleaved, one value per channel and frame, and stored in fixed size blocks. The audio levels task appends
+    values and publishes each block once it is complete. Readers take a snapshot of the published blocks, so they never copy the levels
+    nor wait for the generation.
+ */
+class AudioLevels
+{
+public:
+    /** @brief Number of values in a block */
+    static constexpr int BlockSize = 16384;
+
+    /** @class Snapshot
+        @brief The levels published when it was taken, safe to read from any thread.
+     */
+    class Snapshot
+    {
+    public:
+        int count() const { return m_count; }
+        bool isEmpty() const { return m_count == 0; }
+        uint8_t at(int index) const { return m_blocks[size_t(index / BlockSize)]->at(index % BlockSize); }
+
+    private:
+        friend class AudioLevels;
+        std::vector<std::shared_ptr<const QVector<uint8_t>>> m_blocks;
+        int m_count{0};
+    };
+
+    explicit AudioLevels(int channels);
+    /** @brief Build complete levels from the values @param levels */
+    static std::shared_ptr<AudioLevels> fromVector(const QVector<uint8_t> &levels, int channels);
+
+    int channels() const { return m_channels; }
+    /** @brief Add a value, the current block is published when full. Only the generating thread may call this
+        @returns true if a block was published */
+    bool append(uint8_t value);
+    /** @brief Publish the values of the last, incomplete block. No value can be appended afterwards */
+    void finish();
+    /** @brief Returns true once all the levels were published */
+    bool isComplete() const;
+    /** @brief Number of published values */
+    int count() const;
+    Snapshot snapshot() const;
+    /** @brief Highest published level */
+    uint8_t maxLevel() const;
+
+private:
+    int m_channels;
+    mutable QMutex m_mutex;
+    std::vector<std::shared_ptr<const QVector<uint8_t>>> m_blocks;
+    int m_count{0};
+    uint8_t m_max{0};
+    bool m_complete{false};
+    /** @brief Values appended since the last published block, only used by the generating thread */
+    QVector<uint8_t> m_pending;
+    uint8_t m_pendingMax{0};
+    void publish();
+};
@@ -5,6 +5,8 @@
 
 #pragma once
 
+#include "utils/modellocker.h"
+
 /** This file contains a collection of macros that can be used in model related classes.
     The class only needs to have the following members:
     - For Push_undo : std::weak_ptr<DocUndoStack> m_undoStack;  this is a pointer to the undoStack
@@ -29,19 +31,18 @@
     };
 
 /** This convenience macro locks the mutex for reading.
-Note that it might happen that a thread is executing a write operation that requires
-reading a Read-protected property. In that case, we try to write lock it first (this will be granted since the lock is recursive)
+Reads are shared between threads. Note that it might happen that a thread is executing a write operation that requires
+reading a Read-protected property. In that case, the write lock is taken again (this will be granted since the lock is recursive)
+See ModelLocker
 */
-#define READ_LOCK()                                                                                                                                            \
-    std::unique_ptr<QReadLocker> rlocker(new QReadLocker(nullptr));                                                                                            \
-    std::unique_ptr<QWriteLocker> wlocker(new QWriteLocker(nullptr));                                                                                          \
-    if (m_lock.tryLockForWrite()) {                                                                                                                            \
-        /*we yield ownership of the lock to the WriteLocker*/                                                                                                  \
-        m_lock.unlock();                                                                                                                                       \
-        wlocker.reset(new QWriteLocker(&m_lock));                                                                                                              \
-    } else {                                                                                                                                                   \
-        rlocker.reset(new QReadLocker(&m_lock));                                                                                                               \
-    }
+#define READ_LOCK() ModelLocker rlocker(&m_lock)
+
+/** Same as READ_LOCK, but the lock is taken for writing when it is free. This is meant for the few operations that modify the model
+outside of an undo/redo lambda and might be called from a thread already holding the read lock, where a QWriteLocker would deadlock.
+Like the former READ_LOCK, this falls back to a shared read lock when another thread holds the lock, so it does not guarantee exclusive
+access: lazily created members must not be initialized under it.
+*/
+#define READ_WRITE_LOCK() ModelLocker rwlocker(&m_lock, ModelLocker::PreferWrite)
 
 /** @brief This macro takes some lambdas that represent undo/redo for an operation and the text (name) associated with this operation
  * The lambdas are transformed to make sure they lock access to the class they operate on.
@@ -55,6 +56,17 @@ reading a Read-protected property. In that case, we try to write lock it first (
         Q_ASSERT(false);                                                                                                                                       \
     }
 
+/** @brief Same as PUSH_UNDO, @param cost is the size in bytes of the data captured by the lambdas, see FunctionalUndoCommand::setMemoryCost */
+#define PUSH_UNDO_WITH_COST(undo, redo, text, cost)                                                                                                            \
+    if (auto ptr = m_undoStack.lock()) {                                                                                                                       \
+        auto *command = new FunctionalUndoCommand(undo, redo, text);                                                                                           \
+        command->setMemoryCost(cost);                                                                                                                          \
+        ptr->push(command);                                                                                                                                    \
+    } else {                                                                                                                                                   \
+        qDebug() << "ERROR : unable to access undo stack";                                                                                                     \
+        Q_ASSERT(false);                                                                                                                                       \
+    }
+
 /** @brief This macro takes as parameter one atomic operation and its reverse, and update
  * the undo and redo functional stacks/queue accordingly
  * This should be used in the rare case where we don't need a lock mutex. In general, prefer the other version
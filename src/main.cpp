@@ -16,6 +16,7 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include "kdenlivesettings.h"
 #include "mainwindow.h"
 #include "render/renderrequest.h"
+#include "utils/tracing.h"
 #include <config-kdenlive.h>
 #include <project/projectmanager.h>
 
@@ -176,6 +177,11 @@ int main(int argc, char *argv[])
 #ifdef CRASH_AUTO_TEST
     Logger::init();
 #endif
+    // Record a performance trace of the session, see Tracing
+    const QString traceFile = qEnvironmentVariable("KDENLIVE_TRACE_FILE");
+    if (!traceFile.isEmpty()) {
+        Tracing::setEnabled(true);
+    }
 
 #if defined(Q_OS_WIN)
     QQuickWindow::setGraphicsApi(QSGRendererInterface::Direct3D11);
@@ -506,8 +512,17 @@ int main(int argc, char *argv[])
         QObject::connect(pCore.get(), &Core::closeSplash, &splash, [&]() { splash.finish(pCore->window()); });
         pCore->initGUI(parser.value(mltPathOption), url, clipsToLoad);
         result = app.exec();
+#ifdef CRASH_AUTO_TEST
+        // Dump the recorded timeline operations, to be replayed as a performance workload by fuzz_replay
+        if (qEnvironmentVariableIsSet("KDENLIVE_RECORD_SESSION")) {
+            Logger::print_trace();
+        }
+#endif
     }
     Core::clean();
+    if (!traceFile.isEmpty()) {
+        Tracing::exportChromeTrace(traceFile);
+    }
     if (result == EXIT_RESTART || result == EXIT_CLEAN_RESTART) {
         qCDebug(KDENLIVE_LOG) << "restarting app";
         if (result == EXIT_CLEAN_RESTART) {
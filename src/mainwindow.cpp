@@ -67,7 +67,9 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include "titler/titlewidget.h"
 #include "transitions/transitionlist/view/transitionlistwidget.hpp"
 #include "transitions/transitionsrepository.hpp"
+#include "utils/cachemanager.h"
 #include "utils/thememanager.h"
+#include "utils/tracing.h"
 #include "widgets/progressbutton.h"
 #include <config-kdenlive.h>
 
@@ -87,6 +89,7 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include <KCoreAddons>
 #include <KDualAction>
 #include <KEditToolBar>
+#include <KIO/Global>
 #include <KIconTheme>
 #include <KLocalizedString>
 #include <KMessageBox>
@@ -422,7 +425,15 @@ void MainWindow::init(const QString &mltPath)
     m_undoView->setCleanIcon(QIcon::fromTheme(QStringLiteral("edit-clear")));
     m_undoView->setEmptyLabel(i18n("Clean"));
     m_undoView->setGroup(m_commandStack);
-    m_undoViewDock = addDock(i18n("Undo History"), QStringLiteral("undo_history"), m_undoView);
+    auto *undoWidget = new QWidget(this);
+    auto *undoLayout = new QVBoxLayout(undoWidget);
+    undoLayout->setContentsMargins(0, 0, 0, 0);
+    undoLayout->addWidget(m_undoView);
+    m_undoMemoryLabel = new QLabel(undoWidget);
+    m_undoMemoryLabel->setToolTip(i18n("Estimated memory used by the undo history"));
+    undoLayout->addWidget(m_undoMemoryLabel);
+    connect(m_commandStack, &QUndoGroup::activeStackChanged, this, &MainWindow::slotUndoStackChanged);
+    m_undoViewDock = addDock(i18n("Undo History"), QStringLiteral("undo_history"), undoWidget);
 
     // Color and icon theme stuff
     connect(m_commandStack, &QUndoGroup::cleanChanged, m_saveAction, &QAction::setDisabled);
@@ -1946,6 +1957,10 @@ void MainWindow::setupActions()
     });
 
     addAction(QStringLiteral("copy_debuginfo"), i18n("Copy Debug Information"), this, SLOT(slotCopyDebugInfo()), QIcon::fromTheme(QStringLiteral("edit-copy")));
+    QAction *recordTrace = addAction(QStringLiteral("record_trace"), i18n("Record Performance Trace"), this, SLOT(slotRecordTrace(bool)),
+                                     QIcon::fromTheme(QStringLiteral("media-record")));
+    recordTrace->setCheckable(true);
+    recordTrace->setChecked(Tracing::isEnabled());
 
     QAction *disableEffects = addAction(QStringLiteral("disable_timeline_effects"), i18n("Disable Timeline Effects"), pCore->projectManager(),
                                         SLOT(slotDisableTimelineEffects(bool)), QIcon::fromTheme(QStringLiteral("favorite")));
@@ -2624,6 +2639,23 @@ void MainWindow::updateConfiguration()
     loadClipActions();
 }
 
+void MainWindow::slotUndoStackChanged(QUndoStack *stack)
+{
+    disconnect(m_undoMemoryConnection);
+    auto *docStack = qobject_cast<DocUndoStack *>(stack);
+    if (docStack == nullptr) {
+        m_undoMemoryLabel->clear();
+        return;
+    }
+    m_undoMemoryConnection = connect(docStack, &DocUndoStack::memoryUsageChanged, this, &MainWindow::slotUpdateUndoMemory);
+    slotUpdateUndoMemory(docStack->memoryUsage());
+}
+
+void MainWindow::slotUpdateUndoMemory(qint64 bytes)
+{
+    m_undoMemoryLabel->setText(i18n("Memory: %1", KIO::convertSize(KIO::filesize_t(bytes))));
+}
+
 void MainWindow::slotSwitchVideoThumbs()
 {
     KdenliveSettings::setVideothumbnails(!KdenliveSettings::videothumbnails());
@@ -4717,6 +4749,27 @@ void MainWindow::slotCopyDebugInfo()
     clipboard->setText(debuginfo);
 }
 
+void MainWindow::slotRecordTrace(bool record)
+{
+    if (record) {
+        Tracing::clear();
+        Tracing::setEnabled(true);
+        pCore->displayMessage(i18n("Recording performance trace"), InformationMessage);
+        return;
+    }
+    Tracing::setEnabled(false);
+    const QString path = QFileDialog::getSaveFileName(this, i18nc("@title:window", "Save Performance Trace"), QDir::homePath(),
+                                                      i18n("Chrome Trace Files (*.json)"));
+    if (!path.isEmpty()) {
+        if (Tracing::exportChromeTrace(path)) {
+            pCore->displayMessage(i18n("Performance trace saved to %1", path), OperationCompletedMessage);
+        } else {
+            pCore->displayMessage(i18n("Cannot write file %1", path), ErrorMessage);
+        }
+    }
+    Tracing::clear();
+}
+
 bool MainWindow::eventFilter(QObject *object, QEvent *event)
 {
     switch (event->type()) {
@@ -4989,21 +5042,27 @@ void MainWindow::checkMaxCacheSize()
     QDir backupFolder(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + QStringLiteral("/.backup"));
     QList<QDir> toAdd;
     QList<QDir> toRemove;
-    if (cacheDir.exists()) {
-        toAdd << cacheDir;
-    }
     if (backupFolder.exists()) {
+        toAdd << backupFolder;
+    }
+    bool walkCache = false;
+    const auto &cacheManager = CacheManager::get();
+    if (cacheManager->isUpToDate() && QDir::cleanPath(cacheManager->root().absolutePath()) == QDir::cleanPath(cacheDir.absolutePath())) {
+        // The cache manifest knows the size of the cached data, proxies are not counted
+        total += KIO::filesize_t(cacheManager->totalSize(cacheDir.absolutePath()) - cacheManager->size(CacheProxy, QString(), cacheDir.absolutePath()));
+    } else if (cacheDir.exists()) {
         toAdd << cacheDir;
+        walkCache = true;
     }
-    if (cacheDir.cd(QStringLiteral("knewstuff"))) {
+    if (walkCache && cacheDir.cd(QStringLiteral("knewstuff"))) {
         toRemove << cacheDir;
         cacheDir.cdUp();
     }
-    if (cacheDir.cd(QStringLiteral("attica"))) {
+    if (walkCache && cacheDir.cd(QStringLiteral("attica"))) {
         toRemove << cacheDir;
         cacheDir.cdUp();
     }
-    if (cacheDir.cd(QStringLiteral("proxy"))) {
+    if (walkCache && cacheDir.cd(QStringLiteral("proxy"))) {
         toRemove << cacheDir;
         cacheDir.cdUp();
     }
@@ -254,6 +254,9 @@ private:
     AudioGraphSpectrum *m_audioSpectrum;
 
     QDockWidget *m_undoViewDock;
+    /** @brief Shows the memory used by the undo history */
+    QLabel *m_undoMemoryLabel;
+    QMetaObject::Connection m_undoMemoryConnection;
     QDockWidget *m_mixerDock;
     QDockWidget *m_onlineResourcesDock;
 
@@ -416,6 +419,9 @@ private Q_SLOTS:
     void loadDockActions();
     /** @brief Reflects setting changes to the GUI. */
     void updateConfiguration();
+    /** @brief Follow the memory usage of the active undo @param stack */
+    void slotUndoStackChanged(QUndoStack *stack);
+    void slotUpdateUndoMemory(qint64 bytes);
     void slotConnectMonitors();
     void slotSwitchMarkersComments();
     void slotSwitchSnap();
@@ -615,6 +621,8 @@ private Q_SLOTS:
     void slotSpeechRecognition();
     /** @brief Copy debug information like lib versions, gpu mode state,... to clipboard */
     void slotCopyDebugInfo();
+    /** @brief Start recording a performance trace, or stop it and save the trace in the Chrome trace format */
+    void slotRecordTrace(bool record);
     void slotRemoveBinDock(const QString &name);
     /** @brief Focus the guides list search line */
     void slotSearchGuide();
@@ -0,0 +1,136 @@
+/*
+    SPDX-FileCopyrightText: 2026 Kdenlive contributors
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#include "framecache.h"
+#include "scopes/sharedframe.h"
+
+#include <QtGlobal>
+
+MonitorFrameCache::MonitorFrameCache(qint64 budget)
+    : m_budget(budget)
+{
+}
+
+void MonitorFrameCache::setBudget(qint64 budget)
+{
+    QMutexLocker lk(&m_mutex);
+    m_budget.store(budget, std::memory_order_relaxed);
+    evict();
+}
+
+void MonitorFrameCache::setCaptureRange(int in, int out)
+{
+    QMutexLocker lk(&m_mutex);
+    m_captureIn = in;
+    m_captureOut = out;
+}
+
+void MonitorFrameCache::setAnchor(int position)
+{
+    QMutexLocker lk(&m_mutex);
+    m_anchor = position;
+}
+
+void MonitorFrameCache::store(const SharedFrame &frame)
+{
+    if (!isEnabled() || !frame.is_valid() || isCachedFrame(frame)) {
+        return;
+    }
+    const int position = frame.get_position();
+    {
+        QMutexLocker lk(&m_mutex);
+        if (position < m_captureIn || position > m_captureOut) {
+            return;
+        }
+    }
+    const qint64 bytes = mlt_image_format_size(frame.get_image_format(), frame.get_image_width(), frame.get_image_height(), nullptr);
+    if (bytes <= 0) {
+        return;
+    }
+    // Copy the image outside of the lock, the copy does not keep the producers of the original frame alive
+    Mlt::Frame copy = frame.clone(false, true);
+    copy.set("kdenlive:ramcache", 1);
+    QMutexLocker lk(&m_mutex);
+    auto existing = m_frames.find(position);
+    if (existing != m_frames.end()) {
+        m_size -= existing->bytes;
+        m_frames.erase(existing);
+    }
+    m_frames.insert(position, {copy, bytes});
+    m_size += bytes;
+    evict();
+}
+
+Mlt::Frame MonitorFrameCache::frame(int position) const
+{
+    QMutexLocker lk(&m_mutex);
+    auto it = m_frames.constFind(position);
+    if (it == m_frames.constEnd()) {
+        return Mlt::Frame();
+    }
+    return it->frame;
+}
+
+bool MonitorFrameCache::covers(int in, int out) const
+{
+    if (out < in) {
+        return false;
+    }
+    QMutexLocker lk(&m_mutex);
+    auto it = m_frames.constFind(in);
+    for (int pos = in; pos <= out; ++pos, ++it) {
+        if (it == m_frames.constEnd() || it.key() != pos) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void MonitorFrameCache::invalidate(int in, int out)
+{
+    QMutexLocker lk(&m_mutex);
+    auto it = m_frames.lowerBound(in);
+    while (it != m_frames.end() && (out < 0 || it.key() <= out)) {
+        m_size -= it->bytes;
+        it = m_frames.erase(it);
+    }
+}
+
+void MonitorFrameCache::clear()
+{
+    QMutexLocker lk(&m_mutex);
+    m_frames.clear();
+    m_size = 0;
+}
+
+qint64 MonitorFrameCache::size() const
+{
+    QMutexLocker lk(&m_mutex);
+    return m_size;
+}
+
+int MonitorFrameCache::count() const
+{
+    QMutexLocker lk(&m_mutex);
+    return int(m_frames.size());
+}
+
+bool MonitorFrameCache::isCachedFrame(const SharedFrame &frame)
+{
+    return frame.get_int("kdenlive:ramcache") == 1;
+}
+
+void MonitorFrameCache::evict()
+{
+    const qint64 budget = m_budget.load(std::memory_order_relaxed);
+    while (!m_frames.isEmpty() && m_size > budget) {
+        // Frames are sorted by position, so the farthest one from the anchor is either the first or the last
+        auto first = m_frames.begin();
+        auto last = std::prev(m_frames.end());
+        auto farthest = qAbs(first.key() - m_anchor) >= qAbs(last.key() - m_anchor) ? first : last;
+        m_size -= farthest->bytes;
+        m_frames.erase(farthest);
+    }
+}
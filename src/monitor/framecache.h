@@ -0,0 +1,67 @@
+/*
+    SPDX-FileCopyrightText: 2026 Kdenlive contributors
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#pragma once
+
+#include <QMap>
+#include <QMutex>
+
+#include <atomic>
+#include <mlt++/MltFrame.h>
+
+class SharedFrame;
+
+/** @class MonitorFrameCache
+    @brief Memory budgeted cache of the frames rendered by the project monitor.
+    The monitor stores the frames it displays while the user scrubs or loops a zone, so that seeking back to a
+    cached position does not re-render it and a zone whose frames are all cached can be played back from RAM.
+    When the budget is exceeded, the frames farthest from the anchor (playhead or zone start) are evicted first.
+    Cached frames are invalidated with the timeline ranges that change, see TimelineModel::invalidateZone
+    and TimelineModel::invalidateFrames.
+    All methods are thread safe.
+ */
+class MonitorFrameCache
+{
+public:
+    explicit MonitorFrameCache(qint64 budget = 0);
+
+    /** @brief Maximum memory used by the cached images, in bytes. A budget of 0 disables the cache */
+    void setBudget(qint64 budget);
+    bool isEnabled() const { return m_budget.load(std::memory_order_relaxed) > 0; }
+    /** @brief Only frames in this range are stored, an empty range (in > out) stops storing */
+    void setCaptureRange(int in, int out);
+    /** @brief Position around which frames are kept when evicting */
+    void setAnchor(int position);
+    /** @brief Store a copy of the image of a displayed frame, if its position is in the capture range */
+    void store(const SharedFrame &frame);
+    /** @brief The cached frame at @param position, or an invalid frame */
+    Mlt::Frame frame(int position) const;
+    /** @brief Returns true if all frames from @param in to @param out are cached */
+    bool covers(int in, int out) const;
+    /** @brief Discard the frames from @param in to @param out, everything after @param in if out is negative */
+    void invalidate(int in, int out);
+    void clear();
+    /** @brief Memory used by the cached images, in bytes */
+    qint64 size() const;
+    int count() const;
+    /** @brief Returns true if @param frame was served by a cache */
+    static bool isCachedFrame(const SharedFrame &frame);
+
+private:
+    struct Entry
+    {
+        Mlt::Frame frame;
+        qint64 bytes;
+    };
+    mutable QMutex m_mutex;
+    QMap<int, Entry> m_frames;
+    std::atomic<qint64> m_budget;
+    qint64 m_size{0};
+    int m_captureIn{0};
+    int m_captureOut{-1};
+    int m_anchor{0};
+    /** @brief Drop the frames farthest from the anchor until the budget is met, with m_mutex locked */
+    void evict();
+};
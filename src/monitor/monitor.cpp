@@ -716,6 +716,18 @@ void Monitor::setupMenu(QMenu *goMenu, QMenu *overlayMenu, QAction *playZone, QA
 
     m_configMenuAction->addAction(m_monitorManager->getAction("mlt_scrub"));
 
+    if (m_id == Kdenlive::ProjectMonitor) {
+        QAction *ramCache = new QAction(i18n("Cache Frames in RAM"), this);
+        ramCache->setToolTip(i18n("Keep rendered frames in memory to scrub and loop zones in real time"));
+        ramCache->setCheckable(true);
+        ramCache->setChecked(KdenliveSettings::monitorRamCache());
+        connect(ramCache, &QAction::triggered, this, [this](bool checked) {
+            KdenliveSettings::setMonitorRamCache(checked);
+            m_glMonitor->updateFrameCacheBudget();
+        });
+        m_configMenuAction->addAction(ramCache);
+    }
+
     QAction *switchAudioMonitor = new QAction(i18n("Show Audio Levels"), this);
     connect(switchAudioMonitor, &QAction::triggered, this, &Monitor::slotSwitchAudioMonitor);
     m_configMenuAction->addAction(switchAudioMonitor);
@@ -2644,8 +2656,10 @@ void Monitor::slotEditInlineMarker()
 void Monitor::prepareAudioThumb()
 {
     if (m_controller) {
-        m_glMonitor->getControllerProxy()->setAudioThumb();
-        if (!m_controller->audioStreams().isEmpty() && m_controller->hasAudio()) {
+        // Waveforms are not reset, they repaint the new levels as they are generated
+        if (m_controller->audioStreams().isEmpty() || !m_controller->hasAudio()) {
+            m_glMonitor->getControllerProxy()->setAudioThumb();
+        } else {
             QList<int> streamIndexes = m_controller->activeStreams().keys();
             if (streamIndexes.count() == 1 && streamIndexes.at(0) == INT_MAX) {
                 // Display all streams
@@ -2891,6 +2905,11 @@ void Monitor::purgeCache()
     m_glMonitor->purgeCache();
 }
 
+void Monitor::invalidateFrameCache(int in, int out)
+{
+    m_glMonitor->invalidateFrameCache(in, out);
+}
+
 void Monitor::updateBgColor()
 {
     m_glMonitor->setClearColor(KdenliveSettings::window_background());
@@ -364,6 +364,8 @@ public Q_SLOTS:
     void forceMonitorRefresh();
     /** @brief Clear read ahead cache, to ensure up to date audio */
     void purgeCache();
+    /** @brief Discard the RAM cached frames of a modified timeline range */
+    void invalidateFrameCache(int in, int out);
 
 Q_SIGNALS:
     void screenChanged(int screenIndex);
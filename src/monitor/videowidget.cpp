@@ -33,10 +33,12 @@
 
 #include "bin/model/markersortmodel.h"
 #include "core.h"
+#include "framecache.h"
 #include "monitorproxy.h"
 #include "profiles/profilemodel.hpp"
 #include "timeline2/view/qml/timelineitems.h"
 #include "timeline2/view/qmltypes/thumbnailprovider.h"
+#include "utils/tracing.h"
 #include "videowidget.h"
 #include <lib/localeHandling.h>
 #include <mlt++/Mlt.h>
@@ -108,6 +110,10 @@ VideoWidget::VideoWidget(int id, QObject *parent)
     if (!initGPUAccel()) {
         m_glslManager.reset();
     }
+    if (m_id == Kdenlive::ProjectMonitor) {
+        m_frameCache = std::make_unique<MonitorFrameCache>();
+        updateFrameCacheBudget();
+    }
     quickWindow()->setPersistentGraphics(true);
     quickWindow()->setPersistentSceneGraph(true);
     setResizeMode(QQuickWidget::SizeRootObjectToView);
@@ -150,6 +156,7 @@ void VideoWidget::updateAudioForAnalysis()
 void VideoWidget::initialize()
 {
     m_frameRenderer = new FrameRenderer();
+    m_frameRenderer->setFrameCache(m_frameCache.get());
     connect(m_frameRenderer, &FrameRenderer::frameDisplayed, this, &VideoWidget::onFrameDisplayed, Qt::QueuedConnection);
     connect(m_frameRenderer, &FrameRenderer::frameDisplayed, this, &VideoWidget::frameDisplayed, Qt::QueuedConnection);
     connect(m_frameRenderer, SIGNAL(imageReady()), SIGNAL(imageReady()));
@@ -301,6 +308,14 @@ void VideoWidget::requestSeek(int position, bool noAudioScrub)
     if (!m_consumer) {
         return;
     }
+    if (m_frameCache && m_frameCache->isEnabled() && qFuzzyIsNull(m_producer->get_speed())) {
+        // Keep the frames displayed while scrubbing, and display them from the cache when seeking back
+        m_frameCache->setAnchor(position);
+        m_frameCache->setCaptureRange(0, m_maxProducerPosition);
+        if ((noAudioScrub || !KdenliveSettings::audio_scrub()) && showCachedFrame(position)) {
+            return;
+        }
+    }
     if (!qFuzzyIsNull(m_producer->get_speed())) {
         m_consumer->purge();
     }
@@ -349,6 +364,7 @@ bool VideoWidget::checkFrameNumber(int pos, bool isPlaying)
             m_consumer->purge();
             if (!m_isLoopMode) {
                 // end play zone mode
+                setCachedPlayback(false);
                 m_isZoneMode = false;
                 m_producer->set_speed(0);
                 m_proxy->setSpeed(0);
@@ -358,6 +374,10 @@ bool VideoWidget::checkFrameNumber(int pos, bool isPlaying)
                 m_loopOut = 0;
                 return false;
             }
+            if (!m_cachedPlayback && m_frameCache && m_frameCache->isEnabled() && m_frameCache->covers(m_loopIn, m_loopOut - 1)) {
+                // The whole zone was rendered during the previous passes, play it from RAM
+                setCachedPlayback(true);
+            }
             m_producer->seek(m_isZoneMode ? m_proxy->zoneIn() : m_loopIn);
             m_producer->set_speed(1.0);
             m_proxy->setSpeed(1.);
@@ -591,6 +611,9 @@ int VideoWidget::setProducer(const std::shared_ptr<Mlt::Producer> &producer, boo
         consumerPosition = m_consumer->position();
     }
     stop();
+    if (m_frameCache && producer != m_producer) {
+        m_frameCache->clear();
+    }
     if (producer) {
         m_producer = producer;
     } else {
@@ -725,6 +748,12 @@ int VideoWidget::reconfigure()
             dropFrames = -dropFrames;
         }
         m_consumer->set("real_time", dropFrames);
+        // Cached frames may not match the new consumer settings
+        m_cachedPlayback = false;
+        m_consumer->set("video_off", 0);
+        if (m_frameCache) {
+            m_frameCache->clear();
+        }
         m_consumer->set("channels", pCore->audioChannels());
         if (KdenliveSettings::previewScaling() > 1) {
             m_consumer->set("scale", 1.0 / KdenliveSettings::previewScaling());
@@ -854,6 +883,7 @@ void VideoWidget::setZoom(float zoom, bool force)
 
 void VideoWidget::onFrameDisplayed(const SharedFrame &frame)
 {
+    TRACE_INSTANT("monitor", "frame displayed", "position", frame.get_position());
     m_mutex.lock();
     m_sharedFrame = frame;
     m_sendFrame = sendFrameForAnalysis;
@@ -863,6 +893,9 @@ void VideoWidget::onFrameDisplayed(const SharedFrame &frame)
 
 void VideoWidget::purgeCache()
 {
+    if (m_frameCache) {
+        m_frameCache->clear();
+    }
     if (m_consumer) {
         // m_consumer->set("buffer", 1);
         m_consumer->purge();
@@ -922,7 +955,18 @@ void VideoWidget::resetConsumer(bool fullReset)
 
 void VideoWidget::on_frame_show(mlt_consumer, VideoWidget *widget, mlt_event_data data)
 {
+    TRACE_SCOPE_NAMED("monitor", "frameShow");
     auto frame = Mlt::EventData(data).to_frame();
+    if (frame.is_valid() && widget->m_cachedPlayback) {
+        // Video rendering is off, display the cached image of this position
+        Mlt::Frame cached = widget->m_frameCache->frame(frame.get_position());
+        if (!cached.is_valid()) {
+            // The zone was modified
+            QMetaObject::invokeMethod(widget, "stopCachedPlayback", Qt::QueuedConnection);
+            return;
+        }
+        frame = cached;
+    }
     if (frame.is_valid() && frame.get_int("rendered")) {
         int timeout = (widget->consumer()->get_int("real_time") > 0) ? 0 : 1000;
         if ((widget->m_frameRenderer != nullptr) && widget->m_frameRenderer->semaphore()->tryAcquire(1, timeout)) {
@@ -984,8 +1028,12 @@ void FrameRenderer::requestImage()
 
 void FrameRenderer::showFrame(Mlt::Frame frame)
 {
+    TRACE_SCOPE("monitor");
     // Save this frame for future use and to keep a reference to the GL Texture.
     m_displayFrame = SharedFrame(frame);
+    if (m_frameCache && m_frameCache->isEnabled()) {
+        m_frameCache->store(m_displayFrame);
+    }
     Q_EMIT frameDisplayed(m_displayFrame);
     if (m_imageRequested) {
         m_imageRequested = false;
@@ -1020,6 +1068,10 @@ bool VideoWidget::switchPlay(bool play, double speed)
         resetZoneMode();
     }
     if (play) {
+        if (m_frameCache) {
+            // Frames are only kept while scrubbing or playing a zone
+            m_frameCache->setCaptureRange(0, -1);
+        }
         if (m_consumer->position() >= m_maxProducerPosition && speed > 0) {
             // We are at the end of the clip / timeline
             if (m_id == Kdenlive::ClipMonitor || (m_id == Kdenlive::ProjectMonitor && KdenliveSettings::jumptostart())) {
@@ -1103,6 +1155,14 @@ bool VideoWidget::playZone(int in, int out, bool startFromIn, bool loop, bool zo
     }
     m_isZoneMode = zoneMode;
     m_isLoopMode = loop;
+    if (m_frameCache && m_frameCache->isEnabled()) {
+        // Keep the frames of the zone, it will be played from RAM once they are all rendered
+        m_frameCache->setAnchor(m_loopIn);
+        m_frameCache->setCaptureRange(m_loopIn, m_loopOut);
+        if (m_frameCache->covers(m_loopIn, m_loopOut - 1)) {
+            setCachedPlayback(true);
+        }
+    }
     return true;
 }
 
@@ -1131,6 +1191,64 @@ void VideoWidget::resetZoneMode()
     m_loopOut = 0;
     m_isZoneMode = false;
     m_isLoopMode = false;
+    setCachedPlayback(false);
+    if (m_frameCache) {
+        m_frameCache->setCaptureRange(0, -1);
+    }
+}
+
+void VideoWidget::setCachedPlayback(bool enable)
+{
+    if (m_cachedPlayback == enable || !m_consumer) {
+        return;
+    }
+    m_cachedPlayback = enable;
+    // MLT only reads this property when the consumer starts, audio is still played by the consumer
+    m_consumer->set("video_off", enable ? 1 : 0);
+    if (!m_consumer->is_stopped()) {
+        m_consumer->purge();
+        m_consumer->stop();
+        restartConsumer();
+    }
+}
+
+void VideoWidget::stopCachedPlayback()
+{
+    if (!m_cachedPlayback) {
+        return;
+    }
+    setCachedPlayback(false);
+    m_consumer->set("refresh", 1);
+}
+
+bool VideoWidget::showCachedFrame(int position)
+{
+    Mlt::Frame cached = m_frameCache->frame(position);
+    if (!cached.is_valid() || m_frameRenderer == nullptr || !m_frameRenderer->semaphore()->tryAcquire()) {
+        return false;
+    }
+    QMetaObject::invokeMethod(m_frameRenderer, "showFrame", Qt::QueuedConnection, Q_ARG(Mlt::Frame, cached));
+    return true;
+}
+
+void VideoWidget::updateFrameCacheBudget()
+{
+    if (!m_frameCache) {
+        return;
+    }
+    // GPU accelerated frames are textures, they cannot be kept
+    const bool enabled = KdenliveSettings::monitorRamCache() && !m_glslManager;
+    m_frameCache->setBudget(enabled ? qint64(KdenliveSettings::monitorRamCacheSize()) * 1024 * 1024 : 0);
+    if (!enabled) {
+        m_frameCache->clear();
+    }
+}
+
+void VideoWidget::invalidateFrameCache(int in, int out)
+{
+    if (m_frameCache) {
+        m_frameCache->invalidate(in, out);
+    }
 }
 
 MonitorProxy *VideoWidget::getControllerProxy()
@@ -1292,6 +1410,9 @@ bool VideoWidget::updateScaling()
         return false;
     }
     m_profileSize = profileSize;
+    if (m_frameCache) {
+        m_frameCache->clear();
+    }
     pCore->getMonitorProfile().set_width(m_profileSize.width());
     pCore->getMonitorProfile().set_height(m_profileSize.height());
     if (m_consumer) {
@@ -18,6 +18,8 @@
 #include <QThread>
 #include <QTimer>
 
+#include <atomic>
+
 #include "bin/model/markerlistmodel.hpp"
 #include "definitions.h"
 #include "kdenlivesettings.h"
@@ -35,6 +37,7 @@ class Consumer;
 
 class RenderThread;
 class FrameRenderer;
+class MonitorFrameCache;
 class MonitorProxy;
 class MarkerSortModel;
 
@@ -123,6 +126,10 @@ public:
     virtual const QStringList getGPUInfo();
     /** @brief Returns the current frame as image */
     QImage image() const;
+    /** @brief Apply the RAM cache settings (project monitor only) */
+    void updateFrameCacheBudget();
+    /** @brief Discard the cached frames of a modified timeline range */
+    void invalidateFrameCache(int in, int out);
 
 protected:
     void mouseReleaseEvent(QMouseEvent *event) override;
@@ -232,6 +239,10 @@ private:
     MonitorProxy *m_proxy;
     std::unique_ptr<RenderThread> m_renderThread;
     std::shared_ptr<Mlt::Producer> m_blackClip;
+    /** @brief Rendered frames of the project monitor, see MonitorFrameCache */
+    std::unique_ptr<MonitorFrameCache> m_frameCache;
+    /** @brief True when the consumer only plays audio and the frames are displayed from m_frameCache */
+    std::atomic_bool m_cachedPlayback{false};
     static void on_frame_show(mlt_consumer, VideoWidget *widget, mlt_event_data);
     static void on_frame_render(mlt_consumer, VideoWidget *widget, mlt_frame frame);
     /*static void on_gl_frame_show(mlt_consumer, VideoWidget *widget, mlt_event_data data);
@@ -239,6 +250,11 @@ private:
 
     void refreshSceneLayout();
     void resetZoneMode();
+    /** @brief Switch video rendering off and display the cached frames, or switch back to normal playback */
+    void setCachedPlayback(bool enable);
+    /** @brief Display the cached frame at @param position without rendering it
+     *  @returns false if it is not cached */
+    bool showCachedFrame(int position);
     bool initGPUAccel();
     void disableGPUAccel();
     /** @brief Restart consumer, keeping preview scaling settings */
@@ -259,6 +275,8 @@ private Q_SLOTS:
     void switchRecordState(bool on);
     /** @brief Enforce a zoom refresh, can be useful when switching to/from fullscreen to adjust image size/position */
     void forceRefreshZoom();
+    /** @brief A frame of the played zone is missing from the cache, resume normal playback */
+    void stopCachedPlayback();
 
 protected:
     void resizeEvent(QResizeEvent *event) override;
@@ -291,6 +309,8 @@ public:
     explicit FrameRenderer();
     ~FrameRenderer();
     QSemaphore *semaphore() { return &m_semaphore; }
+    /** @brief Displayed frames are stored in @param cache when it is enabled */
+    void setFrameCache(MonitorFrameCache *cache) { m_frameCache = cache; }
     SharedFrame getDisplayFrame();
     Q_INVOKABLE void showFrame(Mlt::Frame frame);
     void requestImage();
@@ -305,4 +325,5 @@ private:
     SharedFrame m_displayFrame;
     bool m_imageRequested;
     QImage m_image;
+    MonitorFrameCache *m_frameCache{nullptr};
 };
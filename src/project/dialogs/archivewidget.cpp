@@ -105,6 +105,7 @@ ArchiveWidget::ArchiveWidget(const QString &projectName, const QString &xmlData,
     // subtitles->setData(0, Qt::UserRole, QStringLiteral("subtitles"));
     subtitles->setExpanded(false);
 
+    // Pending subtitle edits are written before the files are measured and copied
     QStringList subtitlePath = pCore->currentDoc()->getAllSubtitlesPath(true);
     for (auto &path : subtitlePath) {
         QFileInfo info(path);
@@ -10,6 +10,7 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include "core.h"
 #include "doc/kdenlivedoc.h"
 #include "kdenlivesettings.h"
+#include "utils/cachemanager.h"
 
 #include <KLocalizedString>
 #include <KMessageBox>
@@ -208,16 +209,36 @@ TemporaryData::TemporaryData(KdenliveDoc *doc, bool currentProjectOnly, QWidget
 void TemporaryData::updateDataInfo()
 {
     m_totalCurrent = 0;
+    m_currentSizes = {0, 0, 0, 0, 0};
     bool ok = false;
     QDir preview = m_doc->getCacheDir(CacheBase, &ok);
     if (!ok) {
         projectPage->setEnabled(false);
         return;
     }
+    if (isManaged(preview)) {
+        // The cache manifest knows the size of each folder
+        const QString owner = preview.dirName();
+        const auto &manager = CacheManager::get();
+        gotPreviewSize(KIO::filesize_t(manager->size(CachePreview, owner)));
+        KIO::filesize_t proxySize = 0;
+        const QDir proxyDir = m_doc->getCacheDir(CacheProxy, &ok);
+        for (const QString &hash : m_doc->getProxyHashList()) {
+            proxySize += KIO::filesize_t(manager->usage(proxyDir.absoluteFilePath(hash)).size);
+        }
+        gotProxySize(proxySize);
+        gotAudioSize(KIO::filesize_t(manager->size(CacheAudio, owner)));
+        gotSequenceSize(KIO::filesize_t(manager->size(CacheSequence, owner) + manager->size(CacheTmpWorkFiles, owner)));
+        gotThumbSize(KIO::filesize_t(manager->size(CacheThumbs, owner)));
+        if (!m_currentProjectOnly) {
+            updateGlobalInfo();
+        }
+        return;
+    }
     preview = m_doc->getCacheDir(CachePreview, &ok);
     if (ok) {
         KIO::DirectorySizeJob *job = KIO::directorySize(QUrl::fromLocalFile(preview.absolutePath()));
-        connect(job, &KIO::DirectorySizeJob::result, this, &TemporaryData::gotPreviewSize);
+        connect(job, &KIO::DirectorySizeJob::result, this, [this](KJob *job) { gotPreviewSize(jobSize(job)); });
     }
 
     preview = m_doc->getCacheDir(CacheProxy, &ok);
@@ -239,35 +260,30 @@ void TemporaryData::updateDataInfo()
     preview = m_doc->getCacheDir(CacheAudio, &ok);
     if (ok) {
         KIO::DirectorySizeJob *job = KIO::directorySize(QUrl::fromLocalFile(preview.absolutePath()));
-        connect(job, &KIO::DirectorySizeJob::result, this, &TemporaryData::gotAudioSize);
+        connect(job, &KIO::DirectorySizeJob::result, this, [this](KJob *job) { gotAudioSize(jobSize(job)); });
     }
     preview = m_doc->getCacheDir(CacheSequence, &ok);
     if (ok) {
         KIO::DirectorySizeJob *job = KIO::directorySize(QUrl::fromLocalFile(preview.absolutePath()));
-        connect(job, &KIO::DirectorySizeJob::result, this, &TemporaryData::gotSequenceSize);
+        connect(job, &KIO::DirectorySizeJob::result, this, [this](KJob *job) { gotSequenceSize(jobSize(job)); });
     }
     preview = m_doc->getCacheDir(CacheTmpWorkFiles, &ok);
     if (ok) {
         KIO::DirectorySizeJob *job = KIO::directorySize(QUrl::fromLocalFile(preview.absolutePath()));
-        connect(job, &KIO::DirectorySizeJob::result, this, &TemporaryData::gotSequenceSize);
+        connect(job, &KIO::DirectorySizeJob::result, this, [this](KJob *job) { gotSequenceSize(jobSize(job)); });
     }
     preview = m_doc->getCacheDir(CacheThumbs, &ok);
     if (ok) {
         KIO::DirectorySizeJob *job = KIO::directorySize(QUrl::fromLocalFile(preview.absolutePath()));
-        connect(job, &KIO::DirectorySizeJob::result, this, &TemporaryData::gotThumbSize);
+        connect(job, &KIO::DirectorySizeJob::result, this, [this](KJob *job) { gotThumbSize(jobSize(job)); });
     }
     if (!m_currentProjectOnly) {
         updateGlobalInfo();
     }
 }
 
-void TemporaryData::gotPreviewSize(KJob *job)
+void TemporaryData::gotPreviewSize(KIO::filesize_t total)
 {
-    auto *sourceJob = static_cast<KIO::DirectorySizeJob *>(job);
-    KIO::filesize_t total = sourceJob->totalSize();
-    if (sourceJob->totalFiles() == 0) {
-        total = 0;
-    }
     delPreview->setEnabled(total > 0);
     m_totalCurrent += total;
     m_currentSizes[0] = total;
@@ -284,13 +300,8 @@ void TemporaryData::gotProxySize(KIO::filesize_t total)
     updateTotal();
 }
 
-void TemporaryData::gotAudioSize(KJob *job)
+void TemporaryData::gotAudioSize(KIO::filesize_t total)
 {
-    auto *sourceJob = static_cast<KIO::DirectorySizeJob *>(job);
-    KIO::filesize_t total = sourceJob->totalSize();
-    if (sourceJob->totalFiles() == 0) {
-        total = 0;
-    }
     delAudio->setEnabled(total > 0);
     m_totalCurrent += total;
     m_currentSizes[2] = total;
@@ -298,13 +309,8 @@ void TemporaryData::gotAudioSize(KJob *job)
     updateTotal();
 }
 
-void TemporaryData::gotThumbSize(KJob *job)
+void TemporaryData::gotThumbSize(KIO::filesize_t total)
 {
-    auto *sourceJob = static_cast<KIO::DirectorySizeJob *>(job);
-    KIO::filesize_t total = sourceJob->totalSize();
-    if (sourceJob->totalFiles() == 0) {
-        total = 0;
-    }
     delThumb->setEnabled(total > 0);
     m_totalCurrent += total;
     m_currentSizes[3] = total;
@@ -312,19 +318,29 @@ void TemporaryData::gotThumbSize(KJob *job)
     updateTotal();
 }
 
-void TemporaryData::gotSequenceSize(KJob *job)
+void TemporaryData::gotSequenceSize(KIO::filesize_t total)
 {
-    auto *sourceJob = static_cast<KIO::DirectorySizeJob *>(job);
-    KIO::filesize_t total = sourceJob->totalSize();
-    if (sourceJob->totalFiles() == 0) {
-        total = 0;
-    }
     m_totalCurrent += total;
     m_currentSizes[4] += total;
     sequenceSize->setText(KIO::convertSize(m_currentSizes.at(4)));
     updateTotal();
 }
 
+bool TemporaryData::isManaged(const QDir &dir) const
+{
+    const auto &manager = CacheManager::get();
+    return manager->isUpToDate() && manager->manages(dir.absolutePath());
+}
+
+KIO::filesize_t TemporaryData::jobSize(KJob *job)
+{
+    auto *sourceJob = static_cast<KIO::DirectorySizeJob *>(job);
+    if (sourceJob->totalFiles() == 0) {
+        return 0;
+    }
+    return sourceJob->totalSize();
+}
+
 void TemporaryData::updateTotal()
 {
     currentSize->setText(KIO::convertSize(m_totalCurrent));
@@ -356,6 +372,7 @@ void TemporaryData::deletePreview()
     if (dir.dirName() == QLatin1String("preview")) {
         dir.removeRecursively();
         dir.mkpath(QStringLiteral("."));
+        CacheManager::get()->recordDeletion(dir.absolutePath());
         Q_EMIT disablePreview();
         updateDataInfo();
     }
@@ -474,6 +491,8 @@ void TemporaryData::deleteProjectProxy()
     for (const QString &file : std::as_const(files)) {
         dir.remove(file);
     }
+    CacheManager::get()->refresh(dir.absolutePath());
+    CacheManager::get()->waitForDone();
     Q_EMIT disableProxies();
     updateDataInfo();
 }
@@ -493,6 +512,7 @@ void TemporaryData::deleteAudio()
     if (dir.dirName() == QLatin1String("audiothumbs")) {
         dir.removeRecursively();
         dir.mkpath(QStringLiteral("."));
+        CacheManager::get()->recordDeletion(dir.absolutePath());
         updateDataInfo();
     }
 }
@@ -512,6 +532,7 @@ void TemporaryData::deleteThumbs()
     if (dir.dirName() == QLatin1String("videothumbs")) {
         dir.removeRecursively();
         dir.mkpath(QStringLiteral("."));
+        CacheManager::get()->recordDeletion(dir.absolutePath());
         updateDataInfo();
     }
 }
@@ -532,6 +553,7 @@ void TemporaryData::deleteCurrentCacheData(bool warn)
         Q_EMIT disablePreview();
         Q_EMIT disableProxies();
         dir.removeRecursively();
+        CacheManager::get()->recordDeletion(dir.absolutePath());
         m_doc->initCacheDirs();
         if (warn) {
             updateDataInfo();
@@ -558,14 +580,16 @@ void TemporaryData::processBackupDirectories()
 
 void TemporaryData::processProxyDirectory()
 {
+    if (isManaged(m_globalDir.absoluteFilePath(QStringLiteral("proxy")))) {
+        gotProjectProxySize(KIO::filesize_t(CacheManager::get()->size(CacheProxy, QString(), m_globalDir.absolutePath())));
+        return;
+    }
     KIO::DirectorySizeJob *job = KIO::directorySize(QUrl::fromLocalFile(m_globalDir.absoluteFilePath(QStringLiteral("proxy"))));
-    connect(job, &KIO::DirectorySizeJob::result, this, &TemporaryData::gotProjectProxySize);
+    connect(job, &KIO::DirectorySizeJob::result, this, [this](KJob *job) { gotProjectProxySize(jobSize(job)); });
 }
 
-void TemporaryData::gotProjectProxySize(KJob *job)
+void TemporaryData::gotProjectProxySize(KIO::filesize_t total)
 {
-    auto *sourceJob = static_cast<KIO::DirectorySizeJob *>(job);
-    KIO::filesize_t total = sourceJob->totalSize();
     m_totalProxy = total;
     refreshWarningMessage();
     gProxySize->setText(KIO::convertSize(total));
@@ -606,7 +630,18 @@ void TemporaryData::updateGlobalInfo()
     m_globalDirectories.removeAll(QStringLiteral("proxy"));
     gDelete->setEnabled(!m_globalDirectories.isEmpty());
     processProxyDirectory();
-    processglobalDirectories();
+    if (!m_globalDirectories.isEmpty() && isManaged(m_globalDir.absoluteFilePath(m_globalDirectories.constFirst()))) {
+        // The cache manifest knows the size and last use of each folder
+        const QStringList folders = m_globalDirectories;
+        m_globalDirectories.clear();
+        for (const QString &folder : folders) {
+            const CacheManager::Usage usage = CacheManager::get()->usage(m_globalDir.absoluteFilePath(folder));
+            const QDateTime date = usage.lastAccess.isValid() ? usage.lastAccess : QFileInfo(m_globalDir.absoluteFilePath(folder)).lastModified();
+            addFolderItem(folder, KIO::filesize_t(usage.size), date);
+        }
+    } else {
+        processglobalDirectories();
+    }
     listWidget->blockSignals(false);
 }
 
@@ -625,15 +660,19 @@ void TemporaryData::gotFolderSize(KJob *job)
     if (m_processingDirectory.isEmpty()) {
         return;
     }
-    auto *sourceJob = static_cast<KIO::DirectorySizeJob *>(job);
-    KIO::filesize_t total = sourceJob->totalSize();
-    if (sourceJob->totalFiles() == 0) {
-        total = 0;
+    const QString folder = m_processingDirectory;
+    addFolderItem(folder, jobSize(job), QFileInfo(m_globalDir.absoluteFilePath(folder)).lastModified());
+    if (!m_globalDirectories.isEmpty()) {
+        processglobalDirectories();
     }
+}
+
+void TemporaryData::addFolderItem(const QString &folder, KIO::filesize_t total, const QDateTime &date)
+{
     m_totalGlobal += total;
     auto *item = new TreeWidgetItem(listWidget);
     // Check last save path for this cache folder
-    QDir dir(m_globalDir.absoluteFilePath(m_processingDirectory));
+    QDir dir(m_globalDir.absoluteFilePath(folder));
     QStringList filters;
     filters << QStringLiteral("*.kdenlive");
     QStringList str = dir.entryList(filters, QDir::Files | QDir::Hidden, QDir::Time);
@@ -641,21 +680,20 @@ void TemporaryData::gotFolderSize(KJob *job)
         QString path = QUrl::fromPercentEncoding(str.at(0).toUtf8());
         // Remove leading dot
         path.remove(0, 1);
-        item->setText(0, m_processingDirectory + QStringLiteral(" (%1)").arg(QUrl::fromLocalFile(path).fileName()));
+        item->setText(0, folder + QStringLiteral(" (%1)").arg(QUrl::fromLocalFile(path).fileName()));
         if (QFile::exists(path)) {
             item->setIcon(0, QIcon::fromTheme(QStringLiteral("kdenlive")));
         } else {
             item->setIcon(0, QIcon::fromTheme(QStringLiteral("dialog-close")));
         }
     } else {
-        item->setText(0, m_processingDirectory);
-        if (m_processingDirectory == QLatin1String("proxy")) {
+        item->setText(0, folder);
+        if (folder == QLatin1String("proxy")) {
             item->setIcon(0, QIcon::fromTheme(QStringLiteral("kdenlive-show-video")));
         }
     }
-    item->setData(0, Qt::UserRole, m_processingDirectory);
+    item->setData(0, Qt::UserRole, folder);
     item->setText(1, KIO::convertSize(total));
-    QDateTime date = QFileInfo(dir.absolutePath()).lastModified();
     QLocale locale;
     item->setText(2, locale.toString(date, QLocale::ShortFormat));
     item->setData(1, Qt::UserRole, total);
@@ -668,8 +706,6 @@ void TemporaryData::gotFolderSize(KJob *job)
         refreshWarningMessage();
         gTotalSize->setText(KIO::convertSize(m_totalGlobal));
         listWidget->setCurrentItem(listWidget->topLevelItem(0));
-    } else {
-        processglobalDirectories();
     }
 }
 
@@ -733,6 +769,7 @@ void TemporaryData::deleteCache(QStringList &folders)
         }
         QDir toRemove(m_globalDir.filePath(folder));
         toRemove.removeRecursively();
+        CacheManager::get()->recordDeletion(toRemove.absolutePath());
     }
     updateGlobalInfo();
 }
@@ -751,6 +788,7 @@ void TemporaryData::deleteProxy()
     toRemove.removeRecursively();
     // We deleted proxy folder, recreate it
     toRemove.mkpath(QStringLiteral("."));
+    CacheManager::get()->recordDeletion(toRemove.absolutePath());
     processProxyDirectory();
 }
 
@@ -782,6 +820,8 @@ void TemporaryData::cleanProxy()
     for (const QString &f : std::as_const(oldFiles)) {
         proxies.remove(f);
     }
+    CacheManager::get()->refresh(proxies.absolutePath());
+    CacheManager::get()->waitForDone();
     processProxyDirectory();
 }
 
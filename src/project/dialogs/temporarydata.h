@@ -102,20 +102,26 @@ private:
     void processBackupDirectories();
     void processProxyDirectory();
     void deleteCache(QStringList &folders);
+    /** @brief Add the cache folder @param folder to the global list */
+    void addFolderItem(const QString &folder, KIO::filesize_t total, const QDateTime &date);
+    /** @brief Returns true if the sizes of the cache folder @param dir can be read from the cache manifest instead of walking the folder */
+    bool isManaged(const QDir &dir) const;
+    /** @brief Size counted by a KIO::DirectorySizeJob */
+    static KIO::filesize_t jobSize(KJob *job);
     /** @brief
      * Check if size of cache + backup data exceeds a limit and warn user
      **/
     void refreshWarningMessage();
 
 private Q_SLOTS:
-    void gotPreviewSize(KJob *job);
+    void gotPreviewSize(KIO::filesize_t total);
     void gotProxySize(KIO::filesize_t total);
-    void gotAudioSize(KJob *job);
-    void gotSequenceSize(KJob *job);
-    void gotThumbSize(KJob *job);
+    void gotAudioSize(KIO::filesize_t total);
+    void gotSequenceSize(KIO::filesize_t total);
+    void gotThumbSize(KIO::filesize_t total);
     void gotFolderSize(KJob *job);
     void gotBackupSize(KJob *job);
-    void gotProjectProxySize(KJob *job);
+    void gotProjectProxySize(KIO::filesize_t total);
     void refreshGlobalPie();
     void deletePreview();
     void deleteProjectProxy();
@@ -24,6 +24,7 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include "timeline2/model/timelinefunctions.hpp"
 #include "utils/qstringutils.h"
 #include "utils/thumbnailcache.hpp"
+#include "utils/tracing.h"
 #include "xml/xml.hpp"
 #include <audiomixer/mixermanager.hpp>
 #include <bin/clipcreator.hpp>
@@ -59,6 +60,7 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include <QMimeType>
 #include <QProgressDialog>
 #include <QSaveFile>
+#include <QTemporaryFile>
 #include <QTimeZone>
 #include <QUndoGroup>
 
@@ -523,6 +525,7 @@ bool ProjectManager::closeCurrentDocument(bool saveChanges, bool quit)
 
 bool ProjectManager::saveFileAs(const QString &outputFileName, bool saveOverExistingFile, bool saveACopy)
 {
+    TRACE_SCOPE_NAMED("project", "save");
     // Disable autosave while saving
     m_autoSaveTimer.stop();
     pCore->monitorManager()->pauseActiveMonitor();
@@ -544,16 +547,10 @@ bool ProjectManager::saveFileAs(const QString &outputFileName, bool saveOverExis
     QString saveFolder = QFileInfo(outputFileName).absolutePath();
     m_project->updateWorkFilesBeforeSave(outputFileName);
     checkProjectIntegrity();
-    QString scene = projectSceneList(saveFolder).first;
-    if (!m_replacementPattern.isEmpty()) {
-        QMapIterator<QString, QString> i(m_replacementPattern);
-        while (i.hasNext()) {
-            i.next();
-            scene.replace(i.key(), i.value());
-        }
-    }
+    QTemporaryFile sceneFile(QDir::temp().absoluteFilePath(QStringLiteral("kdenlive-XXXXXX.mlt")));
+    bool sceneWritten = projectSceneListToFile(saveFolder, sceneFile);
     m_project->updateWorkFilesAfterSave();
-    if (!m_project->saveSceneList(outputFileName, scene, saveOverExistingFile)) {
+    if (!sceneWritten || !m_project->saveSceneList(outputFileName, &sceneFile, m_replacementPattern, saveOverExistingFile)) {
         KNotification::event(QStringLiteral("ErrorMessage"), i18n("Saving project file <br><b>%1</B> failed", outputFileName), QPixmap());
         return false;
     }
@@ -816,6 +813,7 @@ void ProjectManager::abortLoading()
 
 void ProjectManager::doOpenFile(const QUrl &url, KAutoSaveFile *stale, bool isBackup)
 {
+    TRACE_SCOPE_NAMED("project", "open");
     Q_ASSERT(m_project == nullptr);
     m_fileRevert->setEnabled(true);
     ThumbnailCache::get()->clearCache();
@@ -1088,6 +1086,7 @@ void ProjectManager::abortProjectLoad(const QUrl &url)
 
 void ProjectManager::doOpenFileHeadless(const QUrl &url)
 {
+    TRACE_SCOPE_NAMED("project", "open");
     Q_ASSERT(m_project == nullptr);
     QUndoGroup *undoGroup = new QUndoGroup();
     std::shared_ptr<DocUndoStack> undoStack = std::make_shared<DocUndoStack>(nullptr);
@@ -1214,24 +1213,41 @@ void ProjectManager::slotAutoSave()
     }
     prepareSave();
     QString saveFolder = m_project->url().adjusted(QUrl::RemoveFilename | QUrl::StripTrailingSlash).toLocalFile();
-    QString scene = projectSceneList(saveFolder).first;
-    if (!m_replacementPattern.isEmpty()) {
-        QMapIterator<QString, QString> i(m_replacementPattern);
-        while (i.hasNext()) {
-            i.next();
-            scene.replace(i.key(), i.value());
-        }
-    }
-    if (!scene.contains(QLatin1String("<track "))) {
+    QTemporaryFile sceneFile(QDir::temp().absoluteFilePath(QStringLiteral("kdenlive-XXXXXX.mlt")));
+    if (!projectSceneListToFile(saveFolder, sceneFile) || !KdenliveDoc::checkSceneList(&sceneFile)) {
         // In some unexplained cases, the MLT playlist is corrupted and all tracks are deleted. Don't save in that case.
         pCore->displayMessage(i18n("Project was corrupted, cannot backup. Please close and reopen your project file to recover last backup"), ErrorMessage);
         return;
     }
-    m_project->slotAutoSave(scene);
+    m_project->slotAutoSave(&sceneFile, m_replacementPattern);
     m_lastSave.start();
 }
 
 std::pair<QString, QString> ProjectManager::projectSceneList(const QString &outputFolder, const QString &overlayData, const QString &aspectRatio)
+{
+    std::pair<QString, QString> scene;
+    exportSceneList([&](int duration) {
+        scene = pCore->projectItemModel()->sceneList(outputFolder, overlayData, m_activeTimelineModel->tractor(), duration, aspectRatio);
+    });
+    return scene;
+}
+
+bool ProjectManager::projectSceneListToFile(const QString &outputFolder, QTemporaryFile &sceneFile)
+{
+    // Create the file, it is written by MLT then read again from the start
+    if (!sceneFile.open()) {
+        qCWarning(KDENLIVE_LOG) << "Cannot create temporary file" << sceneFile.fileTemplate();
+        return false;
+    }
+    sceneFile.close();
+    bool result = false;
+    exportSceneList([&](int duration) {
+        result = pCore->projectItemModel()->sceneListToFile(outputFolder, m_activeTimelineModel->tractor(), duration, sceneFile.fileName());
+    });
+    return result && sceneFile.open();
+}
+
+void ProjectManager::exportSceneList(const std::function<void(int)> &exportFunction)
 {
     // Disable multitrack view and overlay
     bool isMultiTrack = pCore->monitorManager() && pCore->monitorManager()->isMultiTrack();
@@ -1252,8 +1268,7 @@ std::pair<QString, QString> ProjectManager::projectSceneList(const QString &outp
 
     // We must save from the primary timeline model
     int duration = pCore->window() ? pCore->window()->getCurrentTimeline()->controller()->duration() : m_activeTimelineModel->duration();
-    std::pair<QString, QString> scene =
-        pCore->projectItemModel()->sceneList(outputFolder, overlayData, m_activeTimelineModel->tractor(), duration, aspectRatio);
+    exportFunction(duration);
     if (pCore->mixer()) {
         pCore->mixer()->pauseMonitoring(false);
     }
@@ -1266,7 +1281,6 @@ std::pair<QString, QString> ProjectManager::projectSceneList(const QString &outp
     if (isTrimming) {
         pCore->window()->getCurrentTimeline()->controller()->requestStartTrimmingMode();
     }
-    return scene;
 }
 
 void ProjectManager::setDocumentNotes(QString &notes, QStringList deprecatedBinIds)
@@ -16,6 +16,7 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 
 #include "timeline2/model/timelineitemmodel.hpp"
 
+#include <functional>
 #include <memory>
 #include <unordered_map>
 #include <unordered_set>
@@ -28,6 +29,7 @@ class NotesPlugin;
 class Project;
 class QAction;
 class QProgressDialog;
+class QTemporaryFile;
 class QUrl;
 class DocUndoStack;
 class TimelineWidget;
@@ -69,6 +71,10 @@ public:
      * @param aspectRation The aspect ratio for the project (e.g. square).
      */
     std::pair<QString, QString> projectSceneList(const QString &outputFolder, const QString &overlayData = QString(), const QString &aspectRation = QString());
+    /** @brief Write current project's xml scene to @param sceneFile without keeping it in memory.
+     * On success, the file is open and ready to be read from the start.
+     */
+    bool projectSceneListToFile(const QString &outputFolder, QTemporaryFile &sceneFile);
     /** @brief returns a default hd profile depending on timezone*/
     static QString getDefaultProjectFormat();
     void saveZone(const QStringList &info, const QDir &dir);
@@ -255,6 +261,8 @@ private:
     bool checkForBackupFile(const QUrl &url, bool newFile = false);
     /** @brief Update the sequence producer stored in the project model. */
     void updateSequenceProducer(const QUuid &uuid, std::shared_ptr<Mlt::Producer> prod);
+    /** @brief Call @param exportFunction with the timeline duration, after disabling the timeline and monitor modes that must not be saved */
+    void exportSceneList(const std::function<void(int)> &exportFunction);
 
     std::shared_ptr<TimelineItemModel> m_activeTimelineModel;
     QElapsedTimer m_lastSave;
@@ -15,6 +15,8 @@
 
 #include <QTemporaryFile>
 
+#include <cmath>
+
 // TODO: remove, see generatePlaylistFile()
 #include <KMessageBox>
 #include <QInputDialog>
@@ -33,6 +35,58 @@ QStringList RenderRequest::argsByJob(const RenderJob &job, bool addPid)
     if (!job.subtitlePath.isEmpty()) {
         args << QStringLiteral("--subtitle") << job.subtitlePath;
     }
+    if (job.stemChannels > 0) {
+        args << QStringLiteral("--stem-channels") << QString::number(job.stemChannels);
+        if (!job.stemMaster.isEmpty()) {
+            args << QStringLiteral("--stem-master") << job.stemMaster;
+        }
+        for (const QString &path : job.stemPaths) {
+            args << QStringLiteral("--stem") << path;
+        }
+        if (!job.stemCodecArgs.isEmpty()) {
+            args << QStringLiteral("--stem-codec") << job.stemCodecArgs.join(QLatin1Char(' '));
+        }
+    }
+    return args;
+}
+
+QString RenderRequest::stemRouting(int channels, int totalChannels, int stemSlot, const QVector<double> &mixGains)
+{
+    // The track audio is in the first channels, the mix uses slot 0 and the stems the following slots. Unset channels are silent.
+    QStringList routes = {QStringLiteral("%1c").arg(totalChannels)};
+    for (int i = 0; i < mixGains.size(); ++i) {
+        if (qFuzzyCompare(mixGains.at(i), 1.)) {
+            routes << QStringLiteral("c%1=c%1").arg(i);
+        } else {
+            routes << QStringLiteral("c%1=%2*c%1").arg(i).arg(mixGains.at(i), 0, 'f', 6);
+        }
+    }
+    if (stemSlot > 0) {
+        for (int i = 0; i < channels; ++i) {
+            routes << QStringLiteral("c%1=c%2").arg(stemSlot * channels + i).arg(i);
+        }
+    }
+    return routes.join(QLatin1Char('|'));
+}
+
+QStringList RenderRequest::stemCodecArgs(const QDomElement &consumer)
+{
+    // The avformat consumer properties and the FFmpeg options they set
+    static const QList<QPair<QString, QString>> options = {{QStringLiteral("f"), QStringLiteral("-f")},
+                                                           {QStringLiteral("acodec"), QStringLiteral("-c:a")},
+                                                           {QStringLiteral("ab"), QStringLiteral("-b:a")},
+                                                           {QStringLiteral("aq"), QStringLiteral("-q:a")},
+                                                           {QStringLiteral("ar"), QStringLiteral("-ar")},
+                                                           {QStringLiteral("frequency"), QStringLiteral("-ar")},
+                                                           {QStringLiteral("sample_fmt"), QStringLiteral("-sample_fmt")},
+                                                           {QStringLiteral("compression_level"), QStringLiteral("-compression_level")}};
+    QStringList args;
+    for (const auto &option : options) {
+        const QString value = consumer.attribute(option.first);
+        if (!value.isEmpty() && !args.contains(option.second)) {
+            args << option.second << value;
+        }
+    }
     return args;
 }
 
@@ -107,6 +161,11 @@ void RenderRequest::setAudioFilePerTrack(bool enabled)
     m_audioFilePerTrack = enabled;
 }
 
+void RenderRequest::setStemMode(StemMode mode)
+{
+    m_stemMode = mode;
+}
+
 void RenderRequest::setGuideParams(std::weak_ptr<MarkerListModel> model, bool enableMultiExport, int filterCategory)
 {
     m_guidesModel = std::move(model);
@@ -134,6 +193,8 @@ std::vector<RenderRequest::RenderJob> RenderRequest::process()
     }
 
     KdenliveDoc *project = pCore->currentDoc();
+    // The rendered playlist reads the subtitle work files
+    project->flushSubtitleFiles();
 
     // On delayed rendering, make a copy of all assets
     if (m_delayedRendering) {
@@ -264,7 +325,11 @@ void RenderRequest::createRenderJobs(std::vector<RenderJob> &jobs, const QDomDoc
             addErrorMessage(i18n("Script rendering and multi track audio export can not be used together. Script will be saved without multi track export."));
             m_audioFilePerTrack = false;
         } else {
-            prepareMultiAudioFiles(jobs, doc, playlistPath, outputPath, uuid);
+            if (m_stemMode == StemMode::SeparateRenders) {
+                prepareMultiAudioFiles(jobs, doc, playlistPath, outputPath, uuid);
+            } else {
+                prepareStemFiles(jobs, doc, playlistPath, outputPath, uuid, pCore->audioChannels(), m_stemMode == StemMode::PreFader);
+            }
             QDomElement consumer = doc.documentElement().firstChildElement(QStringLiteral("consumer"));
             // If we are exporting an audio format, stop here
             if (consumer.hasAttribute(QLatin1String("vn")) || consumer.hasAttribute(QLatin1String("video_off"))) {
@@ -519,20 +584,7 @@ void RenderRequest::prepareMultiAudioFiles(std::vector<RenderJob> &jobs, const Q
 {
     int audioCount = 0;
     QDomNodeList orginalTractors = doc.elementsByTagName(QStringLiteral("tractor"));
-    // process in reversed order to make file naming fit to UI
-    QStringList trackIds;
-    for (int i = orginalTractors.size(); i >= 0; i--) {
-        auto originalTracktor = orginalTractors.at(i).toElement();
-        const QUuid tractorUuid(Xml::getXmlProperty(originalTracktor, QStringLiteral("kdenlive:uuid")));
-        if (tractorUuid == uuid) {
-            // We found the current timeline tractor, list its tracks
-            QDomNodeList childTracks = originalTracktor.elementsByTagName(QStringLiteral("track"));
-            for (int j = childTracks.size(); j >= 0; j--) {
-                trackIds << childTracks.at(j).toElement().attribute(QStringLiteral("producer"));
-            }
-            break;
-        }
-    }
+    const QStringList trackIds = timelineTrackIds(doc, uuid);
 
     for (int i = orginalTractors.size(); i >= 0; i--) {
         // Create a render job for each track, muting others
@@ -622,6 +674,196 @@ void RenderRequest::prepareMultiAudioFiles(std::vector<RenderJob> &jobs, const Q
     }
 }
 
+QStringList RenderRequest::timelineTrackIds(const QDomDocument &doc, const QUuid &uuid)
+{
+    QStringList trackIds;
+    QDomNodeList tractors = doc.elementsByTagName(QStringLiteral("tractor"));
+    for (int i = tractors.size() - 1; i >= 0; i--) {
+        auto tractor = tractors.at(i).toElement();
+        const QUuid tractorUuid(Xml::getXmlProperty(tractor, QStringLiteral("kdenlive:uuid")));
+        if (tractorUuid == uuid) {
+            // We found the current timeline tractor, list its tracks in reversed order to make file naming fit to UI
+            QDomNodeList childTracks = tractor.elementsByTagName(QStringLiteral("track"));
+            for (int j = childTracks.size() - 1; j >= 0; j--) {
+                trackIds << childTracks.at(j).toElement().attribute(QStringLiteral("producer"));
+            }
+            break;
+        }
+    }
+    return trackIds;
+}
+
+void RenderRequest::prepareStemFiles(std::vector<RenderJob> &jobs, const QDomDocument &doc, const QString &playlistFile, const QString &targetFile,
+                                     const QUuid &uuid, int channels, bool preFader)
+{
+    struct Stem
+    {
+        QString trackId;
+        QString outputPath;
+    };
+    channels = qMax(1, channels);
+    const QStringList trackIds = timelineTrackIds(doc, uuid);
+    QDomElement originalConsumer = doc.documentElement().firstChildElement(QStringLiteral("consumer"));
+    const bool audioExport = originalConsumer.hasAttribute(QLatin1String("vn")) || originalConsumer.hasAttribute(QLatin1String("video_off"));
+    auto outputFile = [&targetFile, audioExport](const QString &appendix) {
+        QString path = QStringUtils::appendToFilename(targetFile, appendix);
+        if (!audioExport) {
+            // The main render is a video, write the audio to wav files
+            QFileInfo render(path);
+            path = render.absoluteDir().absoluteFilePath(render.completeBaseName() + QStringLiteral(".wav"));
+        }
+        return path;
+    };
+
+    // List the audio tracks, named as with separate renders
+    std::vector<Stem> stems;
+    QDomNodeList tractors = doc.elementsByTagName(QStringLiteral("tractor"));
+    int audioCount = 0;
+    for (int i = tractors.size() - 1; i >= 0; i--) {
+        auto tractor = tractors.at(i).toElement();
+        const QString trackId = tractor.attribute(QStringLiteral("id"));
+        if (!trackIds.contains(trackId) || Xml::getXmlProperty(tractor, QStringLiteral("kdenlive:audio_track")).toInt() != 1) {
+            continue;
+        }
+        audioCount++;
+        QDomNodeList tracks = tractor.elementsByTagName(QStringLiteral("track"));
+        bool muted = true;
+        for (int l = 0; l < tracks.size(); l++) {
+            if (tracks.at(l).toElement().attribute(QStringLiteral("hide")) != QLatin1String("both")) {
+                muted = false;
+                break;
+            }
+        }
+        if (muted) {
+            continue;
+        }
+        QString trackName = Xml::getXmlProperty(tractor, QStringLiteral("kdenlive:track_name"));
+        const QString appendix = QStringLiteral("_A%1%2%3")
+                                     .arg(audioCount)
+                                     .arg(trackName.isEmpty() ? QString() : QStringLiteral("-"))
+                                     .arg(trackName.replace(QStringLiteral(" "), QStringLiteral("_")));
+        stems.push_back({trackId, outputFile(appendix)});
+    }
+    if (stems.empty()) {
+        return;
+    }
+
+    // Slot 0 holds the mix, each following slot a track
+    const int stemsPerPass = qMax(1, MaxStemPassChannels / channels - 1);
+    const int passes = int((stems.size() + size_t(stemsPerPass) - 1) / size_t(stemsPerPass));
+    for (int pass = 0; pass < passes; ++pass) {
+        const size_t first = size_t(pass * stemsPerPass);
+        const size_t last = qMin(stems.size(), first + size_t(stemsPerPass));
+        const int totalChannels = channels * int(last - first + 1);
+        RenderJob job;
+        job.playlistPath = QStringUtils::appendToFilename(playlistFile, QStringLiteral("_stems%1").arg(pass + 1));
+        QFileInfo target(targetFile);
+        job.outputPath = target.absoluteDir().absoluteFilePath(QStringLiteral("%1_stems%2.w64").arg(target.completeBaseName()).arg(pass + 1));
+        job.stemChannels = channels;
+        // The extracted files are encoded with the preset audio settings, or as the wav files of separate renders
+        job.stemCodecArgs = audioExport ? stemCodecArgs(originalConsumer) : QStringList({QStringLiteral("-c:a"), QStringLiteral("pcm_s16le")});
+        if (pass == 0) {
+            // With an audio export, the mix is the requested output
+            job.stemMaster = audioExport ? targetFile : outputFile(QStringLiteral("_mix"));
+        }
+
+        QDomDocument docCopy = doc.cloneNode(true).toDocument();
+        QDomElement consumer = docCopy.documentElement().firstChildElement(QStringLiteral("consumer"));
+        consumer.setAttribute(QStringLiteral("target"), job.outputPath);
+        consumer.setAttribute(QStringLiteral("video_off"), QStringLiteral("1"));
+        consumer.setAttribute(QStringLiteral("vn"), QStringLiteral("1"));
+        consumer.setAttribute(QStringLiteral("f"), QStringLiteral("w64"));
+        consumer.setAttribute(QStringLiteral("acodec"), QStringLiteral("pcm_f32le"));
+        consumer.setAttribute(QStringLiteral("channels"), totalChannels);
+        consumer.removeAttribute(QStringLiteral("ac"));
+        consumer.removeAttribute(QStringLiteral("channel_layout"));
+
+        QDomNodeList copyTractors = docCopy.elementsByTagName(QStringLiteral("tractor"));
+        for (int i = 0; i < copyTractors.size(); i++) {
+            auto tractor = copyTractors.at(i).toElement();
+            const QString trackId = tractor.attribute(QStringLiteral("id"));
+            if (!trackIds.contains(trackId)) {
+                // Not a track in current timeline
+                continue;
+            }
+            int stemSlot = 0;
+            for (size_t s = first; s < last; ++s) {
+                if (stems.at(s).trackId == trackId) {
+                    stemSlot = int(s - first) + 1;
+                    break;
+                }
+            }
+            if (pass > 0 && stemSlot == 0) {
+                // The mix was written by the first pass, only decode the tracks of this pass
+                QDomNodeList tracks = tractor.elementsByTagName(QStringLiteral("track"));
+                for (int l = 0; l < tracks.size(); l++) {
+                    tracks.at(l).toElement().setAttribute(QStringLiteral("hide"), QStringLiteral("both"));
+                }
+                continue;
+            }
+            QVector<double> mixGains;
+            if (pass == 0) {
+                mixGains.fill(1., channels);
+            }
+            QDomElement routing = docCopy.createElement(QStringLiteral("filter"));
+            routing.setAttribute(QStringLiteral("id"), QStringLiteral("%1_stem").arg(trackId));
+            QDomElement fader;
+            if (preFader && stemSlot > 0) {
+                // Route the track before the mixer volume and balance, which are then only applied to the mix
+                QList<QDomElement> faders;
+                bool animated = false;
+                QDomNodeList filters = tractor.elementsByTagName(QStringLiteral("filter"));
+                for (int f = 0; f < filters.size(); f++) {
+                    auto filter = filters.at(f).toElement();
+                    const QString service = Xml::getXmlProperty(filter, QStringLiteral("mlt_service"));
+                    if (Xml::getXmlProperty(filter, QStringLiteral("internal_added")) == QLatin1String("237") &&
+                        (service == QLatin1String("volume") || service == QLatin1String("panner"))) {
+                        faders << filter;
+                        animated = animated || Xml::getXmlProperty(filter, QStringLiteral("level")).contains(QLatin1Char('=')) ||
+                                   Xml::getXmlProperty(filter, QStringLiteral("start")).contains(QLatin1Char('='));
+                    }
+                }
+                // An animated fader cannot be applied to the mix channels only, use the post fader output
+                if (!animated && !faders.isEmpty()) {
+                    fader = faders.first();
+                    for (auto &filter : faders) {
+                        if (Xml::getXmlProperty(filter, QStringLiteral("disable")).toInt() == 1) {
+                            continue;
+                        }
+                        if (!mixGains.isEmpty() && Xml::getXmlProperty(filter, QStringLiteral("mlt_service")) == QLatin1String("volume")) {
+                            const double gain = pow(10, Xml::getXmlProperty(filter, QStringLiteral("level")).toDouble() / 20.);
+                            for (double &value : mixGains) {
+                                value *= gain;
+                            }
+                        } else if (!mixGains.isEmpty() && channels == 2) {
+                            // Same as the panner filter balance
+                            const double balance = Xml::getXmlProperty(filter, QStringLiteral("start"), QStringLiteral("0.5")).toDouble();
+                            if (balance < 0.5) {
+                                mixGains[1] *= balance * 2;
+                            } else {
+                                mixGains[0] *= (1. - balance) * 2;
+                            }
+                        }
+                        Xml::setXmlProperty(filter, QStringLiteral("disable"), QStringLiteral("1"));
+                    }
+                }
+            }
+            Xml::setXmlProperty(routing, QStringLiteral("mlt_service"), QStringLiteral("avfilter.pan"));
+            Xml::setXmlProperty(routing, QStringLiteral("av.args"), stemRouting(channels, totalChannels, stemSlot, mixGains));
+            if (fader.isNull()) {
+                tractor.appendChild(routing);
+            } else {
+                tractor.insertBefore(routing, fader);
+            }
+        }
+        for (size_t s = first; s < last; ++s) {
+            job.stemPaths << stems.at(s).outputPath;
+        }
+        jobs.push_back(job);
+        Xml::docContentToFile(docCopy, job.playlistPath);
+    }
+}
+
 void RenderRequest::addErrorMessage(const QString &error)
 {
     m_errors.append(error);
@@ -20,8 +20,25 @@ public:
         QString playlistPath;
         QString outputPath;
         QString subtitlePath;
+        /** @brief For a single pass stem render, the output is a multichannel file from which the mix (@var stemMaster, if not empty) and the tracks
+         *  (@var stemPaths) are extracted, each using @var stemChannels channels */
+        int stemChannels = 0;
+        QString stemMaster;
+        QStringList stemPaths;
+        /** @brief FFmpeg options encoding the extracted files like the render preset */
+        QStringList stemCodecArgs;
     };
 
+    /** @brief How the audio tracks are exported when there is a separate file for each audio track */
+    enum class StemMode {
+        SeparateRenders, /// one render job per track, the other tracks being muted
+        PostFader,       /// one render pass writing each track after its volume and balance, and the mix
+        PreFader         /// one render pass writing each track before its volume and balance, and the mix
+    };
+
+    /** @brief Maximum number of channels of a stem render pass, more tracks are split in several passes */
+    static constexpr int MaxStemPassChannels = 32;
+
     /** @brief Set frame range that should be rendered
      *  @param in The in point in frames. -1 means project start.
      *  @param out The out point in frames. -1 means project end.
@@ -37,6 +54,7 @@ public:
     void setTwoPass(bool enabled);
     void setAspectRatio(const QString &aspectRatio);
     void setAudioFilePerTrack(bool enabled);
+    void setStemMode(StemMode mode);
     void setGuideParams(std::weak_ptr<MarkerListModel> model, bool enableMultiExport, int filterCategory);
     void setOverlayData(const QString &data);
 
@@ -46,6 +64,13 @@ public:
 
     static QStringList argsByJob(const RenderJob &job, bool addPid = true);
 
+    /** @brief Arguments of the avfilter.pan filter routing the @param channels channels of a track in a stem render pass of @param totalChannels channels.
+     *  The track is copied to the channels of @param stemSlot (0 for none), and to the mix channels with @param mixGains (one per channel, empty for none)
+     */
+    static QString stemRouting(int channels, int totalChannels, int stemSlot, const QVector<double> &mixGains);
+    /** @brief FFmpeg options matching the audio format and codec properties of the MLT avformat @param consumer */
+    static QStringList stemCodecArgs(const QDomElement &consumer);
+
     /** @brief Some methods used for tests */
     int guideSectionsCount();
     QVector<std::pair<int, int>> getSectionsInOut();
@@ -68,6 +93,7 @@ private:
     bool m_proxyRendering = false;
     RenderPresetParams m_presetParams;
     bool m_audioFilePerTrack = false;
+    StemMode m_stemMode = StemMode::SeparateRenders;
     bool m_delayedRendering = false;
     QString m_outputFile;
     bool m_embedSubtitles = false;
@@ -84,6 +110,12 @@ private:
 
     static void prepareMultiAudioFiles(std::vector<RenderJob> &jobs, const QDomDocument &doc, const QString &playlistFile, const QString &targetFile,
                                        const QUuid &uuid);
+    /** @brief Create the jobs rendering the audio tracks and the mix in a single pass (or one pass per MaxStemPassChannels channels).
+     *  Each track is routed to its own channels of a multichannel file by a filter added to its tractor, the files are extracted after rendering */
+    static void prepareStemFiles(std::vector<RenderJob> &jobs, const QDomDocument &doc, const QString &playlistFile, const QString &targetFile,
+                                 const QUuid &uuid, int channels, bool preFader);
+    /** @brief Returns the ids of the track tractors of timeline @param uuid, from the top track */
+    static QStringList timelineTrackIds(const QDomDocument &doc, const QUuid &uuid);
 
     static QString createEmptyTempFile(const QString &extension);
 
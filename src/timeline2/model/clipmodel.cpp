@@ -1286,7 +1286,7 @@ ClipType::ProducerType ClipModel::clipType() const
 
 void ClipModel::passTimelineProperties(const std::shared_ptr<ClipModel> &other)
 {
-    READ_LOCK();
+    READ_WRITE_LOCK();
     Mlt::Properties source(m_producer->get_properties());
     Mlt::Properties dest(other->service()->get_properties());
     dest.pass_list(source, "kdenlive:hide_keyframes,kdenlive:activeeffect");
@@ -1320,6 +1320,12 @@ const QStringList ClipModel::externalFiles() const
     return m_effectStack->externalFiles();
 }
 
+qint64 ClipModel::memoryCost() const
+{
+    READ_LOCK();
+    return qint64(sizeof(ClipModel)) + m_effectStack->memoryCost();
+}
+
 QDomElement ClipModel::toXml(QDomDocument &document)
 {
     QDomElement container = document.createElement(QStringLiteral("clip"));
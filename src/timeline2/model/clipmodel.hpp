@@ -108,6 +108,8 @@ public:
 
     /** @brief Returns an XML representation of the clip with its effects */
     QDomElement toXml(QDomDocument &document);
+    /** @brief Returns the size in bytes of the clip model and its effect parameters, kept by the undo commands that hold this clip */
+    qint64 memoryCost() const;
 
     /** @brief Retrieve a list of all snaps for this clip */
     void allSnaps(std::vector<int> &snaps, int offset = 0) const;
@@ -231,7 +231,7 @@ int CompositionModel::getATrack() const
 
 void CompositionModel::setForceTrack(bool force)
 {
-    READ_LOCK();
+    READ_WRITE_LOCK();
     service()->set("force_track", force ? 1 : 0);
 }
 
@@ -25,6 +25,7 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include "timelineitemmodel.hpp"
 #include "trackmodel.hpp"
 #include "transitions/transitionsrepository.hpp"
+#include "utils/tracing.h"
 
 #include <KIO/RenameDialog>
 #include <KLocalizedString>
@@ -217,6 +218,7 @@ bool TimelineFunctions::requestClipCut(std::shared_ptr<TimelineItemModel> timeli
 {
     std::function<bool(void)> undo = []() { return true; };
     std::function<bool(void)> redo = []() { return true; };
+    TRACE_SCOPE("timeline");
     TRACE_STATIC(timeline, clipId, position);
     bool result = TimelineFunctions::requestClipCut(timeline, clipId, position, undo, redo);
     if (result) {
@@ -1872,7 +1874,8 @@ bool TimelineFunctions::pasteClips(const std::shared_ptr<TimelineItemModel> &tim
     std::function<bool(void)> undo = []() { return true; };
     std::function<bool(void)> redo = []() { return true; };
     if (TimelineFunctions::pasteClips(timeline, pasteString, trackId, position, undo, redo)) {
-        pCore->pushUndo(undo, redo, i18n("Paste clips"));
+        // Estimate the memory used by the pasted items with the size of their description
+        pCore->pushUndo(undo, redo, i18n("Paste clips"), pasteString.size() * qint64(sizeof(QChar)));
         return true;
     }
     return false;
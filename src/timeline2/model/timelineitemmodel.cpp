@@ -45,9 +45,34 @@ RTTR_REGISTRATION
 }
 #endif
 
+namespace {
+// Set while publishChange emits, so that its own signal does not discard the snapshot it just published
+thread_local bool publishingSnapshot = false;
+} // namespace
+
 TimelineItemModel::TimelineItemModel(const QUuid &uuid, std::weak_ptr<DocUndoStack> undo_stack)
     : TimelineModel(uuid, std::move(undo_stack))
 {
+    // Many places emit dataChanged directly, discard the snapshots of these items so that they get rebuilt on next read.
+    // These connections are made before any view connects, so that the snapshots are up to date when the views read the data.
+    // They are direct, so that the snapshots are discarded in the mutation path, whatever thread emits
+    connect(
+        this, &QAbstractItemModel::dataChanged, this,
+        [this](const QModelIndex &topleft, const QModelIndex &bottomright) {
+            if (!publishingSnapshot) {
+                invalidateSnapshots(topleft, bottomright);
+            }
+        },
+        Qt::DirectConnection);
+    connect(
+        this, &QAbstractItemModel::rowsAboutToBeRemoved, this,
+        [this](const QModelIndex &parent, int first, int last) {
+            if (parent.isValid()) {
+                invalidateSnapshots(index(first, 0, parent), index(last, 0, parent));
+            }
+        },
+        Qt::DirectConnection);
+    connect(this, &QAbstractItemModel::modelAboutToBeReset, this, [this]() { invalidateSnapshots(QModelIndex(), QModelIndex()); }, Qt::DirectConnection);
 }
 
 void TimelineItemModel::finishConstruct(const std::shared_ptr<TimelineItemModel> &ptr)
@@ -304,6 +329,12 @@ QHash<int, QByteArray> TimelineItemModel::roleNames() const
 
 QVariant TimelineItemModel::data(const QModelIndex &index, int role) const
 {
+    if (index.isValid() && DisplaySnapshot::contains(role)) {
+        // Published snapshots are immutable and discarded on change, they are read without locking the model
+        if (auto snapshot = publishedSnapshot(int(index.internalId()))) {
+            return snapshot->value(role);
+        }
+    }
     READ_LOCK();
     if (!m_tractor || !index.isValid()) {
         // qDebug() << "DATA abort. Index validity="<<index.isValid();
@@ -321,107 +352,29 @@ QVariant TimelineItemModel::data(const QModelIndex &index, int role) const
     }
     if (isClip(id)) {
         // qDebug() << "REQUESTING DATA "<<roleNames()[role]<<index;
+        if (DisplaySnapshot::contains(role)) {
+            return displaySnapshot(id)->value(role);
+        }
         std::shared_ptr<ClipModel> clip = m_allClips.at(id);
-        // Get data for a clip
+        // Data that changes too often to be part of the snapshot
         switch (role) {
-        // TODO
-        case NameRole:
-        case Qt::DisplayRole: {
-            return clip->clipName();
-        }
-        case ResourceRole: {
-            QString result = clip->getProperty("resource");
-            if (result == QLatin1String("<producer>")) {
-                result = clip->getProperty("mlt_service");
-            }
-            return result;
-        }
-        case StatusRole: {
-            return clip->clipStatus();
-        }
         case FakeTrackIdRole:
             return clip->getFakeTrackId();
         case FakePositionRole:
             return clip->getFakePosition();
-        case BinIdRole:
-            return clip->binId();
-        case TrackIdRole:
-            return clip->getCurrentTrackId();
-        case ServiceRole:
-            return clip->getProperty("mlt_service");
-            break;
-        case AudioChannelsRole:
-            return clip->audioChannels();
-        case AudioStreamRole:
-            return clip->audioStream();
-        case AudioMultiStreamRole:
-            return clip->audioMultiStream();
-        case AudioStreamIndexRole:
-            return clip->audioStreamIndex();
-        case HasAudio:
-            return clip->audioEnabled();
-        case IsAudioRole:
-            return clip->isAudioOnly();
-        case CanBeAudioRole:
-            return clip->canBeAudio();
-        case CanBeVideoRole:
-            return clip->canBeVideo();
-        case MarkersRole: {
-            return QVariant::fromValue<MarkerListModel *>(clip->getMarkerModel().get());
-        }
         case KeyframesRole: {
             return QVariant::fromValue<KeyframeModel *>(clip->getKeyframeModel());
         }
-        case PlaylistStateRole:
-            return QVariant::fromValue(clip->clipState());
-        case TypeRole:
-            return QVariant::fromValue(clip->clipType());
-        case StartRole:
-            return clip->getPosition();
-        case DurationRole:
-            return clip->getPlaytime();
-        case MaxDurationRole:
-            return clip->getMaxDuration();
         case GroupedRole:
             return m_groups->isInGroup(id);
-        case EffectNamesRole:
-            return clip->effectNames();
-        case EffectsEnabledRole:
-            return clip->stackEnabled();
-        case InPointRole:
-            return clip->getIn();
-        case OutPointRole:
-            return clip->getOut();
         case ShowKeyframesRole:
             return clip->showKeyframes();
-        case FadeInRole:
-            return clip->fadeIn();
-        case FadeOutRole:
-            return clip->fadeOut();
-        case FadeInMethodRole:
-            return clip->fadeMethod(true);
-        case FadeOutMethodRole:
-            return clip->fadeMethod(false);
-        case MixRole:
-            return clip->getMixDuration();
-        case MixCutRole:
-            return clip->getMixCutPosition();
-        case ClipThumbRole:
-            return clip->clipThumbPath();
         case ReloadAudioThumbRole:
             return clip->forceThumbReload;
-        case PositionOffsetRole:
-            return clip->getOffset();
-        case SpeedRole:
-            return clip->getSpeed();
         case GrabbedRole:
             return clip->isGrabbed();
         case SelectedRole:
             return clip->selected;
-        case TagRole:
-            return clip->clipTag();
-        case TimeRemapRole:
-            return clip->hasTimeRemap();
         default:
             break;
         }
@@ -477,56 +430,272 @@ QVariant TimelineItemModel::data(const QModelIndex &index, int role) const
             break;
         }
     } else if (isComposition(id)) {
+        if (DisplaySnapshot::contains(role)) {
+            return displaySnapshot(id)->value(role);
+        }
         std::shared_ptr<CompositionModel> compo = m_allCompositions.at(id);
+        switch (role) {
+        case GroupedRole:
+            return m_groups->isInGroup(id);
+        case KeyframesRole: {
+            return QVariant::fromValue<KeyframeModel *>(compo->getEffectKeyframeModel());
+        }
+        case FakeTrackIdRole:
+            return compo->getFakeTrackId();
+        case FakePositionRole:
+            return compo->getFakePosition();
+        case ShowKeyframesRole:
+            return compo->showKeyframes();
+        case GrabbedRole:
+            return compo->isGrabbed();
+        case SelectedRole:
+            return compo->selected;
+        default:
+            break;
+        }
+    } else {
+        qDebug() << "UNKNOWN DATA requested " << index << roleNames().value(role);
+    }
+    return QVariant();
+}
+
+bool TimelineItemModel::DisplaySnapshot::contains(int role)
+{
+    switch (role) {
+    case NameRole:
+    case Qt::DisplayRole:
+    case ResourceRole:
+    case StatusRole:
+    case BinIdRole:
+    case TrackIdRole:
+    case ServiceRole:
+    case AudioChannelsRole:
+    case AudioStreamRole:
+    case AudioMultiStreamRole:
+    case AudioStreamIndexRole:
+    case HasAudio:
+    case IsAudioRole:
+    case CanBeAudioRole:
+    case CanBeVideoRole:
+    case MarkersRole:
+    case PlaylistStateRole:
+    case TypeRole:
+    case StartRole:
+    case DurationRole:
+    case MaxDurationRole:
+    case EffectNamesRole:
+    case EffectsEnabledRole:
+    case InPointRole:
+    case OutPointRole:
+    case FadeInRole:
+    case FadeOutRole:
+    case FadeInMethodRole:
+    case FadeOutMethodRole:
+    case MixRole:
+    case MixCutRole:
+    case ClipThumbRole:
+    case PositionOffsetRole:
+    case SpeedRole:
+    case TagRole:
+    case TimeRemapRole:
+    case ItemATrack:
+        return true;
+    default:
+        return false;
+    }
+}
+
+QVariant TimelineItemModel::DisplaySnapshot::value(int role) const
+{
+    if (isComposition) {
         switch (role) {
         case NameRole:
         case Qt::DisplayRole:
         case ResourceRole:
         case ServiceRole:
-            return compo->displayName();
-            break;
+            return name;
         case TypeRole:
             return QVariant::fromValue(ClipType::ProducerType::Composition);
         case StartRole:
-            return compo->getPosition();
+            return position;
         case TrackIdRole:
-            return compo->getCurrentTrackId();
+            return trackId;
         case DurationRole:
-            return compo->getPlaytime();
-        case GroupedRole:
-            return m_groups->isInGroup(id);
+            return duration;
         case InPointRole:
             return 0;
         case OutPointRole:
             return 100;
         case BinIdRole:
             return 5;
-        case KeyframesRole: {
-            return QVariant::fromValue<KeyframeModel *>(compo->getEffectKeyframeModel());
-        }
-        case FakeTrackIdRole:
-            return compo->getFakeTrackId();
-        case FakePositionRole:
-            return compo->getFakePosition();
-        case ShowKeyframesRole:
-            return compo->showKeyframes();
         case ItemATrack:
-            return compo->getForcedTrack();
+            return forcedTrack;
         case MarkersRole: {
             QVariantList markersList;
             return markersList;
         }
-        case GrabbedRole:
-            return compo->isGrabbed();
-        case SelectedRole:
-            return compo->selected;
         default:
-            break;
+            return QVariant();
         }
+    }
+    switch (role) {
+    case NameRole:
+    case Qt::DisplayRole:
+        return name;
+    case ResourceRole:
+        return resource;
+    case StatusRole:
+        return status;
+    case BinIdRole:
+        return binId;
+    case TrackIdRole:
+        return trackId;
+    case ServiceRole:
+        return service;
+    case AudioChannelsRole:
+        return audioChannels;
+    case AudioStreamRole:
+        return audioStream;
+    case AudioMultiStreamRole:
+        return multiStream;
+    case AudioStreamIndexRole:
+        return audioStreamIndex;
+    case HasAudio:
+        return hasAudio;
+    case IsAudioRole:
+        return isAudio;
+    case CanBeAudioRole:
+        return canBeAudio;
+    case CanBeVideoRole:
+        return canBeVideo;
+    case MarkersRole:
+        return QVariant::fromValue<MarkerListModel *>(markers);
+    case PlaylistStateRole:
+        return QVariant::fromValue(state);
+    case TypeRole:
+        return QVariant::fromValue(type);
+    case StartRole:
+        return position;
+    case DurationRole:
+        return duration;
+    case MaxDurationRole:
+        return maxDuration;
+    case EffectNamesRole:
+        return effectNames;
+    case EffectsEnabledRole:
+        return stackEnabled;
+    case InPointRole:
+        return in;
+    case OutPointRole:
+        return out;
+    case FadeInRole:
+        return fadeIn;
+    case FadeOutRole:
+        return fadeOut;
+    case FadeInMethodRole:
+        return fadeInMethod;
+    case FadeOutMethodRole:
+        return fadeOutMethod;
+    case MixRole:
+        return mixDuration;
+    case MixCutRole:
+        return mixCut;
+    case ClipThumbRole:
+        return thumbPath;
+    case PositionOffsetRole:
+        return offset;
+    case SpeedRole:
+        return speed;
+    case TagRole:
+        return tag;
+    case TimeRemapRole:
+        return timeRemap;
+    default:
+        return QVariant();
+    }
+}
+
+std::shared_ptr<const TimelineItemModel::DisplaySnapshot> TimelineItemModel::buildSnapshot(int itemId) const
+{
+    READ_LOCK();
+    auto snapshot = std::make_shared<DisplaySnapshot>();
+    if (isClip(itemId)) {
+        std::shared_ptr<ClipModel> clip = m_allClips.at(itemId);
+        snapshot->name = clip->clipName();
+        snapshot->service = clip->getProperty("mlt_service");
+        snapshot->resource = clip->getProperty("resource");
+        if (snapshot->resource == QLatin1String("<producer>")) {
+            snapshot->resource = snapshot->service;
+        }
+        snapshot->status = clip->clipStatus();
+        snapshot->binId = clip->binId();
+        snapshot->trackId = clip->getCurrentTrackId();
+        snapshot->audioChannels = clip->audioChannels();
+        snapshot->audioStream = clip->audioStream();
+        snapshot->multiStream = clip->audioMultiStream();
+        snapshot->audioStreamIndex = clip->audioStreamIndex();
+        snapshot->hasAudio = clip->audioEnabled();
+        snapshot->isAudio = clip->isAudioOnly();
+        snapshot->canBeAudio = clip->canBeAudio();
+        snapshot->canBeVideo = clip->canBeVideo();
+        snapshot->markers = clip->getMarkerModel().get();
+        snapshot->state = clip->clipState();
+        snapshot->type = clip->clipType();
+        snapshot->position = clip->getPosition();
+        snapshot->duration = clip->getPlaytime();
+        snapshot->maxDuration = clip->getMaxDuration();
+        snapshot->effectNames = clip->effectNames();
+        snapshot->stackEnabled = clip->stackEnabled();
+        snapshot->in = clip->getIn();
+        snapshot->out = clip->getOut();
+        snapshot->fadeIn = clip->fadeIn();
+        snapshot->fadeOut = clip->fadeOut();
+        snapshot->fadeInMethod = clip->fadeMethod(true);
+        snapshot->fadeOutMethod = clip->fadeMethod(false);
+        snapshot->mixDuration = clip->getMixDuration();
+        snapshot->mixCut = clip->getMixCutPosition();
+        snapshot->thumbPath = clip->clipThumbPath();
+        snapshot->offset = clip->getOffset();
+        snapshot->speed = clip->getSpeed();
+        snapshot->tag = clip->clipTag();
+        snapshot->timeRemap = clip->hasTimeRemap();
+    } else if (isComposition(itemId)) {
+        std::shared_ptr<CompositionModel> compo = m_allCompositions.at(itemId);
+        snapshot->isComposition = true;
+        snapshot->name = compo->displayName();
+        snapshot->position = compo->getPosition();
+        snapshot->trackId = compo->getCurrentTrackId();
+        snapshot->duration = compo->getPlaytime();
+        snapshot->forcedTrack = compo->getForcedTrack();
     } else {
-        qDebug() << "UNKNOWN DATA requested " << index << roleNames().value(role);
+        return nullptr;
+    }
+    return snapshot;
+}
+
+std::shared_ptr<const TimelineItemModel::DisplaySnapshot> TimelineItemModel::displaySnapshot(int itemId) const
+{
+    if (auto snapshot = publishedSnapshot(itemId)) {
+        return snapshot;
+    }
+    const quint64 generation = m_snapshotGeneration.load();
+    std::shared_ptr<const DisplaySnapshot> snapshot = buildSnapshot(itemId);
+    storeSnapshot(itemId, snapshot, generation);
+    return snapshot;
+}
+
+std::shared_ptr<const TimelineItemModel::DisplaySnapshot> TimelineItemModel::publishedSnapshot(int itemId) const
+{
+    QReadLocker lk(&m_snapshotLock);
+    return m_displaySnapshots.value(itemId);
+}
+
+void TimelineItemModel::storeSnapshot(int itemId, const std::shared_ptr<const DisplaySnapshot> &snapshot, quint64 generation) const
+{
+    QWriteLocker lk(&m_snapshotLock);
+    if (snapshot && m_snapshotGeneration.load() == generation) {
+        m_displaySnapshots.insert(itemId, snapshot);
     }
-    return QVariant();
 }
 
 void TimelineItemModel::setTrackName(int trackId, const QString &text)
@@ -634,6 +803,33 @@ QVariant TimelineItemModel::getTrackProperty(int tid, const QString &name) const
     return getTrackById_const(tid)->getProperty(name);
 }
 
+QList<int> TimelineItemModel::getItemIdsInRange(int trackId, int start, int end) const
+{
+    READ_LOCK();
+    if (!isTrack(trackId)) {
+        return {};
+    }
+    return getTrackById_const(trackId)->getItemIdsInRange(start, end);
+}
+
+bool TimelineItemModel::changesItemRange(const QList<int> &roles) const
+{
+    // An empty list means that all roles may have changed
+    return roles.isEmpty() || roles.contains(StartRole) || roles.contains(DurationRole);
+}
+
+QModelIndex TimelineItemModel::getItemIndex(int itemId) const
+{
+    READ_LOCK();
+    if (isClip(itemId) && getClipTrackId(itemId) != -1) {
+        return makeClipIndexFromID(itemId);
+    }
+    if (isComposition(itemId) && getCompositionTrackId(itemId) != -1) {
+        return makeCompositionIndexFromID(itemId);
+    }
+    return QModelIndex();
+}
+
 int TimelineItemModel::getFirstVideoTrackIndex() const
 {
     int trackId = -1;
@@ -704,14 +900,52 @@ void TimelineItemModel::notifyChange(const QModelIndex &topleft, const QModelInd
             roles.push_back(TimelineModel::OutPointRole);
         }
     }
-    Q_EMIT dataChanged(topleft, bottomright, roles);
+    publishChange(topleft, bottomright, roles);
 }
 
 void TimelineItemModel::notifyChange(const QModelIndex &topleft, const QModelIndex &bottomright, const QVector<int> &roles)
 {
+    publishChange(topleft, bottomright, roles);
+}
+
+void TimelineItemModel::publishChange(const QModelIndex &topleft, const QModelIndex &bottomright, QVector<int> roles)
+{
+    if (topleft == bottomright && topleft.isValid() && !roles.isEmpty()) {
+        const int id = int(topleft.internalId());
+        std::shared_ptr<const DisplaySnapshot> previous = publishedSnapshot(id);
+        const quint64 generation = m_snapshotGeneration.load();
+        // Without a previous snapshot, the item was not displayed yet and there is nothing to compare
+        std::shared_ptr<const DisplaySnapshot> current = previous ? buildSnapshot(id) : nullptr;
+        if (current) {
+            roles.erase(std::remove_if(roles.begin(), roles.end(),
+                                       [&previous, &current](int role) {
+                                           return DisplaySnapshot::contains(role) && previous->value(role) == current->value(role);
+                                       }),
+                        roles.end());
+            storeSnapshot(id, current, generation);
+            if (roles.isEmpty()) {
+                return;
+            }
+            publishingSnapshot = true;
+            Q_EMIT dataChanged(topleft, bottomright, roles);
+            publishingSnapshot = false;
+            return;
+        }
+    }
     Q_EMIT dataChanged(topleft, bottomright, roles);
 }
 
+void TimelineItemModel::invalidateSnapshots(const QModelIndex &topleft, const QModelIndex &bottomright)
+{
+    QWriteLocker lk(&m_snapshotLock);
+    ++m_snapshotGeneration;
+    if (topleft == bottomright && topleft.isValid()) {
+        m_displaySnapshots.remove(int(topleft.internalId()));
+    } else {
+        m_displaySnapshots.clear();
+    }
+}
+
 void TimelineItemModel::rebuildMixer()
 {
     if (pCore->mixer() == nullptr) {
@@ -801,7 +1035,7 @@ void TimelineItemModel::removeTrackCompositing()
 
 void TimelineItemModel::buildTrackCompositing(bool rebuild)
 {
-    READ_LOCK();
+    READ_WRITE_LOCK();
     bool isMultiTrack = pCore->enableMultiTrack(false);
     if (rebuild) {
         removeTrackCompositing();
@@ -865,7 +1099,7 @@ void TimelineItemModel::buildTrackCompositing(bool rebuild)
 
 void TimelineItemModel::notifyChange(const QModelIndex &topleft, const QModelIndex &bottomright, int role)
 {
-    Q_EMIT dataChanged(topleft, bottomright, {role});
+    publishChange(topleft, bottomright, {role});
 }
 
 void TimelineItemModel::_beginRemoveRows(const QModelIndex &i, int j, int k)
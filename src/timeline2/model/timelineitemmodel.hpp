@@ -9,6 +9,10 @@
 #include "timelinemodel.hpp"
 #include "undohelper.hpp"
 
+#include <QReadWriteLock>
+
+#include <atomic>
+
 class MarkerListModel;
 
 /** @class TimelineItemModel
@@ -78,6 +82,14 @@ public:
     */
     Q_INVOKABLE void setTrackName(int trackId, const QString &text);
     Q_INVOKABLE bool copyClipEffect(int clipId, const QString sourceId);
+    /** @brief Returns the ids of the clips and compositions of a track intersecting the frame range [start, end].
+       This is used by the QML timeline to only instantiate the delegates of the items around the visible area.
+    */
+    Q_INVOKABLE QList<int> getItemIdsInRange(int trackId, int start, int end) const;
+    /** @brief Returns the model index of the clip or composition @param itemId, invalid if it is not in a track */
+    Q_INVOKABLE QModelIndex getItemIndex(int itemId) const;
+    /** @brief Returns true if a change of these @param roles can move an item in or out of a frame range */
+    Q_INVOKABLE bool changesItemRange(const QList<int> &roles) const;
     /** @brief returns the lower video track index in timeline.
      **/
     int getFirstVideoTrackIndex() const;
@@ -124,6 +136,71 @@ protected:
     /** @brief This is an helper function that finishes a construction of a freshly created TimelineItemModel */
     static void finishConstruct(const std::shared_ptr<TimelineItemModel> &ptr);
 
+private:
+    /** @brief Immutable copy of the data displayed by the QML delegate of a clip or composition.
+       It is built on first read and rebuilt when the item is notified as changed, so that QML role reads
+       do not query the item (and its MLT properties) again.
+    */
+    struct DisplaySnapshot
+    {
+        QString name;
+        QString resource;
+        QString service;
+        QString binId;
+        QString effectNames;
+        QString thumbPath;
+        QString tag;
+        int trackId{-1};
+        int position{0};
+        int duration{0};
+        int in{0};
+        int out{0};
+        int maxDuration{0};
+        int mixDuration{0};
+        int mixCut{0};
+        int fadeIn{0};
+        int fadeOut{0};
+        int fadeInMethod{0};
+        int fadeOutMethod{0};
+        int offset{0};
+        int audioChannels{0};
+        int audioStream{0};
+        int audioStreamIndex{0};
+        int forcedTrack{-1};
+        double speed{1.};
+        FileStatus::ClipStatus status{FileStatus::StatusReady};
+        PlaylistState::ClipState state{PlaylistState::Disabled};
+        bool isComposition{false};
+        bool stackEnabled{true};
+        bool multiStream{false};
+        bool hasAudio{false};
+        bool isAudio{false};
+        bool canBeAudio{false};
+        bool canBeVideo{false};
+        bool timeRemap{false};
+        ClipType::ProducerType type{ClipType::Unknown};
+        MarkerListModel *markers{nullptr};
+        /** @brief Returns true if the role is served from the snapshot */
+        static bool contains(int role);
+        QVariant value(int role) const;
+    };
+    /** @brief Build the display snapshot of a clip or composition, nullptr for other items */
+    std::shared_ptr<const DisplaySnapshot> buildSnapshot(int itemId) const;
+    /** @brief Returns the current snapshot of an item, building it if needed, with the model locked */
+    std::shared_ptr<const DisplaySnapshot> displaySnapshot(int itemId) const;
+    /** @brief Returns the published snapshot of an item, nullptr if there is none. The model does not need to be locked */
+    std::shared_ptr<const DisplaySnapshot> publishedSnapshot(int itemId) const;
+    /** @brief Publish a snapshot built at @param generation, unless some snapshots were invalidated since then */
+    void storeSnapshot(int itemId, const std::shared_ptr<const DisplaySnapshot> &snapshot, quint64 generation) const;
+    /** @brief Rebuild the snapshot of the changed item and only emit dataChanged for the roles whose value changed */
+    void publishChange(const QModelIndex &topleft, const QModelIndex &bottomright, QVector<int> roles);
+    /** @brief Discard the snapshots of the items in the range, when their data changed outside of notifyChange */
+    void invalidateSnapshots(const QModelIndex &topleft, const QModelIndex &bottomright);
+    mutable QHash<int, std::shared_ptr<const DisplaySnapshot>> m_displaySnapshots;
+    mutable QReadWriteLock m_snapshotLock;
+    /** @brief Incremented by each invalidation, so that a snapshot built from older data is never published */
+    mutable std::atomic<quint64> m_snapshotGeneration{0};
+
 Q_SIGNALS:
     /** @brief Triggered when a video track visibility changed */
     void trackVisibilityChanged();
@@ -24,6 +24,7 @@
 #include "snapmodel.hpp"
 #include "timeline2/view/previewmanager.h"
 #include "timelinefunctions.hpp"
+#include "utils/tracing.h"
 
 #include "monitor/monitormanager.h"
 
@@ -141,6 +142,10 @@ TimelineModel::TimelineModel(const QUuid &uuid, std::weak_ptr<DocUndoStack> undo
         // This is not the main tractor
         m_tractor->set("id", uuid.toString().toUtf8().constData());
     }
+    // The master stack is created with the tractor, so that concurrent readers never have to create it
+    m_masterService.reset(new Mlt::Service(*m_tractor.get()));
+    m_masterStack = EffectStackModel::construct(m_masterService, ObjectId(KdenliveObjectType::Master, 0, m_uuid), m_undoStack);
+    connect(m_masterStack.get(), &EffectStackModel::updateMasterZones, pCore.get(), &Core::updateMasterZones);
     m_guidesFilterModel.reset(new MarkerSortModel(this));
     TRACE_CONSTR(this);
 }
@@ -1249,6 +1254,7 @@ bool TimelineModel::requestClipMix(const QString &mixId, std::pair<int, int> cli
 bool TimelineModel::requestFakeClipMove(int clipId, int trackId, int position, bool updateView, bool logUndo, bool invalidateTimeline)
 {
     QWriteLocker locker(&m_lock);
+    TRACE_SCOPE("timeline");
     TRACE(clipId, trackId, position, updateView, logUndo, invalidateTimeline)
     Q_ASSERT(m_allClips.count(clipId) > 0);
     bool groupMove = m_groups->isInGroup(clipId);
@@ -1281,6 +1287,7 @@ bool TimelineModel::requestClipMove(int clipId, int trackId, int position, bool
                                     bool revertMove)
 {
     QWriteLocker locker(&m_lock);
+    TRACE_SCOPE("timeline");
     TRACE(clipId, trackId, position, updateView, logUndo, invalidateTimeline);
     Q_ASSERT(m_allClips.count(clipId) > 0);
     if (m_allClips[clipId]->getPosition() == position && getClipTrackId(clipId) == trackId) {
@@ -1466,6 +1473,7 @@ int TimelineModel::suggestSubtitleMove(int subId, int newLayer, int position, in
 QVariantList TimelineModel::suggestClipMove(int clipId, int trackId, int position, int cursorPosition, int snapDistance, bool moveMirrorTracks, bool fakeMove)
 {
     QWriteLocker locker(&m_lock);
+    TRACE_SCOPE("timeline");
     TRACE(clipId, trackId, position, cursorPosition, snapDistance);
     Q_ASSERT(isClip(clipId));
     Q_ASSERT(isTrack(trackId));
@@ -1709,6 +1717,7 @@ QVariantList TimelineModel::suggestClipMove(int clipId, int trackId, int positio
 QVariantList TimelineModel::suggestCompositionMove(int compoId, int trackId, int position, int cursorPosition, int snapDistance, bool fakeMove)
 {
     QWriteLocker locker(&m_lock);
+    TRACE_SCOPE("timeline");
     TRACE(compoId, trackId, position, cursorPosition, snapDistance);
     Q_ASSERT(isComposition(compoId));
     Q_ASSERT(isTrack(trackId));
@@ -1822,6 +1831,7 @@ bool TimelineModel::requestClipCreation(const QString &binClipId, int &id, Playl
 bool TimelineModel::requestClipInsertion(const QString &binClipId, int trackId, int position, int &id, bool logUndo, bool refreshView, bool useTargets)
 {
     QWriteLocker locker(&m_lock);
+    TRACE_SCOPE("timeline");
     TRACE(binClipId, trackId, position, id, logUndo, refreshView, useTargets);
     Fun undo = []() { return true; };
     Fun redo = []() { return true; };
@@ -1842,7 +1852,7 @@ bool TimelineModel::requestClipInsertion(const QString &binClipId, int trackId,
     }
     bool result = requestClipInsertion(binClipId, trackId, position, id, logUndo, refreshView, useTargets, undo, redo, allowedTracks);
     if (result && logUndo) {
-        PUSH_UNDO(undo, redo, i18n("Insert Clip"));
+        PUSH_UNDO_WITH_COST(undo, redo, i18n("Insert Clip"), getClipPtr(id)->memoryCost());
     }
     TRACE_RES(result);
     return result;
@@ -2152,6 +2162,7 @@ bool TimelineModel::requestItemDeletion(int itemId, Fun &undo, Fun &redo, bool l
 bool TimelineModel::requestItemDeletion(int itemId, bool logUndo)
 {
     QWriteLocker locker(&m_lock);
+    TRACE_SCOPE("timeline");
     TRACE(itemId, logUndo);
     Q_ASSERT(isItem(itemId));
     QString actionLabel;
@@ -2397,6 +2408,7 @@ std::unordered_set<int> TimelineModel::getItemsInRange(int trackId, int start, i
 
 bool TimelineModel::requestFakeGroupMove(int clipId, int groupId, int delta_track, int delta_pos, bool updateView, bool logUndo)
 {
+    TRACE_SCOPE("timeline");
     TRACE(clipId, groupId, delta_track, delta_pos, updateView, logUndo);
     std::function<bool(void)> undo = []() { return true; };
     std::function<bool(void)> redo = []() { return true; };
@@ -2645,6 +2657,7 @@ bool TimelineModel::requestGroupMove(int itemId, int groupId, int delta_track, i
                                      bool revertMove)
 {
     QWriteLocker locker(&m_lock);
+    TRACE_SCOPE("timeline");
     TRACE(itemId, groupId, delta_track, delta_pos, updateView, logUndo);
     std::function<bool(void)> undo = []() { return true; };
     std::function<bool(void)> redo = []() { return true; };
@@ -3198,6 +3211,7 @@ bool TimelineModel::requestGroupMove(int itemId, int groupId, int delta_track, i
 bool TimelineModel::requestGroupDeletion(int clipId, bool logUndo)
 {
     QWriteLocker locker(&m_lock);
+    TRACE_SCOPE("timeline");
     TRACE(clipId, logUndo);
     if (!m_groups->isInGroup(clipId)) {
         TRACE_RES(false);
@@ -3417,6 +3431,7 @@ int TimelineModel::requestClipResizeAndTimeWarp(int itemId, int size, bool right
 {
     Q_UNUSED(snapDistance)
     QWriteLocker locker(&m_lock);
+    TRACE_SCOPE("timeline");
     TRACE(itemId, size, right, true, snapDistance, allowSingleResize);
     Q_ASSERT(isClip(itemId));
     if (size <= 0) {
@@ -3621,6 +3636,7 @@ int TimelineModel::requestItemSpeedChange(int itemId, int size, bool right, int
 {
     Q_ASSERT(isClip(itemId));
     QWriteLocker locker(&m_lock);
+    TRACE_SCOPE("timeline");
     TRACE(itemId, size, right, snapDistance);
     Q_ASSERT(isItem(itemId));
     if (size <= 0) {
@@ -3679,6 +3695,7 @@ bool TimelineModel::removeMix(int cid)
 int TimelineModel::requestItemResize(int itemId, int size, bool right, bool logUndo, int snapDistance, bool allowSingleResize)
 {
     QWriteLocker locker(&m_lock);
+    TRACE_SCOPE("timeline");
     TRACE(itemId, size, right, logUndo, snapDistance, allowSingleResize)
     Q_ASSERT(isItem(itemId));
     if (size <= 0) {
@@ -4042,6 +4059,7 @@ int TimelineModel::requestItemRippleResize(const std::shared_ptr<TimelineItemMod
                                            int snapDistance, bool allowSingleResize)
 {
     QWriteLocker locker(&m_lock);
+    TRACE_SCOPE("timeline");
     TRACE(itemId, size, right, logUndo, snapDistance, allowSingleResize)
     Q_ASSERT(isItem(itemId));
     if (size <= 0) {
@@ -4413,6 +4431,7 @@ bool TimelineModel::requestItemRippleResize(const std::shared_ptr<TimelineItemMo
 int TimelineModel::requestSlipSelection(int offset, bool logUndo)
 {
     QWriteLocker locker(&m_lock);
+    TRACE_SCOPE("timeline");
     TRACE(offset, logUndo)
 
     Fun undo = []() { return true; };
@@ -4445,6 +4464,7 @@ int TimelineModel::requestSlipSelection(int offset, bool logUndo)
 int TimelineModel::requestClipSlip(int itemId, int offset, bool logUndo, bool allowSingleResize)
 {
     QWriteLocker locker(&m_lock);
+    TRACE_SCOPE("timeline");
     TRACE(itemId, offset, logUndo, allowSingleResize)
     Q_ASSERT(isClip(itemId));
     Fun undo = []() { return true; };
@@ -4495,6 +4515,7 @@ bool TimelineModel::requestClipSlip(int itemId, int offset, bool logUndo, Fun &u
 int TimelineModel::requestClipsGroup(const std::unordered_set<int> &ids, bool logUndo, GroupType type)
 {
     QWriteLocker locker(&m_lock);
+    TRACE_SCOPE("timeline");
     TRACE(ids, logUndo, type);
     if (type == GroupType::Selection || type == GroupType::Leaf) {
         // Selections shouldn't be done here. Call requestSetSelection instead
@@ -4573,6 +4594,7 @@ int TimelineModel::requestClipsGroup(const std::unordered_set<int> &ids, Fun &un
 bool TimelineModel::requestClipsUngroup(const std::unordered_set<int> &itemIds, bool logUndo)
 {
     QWriteLocker locker(&m_lock);
+    TRACE_SCOPE("timeline");
     TRACE(itemIds, logUndo);
     Fun undo = []() { return true; };
     Fun redo = []() { return true; };
@@ -4599,6 +4621,7 @@ bool TimelineModel::requestClipsUngroup(const std::unordered_set<int> &itemIds,
 bool TimelineModel::requestClipUngroup(int itemId, bool logUndo)
 {
     QWriteLocker locker(&m_lock);
+    TRACE_SCOPE("timeline");
     TRACE(itemId, logUndo);
     requestClearSelection();
     Fun undo = []() { return true; };
@@ -4657,6 +4680,7 @@ bool TimelineModel::requestRemoveFromGroup(int itemId, Fun &undo, Fun &redo)
 bool TimelineModel::requestTrackInsertion(int position, int &id, const QString &trackName, bool audioTrack)
 {
     QWriteLocker locker(&m_lock);
+    TRACE_SCOPE("timeline");
     TRACE(position, id, trackName, audioTrack);
     Fun undo = []() { return true; };
     Fun redo = []() { return true; };
@@ -4760,6 +4784,7 @@ bool TimelineModel::requestTrackDeletion(int trackId)
 {
     // TODO: make sure we disable overlayTrack before deleting a track
     QWriteLocker locker(&m_lock);
+    TRACE_SCOPE("timeline");
     TRACE(trackId);
     Fun undo = []() { return true; };
     Fun redo = []() { return true; };
@@ -5437,7 +5462,7 @@ bool TimelineModel::requestCompositionInsertion(const QString &transitionId, int
     Fun redo = []() { return true; };
     bool result = requestCompositionInsertion(transitionId, trackId, -1, position, length, std::move(transProps), id, undo, redo, logUndo);
     if (result && logUndo) {
-        PUSH_UNDO(undo, redo, i18n("Insert Composition"));
+        PUSH_UNDO_WITH_COST(undo, redo, i18n("Insert Composition"), getCompositionPtr(id)->memoryCost());
     }
     // TRACE_RES(result);
     return result;
@@ -6162,21 +6187,12 @@ std::shared_ptr<EffectStackModel> TimelineModel::getTrackEffectStackModel(int tr
 
 std::shared_ptr<EffectStackModel> TimelineModel::getMasterEffectStackModel()
 {
-    READ_LOCK();
-    if (m_masterStack == nullptr) {
-        m_masterService.reset(new Mlt::Service(*m_tractor.get()));
-        m_masterStack = EffectStackModel::construct(m_masterService, ObjectId(KdenliveObjectType::Master, 0, m_uuid), m_undoStack);
-        connect(m_masterStack.get(), &EffectStackModel::updateMasterZones, pCore.get(), &Core::updateMasterZones);
-    }
     return m_masterStack;
 }
 
 void TimelineModel::importMasterEffects(std::weak_ptr<Mlt::Service> service)
 {
-    READ_LOCK();
-    if (m_masterStack == nullptr) {
-        getMasterEffectStackModel();
-    }
+    READ_WRITE_LOCK();
     m_masterStack->importEffects(std::move(service), PlaylistState::Disabled, false, QString(), m_uuid);
 }
 
@@ -6384,6 +6400,7 @@ bool TimelineModel::requestClipTimeWarp(int clipId, double speed, bool pitchComp
     if (qFuzzyCompare(speed, m_allClips[clipId]->getSpeed()) && pitchCompensate == bool(m_allClips[clipId]->getIntProperty("warp_pitch"))) {
         return true;
     }
+    TRACE_SCOPE("timeline");
     TRACE(clipId, speed);
     Fun undo = []() { return true; };
     Fun redo = []() { return true; };
@@ -6547,6 +6564,7 @@ bool TimelineModel::requestClearSelection(bool onDeletion)
 {
     QWriteLocker locker(&m_lock);
     qDebug() << "::: REQUESTING SELECTION CLEAR!!!!!!";
+    TRACE_SCOPE("timeline");
     TRACE();
     if (m_singleSelectionMode) {
         m_singleSelectionMode = false;
@@ -6642,7 +6660,7 @@ void TimelineModel::requestClearSelection(bool onDeletion, Fun &undo, Fun &redo)
 
 void TimelineModel::clearGroupSelectionOnDelete(std::vector<int> groups)
 {
-    READ_LOCK();
+    READ_WRITE_LOCK();
     if (m_currentSelection.size() == 0) {
         return;
     }
@@ -6670,6 +6688,7 @@ std::unordered_set<int> TimelineModel::getCurrentSelection() const
 void TimelineModel::requestAddToSelection(int itemId, bool clear, bool singleSelect)
 {
     QWriteLocker locker(&m_lock);
+    TRACE_SCOPE("timeline");
     TRACE(itemId, clear);
     std::unordered_set<int> selection;
     if (clear) {
@@ -6701,6 +6720,7 @@ void TimelineModel::requestAddToSelection(int itemId, bool clear, bool singleSel
 void TimelineModel::requestRemoveFromSelection(int itemId)
 {
     QWriteLocker locker(&m_lock);
+    TRACE_SCOPE("timeline");
     TRACE(itemId);
     std::unordered_set<int> all_items = {itemId};
     int parentGroup = m_groups->getDirectAncestor(itemId);
@@ -6718,6 +6738,7 @@ void TimelineModel::requestRemoveFromSelection(int itemId)
 
 bool TimelineModel::requestSetSelection(const std::unordered_set<int> &ids)
 {
+    TRACE_SCOPE("timeline");
     TRACE(ids);
     if (m_currentSelection.size() > 0) {
         requestClearSelection();
@@ -7384,6 +7405,77 @@ QByteArray TimelineModel::timelineHash()
     return fileHash;
 }
 
+QMap<int, QByteArray> TimelineModel::chunkHashes(const QList<int> &chunks, int chunkSize)
+{
+    READ_LOCK();
+    QMap<int, QByteArray> hashes;
+    QByteArray timelineData = QStringLiteral("%1 %2\n")
+                                  .arg(QString::fromUtf8(m_blackClip->get("resource")), pCore->currentDoc()->getSequenceProperty(m_uuid, QStringLiteral("compositing"), QStringLiteral("1")))
+                                  .toUtf8();
+    // Master keyframes are at absolute timeline positions
+    bool animatedMaster = false;
+    if (m_masterStack && m_masterStack->rowCount() > 0) {
+        QDomDocument document;
+        document.appendChild(m_masterStack->toXml(document));
+        timelineData.append(document.toByteArray());
+        animatedMaster = m_masterStack->hasKeyframes();
+    }
+    // The subtitle filter burns the subtitles into the rendered chunks
+    const bool hasSubtitles = m_subtitleModel && !m_subtitleModel->isDisabled();
+    if (hasSubtitles) {
+        timelineData.append(m_subtitleModel->renderData());
+    }
+    QHash<QString, QByteArray> binClipsData;
+    for (int start : chunks) {
+        const int end = start + chunkSize - 1;
+        QByteArray data = timelineData;
+        if (animatedMaster) {
+            data.append(QStringLiteral("range %1 %2\n").arg(start).arg(end).toLatin1());
+        }
+        for (auto &track : m_allTracks) {
+            data.append(track->rangeData(start, end, binClipsData));
+        }
+        for (auto &compo : m_allCompositions) {
+            const int position = compo.second->getPosition();
+            if (position > end || position + compo.second->getPlaytime() <= start) {
+                continue;
+            }
+            data.append(QStringLiteral("composition %1 %2 %3 %4 %5\n")
+                            .arg(getTrackPosition(compo.second->getCurrentTrackId()))
+                            .arg(compo.second->getATrack())
+                            .arg(position - start)
+                            .arg(compo.second->getPlaytime())
+                            .arg(compo.second->getAssetId())
+                            .toUtf8());
+            QScopedPointer<Mlt::Properties> props(compo.second->properties());
+            data.append(assetData(*props.data()));
+        }
+        if (hasSubtitles) {
+            data.append(m_subtitleModel->rangeData(start, end));
+        }
+        hashes.insert(start, QCryptographicHash::hash(data, QCryptographicHash::Md5));
+    }
+    return hashes;
+}
+
+// static
+QByteArray TimelineModel::assetData(Mlt::Properties &properties)
+{
+    QByteArray data;
+    for (int i = 0; i < properties.count(); i++) {
+        const QString name = properties.get_name(i);
+        // Skip internal properties and the timeline position, which depends on where the asset is
+        if (name.startsWith(QLatin1Char('_')) || name == QLatin1String("in") || name == QLatin1String("out") || name.startsWith(QLatin1String("kdenlive:"))) {
+            continue;
+        }
+        data.append(name.toUtf8());
+        data.append('=');
+        data.append(properties.get(i));
+        data.append('\n');
+    }
+    return data;
+}
+
 std::shared_ptr<MarkerSortModel> TimelineModel::getFilteredGuideModel()
 {
     return m_guidesFilterModel;
@@ -7441,6 +7533,17 @@ bool TimelineModel::hasTimelinePreview() const
     return m_timelinePreview != nullptr;
 }
 
+void TimelineModel::invalidateItemFrames(int itemId)
+{
+    if (isTrack(itemId)) {
+        // Track effects apply to the whole track duration
+        Q_EMIT invalidateFrames(0, -1);
+    } else if (isItem(itemId)) {
+        int start = getItemPosition(itemId);
+        Q_EMIT invalidateFrames(start, start + getItemPlaytime(itemId));
+    }
+}
+
 void TimelineModel::updatePreviewConnection(bool enable)
 {
     if (hasTimelinePreview()) {
@@ -7531,8 +7634,8 @@ void TimelineModel::loadPreview(const QString &chunks, const QString &dirty, boo
     if (!hasTimelinePreview()) {
         initializePreviewManager();
     }
-    QVariantList renderedChunks;
-    QVariantList dirtyChunks;
+    QList<int> renderedChunks;
+    QList<int> dirtyChunks;
     QStringList chunksList = chunks.split(QLatin1Char(','), Qt::SkipEmptyParts);
     QStringList dirtyList = dirty.split(QLatin1Char(','), Qt::SkipEmptyParts);
     for (const QString &frame : std::as_const(chunksList)) {
@@ -517,6 +517,9 @@ public:
     void initializePreviewManager();
     void resetPreviewManager();
     bool hasTimelinePreview() const;
+    /**  @brief Discard the monitor frames of an item, or of the whole timeline for a track
+     */
+    void invalidateItemFrames(int itemId);
     /**  @brief Enable/disable timeline preview
      */
     void updatePreviewConnection(bool enable);
@@ -708,6 +711,13 @@ public:
     /** @brief Calculate timeline hash based on clips, mixes and compositions
      */
     QByteArray timelineHash();
+    /** @brief Calculate a hash of what is rendered in each timeline preview chunk. Positions are relative to the chunk start, so that a chunk
+       with the same content at another position, in another sequence or after an undo gets the same hash.
+       @param chunks the first frame of the chunks
+    */
+    QMap<int, QByteArray> chunkHashes(const QList<int> &chunks, int chunkSize);
+    /** @brief Serialize the parameters of an asset, ignoring its timeline position */
+    static QByteArray assetData(Mlt::Properties &properties);
     /** @brief Make the background track transparent (or opaque black) - this affects compositing.
      */
     void makeTransparentBg(bool transparent);
@@ -1018,6 +1028,8 @@ Q_SIGNALS:
     void requestMonitorRefresh();
     /** @brief signal triggered by track operations */
     void invalidateZone(int in, int out);
+    /** @brief The frames rendered in this range changed, but not the timeline preview state */
+    void invalidateFrames(int in, int out);
     /** @brief signal triggered when a track duration changed (insertion/deletion) */
     void durationUpdated(const QUuid &uuid);
 
@@ -18,6 +18,7 @@
 #include "snapmodel.hpp"
 #include "timelinemodel.hpp"
 #include <QDebug>
+#include <QDomDocument>
 #include <QModelIndex>
 #include <memory>
 #include <mlt++/MltTransition.h>
@@ -105,6 +106,7 @@ TrackModel::~TrackModel()
         field->unblock();
         m_sameCompositions.clear();
         m_allClips.clear();
+        m_clipPos.clear();
         m_allCompositions.clear();
         m_track->remove_track(1);
         m_track->remove_track(0);
@@ -193,6 +195,7 @@ Fun TrackModel::requestClipInsertion_lambda(int clipId, int position, bool updat
             m_allClips[clip->getId()] = clip; // store clip
             // update clip position and track
             clip->setPosition(position);
+            m_clipPos.emplace(position, clipId);
             if (finalMove) {
                 clip->setSubPlaylistIndex(subPlaylist, m_id);
             }
@@ -436,6 +439,7 @@ Fun TrackModel::requestClipDeletion_lambda(int clipId, bool updateView, bool fin
             m_playlists[target_track].consolidate_blanks();
             m_allClips[clipId]->setCurrentTrackId(-1);
             // m_allClips[clipId]->setSubPlaylistIndex(-1);
+            removeClipPosition(clipId, m_allClips[clipId]->getPosition());
             m_allClips.erase(clipId);
             delete prod;
             field->unblock();
@@ -706,7 +710,9 @@ Fun TrackModel::requestClipResize_lambda(int clipId, int in, int out, bool right
             // The second is parameter is delta - 1 because this function expects an out time, which is basically size - 1
             m_playlists[target_track].insert_blank(blank_index, delta - 1);
             if (!right) {
+                removeClipPosition(clipId, m_allClips[clipId]->getPosition());
                 m_allClips[clipId]->setPosition(clip_position + delta);
+                m_clipPos.emplace(clip_position + delta, clipId);
                 // Because we inserted blank before, the index of our clip has increased
                 target_clip_mutable++;
             }
@@ -805,7 +811,9 @@ Fun TrackModel::requestClipResize_lambda(int clipId, int in, int out, bool right
                     // m_track->unblock();
                 }
                 if (!right && err == 0) {
+                    removeClipPosition(clipId, m_allClips[clipId]->getPosition());
                     m_allClips[clipId]->setPosition(m_playlists[target_track].clip_start(target_clip_mutable));
+                    m_clipPos.emplace(m_allClips[clipId]->getPosition(), clipId);
                 }
                 if (err == 0) {
                     update_snaps(m_allClips[clipId]->getPosition(), m_allClips[clipId]->getPosition() + out - in + 1);
@@ -959,6 +967,50 @@ int TrackModel::getRowfromComposition(int tid) const
     return int(m_allClips.size()) + int(std::distance(m_allCompositions.begin(), m_allCompositions.find(tid)));
 }
 
+QList<int> TrackModel::getItemIdsInRange(int start, int end) const
+{
+    READ_LOCK();
+    QList<int> ids;
+    // Clips of a sub playlist don't overlap, and a clip of the second sub playlist only overlaps the clips it is mixed with.
+    // So the clips starting before the range and reaching into it follow the last clip of the first sub playlist ending before it
+    auto clip = m_clipPos.lower_bound(start);
+    while (clip != m_clipPos.begin()) {
+        --clip;
+        const auto &model = m_allClips.at(clip->second);
+        if (clip->first + model->getPlaytime() > start) {
+            ids.prepend(clip->second);
+        } else if (model->getSubPlaylistIndex() == 0) {
+            break;
+        }
+    }
+    for (clip = m_clipPos.lower_bound(start); clip != m_clipPos.end() && clip->first <= end; ++clip) {
+        ids << clip->second;
+    }
+    // Compositions of a track never overlap
+    auto compo = m_compoPos.lower_bound(start);
+    if (compo != m_compoPos.begin()) {
+        auto previous = std::prev(compo);
+        if (previous->first + m_allCompositions.at(previous->second)->getPlaytime() > start) {
+            compo = previous;
+        }
+    }
+    for (; compo != m_compoPos.end() && compo->first <= end; ++compo) {
+        ids << compo->second;
+    }
+    return ids;
+}
+
+void TrackModel::removeClipPosition(int clipId, int position)
+{
+    auto range = m_clipPos.equal_range(position);
+    for (auto it = range.first; it != range.second; ++it) {
+        if (it->second == clipId) {
+            m_clipPos.erase(it);
+            return;
+        }
+    }
+}
+
 QVariant TrackModel::getProperty(const QString &name) const
 {
     READ_LOCK();
@@ -977,6 +1029,81 @@ void TrackModel::setProperty(const QString &name, const QString &value)
     }
 }
 
+QByteArray TrackModel::rangeData(int start, int end, QHash<QString, QByteArray> &binClipsData)
+{
+    QByteArray data;
+    if (isAudioTrack()) {
+        // Timeline preview only renders video
+        return data;
+    }
+    data.append(QStringLiteral("track %1\n").arg(int(isHidden())).toLatin1());
+    if (m_effectStack->rowCount() > 0) {
+        QDomDocument document;
+        document.appendChild(m_effectStack->toXml(document));
+        data.append(document.toByteArray());
+        if (m_effectStack->hasKeyframes()) {
+            // Track keyframes are at absolute timeline positions
+            data.append(QStringLiteral("range %1 %2\n").arg(start).arg(end).toLatin1());
+        }
+    }
+    for (auto &clip : m_allClips) {
+        const int position = clip.second->getPosition();
+        if (position > end || position + clip.second->getPlaytime() <= start) {
+            continue;
+        }
+        const QString &binId = clip.second->binId();
+        if (!binClipsData.contains(binId)) {
+            std::shared_ptr<ProjectClip> binClip = pCore->projectItemModel()->getClipByBinID(binId);
+            binClipsData.insert(binId, binClip ? binClip->renderData() : QByteArray());
+        }
+        data.append(binClipsData.value(binId));
+        if (clip.second->clipType() == ClipType::Timeline) {
+            // Only the part of the nested sequence that is used in this range matters
+            std::shared_ptr<ProjectClip> binClip = pCore->projectItemModel()->getClipByBinID(binId);
+            if (binClip) {
+                int in = clip.second->getIn();
+                int out = clip.second->getOut();
+                if (qFuzzyCompare(clip.second->getSpeed(), 1.) && !clip.second->hasTimeRemap()) {
+                    in += qMax(0, start - position);
+                    out = clip.second->getIn() + qMin(end, position + clip.second->getPlaytime() - 1) - position;
+                } else {
+                    in = 0;
+                    out = int(binClip->frameDuration()) - 1;
+                }
+                data.append(binClip->sequenceRenderData(in, out));
+            }
+        }
+        data.append(QStringLiteral("clip %1 %2 %3 %4 %5 %6\n")
+                        .arg(position - start)
+                        .arg(clip.second->getIn())
+                        .arg(clip.second->getOut())
+                        .arg(QString::number(clip.second->getSpeed(), 'f'))
+                        .arg(int(clip.second->clipState()))
+                        .arg(clip.second->getSubPlaylistIndex())
+                        .toLatin1());
+        if (clip.second->hasTimeRemap()) {
+            const QMap<QString, QString> remap = clip.second->getRemapValues();
+            for (auto it = remap.constBegin(); it != remap.constEnd(); ++it) {
+                data.append(QStringLiteral("%1=%2\n").arg(it.key(), it.value()).toUtf8());
+            }
+        }
+        if (clip.second->m_effectStack->rowCount() > 0) {
+            QDomDocument document;
+            document.appendChild(clip.second->m_effectStack->toXml(document));
+            data.append(document.toByteArray());
+        }
+    }
+    for (auto &sameComposition : m_sameCompositions) {
+        Mlt::Transition *tr = static_cast<Mlt::Transition *>(sameComposition.second->getAsset());
+        if (tr->get_in() > end || tr->get_out() < start) {
+            continue;
+        }
+        data.append(QStringLiteral("mix %1 %2 %3\n").arg(tr->get_in() - start).arg(tr->get_out() - start).arg(sameComposition.second->getAssetId()).toLatin1());
+        data.append(TimelineModel::assetData(*tr));
+    }
+    return data;
+}
+
 bool TrackModel::checkConsistency()
 {
     auto ptr = m_parent.lock();
@@ -1102,6 +1229,18 @@ bool TrackModel::checkConsistency()
         return false;
     }
 
+    // We check the ordered clip positions
+    if (m_allClips.size() != m_clipPos.size()) {
+        qDebug() << "Error: the number of clips position doesn't match number of clips";
+        return false;
+    }
+    for (const auto &clp : m_clipPos) {
+        if (m_allClips.count(clp.second) == 0 || m_allClips.at(clp.second)->getPosition() != clp.first) {
+            qDebug() << "Error: the position of clip " << clp.second << " is not properly stored";
+            return false;
+        }
+    }
+
     // We now check compositions positions
     if (m_allCompositions.size() != m_compoPos.size()) {
         qDebug() << "Error: the number of compositions position doesn't match number of compositions";
@@ -1567,7 +1706,7 @@ bool TrackModel::hasIntersectingComposition(int in, int out) const
 
 bool TrackModel::addEffect(const QString &effectId)
 {
-    READ_LOCK();
+    READ_WRITE_LOCK();
     return m_effectStack->appendEffect(effectId);
 }
 
@@ -7,8 +7,10 @@
 
 #include "definitions.h"
 #include "undohelper.hpp"
+#include <QHash>
 #include <QReadWriteLock>
 #include <QSharedPointer>
+#include <map>
 #include <memory>
 #include <mlt++/MltPlaylist.h>
 #include <mlt++/MltProfile.h>
@@ -151,6 +153,10 @@ public:
     bool hasClipStart(int pos);
     /** @brief Calculate a hash based on all clips an d mixes positions/playtime */
     QByteArray trackHash();
+    /** @brief Describe what the track renders between @param start and @param end, positions being relative to @param start
+       @param binClipsData caches the render data of the bin clips between calls
+    */
+    QByteArray rangeData(int start, int end, QHash<QString, QByteArray> &binClipsData);
     /** @brief This is an helper function that test frame level consistency with the MLT structures */
     bool checkConsistency();
     /** @brief Check if a mix is reversed (moslty used in tests) */
@@ -272,6 +278,10 @@ protected:
     */
     int getRowfromComposition(int compoId) const;
 
+    /** @brief Returns the ids of the clips, then of the compositions, intersecting the frame range [start, end], in position order.
+    */
+    QList<int> getItemIdsInRange(int start, int end) const;
+
     /** @brief Returns true if we have a composition intersecting with the range [in,out]*/
     bool hasIntersectingComposition(int in, int out) const;
 
@@ -369,6 +379,12 @@ private:
      *  those positions here to check for moves and resize
      */
     std::map<int, int> m_compoPos;
+    /** We store the start positions of the clips, ordered, to find the clips of a range without walking the whole track.
+     *  Clips of the two sub playlists can start at the same frame
+     */
+    std::multimap<int, int> m_clipPos;
+    /** @brief Remove the clip @param clipId starting at @param position from m_clipPos */
+    void removeClipPosition(int clipId, int position);
 
     /// This is a lock that ensures safety in case of concurrent access
     mutable QReadWriteLock m_lock;
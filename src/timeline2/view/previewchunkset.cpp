@@ -0,0 +1,126 @@
+/*
+    SPDX-FileCopyrightText: 2026 Kdenlive contributors
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#include "previewchunkset.h"
+
+#include <QtGlobal>
+
+#include <iterator>
+
+PreviewChunkSet::PreviewChunkSet(int chunkSize)
+    : m_chunkSize(qMax(1, chunkSize))
+{
+}
+
+bool PreviewChunkSet::contains(int chunk) const
+{
+    auto it = m_ranges.upperBound(chunk);
+    if (it == m_ranges.constBegin()) {
+        return false;
+    }
+    --it;
+    return chunk <= it.value() && (chunk - it.key()) % m_chunkSize == 0;
+}
+
+bool PreviewChunkSet::intersects(int start, int end) const
+{
+    // The last range starting before the end of the zone is the only one that can reach its start
+    auto it = m_ranges.upperBound(end);
+    if (it == m_ranges.constBegin()) {
+        return false;
+    }
+    --it;
+    return it.value() >= start;
+}
+
+bool PreviewChunkSet::insert(int chunk)
+{
+    if (contains(chunk)) {
+        return false;
+    }
+    auto next = m_ranges.upperBound(chunk);
+    const bool joinsNext = next != m_ranges.end() && next.key() == chunk + m_chunkSize;
+    if (next != m_ranges.begin() && std::prev(next).value() + m_chunkSize == chunk) {
+        auto previous = std::prev(next);
+        if (joinsNext) {
+            previous.value() = next.value();
+            m_ranges.erase(next);
+        } else {
+            previous.value() = chunk;
+        }
+    } else if (joinsNext) {
+        const int last = next.value();
+        m_ranges.erase(next);
+        m_ranges.insert(chunk, last);
+    } else {
+        m_ranges.insert(chunk, chunk);
+    }
+    m_count++;
+    return true;
+}
+
+bool PreviewChunkSet::remove(int chunk)
+{
+    if (!contains(chunk)) {
+        return false;
+    }
+    auto range = std::prev(m_ranges.upperBound(chunk));
+    const int first = range.key();
+    const int last = range.value();
+    if (chunk == first) {
+        m_ranges.erase(range);
+        if (last > chunk) {
+            m_ranges.insert(chunk + m_chunkSize, last);
+        }
+    } else {
+        range.value() = chunk - m_chunkSize;
+        if (last > chunk) {
+            m_ranges.insert(chunk + m_chunkSize, last);
+        }
+    }
+    m_count--;
+    return true;
+}
+
+void PreviewChunkSet::clear()
+{
+    m_ranges.clear();
+    m_count = 0;
+}
+
+QList<int> PreviewChunkSet::chunks() const
+{
+    QList<int> result;
+    result.reserve(m_count);
+    for (auto it = m_ranges.constBegin(); it != m_ranges.constEnd(); ++it) {
+        for (int chunk = it.key(); chunk <= it.value(); chunk += m_chunkSize) {
+            result << chunk;
+        }
+    }
+    return result;
+}
+
+QVariantList PreviewChunkSet::toVariantList() const
+{
+    QVariantList result;
+    result.reserve(m_count);
+    for (int chunk : chunks()) {
+        result << chunk;
+    }
+    return result;
+}
+
+QStringList PreviewChunkSet::toStringList() const
+{
+    QStringList result;
+    for (auto it = m_ranges.constBegin(); it != m_ranges.constEnd(); ++it) {
+        if (it.key() == it.value()) {
+            result << QString::number(it.key());
+        } else {
+            result << QStringLiteral("%1-%2").arg(it.key()).arg(it.value());
+        }
+    }
+    return result;
+}
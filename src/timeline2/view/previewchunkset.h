@@ -0,0 +1,46 @@
+/*
+    SPDX-FileCopyrightText: 2026 Kdenlive contributors
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#pragma once
+
+#include <QList>
+#include <QMap>
+#include <QStringList>
+#include <QVariantList>
+
+/** @class PreviewChunkSet
+    @brief Set of timeline preview chunks, identified by their first frame.
+    Consecutive chunks are stored as a single range, so that lookups and range queries do not depend on the number of chunks
+    in a long preview zone.
+ */
+class PreviewChunkSet
+{
+public:
+    explicit PreviewChunkSet(int chunkSize = 25);
+
+    int chunkSize() const { return m_chunkSize; }
+    /** @brief Returns true if the chunk starting at @param chunk is in the set */
+    bool contains(int chunk) const;
+    /** @brief Returns true if one of the chunks starting between @param start and @param end (both chunk aligned) is in the set */
+    bool intersects(int start, int end) const;
+    /** @brief Add a chunk, returns false if it was already in the set */
+    bool insert(int chunk);
+    /** @brief Remove a chunk, returns false if it was not in the set */
+    bool remove(int chunk);
+    void clear();
+    bool isEmpty() const { return m_ranges.isEmpty(); }
+    int count() const { return m_count; }
+    /** @brief The chunks, sorted */
+    QList<int> chunks() const;
+    QVariantList toVariantList() const;
+    /** @brief Compressed list of chunks, like: "0-500,525,575" */
+    QStringList toStringList() const;
+
+private:
+    int m_chunkSize;
+    int m_count{0};
+    /** @brief First chunk of each range of consecutive chunks, mapped to the last chunk of the range */
+    QMap<int, int> m_ranges;
+};
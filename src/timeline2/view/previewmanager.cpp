@@ -14,16 +14,20 @@
 #include "mainwindow.h"
 #include "monitor/monitor.h"
 #include "profiles/profilemodel.hpp"
+#include "timeline2/model/timelineitemmodel.hpp"
 #include "timeline2/view/timelinecontroller.h"
 #include "timeline2/view/timelinewidget.h"
+#include "utils/cachemanager.h"
 #include "xml/xml.hpp"
 
 #include <KLocalizedString>
 #include <KMessageBox>
-#include <QCollator>
 #include <QCryptographicHash>
+#include <QDateTime>
+#include <QFileInfo>
 #include <QMutexLocker>
 #include <QSaveFile>
+#include <QSet>
 #include <QStandardPaths>
 
 PreviewManager::PreviewManager(Mlt::Tractor *tractor, QUuid uuid, QObject *parent)
@@ -36,6 +40,8 @@ PreviewManager::PreviewManager(Mlt::Tractor *tractor, QUuid uuid, QObject *paren
     , m_warnOnCrash(true)
     , m_previewTrackIndex(-1)
     , m_initialized(false)
+    , m_renderedChunks(KdenliveSettings::timelinechunks())
+    , m_dirtyChunks(KdenliveSettings::timelinechunks())
 {
     m_previewGatherTimer.setSingleShot(true);
     m_previewGatherTimer.setInterval(200);
@@ -58,10 +64,9 @@ PreviewManager::~PreviewManager()
 {
     if (m_initialized) {
         abortRendering();
-        if (m_undoDir.dirName() == QLatin1String("undo")) {
-            m_undoDir.removeRecursively();
-        }
-        if ((pCore->currentDoc()->url().isEmpty() && m_cacheDir.entryList(QDir::Dirs | QDir::NoDotAndDotDot).isEmpty()) ||
+        QStringList sequenceDirs = m_cacheDir.entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+        sequenceDirs.removeAll(QStringLiteral("chunks"));
+        if ((pCore->currentDoc()->url().isEmpty() && sequenceDirs.isEmpty()) ||
             m_cacheDir.entryList(QDir::AllEntries | QDir::NoDotAndDotDot).isEmpty()) {
             if (m_cacheDir.dirName() == QLatin1String("preview")) {
                 m_cacheDir.removeRecursively();
@@ -91,14 +96,13 @@ bool PreviewManager::initialize()
         return false;
     }
     if (m_uuid == doc->uuid()) {
-        if (m_cacheDir.dirName() != QLatin1String("preview") || m_cacheDir == QDir() ||
-            (!m_cacheDir.exists(QStringLiteral("undo")) && !m_cacheDir.mkdir(QStringLiteral("undo"))) || !m_cacheDir.absolutePath().contains(documentId)) {
+        if (m_cacheDir.dirName() != QLatin1String("preview") || m_cacheDir == QDir() || !m_cacheDir.absolutePath().contains(documentId)) {
             pCore->displayMessage(i18n("Something is wrong with cache folder %1", m_cacheDir.absolutePath()), ErrorMessage);
             return false;
         }
     } else {
         if (m_cacheDir.dirName().toLatin1() != QCryptographicHash::hash(m_uuid.toByteArray(), QCryptographicHash::Md5).toHex() || m_cacheDir == QDir() ||
-            (!m_cacheDir.exists(QStringLiteral("undo")) && !m_cacheDir.mkdir(QStringLiteral("undo"))) || !m_cacheDir.absolutePath().contains(documentId)) {
+            !m_cacheDir.absolutePath().contains(documentId)) {
             pCore->displayMessage(i18n("Something is wrong with cache folder %1", m_cacheDir.absolutePath()), ErrorMessage);
             return false;
         }
@@ -107,16 +111,25 @@ bool PreviewManager::initialize()
         pCore->displayMessage(i18n("Invalid timeline preview parameters"), ErrorMessage);
         return false;
     }
-    m_undoDir = QDir(m_cacheDir.absoluteFilePath(QStringLiteral("undo")));
+    // The chunks of all sequences are stored in the main preview folder
+    m_chunksDir = doc->getCacheDir(CachePreview, &ok);
+    if (!ok || m_chunksDir.dirName() != QLatin1String("preview") || !m_chunksDir.mkpath(QStringLiteral("chunks")) || !m_chunksDir.cd(QStringLiteral("chunks"))) {
+        pCore->displayMessage(i18n("Something is wrong with cache folder %1", m_chunksDir.absolutePath()), ErrorMessage);
+        return false;
+    }
 
     // Make sure our cache dirs are inside the temporary folder
-    if (!m_cacheDir.makeAbsolute() || !m_undoDir.makeAbsolute() || !m_undoDir.mkpath(QStringLiteral("."))) {
+    if (!m_cacheDir.makeAbsolute() || !m_chunksDir.makeAbsolute()) {
         pCore->displayMessage(i18n("Something is wrong with cache folders"), ErrorMessage);
         return false;
     }
+    // Undo history of the previous chunk layout, now replaced by the chunk store
+    QDir legacyUndo(m_cacheDir.absoluteFilePath(QStringLiteral("undo")));
+    if (legacyUndo.exists() && legacyUndo.dirName() == QLatin1String("undo")) {
+        legacyUndo.removeRecursively();
+    }
 
     connect(this, &PreviewManager::cleanupOldPreviews, this, &PreviewManager::doCleanupOldPreviews);
-    connect(doc, &KdenliveDoc::removeInvalidUndo, this, &PreviewManager::slotRemoveInvalidUndo, Qt::DirectConnection);
     m_previewTimer.setSingleShot(true);
     m_previewTimer.setInterval(3000);
     connect(&m_previewTimer, &QTimer::timeout, this, &PreviewManager::startPreviewRender);
@@ -141,27 +154,22 @@ bool PreviewManager::buildPreviewTrack()
     return true;
 }
 
-void PreviewManager::loadChunks(QVariantList previewChunks, QVariantList dirtyChunks, Mlt::Playlist &playlist)
+void PreviewManager::loadChunks(const QList<int> &previewChunks, const QList<int> &dirtyChunks, Mlt::Playlist &playlist)
 {
-    if (previewChunks.isEmpty()) {
-        previewChunks = m_renderedChunks;
-    }
-    if (dirtyChunks.isEmpty()) {
-        dirtyChunks = m_dirtyChunks;
-    }
-
-    QStringList existingChuncks;
-    if (!previewChunks.isEmpty()) {
-        existingChuncks = m_cacheDir.entryList(QDir::Files);
+    PreviewChunkSet loadedChunks(KdenliveSettings::timelinechunks());
+    for (int chunk : previewChunks.isEmpty() ? m_renderedChunks.chunks() : previewChunks) {
+        loadedChunks.insert(chunk);
     }
+    QList<int> invalidChunks = dirtyChunks.isEmpty() ? m_dirtyChunks.chunks() : dirtyChunks;
 
     int max = playlist.count();
     std::shared_ptr<Mlt::Producer> clip;
     m_tractor->lock();
     if (max == 0) {
         // Empty timeline preview, mark all as dirty
-        for (auto &prev : previewChunks) {
-            dirtyChunks << prev;
+        for (int chunk : loadedChunks.chunks()) {
+            m_renderedChunks.remove(chunk);
+            invalidChunks << chunk;
         }
     }
     for (int i = 0; i < max; i++) {
@@ -169,29 +177,29 @@ void PreviewManager::loadChunks(QVariantList previewChunks, QVariantList dirtyCh
             continue;
         }
         int position = playlist.clip_start(i);
-        if (previewChunks.contains(QString::number(position))) {
-            if (existingChuncks.contains(QStringLiteral("%1.%2").arg(position).arg(m_extension))) {
-                clip.reset(playlist.get_clip(i));
-                m_renderedChunks << position;
+        if (loadedChunks.contains(position)) {
+            clip.reset(playlist.get_clip(i));
+            // Chunks are in the chunk store, or in the sequence cache folder for older projects
+            if (QFileInfo::exists(QString::fromUtf8(clip->parent().get("resource")))) {
+                m_renderedChunks.insert(position);
                 m_previewTrack->insert_at(position, clip.get(), 1);
             } else {
-                dirtyChunks << position;
+                invalidChunks << position;
             }
         }
     }
     m_previewTrack->consolidate_blanks();
     m_tractor->unlock();
-    if (!dirtyChunks.isEmpty()) {
-        std::sort(dirtyChunks.begin(), dirtyChunks.end(), chunkSort);
+    if (!invalidChunks.isEmpty()) {
         QMutexLocker lock(&m_dirtyMutex);
-        for (const auto &i : std::as_const(dirtyChunks)) {
-            if (!m_dirtyChunks.contains(i)) {
-                m_dirtyChunks << i;
+        for (int chunk : std::as_const(invalidChunks)) {
+            if (!m_renderedChunks.contains(chunk)) {
+                m_dirtyChunks.insert(chunk);
             }
         }
         Q_EMIT dirtyChunksChanged();
     }
-    if (!previewChunks.isEmpty()) {
+    if (!loadedChunks.isEmpty()) {
         Q_EMIT renderedChunksChanged();
     }
 }
@@ -325,103 +333,156 @@ void PreviewManager::invalidatePreviews()
         m_previewTimer.stop();
         timer = true;
     }
-    KdenliveDoc *doc = pCore->currentDoc();
-    int stackIx = doc->commandStack()->index();
-    int stackMax = doc->commandStack()->count();
-    if (stackIx == stackMax && !m_undoDir.exists(QString::number(stackIx - 1))) {
-        // We just added a new command in stack, archive existing chunks
-        int ix = stackIx - 1;
-        m_undoDir.mkdir(QString::number(ix));
-        bool foundPreviews = false;
-        for (const auto &i : m_dirtyChunks) {
-            QString current = QStringLiteral("%1.%2").arg(i.toInt()).arg(m_extension);
-            if (m_cacheDir.rename(current, QStringLiteral("undo/%1/%2").arg(ix).arg(current))) {
-                foundPreviews = true;
-            }
-        }
-        if (!foundPreviews) {
-            // No preview files found, remove undo folder
-            m_undoDir.rmdir(QString::number(ix));
-        } else {
-            // new chunks archived, cleanup old ones
-            Q_EMIT cleanupOldPreviews();
-        }
-    } else {
-        // Restore existing chunks, delete others
-        // Check if we just undo the last stack action, then backup, otherwise delete
-        bool lastUndo = false;
-        if (stackIx + 1 == stackMax) {
-            if (!m_undoDir.exists(QString::number(stackMax))) {
-                lastUndo = true;
-                bool foundPreviews = false;
-                m_undoDir.mkdir(QString::number(stackMax));
-                for (const auto &i : m_dirtyChunks) {
-                    QString current = QStringLiteral("%1.%2").arg(i.toInt()).arg(m_extension);
-                    if (m_cacheDir.rename(current, QStringLiteral("undo/%1/%2").arg(stackMax).arg(current))) {
-                        foundPreviews = true;
-                    }
-                }
-                if (!foundPreviews) {
-                    m_undoDir.rmdir(QString::number(stackMax));
-                }
-            }
-        }
-        bool moveFile = true;
-        QDir tmpDir = m_undoDir;
-        if (!tmpDir.cd(QString::number(stackIx))) {
-            moveFile = false;
-        }
-        QVariantList foundChunks;
-        for (const auto &i : m_dirtyChunks) {
-            QString cacheFileName = QStringLiteral("%1.%2").arg(i.toInt()).arg(m_extension);
-            if (!lastUndo) {
-                m_cacheDir.remove(cacheFileName);
-            }
-            if (moveFile) {
-                if (QFile::copy(tmpDir.absoluteFilePath(cacheFileName), m_cacheDir.absoluteFilePath(cacheFileName))) {
-                    foundChunks << i;
-                } else {
-                    qDebug() << "// ERROR PROCESSE CHUNK: " << i << ", " << cacheFileName;
-                }
-            }
+    // After an undo/redo, or any change that restores a previous content, the chunks are still in the store
+    restoreStoredChunks();
+    pCore->currentDoc()->setModified(true);
+    if (timer) {
+        m_previewTimer.start();
+    }
+}
+
+QMap<int, QString> PreviewManager::chunkHashes(const QList<int> &chunks) const
+{
+    QMap<int, QString> hashes;
+    auto timeline = pCore->currentDoc()->getTimeline(m_uuid);
+    if (!timeline || chunks.isEmpty()) {
+        return hashes;
+    }
+    // Chunks rendered with other parameters, or from the original clips instead of the proxies, are different
+    const bool useOriginals = !KdenliveSettings::proxypreview() && pCore->currentDoc()->useProxy();
+    const QByteArray parameters = QStringLiteral("%1 %2 %3 %4 %5")
+                                      .arg(pCore->getCurrentProfilePath(), m_extension, m_consumerParams.join(QLatin1Char(' ')))
+                                      .arg(KdenliveSettings::timelinechunks())
+                                      .arg(int(useOriginals))
+                                      .toUtf8();
+    const QMap<int, QByteArray> contentHashes = timeline->chunkHashes(chunks, KdenliveSettings::timelinechunks());
+    for (auto it = contentHashes.constBegin(); it != contentHashes.constEnd(); ++it) {
+        hashes.insert(it.key(), QString::fromLatin1(QCryptographicHash::hash(parameters + it.value(), QCryptographicHash::Md5).toHex()));
+    }
+    return hashes;
+}
+
+const QString PreviewManager::storedChunkPath(const QString &hash) const
+{
+    return m_chunksDir.absoluteFilePath(QStringLiteral("%1.%2").arg(hash, m_extension));
+}
+
+void PreviewManager::restoreStoredChunks()
+{
+    if (m_previewTrack == nullptr || m_dirtyChunks.isEmpty()) {
+        return;
+    }
+    QMutexLocker lock(&m_dirtyMutex);
+    const QList<int> dirtyChunks = m_dirtyChunks.chunks();
+    lock.unlock();
+    const QMap<int, QString> hashes = chunkHashes(dirtyChunks);
+    bool restored = false;
+    for (auto it = hashes.constBegin(); it != hashes.constEnd(); ++it) {
+        const QString file = storedChunkPath(it.value());
+        if (it.key() != workingPreview && QFileInfo::exists(file) && insertChunk(it.key(), file)) {
+            restored = true;
         }
-        if (!foundChunks.isEmpty()) {
-            std::sort(foundChunks.begin(), foundChunks.end(), chunkSort);
-            m_dirtyMutex.lock();
-            for (auto &ck : foundChunks) {
-                m_dirtyChunks.removeAll(ck);
-                m_renderedChunks << ck;
-            }
-            m_dirtyMutex.unlock();
-            Q_EMIT dirtyChunksChanged();
-            Q_EMIT renderedChunksChanged();
-            reloadChunks(foundChunks);
+    }
+    if (restored) {
+        Q_EMIT dirtyChunksChanged();
+        Q_EMIT renderedChunksChanged();
+    }
+}
+
+bool PreviewManager::insertChunk(int frame, const QString &file)
+{
+    if (!m_previewTrack->is_blank_at(frame)) {
+        return false;
+    }
+    Mlt::Producer prod(pCore->getProjectProfile(), QStringLiteral("avformat:%1").arg(file).toUtf8().constData());
+    if (!prod.is_valid() || prod.get_length() != KdenliveSettings::timelinechunks()) {
+        return false;
+    }
+    prod.set("mlt_service", "avformat-novalidate");
+    m_dirtyMutex.lock();
+    m_dirtyChunks.remove(frame);
+    m_renderedChunks.insert(frame);
+    m_dirtyMutex.unlock();
+    m_tractor->lock();
+    m_previewTrack->insert_at(frame, &prod, 1);
+    m_previewTrack->consolidate_blanks();
+    m_tractor->unlock();
+    // Refresh the modification time, used to remove the least recently used chunks
+    QFile chunkFile(file);
+    if (chunkFile.open(QIODevice::ReadWrite)) {
+        chunkFile.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+    }
+    return true;
+}
+
+QStringList PreviewManager::usedChunkFiles()
+{
+    QStringList files;
+    m_tractor->lock();
+    for (int i = 0; m_previewTrack && i < m_previewTrack->count(); i++) {
+        if (!m_previewTrack->is_blank(i)) {
+            std::unique_ptr<Mlt::Producer> clip(m_previewTrack->get_clip(i));
+            files << QFileInfo(QString::fromUtf8(clip->parent().get("resource"))).fileName();
         }
     }
-    doc->setModified(true);
-    if (timer) {
-        m_previewTimer.start();
+    m_tractor->unlock();
+    return files;
+}
+
+void PreviewManager::saveUsedChunks()
+{
+    QFile file(m_cacheDir.absoluteFilePath(QStringLiteral("usedchunks.txt")));
+    if (file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        file.write(usedChunkFiles().join(QLatin1Char('\n')).toUtf8());
     }
 }
 
 void PreviewManager::doCleanupOldPreviews()
 {
-    if (m_undoDir.dirName() != QLatin1String("undo")) {
+    if (m_chunksDir.dirName() != QLatin1String("chunks")) {
         return;
     }
-    QStringList dirs = m_undoDir.entryList(QDir::Dirs | QDir::NoDotAndDotDot);
-
-    // Use QCollator to do a natural sorting so that 10 is after 2
-    QCollator collator;
-    collator.setNumericMode(true);
-    std::sort(dirs.begin(), dirs.end(), [&collator](const QString &file1, const QString &file2) { return collator.compare(file1, file2) < 0; });
-    bool ok;
-    while (dirs.count() > 5) {
-        QDir tmp = m_undoDir;
-        QString dirName = dirs.takeFirst();
-        dirName.toInt(&ok);
-        if (ok && tmp.cd(dirName)) {
-            tmp.removeRecursively();
+    saveUsedChunks();
+    // Keep the chunks used by any sequence of the project, and a limited number of other chunks that can be reused after an undo
+    constexpr int maxUnusedChunks = 500;
+    QFileInfoList files = m_chunksDir.entryInfoList(QDir::Files, QDir::Time);
+    if (files.count() <= maxUnusedChunks) {
+        return;
+    }
+    QSet<QString> usedFiles;
+    // Closed sequences: chunks listed when the sequence was last saved or rendered
+    QDir previewDir(m_chunksDir.absolutePath());
+    previewDir.cdUp();
+    QStringList lists = {previewDir.absoluteFilePath(QStringLiteral("usedchunks.txt"))};
+    for (const QString &sequenceDir : previewDir.entryList(QDir::Dirs | QDir::NoDotAndDotDot)) {
+        lists << previewDir.absoluteFilePath(sequenceDir + QStringLiteral("/usedchunks.txt"));
+    }
+    for (const QString &list : std::as_const(lists)) {
+        QFile file(list);
+        if (file.open(QIODevice::ReadOnly)) {
+            for (const QString &name : QString::fromUtf8(file.readAll()).split(QLatin1Char('\n'), Qt::SkipEmptyParts)) {
+                usedFiles.insert(name);
+            }
+        }
+    }
+    // Open sequences: their current preview track
+    KdenliveDoc *doc = pCore->currentDoc();
+    for (const QUuid &uuid : doc->getTimelinesUuids()) {
+        std::shared_ptr<TimelineItemModel> timeline = doc->getTimeline(uuid);
+        if (timeline && timeline->hasTimelinePreview()) {
+            for (const QString &name : timeline->previewManager()->usedChunkFiles()) {
+                usedFiles.insert(name);
+            }
+        }
+    }
+    int unusedChunks = 0;
+    // Most recently used first
+    for (const QFileInfo &file : std::as_const(files)) {
+        if (usedFiles.contains(file.fileName())) {
+            continue;
+        }
+        if (++unusedChunks > maxUnusedChunks && m_chunksDir.remove(file.fileName())) {
+            CacheManager::get()->recordRemoval(file.absoluteFilePath(), file.size());
         }
     }
 }
@@ -433,15 +494,13 @@ void PreviewManager::clearPreviewRange(bool resetZones)
     m_tractor->lock();
     bool hasPreview = m_previewTrack != nullptr;
     QMutexLocker lock(&m_dirtyMutex);
-    for (const auto &ix : std::as_const(m_renderedChunks)) {
-        m_cacheDir.remove(QStringLiteral("%1.%2").arg(ix.toInt()).arg(m_extension));
-        if (!m_dirtyChunks.contains(ix)) {
-            m_dirtyChunks << ix;
-        }
+    // Stored chunks are kept, they can be used by other sequences and are removed by doCleanupOldPreviews
+    for (int ix : m_renderedChunks.chunks()) {
+        m_dirtyChunks.insert(ix);
         if (!hasPreview) {
             continue;
         }
-        int trackIx = m_previewTrack->get_clip_index_at(ix.toInt());
+        int trackIx = m_previewTrack->get_clip_index_at(ix);
         if (!m_previewTrack->is_blank(trackIx)) {
             Mlt::Producer *prod = m_previewTrack->replace_with_blank(trackIx);
             delete prod;
@@ -471,15 +530,14 @@ void PreviewManager::addPreviewRange(const QPoint zone, bool add)
     for (int i = startChunk; i <= endChunk; i++) {
         int frame = i * chunkSize;
         if (add) {
-            if (!m_renderedChunks.contains(frame) && !m_dirtyChunks.contains(frame)) {
-                m_dirtyChunks << frame;
+            if (!m_renderedChunks.contains(frame)) {
+                m_dirtyChunks.insert(frame);
             }
         } else {
-            if (m_renderedChunks.contains(frame)) {
+            if (m_renderedChunks.remove(frame)) {
                 toRemove << frame;
-                m_renderedChunks.removeAll(frame);
             } else {
-                m_dirtyChunks.removeAll(frame);
+                m_dirtyChunks.remove(frame);
             }
         }
     }
@@ -496,7 +554,6 @@ void PreviewManager::addPreviewRange(const QPoint zone, bool add)
         m_tractor->lock();
         bool hasPreview = m_previewTrack != nullptr;
         for (int ix : std::as_const(toRemove)) {
-            m_cacheDir.remove(QStringLiteral("%1.%2").arg(ix).arg(m_extension));
             if (!hasPreview) {
                 continue;
             }
@@ -546,6 +603,12 @@ void PreviewManager::startPreviewRender()
     if (!m_dirtyChunks.isEmpty()) {
         // Abort any rendering
         abortRendering();
+        // Only render the chunks that are not already in the store
+        restoreStoredChunks();
+        if (m_dirtyChunks.isEmpty()) {
+            m_previewTimer.stop();
+            return;
+        }
         m_waitingThumbs.clear();
         // clear log
         m_errorLog.clear();
@@ -579,8 +642,21 @@ void PreviewManager::receivedStderr()
         } else if (result.startsWith(QLatin1String("DONE:"))) {
             int chunk = result.section(QLatin1String("DONE:"), 1).simplified().toInt();
             m_processedChunks++;
-            QString fileName = QStringLiteral("%1.%2").arg(chunk).arg(m_extension);
-            Q_EMIT previewRender(chunk, m_cacheDir.absoluteFilePath(fileName), 1000 * m_processedChunks / m_chunksToRender);
+            QString fileName = m_cacheDir.absoluteFilePath(QStringLiteral("%1.%2").arg(chunk).arg(m_extension));
+            const QString hash = m_renderingHashes.value(chunk);
+            if (!hash.isEmpty()) {
+                // Move the chunk to the store, the same content may have been stored meanwhile by another sequence
+                const QString storedFile = storedChunkPath(hash);
+                if (QFileInfo::exists(storedFile)) {
+                    QFile::remove(fileName);
+                    fileName = storedFile;
+                    CacheManager::get()->recordAccess(storedFile);
+                } else if (QFile::rename(fileName, storedFile)) {
+                    fileName = storedFile;
+                    CacheManager::get()->recordWrite(storedFile);
+                }
+            }
+            Q_EMIT previewRender(chunk, fileName, 1000 * m_processedChunks / m_chunksToRender);
         } else {
             m_errorLog.append(result);
         }
@@ -595,9 +671,12 @@ void PreviewManager::doPreviewRender(const QString &scene)
     }
     QMutexLocker lock(&m_dirtyMutex);
     Q_ASSERT(m_previewProcess.state() == QProcess::NotRunning);
-    std::sort(m_dirtyChunks.begin(), m_dirtyChunks.end(), chunkSort);
-    const QStringList dirtyChunks = getCompressedList(m_dirtyChunks);
-    m_chunksToRender = m_dirtyChunks.count();
+    const QStringList dirtyChunks = m_dirtyChunks.toStringList();
+    const QList<int> chunks = m_dirtyChunks.chunks();
+    lock.unlock();
+    // The hashes are computed when the scene is saved, rendered chunks are stored with the content they were rendered from
+    m_renderingHashes = chunkHashes(chunks);
+    m_chunksToRender = chunks.count();
     m_processedChunks = 0;
     int chunkSize = KdenliveSettings::timelinechunks();
     QStringList args{QStringLiteral("preview-chunks"),
@@ -631,6 +710,8 @@ void PreviewManager::processEnded(int exitCode, QProcess::ExitStatus status)
         // Normal exit and exit code 0: everything okay
         pCore->currentDoc()->previewProgress(1000);
     }
+    m_renderingHashes.clear();
+    Q_EMIT cleanupOldPreviews();
     workingPreview = -1;
     m_warnOnCrash = true;
     Q_EMIT workingPreviewChanged();
@@ -647,25 +728,6 @@ void PreviewManager::slotProcessDirtyChunks()
     }
 }
 
-void PreviewManager::slotRemoveInvalidUndo(int ix)
-{
-    QMutexLocker lock(&m_previewMutex);
-    if (m_undoDir.dirName() != QLatin1String("undo")) {
-        // Make sure we delete correct folder
-        return;
-    }
-    QStringList dirs = m_undoDir.entryList(QDir::Dirs | QDir::NoDotAndDotDot);
-    bool ok;
-    for (const QString &dir : std::as_const(dirs)) {
-        if (dir.toInt(&ok) >= ix && ok) {
-            QDir tmp = m_undoDir;
-            if (tmp.cd(dir)) {
-                tmp.removeRecursively();
-            }
-        }
-    }
-}
-
 void PreviewManager::invalidatePreview(int startFrame, int endFrame)
 {
     if (m_previewTrack == nullptr) {
@@ -681,8 +743,7 @@ void PreviewManager::invalidatePreview(int startFrame, int endFrame)
     bool wasInDirtyZone = false;
     if (!m_renderedChunks.isEmpty()) {
         // Check if the invalidated zone was already rendered
-        std::sort(m_renderedChunks.begin(), m_renderedChunks.end(), chunkSort);
-        if (start <= m_renderedChunks.last().toInt() && end >= m_renderedChunks.first().toInt()) {
+        if (m_renderedChunks.intersects(start, end)) {
             alreadyRendered = true;
         } else if (workingPreview >= start && workingPreview <= end) {
             alreadyRendered = true;
@@ -690,8 +751,7 @@ void PreviewManager::invalidatePreview(int startFrame, int endFrame)
     }
     if (!alreadyRendered && !m_dirtyChunks.isEmpty()) {
         // Check if the invalidate zone is in the current todo list (dirtychunks)
-        std::sort(m_dirtyChunks.begin(), m_dirtyChunks.end(), chunkSort);
-        if (start <= m_dirtyChunks.last().toInt() && end >= m_dirtyChunks.first().toInt()) {
+        if (m_dirtyChunks.intersects(start, end)) {
             wasInDirtyZone = true;
         }
     }
@@ -709,11 +769,9 @@ void PreviewManager::invalidatePreview(int startFrame, int endFrame)
                 }
                 Mlt::Producer *prod = m_previewTrack->replace_with_blank(ix);
                 delete prod;
-                QVariant val(i);
-                m_renderedChunks.removeAll(val);
-                if (!m_dirtyChunks.contains(val)) {
-                    QMutexLocker lock(&m_dirtyMutex);
-                    m_dirtyChunks << val;
+                QMutexLocker lock(&m_dirtyMutex);
+                m_renderedChunks.remove(i);
+                if (m_dirtyChunks.insert(i)) {
                     chunksChanged = true;
                 }
             }
@@ -736,28 +794,6 @@ void PreviewManager::invalidatePreview(int startFrame, int endFrame)
     m_previewGatherTimer.start();
 }
 
-void PreviewManager::reloadChunks(const QVariantList &chunks)
-{
-    if (m_previewTrack == nullptr || chunks.isEmpty()) {
-        return;
-    }
-    m_tractor->lock();
-    for (const auto &ix : chunks) {
-        if (m_previewTrack->is_blank_at(ix.toInt())) {
-            QString fileName = m_cacheDir.absoluteFilePath(QStringLiteral("%1.%2").arg(ix.toInt()).arg(m_extension));
-            fileName.prepend(QStringLiteral("avformat:"));
-            Mlt::Producer prod(pCore->getProjectProfile(), fileName.toUtf8().constData());
-            if (prod.is_valid()) {
-                // m_ruler->updatePreview(ix, true);
-                prod.set("mlt_service", "avformat-novalidate");
-                m_previewTrack->insert_at(ix.toInt(), &prod, 1);
-            }
-        }
-    }
-    m_previewTrack->consolidate_blanks();
-    m_tractor->unlock();
-}
-
 void PreviewManager::gotPreviewRender(int frame, const QString &file, int progress)
 {
     if (m_previewTrack == nullptr) {
@@ -781,18 +817,8 @@ void PreviewManager::gotPreviewRender(int frame, const QString &file, int progre
         return;
     }
     if (m_previewTrack->is_blank_at(frame)) {
-        Mlt::Producer prod(pCore->getProjectProfile(), QStringLiteral("avformat:%1").arg(file).toUtf8().constData());
-        if (prod.is_valid() && prod.get_length() == KdenliveSettings::timelinechunks()) {
-            m_dirtyMutex.lock();
-            m_dirtyChunks.removeAll(QVariant(frame));
-            m_dirtyMutex.unlock();
-            m_renderedChunks << frame;
+        if (insertChunk(frame, file)) {
             Q_EMIT renderedChunksChanged();
-            prod.set("mlt_service", "avformat-novalidate");
-            m_tractor->lock();
-            m_previewTrack->insert_at(frame, &prod, 1);
-            m_previewTrack->consolidate_blanks();
-            m_tractor->unlock();
             pCore->currentDoc()->previewProgress(progress);
             pCore->currentDoc()->setModified(true);
         } else {
@@ -813,12 +839,9 @@ void PreviewManager::corruptedChunk(int frame, const QString &fileName)
         Q_EMIT workingPreviewChanged();
     }
     Q_EMIT previewRender(0, m_errorLog, -1);
-    m_cacheDir.remove(fileName);
-    if (!m_dirtyChunks.contains(frame)) {
-        QMutexLocker lock(&m_dirtyMutex);
-        m_dirtyChunks << frame;
-        std::sort(m_dirtyChunks.begin(), m_dirtyChunks.end(), chunkSort);
-    }
+    QFile::remove(fileName);
+    QMutexLocker lock(&m_dirtyMutex);
+    m_dirtyChunks.insert(frame);
 }
 
 int PreviewManager::setOverlayTrack(Mlt::Playlist *overlay)
@@ -839,50 +862,14 @@ void PreviewManager::removeOverlayTrack()
 QPair<QStringList, QStringList> PreviewManager::previewChunks()
 {
     QMutexLocker lock(&m_dirtyMutex);
-    std::sort(m_renderedChunks.begin(), m_renderedChunks.end(), chunkSort);
-    const QStringList renderedChunks = getCompressedList(m_renderedChunks);
-    std::sort(m_dirtyChunks.begin(), m_dirtyChunks.end(), chunkSort);
-    const QStringList dirtyChunks = getCompressedList(m_dirtyChunks);
+    const QStringList renderedChunks = m_renderedChunks.toStringList();
+    const QStringList dirtyChunks = m_dirtyChunks.toStringList();
     lock.unlock();
+    // Called when the sequence is saved, so that its chunks are kept while it is closed
+    saveUsedChunks();
     return {renderedChunks, dirtyChunks};
 }
 
-const QStringList PreviewManager::getCompressedList(const QVariantList items) const
-{
-    QStringList resultString;
-    int lastFrame = -1;
-    QString currentString;
-    for (const QVariant &frame : items) {
-        int current = frame.toInt();
-        if (current - KdenliveSettings::timelinechunks() == lastFrame) {
-            lastFrame = current;
-            if (frame == items.last()) {
-                currentString.append(QStringLiteral("-%1").arg(lastFrame));
-                resultString << currentString;
-                currentString.clear();
-            }
-            continue;
-        }
-        if (currentString.isEmpty()) {
-            currentString = frame.toString();
-        } else if (currentString == QString::number(lastFrame)) {
-            // Only one chunk, store it
-            resultString << currentString;
-            currentString = frame.toString();
-        } else {
-            // Range, store
-            currentString.append(QStringLiteral("-%1").arg(lastFrame));
-            resultString << currentString;
-            currentString = frame.toString();
-        }
-        lastFrame = current;
-    }
-    if (!currentString.isEmpty()) {
-        resultString << currentString;
-    }
-    return resultString;
-}
-
 bool PreviewManager::hasOverlayTrack() const
 {
     return m_overlayTrack != nullptr;
@@ -7,6 +7,7 @@
 #pragma once
 
 #include "definitions.h"
+#include "previewchunkset.h"
 
 #include <QDir>
 #include <QFuture>
@@ -30,6 +31,9 @@ class Producer;
     This allow us to get a preview with a smooth playback of our project.
     Only the preview zone is rendered. Once defined, a preview zone shows as a red line below
     the timeline ruler. As chunks are rendered, the zone turns to green.
+    Rendered chunks are stored in a folder shared by all sequences of the project, named after the hash
+    of their content (see TimelineModel::chunkHashes). A chunk whose content was already rendered, for
+    example after an undo or in another sequence, is reused instead of being rendered again.
  */
 class PreviewManager : public QObject
 {
@@ -64,7 +68,7 @@ public:
     /** @brief: Returns directory currently used to store the preview files. */
     const QDir getCacheDir() const;
     /** @brief: Load existing ruler chunks. */
-    void loadChunks(QVariantList previewChunks, QVariantList dirtyChunks, Mlt::Playlist &playlist);
+    void loadChunks(const QList<int> &previewChunks, const QList<int> &dirtyChunks, Mlt::Playlist &playlist);
     int setOverlayTrack(Mlt::Playlist *overlay);
     /** @brief Remove the effect compare overlay track */
     void removeOverlayTrack();
@@ -72,6 +76,8 @@ public:
     int workingPreview;
     /** @brief Returns the list of existing chunks */
     QPair<QStringList, QStringList> previewChunks();
+    /** @brief Returns the file names of the stored chunks on the preview track */
+    QStringList usedChunkFiles();
     bool hasOverlayTrack() const;
     bool hasPreviewTrack() const;
     int addedTracks() const;
@@ -91,8 +97,10 @@ private:
     QProcess m_previewProcess;
     /** @brief: The directory used to store the preview files. */
     QDir m_cacheDir;
-    /** @brief: The directory used to store undo history of preview files (child of m_cacheDir). */
-    QDir m_undoDir;
+    /** @brief: The directory where rendered chunks are stored, named after their content hash. Shared by all sequences. */
+    QDir m_chunksDir;
+    /** @brief: The content hash of the chunks being rendered */
+    QMap<int, QString> m_renderingHashes;
     QMutex m_previewMutex;
     QStringList m_consumerParams;
     QString m_extension;
@@ -109,25 +117,24 @@ private:
     int m_processedChunks;
     /** @brief: The render process output, useful in case of failure */
     QString m_errorLog;
-    /** @brief: After an undo/redo, if we have preview history, use it. */
-    void reloadChunks(const QVariantList &chunks);
+    /** @brief: The content hash of @param chunks, including the preview rendering parameters. */
+    QMap<int, QString> chunkHashes(const QList<int> &chunks) const;
+    /** @brief: Path of the stored chunk with content @param hash. */
+    const QString storedChunkPath(const QString &hash) const;
+    /** @brief: Put the dirty chunks whose content is already in the chunk store on the preview track. */
+    void restoreStoredChunks();
+    /** @brief: Insert a rendered chunk file on the preview track, returns false if the file is not a valid chunk. */
+    bool insertChunk(int frame, const QString &file);
     /** @brief: A chunk failed to render, abort. */
     void corruptedChunk(int workingPreview, const QString &fileName);
-    /** @brief: Get a compressed list of chunks, like: "0-500,525,575". */
-    const QStringList getCompressedList(const QVariantList items) const;
-
-    /** @brief Compare two chunks for usage by std::sort
-     * @returns true if @param c1 is less than @param c2
-     */
-    static bool chunkSort(const QVariant &c1, const QVariant &c2) { return c1.toInt() < c2.toInt(); };
+    /** @brief: Write the chunk files used by our preview track to the sequence cache folder, so that other sequences do not remove them. */
+    void saveUsedChunks();
 
 private Q_SLOTS:
-    /** @brief: To avoid filling the hard drive, remove preview undo history after 5 steps. */
+    /** @brief: To avoid filling the hard drive, remove the oldest chunks that are not used by any sequence of the project. */
     void doCleanupOldPreviews();
     /** @brief: Start the real rendering process. */
     void doPreviewRender(const QString &scene); // std::shared_ptr<Mlt::Producer> sourceProd);
-    /** @brief: If user does an undo, then makes a new timeline operation, delete undo history of more recent stack . */
-    void slotRemoveInvalidUndo(int ix);
     /** @brief: When the timer collecting invalid zones is done, process. */
     void slotProcessDirtyChunks();
     /** @brief: Process preview rendering output. */
@@ -143,8 +150,8 @@ public Q_SLOTS:
     void invalidatePreview(int startFrame, int endFrame);
 
 protected:
-    QVariantList m_renderedChunks;
-    QVariantList m_dirtyChunks;
+    PreviewChunkSet m_renderedChunks;
+    PreviewChunkSet m_dirtyChunks;
     mutable QMutex m_dirtyMutex;
     /** @brief: Re-enable timeline preview track. */
     void enable();
@@ -49,6 +49,9 @@ Row {
         property int startFrame: clipRoot.inPoint
         property int endFrame: clipRoot.outPoint
         property real imageWidth: Math.max(thumbRow.thumbWidth, parent.width / thumbRepeater.count)
+        // When zoomed out, thumbnails more than 2 seconds apart are decoded from the previous keyframe, which is much faster on long GOP files.
+        // The first and last thumbnails always show the exact in and out frames
+        property bool keyframeThumbs: thumbRepeater.count > 2 && !fixedThumbs && thumbRepeater.imageWidth * Math.abs(clipRoot.speed) / timeline.scaleFactor > 2 * timeline.fps()
         property int thumbStartFrame: fixedThumbs ? 0 :
                                                     (clipRoot.speed >= 0)
                                                     ? Math.round(clipRoot.inPoint * thumbRow.initialSpeed)
@@ -76,7 +79,7 @@ Row {
                                  : Image.AlignLeft
             source: thumbRepeater.count < 3
                     ? (clipRoot.baseThumbPath + currentFrame)
-                    : (index * width < clipRoot.scrollStart - width || index * width > clipRoot.scrollStart + scrollView.width) ? '' : clipRoot.baseThumbPath + currentFrame
+                    : (index * width < clipRoot.scrollStart - width || index * width > clipRoot.scrollStart + scrollView.width) ? '' : clipRoot.baseThumbPath + (thumbRepeater.keyframeThumbs && index > 0 && index < thumbRepeater.count - 1 ? 'k' : '') + currentFrame
             onStatusChanged: {
                 if (status === Image.Ready && (index == 0  || index == thumbRepeater.count - 1)) {
                     thumbPlaceholder.source = source
@@ -19,12 +19,47 @@ Item{
     property int trackThumbsFormat
     property int itemType: 0
     property var effectZones
+    // Frame range for which item delegates are currently instantiated
+    property int coveredStart: -1
+    property int coveredEnd: -1
     opacity: model.disabled ? 0.4 : 1
 
     function clipAt(index) {
         return repeater.itemAt(index)
     }
 
+    // Only create delegates for the items around the visible area (one viewport width on each side).
+    // Delegates are added or destroyed when scrolling or zooming leaves the covered range.
+    function updateVisibleItems(force) {
+        var visibleLength = Math.max(1, root.scrollMax - root.scrollMin)
+        if (!force && root.scrollMin >= coveredStart && root.scrollMax <= coveredEnd && coveredEnd - coveredStart <= 4 * visibleLength) {
+            return
+        }
+        coveredStart = Math.max(0, root.scrollMin - visibleLength)
+        coveredEnd = root.scrollMax + visibleLength
+        var ids = controller.getItemIdsInRange(trackInternalId, coveredStart, coveredEnd)
+        var wanted = {}
+        for (var i = 0; i < ids.length; i++) {
+            wanted[ids[i]] = true
+        }
+        for (var j = inViewGroup.count - 1; j >= 0; j--) {
+            var entry = inViewGroup.get(j)
+            if (wanted[entry.model.item]) {
+                delete wanted[entry.model.item]
+            } else if (!root.dragInProgress && !entry.model.selected && !entry.model.isGrabbed) {
+                // Keep the items being manipulated
+                inViewGroup.remove(j, 1)
+            }
+        }
+        for (var itemId in wanted) {
+            // The delegate model rows are those of the sort proxy, not of the timeline model
+            var itemIndex = multitrack.mapFromSource(controller.getItemIndex(parseInt(itemId)))
+            if (itemIndex.valid) {
+                trackModel.items.addGroups(itemIndex.row, 1, "inView")
+            }
+        }
+    }
+
     function isClip(type) {
         return type != ProducerType.Composition && type != ProducerType.Track;
     }
@@ -123,8 +158,40 @@ Item{
 
     width: clipRow.width
 
+    Component.onCompleted: updateVisibleItems(true)
+
+    Connections {
+        target: root
+        function onScrollMinChanged() { trackRoot.updateVisibleItems(false) }
+        function onScrollMaxChanged() { trackRoot.updateVisibleItems(false) }
+    }
+
+    Connections {
+        // Items of this track that moved or were resized may enter the covered range
+        target: trackModel.model
+        function onDataChanged(topLeft, bottomRight, roles) {
+            if (topLeft.parent.valid && topLeft.parent.row === trackRoot.rootIndex.row && controller.changesItemRange(roles)) {
+                visibleItemsTimer.restart()
+            }
+        }
+        function onLayoutChanged() { visibleItemsTimer.restart() }
+    }
+
+    Timer {
+        id: visibleItemsTimer
+        interval: 50
+        repeat: false
+        onTriggered: trackRoot.updateVisibleItems(true)
+    }
+
     DelegateModel {
         id: trackModel
+        groups: DelegateModelGroup {
+            id: inViewGroup
+            name: "inView"
+        }
+        filterOnGroup: "inView"
+        items.onChanged: visibleItemsTimer.restart()
         delegate: Item {
             property var itemModel : model
             property bool clipItem: isClip(model.clipType)
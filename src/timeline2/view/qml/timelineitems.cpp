@@ -6,6 +6,7 @@
 */
 
 #include "assets/keyframes/model/keyframemodel.hpp"
+#include "audio/audioLevels.h"
 #include "bin/projectitemmodel.h"
 #include "capture/mediacapture.h"
 #include "core.h"
@@ -158,14 +159,15 @@ public:
         // setTextureSize(QSize(1, 1));
         connect(this, &TimelineWaveform::levelsChanged, [&]() {
             if (!m_binId.isEmpty()) {
-                if (m_audioLevels.isEmpty() && m_stream >= 0) {
+                if (m_audioLevels == nullptr && m_stream >= 0) {
                     update();
                 } else {
                     // Clip changed, reset levels
-                    m_audioLevels.clear();
+                    m_audioLevels.reset();
                 }
             }
         });
+        connect(pCore->projectItemModel().get(), &ProjectItemModel::audioLevelsChanged, this, &TimelineWaveform::levelsAvailable);
         connect(this, &TimelineWaveform::normalizeChanged, [&]() {
             m_audioMax = KdenliveSettings::normalizechannels() ? pCore->projectItemModel()->getAudioMaxLevel(m_binId, m_stream) : 0;
             update();
@@ -178,13 +180,21 @@ public:
         if (m_binId.isEmpty()) {
             return;
         }
-        if (m_audioLevels.isEmpty() && m_stream >= 0) {
+        if (m_audioLevels == nullptr && m_stream >= 0) {
             m_audioLevels = pCore->projectItemModel()->getAudioLevelsByBinID(m_binId, m_stream);
-            if (m_audioLevels.isEmpty()) {
+            if (m_audioLevels == nullptr) {
                 return;
             }
             m_audioMax = KdenliveSettings::normalizechannels() ? pCore->projectItemModel()->getAudioMaxLevel(m_binId, m_stream) : 0;
         }
+        if (m_audioLevels == nullptr) {
+            return;
+        }
+        // The levels published so far, more blocks may be added while generating
+        const AudioLevels::Snapshot audioLevels = m_audioLevels->snapshot();
+        if (audioLevels.isEmpty()) {
+            return;
+        }
 
         if (m_outPoint == m_inPoint) {
             return;
@@ -217,7 +227,7 @@ public:
             scaleFactor = m_audioMax;
         }
         bool reverse = m_speed < 0;
-        int maxLength = m_audioLevels.length();
+        int maxLength = audioLevels.count();
         if (reverse) {
             m_inPoint = qMin(m_inPoint, maxLength - m_channels);
         }
@@ -245,9 +255,9 @@ public:
                 if (idx + m_channels >= maxLength || idx < 0) {
                     break;
                 }
-                level = m_audioLevels.at(idx) / scaleFactor;
+                level = audioLevels.at(idx) / scaleFactor;
                 for (int k = 1; k < m_channels; k++) {
-                    level = qMax(level, m_audioLevels.at(idx + k) / scaleFactor);
+                    level = qMax(level, audioLevels.at(idx + k) / scaleFactor);
                 }
                 if (pathDraw) {
                     double val = height() - level * height();
@@ -306,10 +316,10 @@ public:
                     idx += channel;
                     if (idx >= maxLength || idx < 0) break;
                     if (pathDraw) {
-                        level = m_audioLevels.at(idx) * scaleFactor;
+                        level = audioLevels.at(idx) * scaleFactor;
                         path.lineTo(i, y - level);
                     } else {
-                        level = m_audioLevels.at(idx) * scaleFactor; // divide height by 510 (2*255) to get height
+                        level = audioLevels.at(idx) * scaleFactor; // divide height by 510 (2*255) to get height
                         painter->drawLine(int(i), int(y - level), int(i), int(y + level));
                     }
                 }
@@ -334,8 +344,50 @@ Q_SIGNALS:
     void inPointChanged();
     void audioChannelsChanged();
 
+private Q_SLOTS:
+    /** @brief New audio levels were generated, repaint the part of the waveform displaying them */
+    void levelsAvailable(const QString &binId, int stream, int first, int last)
+    {
+        if (binId != m_binId || stream != m_stream) {
+            return;
+        }
+        // The levels may have been regenerated
+        std::shared_ptr<AudioLevels> levels = pCore->projectItemModel()->getAudioLevelsByBinID(m_binId, m_stream);
+        if (levels != m_audioLevels) {
+            // Nothing was painted from these levels yet
+            m_audioLevels.reset();
+            update();
+            return;
+        }
+        if (KdenliveSettings::normalizechannels()) {
+            double audioMax = pCore->projectItemModel()->getAudioMaxLevel(m_binId, m_stream);
+            if (audioMax != m_audioMax) {
+                // The scale changed, repaint everything
+                m_audioMax = audioMax;
+                update();
+                return;
+            }
+        }
+        qreal indicesPrPixel = m_channels / m_scale * qAbs(m_speed);
+        if (indicesPrPixel <= 0) {
+            update();
+            return;
+        }
+        double start = (first - m_inPoint) / indicesPrPixel;
+        double end = (last - m_inPoint) / indicesPrPixel;
+        if (m_speed < 0) {
+            start = (m_inPoint - last) / indicesPrPixel;
+            end = (m_inPoint - first) / indicesPrPixel;
+        }
+        if (end < 0 || start > width()) {
+            return;
+        }
+        // Include the previous end of the waveform, which was closed at the last available level
+        update(QRect(qFloor(start) - 2, 0, qCeil(end - start) + 4, qCeil(height())));
+    }
+
 private:
-    QVector<uint8_t> m_audioLevels;
+    std::shared_ptr<AudioLevels> m_audioLevels;
     int m_inPoint;
     int m_outPoint;
     QString m_binId;
@@ -350,7 +402,7 @@ private:
     int m_stream{0};
     double m_scale;
     double m_speed;
-    double m_audioMax;
+    double m_audioMax{0};
     bool m_firstChunk{false};
     bool m_opaquePaint{false};
     int m_index{0};
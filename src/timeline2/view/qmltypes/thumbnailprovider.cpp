@@ -27,10 +27,15 @@ ThumbnailProvider::~ThumbnailProvider() = default;
 QImage ThumbnailProvider::requestImage(const QString &id, QSize *size, const QSize &requestedSize)
 {
     QImage result;
-    // id is binID/#frameNumber
+    // id is binID/#frameNumber, or binID/#kframeNumber for a thumbnail decoded from the nearest keyframe
     QString binId = id.section('/', 0, 0);
+    QString frame = id.section('#', -1);
+    bool keyframe = frame.startsWith(QLatin1Char('k'));
+    if (keyframe) {
+        frame.remove(0, 1);
+    }
     bool ok;
-    int frameNumber = id.section('#', -1).toInt(&ok);
+    int frameNumber = frame.toInt(&ok);
     if (ok) {
         std::shared_ptr<ProjectClip> binClip = pCore->projectItemModel()->getClipByBinID(binId);
         if (binClip) {
@@ -39,13 +44,28 @@ QImage ThumbnailProvider::requestImage(const QString &id, QSize *size, const QSi
                 // for endless loopable clips, we rewrite the position
                 frameNumber = frameNumber - ((frameNumber / duration) * duration);
             }
-            result = ThumbnailCache::get()->getThumbnail(binClip->hashForThumbs(), binId, frameNumber);
+            result = keyframe ? ThumbnailCache::get()->getKeyframeThumbnail(binId, frameNumber)
+                              : ThumbnailCache::get()->getThumbnail(binClip->hashForThumbs(), binId, frameNumber);
             if (!result.isNull()) {
 
                 *size = result.size();
                 return result;
             }
-            std::unique_ptr<Mlt::Producer> prod = binClip->getThumbProducer();
+            std::unique_ptr<Mlt::Producer> prod;
+            int seekFrame = frameNumber;
+            if (keyframe) {
+                prod = binClip->getKeyframeThumbProducer();
+                if (prod) {
+                    // Decode the keyframe before the requested frame so that we never show a frame past the clip out point
+                    seekFrame = qMax(binClip->keyframeBefore(frameNumber), 0);
+                } else {
+                    // Keyframe positions are unknown, use an exact thumbnail
+                    keyframe = false;
+                }
+            }
+            if (!prod) {
+                prod = binClip->getThumbProducer();
+            }
             if (prod && prod->is_valid()) {
                 if (binClip->clipType() != ClipType::Timeline && binClip->clipType() != ClipType::Playlist) {
                     Mlt::Profile *prodProfile = &pCore->thumbProfile();
@@ -56,8 +76,12 @@ QImage ThumbnailProvider::requestImage(const QString &id, QSize *size, const QSi
                     prod->attach(padder);
                     prod->attach(converter);
                 }
-                result = makeThumbnail(std::move(prod), frameNumber, requestedSize);
-                ThumbnailCache::get()->storeThumbnail(binId, frameNumber, result, false);
+                result = makeThumbnail(std::move(prod), seekFrame, requestedSize);
+                if (keyframe) {
+                    ThumbnailCache::get()->storeKeyframeThumbnail(binId, frameNumber, result);
+                } else {
+                    ThumbnailCache::get()->storeThumbnail(binId, frameNumber, result, false);
+                }
             }
         }
     }
@@ -132,6 +132,9 @@ void TimelineController::setModel(std::shared_ptr<TimelineItemModel> model)
     connect(this, &TimelineController::videoTargetChanged, this, &TimelineController::updateVideoTarget);
     connect(this, &TimelineController::audioTargetChanged, this, &TimelineController::updateAudioTarget);
     connect(m_model.get(), &TimelineItemModel::requestMonitorRefresh, [&]() { pCore->refreshProjectMonitorOnce(true); });
+    connect(m_model.get(), &TimelineModel::invalidateZone, pCore->monitorManager()->projectMonitor(), &Monitor::invalidateFrameCache, Qt::DirectConnection);
+    connect(m_model.get(), &TimelineModel::invalidateFrames, pCore->monitorManager()->projectMonitor(), &Monitor::invalidateFrameCache,
+            Qt::DirectConnection);
     connect(m_model.get(), &TimelineModel::durationUpdated, this, &TimelineController::checkDuration);
     connect(m_model.get(), &TimelineModel::selectionChanged, this, &TimelineController::selectionChanged);
     connect(m_model.get(), &TimelineModel::selectedMixChanged, this, &TimelineController::showMixModel);
@@ -2645,7 +2648,7 @@ void TimelineController::disablePreview(bool disable)
                 m_model->m_tractor->unlock();
             }
             Mlt::Playlist playlist;
-            m_model->previewManager()->loadChunks(QVariantList(), QVariantList(), playlist);
+            m_model->previewManager()->loadChunks(QList<int>(), QList<int>(), playlist);
             m_usePreview = true;
         }
     }
@@ -2653,12 +2656,12 @@ void TimelineController::disablePreview(bool disable)
 
 QVariantList TimelineController::dirtyChunks() const
 {
-    return m_model->hasTimelinePreview() ? m_model->previewManager()->m_dirtyChunks : QVariantList();
+    return m_model->hasTimelinePreview() ? m_model->previewManager()->m_dirtyChunks.toVariantList() : QVariantList();
 }
 
 QVariantList TimelineController::renderedChunks() const
 {
-    return m_model->hasTimelinePreview() ? m_model->previewManager()->m_renderedChunks : QVariantList();
+    return m_model->hasTimelinePreview() ? m_model->previewManager()->m_renderedChunks.toVariantList() : QVariantList();
 }
 
 int TimelineController::workingPreview() const
@@ -46,7 +46,9 @@ protected:
     /** @brief Retrieves additional info about effects from a custom XML file
        The resulting assets are stored in customAssets
      */
-    void parseCustomAssetFile(const QString &file_name, std::unordered_map<QString, Info> &customAssets) const override;
+    void parseCustomAssetDocument(QDomDocument &doc, const QString &file_name, std::unordered_map<QString, Info> &customAssets) const override;
+
+    QString assetCacheName() const override;
 
     /** @brief Returns the paths where the custom transitions' descriptions are stored */
     QStringList assetDirs() const override;
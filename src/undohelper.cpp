@@ -4,17 +4,27 @@
 */
 
 #include "undohelper.hpp"
+#include "utils/tracing.h"
 #ifdef CRASH_AUTO_TEST
 #include "logger.hpp"
 #endif
 #include <QDebug>
 #include <QTime>
 #include <utility>
+
+namespace {
+/** @brief Estimated heap size of a std::function and the state it captures when no memory cost was set */
+constexpr qint64 lambdaCost = 256;
+/** @brief Commands with a merge key are merged if pushed within this delay */
+constexpr int mergeDelay = 3000;
+} // namespace
+
 FunctionalUndoCommand::FunctionalUndoCommand(Fun undo, Fun redo, const QString &text, QUndoCommand *parent)
     : QUndoCommand(parent)
     , m_undo(std::move(undo))
     , m_redo(std::move(redo))
     , m_undone(false)
+    , m_stamp(QTime::currentTime())
 {
     setText(QStringLiteral("%1 %2").arg(QTime::currentTime().toString("hh:mm")).arg(text));
 }
@@ -22,19 +32,21 @@ FunctionalUndoCommand::FunctionalUndoCommand(Fun undo, Fun redo, const QString &
 void FunctionalUndoCommand::undo()
 {
     // qDebug() << "UNDOING " <<text();
+    TRACE_SCOPE_NAMED("undo", "undo");
 #ifdef CRASH_AUTO_TEST
     Logger::log_undo(true);
 #endif
     m_undone = true;
-    bool res = m_undo();
+    bool res = m_discarded || m_undo();
     Q_ASSERT(res);
     QUndoCommand::undo();
 }
 
 void FunctionalUndoCommand::redo()
 {
-    if (m_undone) {
+    if (m_undone && !m_discarded) {
         // qDebug() << "REDOING " <<text();
+        TRACE_SCOPE_NAMED("undo", "redo");
 #ifdef CRASH_AUTO_TEST
         Logger::log_undo(false);
 #endif
@@ -43,3 +55,53 @@ void FunctionalUndoCommand::redo()
     }
     QUndoCommand::redo();
 }
+
+int FunctionalUndoCommand::id() const
+{
+    // Asset commands use ids 1 to 4
+    return m_mergeKey.isEmpty() ? -1 : 5;
+}
+
+bool FunctionalUndoCommand::mergeWith(const QUndoCommand *other)
+{
+    auto *command = dynamic_cast<const FunctionalUndoCommand *>(other);
+    if (command == nullptr || m_discarded || command->m_discarded || command->m_mergeKey != m_mergeKey || command->childCount() > 0 ||
+        m_stamp.msecsTo(command->m_stamp) > mergeDelay) {
+        return false;
+    }
+    m_redo = command->m_redo;
+    m_memoryCost = qMax(m_memoryCost, command->m_memoryCost);
+    m_stamp = command->m_stamp;
+    return true;
+}
+
+void FunctionalUndoCommand::setMemoryCost(qint64 cost)
+{
+    m_memoryCost = cost;
+}
+
+qint64 FunctionalUndoCommand::memoryCost() const
+{
+    qint64 cost = qint64(sizeof(FunctionalUndoCommand)) + (text().size() + m_mergeKey.size()) * qint64(sizeof(QChar));
+    if (!m_discarded) {
+        cost += 2 * lambdaCost + m_memoryCost;
+    }
+    return cost;
+}
+
+void FunctionalUndoCommand::setMergeKey(const QString &key)
+{
+    m_mergeKey = key;
+}
+
+void FunctionalUndoCommand::discard()
+{
+    m_discarded = true;
+    m_undo = Fun();
+    m_redo = Fun();
+}
+
+bool FunctionalUndoCommand::isDiscarded() const
+{
+    return m_discarded;
+}
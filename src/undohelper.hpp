@@ -25,6 +25,7 @@ using Fun = std::function<bool(void)>;
         return v && lambda();                                                                                                                                  \
     };
 
+#include <QTime>
 #include <QUndoCommand>
 
 /** @brief this is a generic class that takes fonctors as undo and redo actions. It just executes them when required by Qt
@@ -38,8 +39,26 @@ public:
     FunctionalUndoCommand(Fun undo, Fun redo, const QString &text, QUndoCommand *parent = nullptr);
     void undo() override;
     void redo() override;
+    int id() const override;
+    bool mergeWith(const QUndoCommand *other) override;
+
+    /** @brief Set the estimated size in bytes of the data captured by the undo and redo lambdas, like copied xml or json data */
+    void setMemoryCost(qint64 cost);
+    /** @brief Estimated memory used by this command, without its children */
+    qint64 memoryCost() const;
+    /** @brief Allow merging with the next command pushed with the same @param key within a few seconds, like repeated edits of a property.
+        The merged command keeps the first undo and the last redo, so the undo lambda must restore and the redo lambda set the whole state
+        affected by commands sharing this key */
+    void setMergeKey(const QString &key);
+    /** @brief Release the lambdas and the data they captured, the command does nothing anymore when undone or redone */
+    void discard();
+    bool isDiscarded() const;
 
 private:
     Fun m_undo, m_redo;
     bool m_undone;
+    bool m_discarded{false};
+    qint64 m_memoryCost{0};
+    QString m_mergeKey;
+    QTime m_stamp;
 };
@@ -0,0 +1,830 @@
+/*
+    SPDX-FileCopyrightText: 2026 Kdenlive contributors
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#include "cachemanager.h"
+#include "kdenlivesettings.h"
+
+#include <QCoreApplication>
+#include <QDataStream>
+#include <QDirIterator>
+#include <QFile>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QtConcurrent/QtConcurrentRun>
+
+#include <algorithm>
+#include <vector>
+
+std::unique_ptr<CacheManager> CacheManager::instance;
+std::once_flag CacheManager::m_onceFlag;
+
+namespace {
+constexpr quint32 manifestMagic = 0x4b434d46; // KCMF
+constexpr qint32 manifestVersion = 2;
+const QString manifestName = QStringLiteral("cache.manifest");
+// The manifest is rebuilt from the files regularly, to account for data written by other applications or Kdenlive instances.
+// An instance that did not update the manifest for that long is considered closed
+constexpr qint64 manifestMaxAge = 7 * 24 * 3600 * 1000LL;
+
+/** @brief Returns true if the top level folder @param name of a cache folder contains cached data: the proxy folder and the project folders,
+ *  named after the document id. Other folders belong to other KDE components, or to the user in custom cache folders */
+bool isCacheFolder(const QString &name)
+{
+    if (name == QLatin1String("proxy")) {
+        return true;
+    }
+    bool ok = false;
+    name.toLongLong(&ok, 10);
+    return ok;
+}
+
+/** @brief The type of the data stored in the project cache subfolder @param folder */
+CacheType subfolderType(const QString &folder)
+{
+    if (folder == QLatin1String("preview")) {
+        return CachePreview;
+    }
+    if (folder == QLatin1String("audiothumbs")) {
+        return CacheAudio;
+    }
+    if (folder == QLatin1String("videothumbs")) {
+        return CacheThumbs;
+    }
+    if (folder == QLatin1String("sequences")) {
+        return CacheSequence;
+    }
+    if (folder == QLatin1String("workfiles")) {
+        return CacheTmpWorkFiles;
+    }
+    return CacheBase;
+}
+
+/** @brief Audio and video thumbnails share a quota */
+CacheType quotaGroup(CacheType type)
+{
+    return type == CacheAudio ? CacheThumbs : type;
+}
+} // namespace
+
+CacheManager::CacheManager()
+    : m_sessionStart(QDateTime::currentMSecsSinceEpoch())
+    , m_sessionId(QStringLiteral("%1-%2").arg(QCoreApplication::applicationPid()).arg(m_sessionStart))
+{
+    m_pool.setMaxThreadCount(1);
+    setRoot(QStandardPaths::writableLocation(QStandardPaths::CacheLocation));
+}
+
+CacheManager::~CacheManager()
+{
+    m_pool.waitForDone();
+    // Leave the manifests, so that other instances can delete the data we used
+    QMutexLocker lock(&m_mutex);
+    m_sessionEnded = true;
+    for (const auto &root : m_roots) {
+        root->modified = true;
+        saveRoot(*root);
+    }
+}
+
+std::unique_ptr<CacheManager> &CacheManager::get()
+{
+    std::call_once(m_onceFlag, [] { instance.reset(new CacheManager()); });
+    return instance;
+}
+
+void CacheManager::setRoot(const QString &root)
+{
+    m_pool.waitForDone();
+    {
+        QMutexLocker lock(&m_mutex);
+        m_roots.clear();
+    }
+    addRoot(root);
+}
+
+void CacheManager::addRoot(const QString &root)
+{
+    if (root.isEmpty()) {
+        return;
+    }
+    auto managed = std::make_shared<Root>();
+    managed->dir = QDir(root);
+    managed->dir.makeAbsolute();
+    bool needsScan = false;
+    {
+        QMutexLocker lock(&m_mutex);
+        for (const auto &existing : m_roots) {
+            if (QDir::cleanPath(existing->dir.absolutePath()) == QDir::cleanPath(managed->dir.absolutePath())) {
+                return;
+            }
+        }
+        const QFileInfo manifest(managed->dir.absoluteFilePath(manifestName));
+        needsScan = !load(*managed) || manifest.lastModified().msecsTo(QDateTime::currentDateTime()) > manifestMaxAge;
+        // Register this instance in the manifest
+        managed->modified = true;
+        m_roots.push_back(managed);
+    }
+    if (needsScan) {
+        QtConcurrent::run(&m_pool, [this, managed]() { scan(managed, QString()); });
+    } else {
+        save();
+    }
+}
+
+const QDir CacheManager::root() const
+{
+    QMutexLocker lock(&m_mutex);
+    return m_roots.empty() ? QDir() : m_roots.front()->dir;
+}
+
+bool CacheManager::manages(const QString &path) const
+{
+    QString relative;
+    QMutexLocker lock(&m_mutex);
+    return rootFor(path, relative) != nullptr;
+}
+
+std::shared_ptr<CacheManager::Root> CacheManager::rootFor(const QString &path, QString &relative) const
+{
+    relative.clear();
+    if (path.isEmpty()) {
+        return nullptr;
+    }
+    const QString cleanPath = QDir::cleanPath(path);
+    std::shared_ptr<Root> match;
+    for (const auto &root : m_roots) {
+        const QString candidate = root->dir.relativeFilePath(cleanPath);
+        if (candidate.isEmpty() || candidate == QLatin1String(".") || candidate.startsWith(QLatin1String("..")) || QDir::isAbsolutePath(candidate)) {
+            continue;
+        }
+        // With nested cache folders, the innermost one holds the data
+        if (match == nullptr || candidate.size() < relative.size()) {
+            match = root;
+            relative = candidate;
+        }
+    }
+    return match;
+}
+
+std::vector<std::shared_ptr<CacheManager::Root>> CacheManager::matchingRoots(const QString &path) const
+{
+    if (path.isEmpty()) {
+        return m_roots;
+    }
+    std::vector<std::shared_ptr<Root>> result;
+    for (const auto &root : m_roots) {
+        if (QDir::cleanPath(root->dir.absolutePath()) == QDir::cleanPath(QDir(path).absolutePath())) {
+            result.push_back(root);
+        }
+    }
+    return result;
+}
+
+bool CacheManager::entryForPath(const QString &relativePath, QString &key, CacheType &type, QString &owner)
+{
+    const QStringList parts = relativePath.split(QLatin1Char('/'), Qt::SkipEmptyParts);
+    if (parts.isEmpty()) {
+        return false;
+    }
+    const QString &top = parts.constFirst();
+    if (!isCacheFolder(top)) {
+        return false;
+    }
+    if (top == QLatin1String("proxy")) {
+        if (parts.size() < 2) {
+            return false;
+        }
+        // A range limited proxy is a playlist and its segments, named like hash.mlt and hash_in_out.mkv
+        const QString hash = parts.at(1).section(QLatin1Char('.'), 0, 0).section(QLatin1Char('_'), 0, 0);
+        key = QStringLiteral("proxy/%1").arg(hash);
+        type = CacheProxy;
+        owner.clear();
+        return true;
+    }
+    owner = top;
+    if (parts.size() > 1) {
+        type = subfolderType(parts.at(1));
+        if (type != CacheBase) {
+            key = top + QLatin1Char('/') + parts.at(1);
+            return true;
+        }
+    }
+    key = top;
+    type = CacheBase;
+    return true;
+}
+
+void CacheManager::insertEntry(Root &root, const QString &key, const Entry &entry)
+{
+    removeEntry(root, key);
+    root.entries.insert(key, entry);
+    root.totals[entry.type] += entry.size;
+    root.modified = true;
+}
+
+void CacheManager::removeEntry(Root &root, const QString &key)
+{
+    auto it = root.entries.find(key);
+    if (it == root.entries.end()) {
+        return;
+    }
+    root.totals[it->type] -= it->size;
+    root.entries.erase(it);
+    root.modified = true;
+}
+
+void CacheManager::recordAccess(const QString &path)
+{
+    QString relative;
+    QString key;
+    CacheType type;
+    QString owner;
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    {
+        QMutexLocker lock(&m_mutex);
+        const std::shared_ptr<Root> root = rootFor(path, relative);
+        if (root == nullptr) {
+            return;
+        }
+        if (entryForPath(relative, key, type, owner) && key != owner) {
+            // A file or folder inside a single entry
+            auto it = root->entries.find(key);
+            if (it != root->entries.end()) {
+                it->lastAccess = now;
+                root->modified = true;
+            } else {
+                insertEntry(*root, key, {type, owner, 0, now});
+            }
+            return;
+        }
+        // A project folder, mark all its entries. Remember it, so that its entries that are not in the manifest yet are protected too
+        if (!root->sessionPaths.contains(relative)) {
+            root->sessionPaths << relative;
+        }
+        const QString prefix = relative + QLatin1Char('/');
+        for (auto it = root->entries.begin(); it != root->entries.end(); ++it) {
+            if (it.key() == relative || it.key().startsWith(prefix)) {
+                it->lastAccess = now;
+                root->modified = true;
+            }
+        }
+    }
+    // A project was opened, let the other instances know that its data is in use
+    save();
+}
+
+void CacheManager::recordWrite(const QString &path, qint64 previousSize)
+{
+    addSize(path, QFileInfo(path).size() - previousSize);
+}
+
+void CacheManager::recordRemoval(const QString &path, qint64 size)
+{
+    addSize(path, -size);
+}
+
+void CacheManager::recordDeletion(const QString &path)
+{
+    QMutexLocker lock(&m_mutex);
+    QString relative;
+    const std::shared_ptr<Root> root = rootFor(path, relative);
+    if (root == nullptr) {
+        return;
+    }
+    QString key;
+    CacheType type;
+    QString owner;
+    QString scope = relative;
+    if (entryForPath(relative, key, type, owner) && key != owner) {
+        scope = key;
+    }
+    const QString prefix = scope + QLatin1Char('/');
+    QStringList deleted;
+    for (auto it = root->entries.constBegin(); it != root->entries.constEnd(); ++it) {
+        if (it.key() == scope || it.key().startsWith(prefix)) {
+            deleted << it.key();
+        }
+    }
+    for (const QString &deletedKey : std::as_const(deleted)) {
+        Entry entry = root->entries.value(deletedKey);
+        removeEntry(*root, deletedKey);
+        if (usedInSession(*root, deletedKey, entry)) {
+            entry.size = 0;
+            insertEntry(*root, deletedKey, entry);
+        }
+    }
+}
+
+bool CacheManager::usedInSession(const Root &root, const QString &key, const Entry &entry) const
+{
+    if (entry.lastAccess >= m_sessionStart) {
+        return true;
+    }
+    for (const QString &path : root.sessionPaths) {
+        if (key == path || key.startsWith(path + QLatin1Char('/')) || path.startsWith(key + QLatin1Char('/'))) {
+            return true;
+        }
+    }
+    // The data may be used by the projects of another running instance
+    for (const Session &session : root.sessions) {
+        if (entry.lastAccess >= session.start) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void CacheManager::addSize(const QString &path, qint64 delta)
+{
+    bool exceeded = false;
+    {
+        QMutexLocker lock(&m_mutex);
+        QString relative;
+        const std::shared_ptr<Root> root = rootFor(path, relative);
+        QString key;
+        CacheType type;
+        QString owner;
+        if (root == nullptr || !entryForPath(relative, key, type, owner)) {
+            return;
+        }
+        auto it = root->entries.find(key);
+        if (it == root->entries.end()) {
+            it = root->entries.insert(key, {type, owner, 0, 0});
+        }
+        const qint64 size = qMax(qint64(0), it->size + delta);
+        root->totals[type] += size - it->size;
+        it->size = size;
+        it->lastAccess = QDateTime::currentMSecsSinceEpoch();
+        root->modified = true;
+        exceeded = delta > 0 && overQuota(*root);
+    }
+    if (exceeded) {
+        enforceQuotas();
+    }
+}
+
+void CacheManager::refresh(const QString &path)
+{
+    QMutexLocker lock(&m_mutex);
+    QString relative;
+    std::shared_ptr<Root> root = rootFor(path, relative);
+    if (root == nullptr) {
+        const std::vector<std::shared_ptr<Root>> roots = matchingRoots(path);
+        if (path.isEmpty() || roots.empty()) {
+            return;
+        }
+        // The whole cache folder
+        root = roots.front();
+    } else {
+        QString key;
+        CacheType type;
+        QString owner;
+        if (entryForPath(relative, key, type, owner)) {
+            // Measure the whole entry, or the whole folder for the files of a project folder
+            relative = key;
+        }
+    }
+    QtConcurrent::run(&m_pool, [this, root, relative]() { scan(root, relative); });
+}
+
+void CacheManager::scan(const std::shared_ptr<Root> &root, const QString &relativePath)
+{
+    QDir dir;
+    {
+        QMutexLocker lock(&m_mutex);
+        dir = root->dir;
+    }
+    const QString scope = relativePath;
+    QHash<QString, Entry> found;
+    const QString scopePath = scope.isEmpty() ? dir.absolutePath() : dir.absoluteFilePath(scope);
+    const QFileInfo scopeInfo(scopePath);
+    auto addFile = [&](const QFileInfo &info) {
+        QString key;
+        CacheType type;
+        QString owner;
+        if (!entryForPath(dir.relativeFilePath(info.absoluteFilePath()), key, type, owner)) {
+            return;
+        }
+        if (!scope.isEmpty() && key != scope && !key.startsWith(scope + QLatin1Char('/')) && !scope.startsWith(key + QLatin1Char('/'))) {
+            return;
+        }
+        Entry &entry = found[key];
+        entry.type = type;
+        entry.owner = owner;
+        entry.size += info.size();
+        // Until it is used, the last modification of an entry is its last use
+        entry.lastAccess = qMax(entry.lastAccess, info.lastModified().toMSecsSinceEpoch());
+    };
+    auto addFolder = [&](const QString &path) {
+        QDirIterator it(path, QDir::Files | QDir::Hidden | QDir::System | QDir::NoDotAndDotDot, QDirIterator::Subdirectories);
+        while (it.hasNext()) {
+            it.next();
+            addFile(it.fileInfo());
+        }
+    };
+    if (scope.isEmpty()) {
+        // Only walk the cached data, a custom cache folder can also contain the user files
+        const QFileInfoList folders = dir.entryInfoList(QDir::Dirs | QDir::Hidden | QDir::NoDotAndDotDot);
+        for (const QFileInfo &folder : folders) {
+            if (isCacheFolder(folder.fileName())) {
+                addFolder(folder.absoluteFilePath());
+            }
+        }
+    } else if (scope.startsWith(QLatin1String("proxy/"))) {
+        // A proxy entry groups the files named after the proxy hash, only check these files
+        const QString hash = scope.section(QLatin1Char('/'), 1);
+        const QFileInfoList files =
+            QDir(dir.absoluteFilePath(QStringLiteral("proxy"))).entryInfoList({hash + QStringLiteral(".*"), hash + QStringLiteral("_*")}, QDir::Files | QDir::Hidden);
+        for (const QFileInfo &info : files) {
+            addFile(info);
+        }
+    } else if (scopeInfo.isFile()) {
+        addFile(scopeInfo);
+    } else if (scopeInfo.isDir()) {
+        addFolder(scopePath);
+    }
+    QMutexLocker lock(&m_mutex);
+    if (std::find(m_roots.begin(), m_roots.end(), root) == m_roots.end()) {
+        // The cache folder is not managed anymore
+        return;
+    }
+    QStringList previous;
+    for (auto it = root->entries.constBegin(); it != root->entries.constEnd(); ++it) {
+        if (scope.isEmpty() || it.key() == scope || it.key().startsWith(scope + QLatin1Char('/'))) {
+            previous << it.key();
+        }
+    }
+    for (const QString &key : std::as_const(previous)) {
+        auto old = root->entries.constFind(key);
+        auto current = found.find(key);
+        if (current != found.end()) {
+            // Keep the recorded use
+            current->lastAccess = qMax(current->lastAccess, old->lastAccess);
+        } else if (usedInSession(*root, key, old.value())) {
+            // Keep the entries used in this session, even if empty
+            found.insert(key, {old->type, old->owner, 0, old->lastAccess});
+        }
+        removeEntry(*root, key);
+    }
+    for (auto it = found.constBegin(); it != found.constEnd(); ++it) {
+        insertEntry(*root, it.key(), it.value());
+    }
+    if (scope.isEmpty()) {
+        saveRoot(*root);
+    }
+    lock.unlock();
+    enforceRootQuotas(root);
+}
+
+qint64 CacheManager::size(CacheType type, const QString &owner, const QString &root) const
+{
+    QMutexLocker lock(&m_mutex);
+    qint64 total = 0;
+    for (const auto &managed : matchingRoots(root)) {
+        if (owner.isEmpty()) {
+            total += managed->totals.value(type);
+            continue;
+        }
+        for (const Entry &entry : std::as_const(managed->entries)) {
+            if (entry.type == type && entry.owner == owner) {
+                total += entry.size;
+            }
+        }
+    }
+    return total;
+}
+
+CacheManager::Usage CacheManager::usage(const QString &path) const
+{
+    Usage result;
+    QMutexLocker lock(&m_mutex);
+    QString relative;
+    const std::shared_ptr<Root> root = rootFor(path, relative);
+    if (root == nullptr) {
+        return result;
+    }
+    const QString prefix = relative + QLatin1Char('/');
+    qint64 lastAccess = 0;
+    for (auto it = root->entries.constBegin(); it != root->entries.constEnd(); ++it) {
+        if (it.key() == relative || it.key().startsWith(prefix)) {
+            result.size += it->size;
+            lastAccess = qMax(lastAccess, it->lastAccess);
+        }
+    }
+    if (lastAccess > 0) {
+        result.lastAccess = QDateTime::fromMSecsSinceEpoch(lastAccess);
+    }
+    return result;
+}
+
+qint64 CacheManager::totalSize(const QString &root) const
+{
+    QMutexLocker lock(&m_mutex);
+    qint64 total = 0;
+    for (const auto &managed : matchingRoots(root)) {
+        for (qint64 size : std::as_const(managed->totals)) {
+            total += size;
+        }
+    }
+    return total;
+}
+
+qint64 CacheManager::quota(CacheType type)
+{
+    switch (quotaGroup(type)) {
+    case CachePreview:
+        return qint64(KdenliveSettings::previewcachequota()) * 1048576;
+    case CacheProxy:
+        return qint64(KdenliveSettings::proxycachequota()) * 1048576;
+    case CacheThumbs:
+        return qint64(KdenliveSettings::thumbscachequota()) * 1048576;
+    default:
+        return 0;
+    }
+}
+
+bool CacheManager::isEvictable(CacheType type)
+{
+    // Sequences and work files cannot be recreated
+    return type == CachePreview || type == CacheProxy || type == CacheAudio || type == CacheThumbs;
+}
+
+bool CacheManager::overQuota(const Root &root)
+{
+    qint64 total = 0;
+    QHash<int, qint64> groups;
+    for (auto it = root.totals.constBegin(); it != root.totals.constEnd(); ++it) {
+        total += it.value();
+        groups[quotaGroup(CacheType(it.key()))] += it.value();
+    }
+    const qint64 globalQuota = qint64(KdenliveSettings::cachequota()) * 1048576;
+    if (globalQuota > 0 && total > globalQuota) {
+        return true;
+    }
+    for (auto it = groups.constBegin(); it != groups.constEnd(); ++it) {
+        const qint64 limit = quota(CacheType(it.key()));
+        if (limit > 0 && it.value() > limit) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void CacheManager::enforceQuotas()
+{
+    if (m_enforcePending.exchange(true)) {
+        return;
+    }
+    QtConcurrent::run(&m_pool, [this]() { doEnforceQuotas(); });
+}
+
+void CacheManager::doEnforceQuotas()
+{
+    m_enforcePending = false;
+    std::vector<std::shared_ptr<Root>> roots;
+    {
+        QMutexLocker lock(&m_mutex);
+        roots = m_roots;
+    }
+    for (const auto &root : roots) {
+        enforceRootQuotas(root);
+    }
+}
+
+void CacheManager::enforceRootQuotas(const std::shared_ptr<Root> &root)
+{
+    QMutexLocker lock(&m_mutex);
+    if (!overQuota(*root)) {
+        return;
+    }
+    // Take the uses recorded by the other instances into account
+    mergeManifest(*root);
+    // Bytes to free in each quota group, and globally
+    QHash<int, qint64> excess;
+    qint64 total = 0;
+    for (auto it = root->totals.constBegin(); it != root->totals.constEnd(); ++it) {
+        total += it.value();
+        excess[quotaGroup(CacheType(it.key()))] += it.value();
+    }
+    for (auto it = excess.begin(); it != excess.end(); ++it) {
+        const qint64 limit = quota(CacheType(it.key()));
+        it.value() = limit > 0 ? it.value() - limit : 0;
+    }
+    const qint64 globalQuota = qint64(KdenliveSettings::cachequota()) * 1048576;
+    qint64 globalExcess = globalQuota > 0 ? total - globalQuota : 0;
+
+    // Least recently used first
+    std::vector<std::pair<qint64, QString>> candidates;
+    for (auto it = root->entries.constBegin(); it != root->entries.constEnd(); ++it) {
+        if (isEvictable(it->type) && it->size > 0 && !usedInSession(*root, it.key(), it.value())) {
+            candidates.emplace_back(it->lastAccess, it.key());
+        }
+    }
+    std::sort(candidates.begin(), candidates.end());
+    QHash<QString, Entry> entries;
+    for (const auto &candidate : candidates) {
+        entries.insert(candidate.second, root->entries.value(candidate.second));
+    }
+    const QDir dir = root->dir;
+    lock.unlock();
+
+    QStringList evicted;
+    QHash<QString, qint64> inUse;
+    for (const auto &candidate : candidates) {
+        const Entry &entry = entries.value(candidate.second);
+        qint64 &groupExcess = excess[quotaGroup(entry.type)];
+        if (globalExcess <= 0 && groupExcess <= 0) {
+            continue;
+        }
+        QFileInfoList files;
+        if (candidate.second.startsWith(QLatin1String("proxy/"))) {
+            const QString hash = candidate.second.section(QLatin1Char('/'), 1);
+            files = QDir(dir.absoluteFilePath(QStringLiteral("proxy"))).entryInfoList({hash + QStringLiteral(".*"), hash + QStringLiteral("_*")}, QDir::Files);
+        } else {
+            QDirIterator it(dir.absoluteFilePath(candidate.second), QDir::Files | QDir::Hidden | QDir::System | QDir::NoDotAndDotDot,
+                            QDirIterator::Subdirectories);
+            while (it.hasNext()) {
+                it.next();
+                files << it.fileInfo();
+            }
+        }
+        // Data written since the manifest recorded its last use is used by another instance or application, keep it
+        qint64 lastModified = 0;
+        for (const QFileInfo &info : std::as_const(files)) {
+            lastModified = qMax(lastModified, info.lastModified().toMSecsSinceEpoch());
+        }
+        if (lastModified > entry.lastAccess) {
+            inUse.insert(candidate.second, lastModified);
+            continue;
+        }
+        if (candidate.second.startsWith(QLatin1String("proxy/"))) {
+            for (const QFileInfo &info : std::as_const(files)) {
+                QFile::remove(info.absoluteFilePath());
+            }
+        } else {
+            QDir folder(dir.absoluteFilePath(candidate.second));
+            // Only remove the content, the project expects its cache folders to exist
+            const QStringList content = folder.entryList(QDir::AllEntries | QDir::Hidden | QDir::System | QDir::NoDotAndDotDot);
+            for (const QString &name : content) {
+                QFileInfo info(folder.absoluteFilePath(name));
+                if (info.isDir()) {
+                    QDir(info.absoluteFilePath()).removeRecursively();
+                } else {
+                    folder.remove(name);
+                }
+            }
+        }
+        evicted << candidate.second;
+        globalExcess -= entry.size;
+        groupExcess -= entry.size;
+    }
+    if (evicted.isEmpty() && inUse.isEmpty()) {
+        return;
+    }
+    lock.relock();
+    for (const QString &key : std::as_const(evicted)) {
+        removeEntry(*root, key);
+    }
+    for (auto it = inUse.constBegin(); it != inUse.constEnd(); ++it) {
+        auto entry = root->entries.find(it.key());
+        if (entry != root->entries.end()) {
+            entry->lastAccess = qMax(entry->lastAccess, it.value());
+            root->modified = true;
+        }
+    }
+    if (!inUse.isEmpty()) {
+        // Measure the entries again, their size changed too
+        for (auto it = inUse.constBegin(); it != inUse.constEnd(); ++it) {
+            const QString key = it.key();
+            QtConcurrent::run(&m_pool, [this, root, key]() { scan(root, key); });
+        }
+    }
+    saveRoot(*root);
+}
+
+bool CacheManager::readManifest(const QDir &dir, QHash<QString, Entry> &entries, QHash<QString, Session> &sessions)
+{
+    QFile file(dir.absoluteFilePath(manifestName));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    QDataStream stream(&file);
+    quint32 magic;
+    qint32 version;
+    qint32 count;
+    stream >> magic >> version;
+    if (magic != manifestMagic || version != manifestVersion) {
+        return false;
+    }
+    stream >> count;
+    for (int i = 0; i < count && stream.status() == QDataStream::Ok; ++i) {
+        QString id;
+        Session session;
+        stream >> id >> session.start >> session.heartbeat;
+        sessions.insert(id, session);
+    }
+    stream >> count;
+    for (int i = 0; i < count && stream.status() == QDataStream::Ok; ++i) {
+        QString key;
+        qint32 type;
+        Entry entry;
+        stream >> key >> type >> entry.owner >> entry.size >> entry.lastAccess;
+        entry.type = CacheType(type);
+        entries.insert(key, entry);
+    }
+    return stream.status() == QDataStream::Ok;
+}
+
+bool CacheManager::load(Root &root)
+{
+    QHash<QString, Entry> entries;
+    QHash<QString, Session> sessions;
+    if (!readManifest(root.dir, entries, sessions)) {
+        return false;
+    }
+    for (auto it = entries.constBegin(); it != entries.constEnd(); ++it) {
+        insertEntry(root, it.key(), it.value());
+    }
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    for (auto it = sessions.constBegin(); it != sessions.constEnd(); ++it) {
+        if (it.key() != m_sessionId && now - it->heartbeat < manifestMaxAge) {
+            root.sessions.insert(it.key(), it.value());
+        }
+    }
+    root.modified = false;
+    return true;
+}
+
+void CacheManager::mergeManifest(Root &root) const
+{
+    QHash<QString, Entry> entries;
+    QHash<QString, Session> sessions;
+    if (!readManifest(root.dir, entries, sessions)) {
+        return;
+    }
+    // Only the uses are merged: entries unknown here were deleted, or will be found by the next scan
+    for (auto it = root.entries.begin(); it != root.entries.end(); ++it) {
+        auto saved = entries.constFind(it.key());
+        if (saved != entries.constEnd() && saved->lastAccess > it->lastAccess) {
+            it->lastAccess = saved->lastAccess;
+        }
+    }
+    root.sessions.clear();
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    for (auto it = sessions.constBegin(); it != sessions.constEnd(); ++it) {
+        if (it.key() != m_sessionId && now - it->heartbeat < manifestMaxAge) {
+            root.sessions.insert(it.key(), it.value());
+        }
+    }
+}
+
+void CacheManager::save()
+{
+    QMutexLocker lock(&m_mutex);
+    for (const auto &root : m_roots) {
+        saveRoot(*root);
+    }
+}
+
+void CacheManager::saveRoot(Root &root)
+{
+    if (!root.modified || !root.dir.exists()) {
+        return;
+    }
+    // Another instance may have saved the manifest meanwhile, keep its data
+    mergeManifest(root);
+    QSaveFile file(root.dir.absoluteFilePath(manifestName));
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Cannot write cache manifest" << file.fileName();
+        return;
+    }
+    QDataStream stream(&file);
+    QHash<QString, Session> sessions = root.sessions;
+    if (!m_sessionEnded) {
+        sessions.insert(m_sessionId, {m_sessionStart, QDateTime::currentMSecsSinceEpoch()});
+    }
+    stream << manifestMagic << manifestVersion << qint32(sessions.size());
+    for (auto it = sessions.constBegin(); it != sessions.constEnd(); ++it) {
+        stream << it.key() << it->start << it->heartbeat;
+    }
+    stream << qint32(root.entries.size());
+    for (auto it = root.entries.constBegin(); it != root.entries.constEnd(); ++it) {
+        stream << it.key() << qint32(it->type) << it->owner << it->size << it->lastAccess;
+    }
+    if (stream.status() == QDataStream::Ok && file.commit()) {
+        root.modified = false;
+    }
+}
+
+bool CacheManager::isUpToDate() const
+{
+    return m_pool.activeThreadCount() == 0;
+}
+
+void CacheManager::waitForDone()
+{
+    m_pool.waitForDone();
+}
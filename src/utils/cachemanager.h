@@ -0,0 +1,158 @@
+/*
+    SPDX-FileCopyrightText: 2026 Kdenlive contributors
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#pragma once
+
+#include "definitions.h"
+#include <QDateTime>
+#include <QDir>
+#include <QHash>
+#include <QMutex>
+#include <QThreadPool>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/** @class CacheManager
+    @brief This class keeps track of the data stored in the cache folders and enforces the cache quotas.
+    The main cache folder is managed, as well as the custom cache folders of the opened projects. In each folder, the cache is split in entries:
+    the timeline previews, audio thumbnails, video thumbnails, sequences and work files of each project folder (named after the document id), the
+    remaining files of each project folder, and the proxy clips (a proxy and its range segments form one entry). Other files, like the user files
+    of a custom cache folder, are ignored. A manifest of the entries, with their size, owner folder and last use, is kept in memory, updated when
+    cached data is written or used, and saved in each cache folder. Sizes are thus known without walking the cache folders.
+    The manifest also lists the Kdenlive instances using the folder. Before saving or deleting data, the last uses recorded by the other instances
+    are merged, so that the data used by another instance, or written since the manifest was saved, is never deleted.
+    When a quota of a cache folder is exceeded, its least recently used previews, thumbnails and proxies are deleted in the background.
+ * Note that this class is a Singleton
+ */
+class CacheManager
+{
+
+public:
+    struct Usage
+    {
+        qint64 size{0};
+        QDateTime lastAccess;
+    };
+
+    // Returns the instance of the Singleton
+    static std::unique_ptr<CacheManager> &get();
+    ~CacheManager();
+
+    /** @brief Manage the main cache folder @param root instead of the current cache folders */
+    void setRoot(const QString &root);
+    /** @brief Also manage the cache folder @param root, used by a project storing its data in a custom folder.
+     *  Its manifest is loaded, the folder is scanned in the background if the manifest is missing or old */
+    void addRoot(const QString &root);
+    /** @brief The main cache folder */
+    const QDir root() const;
+    /** @brief Returns true if @param path is in a managed cache folder */
+    bool manages(const QString &path) const;
+
+    /** @brief Mark the cache data in @param path as used, @param path can be a file or a folder */
+    void recordAccess(const QString &path);
+    /** @brief The file @param path was written in the cache, replacing a file of @param previousSize bytes */
+    void recordWrite(const QString &path, qint64 previousSize = 0);
+    /** @brief The file @param path of @param size bytes was removed from the cache */
+    void recordRemoval(const QString &path, qint64 size);
+    /** @brief The file or folder @param path was deleted, its entries are emptied */
+    void recordDeletion(const QString &path);
+    /** @brief Measure the cache data in @param path again in the background, after it was modified without being recorded */
+    void refresh(const QString &path);
+
+    /** @brief Size of the data of @param type (CacheProxy, CachePreview, CacheAudio, CacheThumbs, CacheSequence, CacheTmpWorkFiles or CacheBase
+     *  for the other files) for the project folder @param owner, or for all folders if @param owner is empty, in the cache folder @param root
+     *  or in all managed cache folders if @param root is empty */
+    qint64 size(CacheType type, const QString &owner = QString(), const QString &root = QString()) const;
+    /** @brief Size and last use of the data in @param path */
+    Usage usage(const QString &path) const;
+    /** @brief Size of the data in the cache folder @param root, or in all managed cache folders if @param root is empty */
+    qint64 totalSize(const QString &root = QString()) const;
+    /** @brief Returns false while a background scan or cleanup is running, the sizes may then be incomplete */
+    bool isUpToDate() const;
+
+    /** @brief Delete the least recently used data until the quotas are met, in the background */
+    void enforceQuotas();
+    /** @brief Write the manifests */
+    void save();
+    /** @brief Wait until the background scans and cleanups are done */
+    void waitForDone();
+
+    /** @brief Returns the entry containing the file or folder @param relativePath, or false if it is not managed */
+    static bool entryForPath(const QString &relativePath, QString &key, CacheType &type, QString &owner);
+
+private:
+    CacheManager();
+    static std::unique_ptr<CacheManager> instance;
+    static std::once_flag m_onceFlag; // flag to create the repository only once;
+
+    struct Entry
+    {
+        CacheType type;
+        QString owner;
+        qint64 size{0};
+        qint64 lastAccess{0};
+    };
+
+    struct Session
+    {
+        qint64 start{0};
+        qint64 heartbeat{0};
+    };
+
+    /** @brief A managed cache folder */
+    struct Root
+    {
+        QDir dir;
+        /** @brief The entries, by path relative to the cache folder */
+        QHash<QString, Entry> entries;
+        /** @brief Total size of the entries of each type */
+        QHash<int, qint64> totals;
+        /** @brief Files and folders used in this session, whose entries are never deleted */
+        QStringList sessionPaths;
+        /** @brief The other Kdenlive instances using this folder, by session id */
+        QHash<QString, Session> sessions;
+        bool modified{false};
+    };
+
+    mutable QMutex m_mutex;
+    /** @brief The managed cache folders, the main cache folder first */
+    std::vector<std::shared_ptr<Root>> m_roots;
+    qint64 m_sessionStart;
+    QString m_sessionId;
+    /** @brief Set when this instance quits, it is then removed from the manifests */
+    bool m_sessionEnded{false};
+    /** @brief Background scans and cleanups, run one at a time */
+    QThreadPool m_pool;
+    std::atomic<bool> m_enforcePending{false};
+
+    /** @brief Returns the cache folder containing @param path and sets @param relative to the path relative to it,
+     *  or nullptr if @param path is not in a managed cache folder. The mutex must be locked */
+    std::shared_ptr<Root> rootFor(const QString &path, QString &relative) const;
+    /** @brief Returns the managed cache folders, only the one in @param path if not empty. The mutex must be locked */
+    std::vector<std::shared_ptr<Root>> matchingRoots(const QString &path) const;
+    void addSize(const QString &path, qint64 delta);
+    static void insertEntry(Root &root, const QString &key, const Entry &entry);
+    static void removeEntry(Root &root, const QString &key);
+    /** @brief Rebuild the entries in @param relativePath from the files on disk, an empty path scans the whole cache folder */
+    void scan(const std::shared_ptr<Root> &root, const QString &relativePath);
+    void doEnforceQuotas();
+    void enforceRootQuotas(const std::shared_ptr<Root> &root);
+    /** @brief Quota for the entries of @param type in bytes, 0 if unlimited */
+    static qint64 quota(CacheType type);
+    /** @brief Returns true if the entries of @param type can be recreated and deleted to meet the quotas */
+    static bool isEvictable(CacheType type);
+    /** @brief Returns true if the entry @param key was used in this session, or since another running instance was started */
+    bool usedInSession(const Root &root, const QString &key, const Entry &entry) const;
+    static bool overQuota(const Root &root);
+    /** @brief Read the manifest saved in the cache folder @param dir */
+    static bool readManifest(const QDir &dir, QHash<QString, Entry> &entries, QHash<QString, Session> &sessions);
+    bool load(Root &root);
+    /** @brief Read the manifest of @param root as saved by all instances, keeping the latest use of each entry. The mutex must be locked */
+    void mergeManifest(Root &root) const;
+    /** @brief Write the manifest of @param root. The mutex must be locked */
+    void saveRoot(Root &root);
+};
@@ -6,112 +6,97 @@
 
 #include "gentime.h"
 
-double GenTime::s_delta = 0.00001;
+#include <numeric>
 
-GenTime::GenTime()
-{
-    m_time = 0.0;
-}
+double GenTime::s_fps = 25.;
+qint64 GenTime::s_frameTicks = GenTime::TicksPerSecond / 25;
+qint64 GenTime::s_frameTicksDen = 1;
 
 GenTime::GenTime(double seconds)
+    : m_ticks(std::llround(seconds * TicksPerSecond))
 {
-    m_time = seconds;
 }
 
 GenTime::GenTime(int frames, double framesPerSecond)
 {
-    m_time = (double)frames / framesPerSecond;
+    if (framesPerSecond == s_fps) {
+        m_ticks = fromFrames(frames).m_ticks;
+    } else {
+        m_ticks = std::llround(frames * TicksPerSecond / framesPerSecond);
+    }
+}
+
+GenTime GenTime::fromFrames(int frames)
+{
+    if (s_frameTicksDen == 1) {
+        return fromTicks(frames * s_frameTicks);
+    }
+    return fromTicks(std::llround(double(frames) * s_frameTicks / s_frameTicksDen));
 }
 
 double GenTime::seconds() const
 {
-    return m_time;
+    return double(m_ticks) / TicksPerSecond;
 }
 
 double GenTime::ms() const
 {
-    return m_time * 1000;
+    return double(m_ticks) * 1000 / TicksPerSecond;
 }
 
 int GenTime::frames(double framesPerSecond) const
 {
-    return (int)floor(m_time * framesPerSecond + 0.5);
+    if (framesPerSecond == s_fps) {
+        return frames();
+    }
+    return (int)floor(seconds() * framesPerSecond + 0.5);
 }
 
 QString GenTime::toString() const
 {
-    return QStringLiteral("%1 s").arg(m_time, 0, 'f', 2);
-}
-
-GenTime GenTime::operator-()
-{
-    return GenTime(-m_time);
-}
-
-GenTime &GenTime::operator+=(GenTime op)
-{
-    m_time += op.m_time;
-    return *this;
-}
-
-GenTime &GenTime::operator-=(GenTime op)
-{
-    m_time -= op.m_time;
-    return *this;
-}
-
-GenTime GenTime::operator+(GenTime op) const
-{
-    return GenTime(m_time + op.m_time);
-}
-
-GenTime GenTime::operator-(GenTime op) const
-{
-    return GenTime(m_time - op.m_time);
+    return QStringLiteral("%1 s").arg(seconds(), 0, 'f', 2);
 }
 
 GenTime GenTime::operator*(double op) const
 {
-    return GenTime(m_time * op);
+    return fromTicks(std::llround(m_ticks * op));
 }
 
 GenTime GenTime::operator/(double op) const
 {
-    return GenTime(m_time / op);
-}
-
-bool GenTime::operator<(GenTime op) const
-{
-    return m_time + s_delta < op.m_time;
-}
-
-bool GenTime::operator>(GenTime op) const
-{
-    return m_time > op.m_time + s_delta;
-}
-
-bool GenTime::operator>=(GenTime op) const
-{
-    return m_time + s_delta >= op.m_time;
-}
-
-bool GenTime::operator<=(GenTime op) const
-{
-    return m_time <= op.m_time + s_delta;
+    return fromTicks(std::llround(m_ticks / op));
 }
 
-bool GenTime::operator==(GenTime op) const
-{
-    return fabs(m_time - op.m_time) < s_delta;
-}
-
-bool GenTime::operator!=(GenTime op) const
+// static
+void GenTime::setFps(int num, int den)
 {
-    return fabs(m_time - op.m_time) >= s_delta;
+    if (num <= 0 || den <= 0) {
+        return;
+    }
+    // A frame lasts TicksPerSecond * den / num ticks
+    qint64 ticks = TicksPerSecond * den;
+    qint64 frameDen = num;
+    const qint64 divisor = std::gcd(ticks, frameDen);
+    s_frameTicks = ticks / divisor;
+    s_frameTicksDen = frameDen / divisor;
+    s_fps = double(num) / den;
 }
 
 // static
 void GenTime::setFps(double fps)
 {
-    s_delta = 0.9 / fps;
+    if (fps <= 0.) {
+        return;
+    }
+    // Find the fraction of the usual frame rates, NTSC ones are multiples of 1000 / 1001
+    const double ntsc = fps * 1001;
+    if (qAbs(ntsc - std::round(ntsc)) < 0.01 && qint64(std::round(ntsc)) % 1000 == 0) {
+        setFps(int(std::round(ntsc)), 1001);
+    } else if (qAbs(fps - std::round(fps)) < 1e-6) {
+        setFps(int(std::round(fps)), 1);
+    } else {
+        setFps(int(std::round(fps * 1000)), 1000);
+    }
+    // Keep the exact value, frames(fps) uses the cached conversion when called with it
+    s_fps = fps;
 }
@@ -7,18 +7,24 @@
 #pragma once
 
 #include <QString>
+#include <QtGlobal>
 #include <cmath>
 
 /**
  * @class GenTime
  * @brief Encapsulates a time, which can be set in various forms and outputted in various forms.
+ * The time is stored as an integer number of ticks, so that times built from frames are exact and their arithmetic does not drift.
+ * The project fps is cached by setFps(), frames() and fromFrames() use it without querying the project profile.
  * @author Jason Wood
  */
 class GenTime
 {
 public:
+    /** @brief Number of ticks in a second. The frames of the usual frame rates, including the NTSC ones, last an integer number of ticks */
+    static constexpr qint64 TicksPerSecond = 705600000;
+
     /** @brief Creates a GenTime object, with a time of 0 seconds. */
-    GenTime();
+    constexpr GenTime() = default;
 
     /** @brief Creates a GenTime object, with time given in seconds. */
     explicit GenTime(double seconds);
@@ -26,6 +32,20 @@ public:
     /** @brief Creates a GenTime object, by passing number of frames and how many frames per second. */
     GenTime(int frames, double framesPerSecond);
 
+    /** @brief Creates a GenTime object at @param frames, at the project fps set with setFps(). */
+    static GenTime fromFrames(int frames);
+
+    /** @brief Creates a GenTime object from a number of ticks. */
+    static constexpr GenTime fromTicks(qint64 ticks)
+    {
+        GenTime time;
+        time.m_ticks = ticks;
+        return time;
+    }
+
+    /** @brief Gets the time, in ticks. */
+    constexpr qint64 ticks() const { return m_ticks; }
+
     /** @brief Gets the time, in seconds. */
     double seconds() const;
 
@@ -36,6 +56,9 @@ public:
      * @param framesPerSecond Number of frames per second */
     int frames(double framesPerSecond) const;
 
+    /** @brief Gets the time in frames, at the project fps set with setFps(). */
+    int frames() const { return int(frameIndex(m_ticks)); }
+
     QString toString() const;
 
     /*
@@ -43,19 +66,27 @@ public:
      */
 
     /// Unary minus
-    GenTime operator-();
+    constexpr GenTime operator-() const { return fromTicks(-m_ticks); }
 
     /// Addition
-    GenTime &operator+=(GenTime op);
+    constexpr GenTime &operator+=(GenTime op)
+    {
+        m_ticks += op.m_ticks;
+        return *this;
+    }
 
     /// Subtraction
-    GenTime &operator-=(GenTime op);
+    constexpr GenTime &operator-=(GenTime op)
+    {
+        m_ticks -= op.m_ticks;
+        return *this;
+    }
 
     /** @brief Adds two GenTimes. */
-    GenTime operator+(GenTime op) const;
+    constexpr GenTime operator+(GenTime op) const { return fromTicks(m_ticks + op.m_ticks); }
 
     /** @brief Subtracts one genTime from another. */
-    GenTime operator-(GenTime op) const;
+    constexpr GenTime operator-(GenTime op) const { return fromTicks(m_ticks - op.m_ticks); }
 
     /** @brief Multiplies one GenTime by a double value, returning a GenTime. */
     GenTime operator*(double op) const;
@@ -63,31 +94,41 @@ public:
     /** @brief Divides one GenTime by a double value, returning a GenTime. */
     GenTime operator/(double op) const;
 
-    /** All the comparison operators considers that two GenTime that differs by less
-    than one frame are equal.
-    The fps used to carry this computation must be set using the static function setFps
+    /** All the comparison operators consider that two GenTime in the same frame are equal.
+    The fps used to carry this computation must be set using the static function setFps, until then 25 fps is used.
     */
-    bool operator<(GenTime op) const;
+    bool operator<(GenTime op) const { return frameIndex(m_ticks) < frameIndex(op.m_ticks); }
 
-    bool operator>(GenTime op) const;
+    bool operator>(GenTime op) const { return frameIndex(m_ticks) > frameIndex(op.m_ticks); }
 
-    bool operator>=(GenTime op) const;
+    bool operator>=(GenTime op) const { return frameIndex(m_ticks) >= frameIndex(op.m_ticks); }
 
-    bool operator<=(GenTime op) const;
+    bool operator<=(GenTime op) const { return frameIndex(m_ticks) <= frameIndex(op.m_ticks); }
 
-    bool operator==(GenTime op) const;
+    bool operator==(GenTime op) const { return frameIndex(m_ticks) == frameIndex(op.m_ticks); }
 
-    bool operator!=(GenTime op) const;
+    bool operator!=(GenTime op) const { return frameIndex(m_ticks) != frameIndex(op.m_ticks); }
 
-    /** @brief Sets the fps used to determine if two GenTimes are equal */
+    /** @brief Sets the project fps, used to convert frames and to determine if two GenTimes are equal */
+    static void setFps(int num, int den);
     static void setFps(double fps);
 
 private:
-    /** Holds the time in seconds for this object. */
-    double m_time;
-
-    /** A delta value that is used to get around floating point rounding issues. */
-    static double s_delta;
+    /** Holds the time in ticks for this object. */
+    qint64 m_ticks{0};
+
+    /** The project fps, and the duration of its frames in ticks as the fraction s_frameTicks / s_frameTicksDen */
+    static double s_fps;
+    static qint64 s_frameTicks;
+    static qint64 s_frameTicksDen;
+
+    /** @brief Returns the frame containing @param ticks, rounded to the nearest frame */
+    static qint64 frameIndex(qint64 ticks)
+    {
+        const qint64 scaled = ticks * s_frameTicksDen + s_frameTicks / 2;
+        // Floor division, times can be negative
+        return scaled >= 0 ? scaled / s_frameTicks : -((-scaled + s_frameTicks - 1) / s_frameTicks);
+    }
 };
 
-Q_DECLARE_TYPEINFO(GenTime, Q_COMPLEX_TYPE); //TODO Q_COMPLEX_TYPE is the default, but does Q_MOVABLE_TYPE fit better?
+Q_DECLARE_TYPEINFO(GenTime, Q_RELOCATABLE_TYPE);
@@ -0,0 +1,46 @@
+/*
+    SPDX-FileCopyrightText: 2026 Kdenlive contributors
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#pragma once
+
+#include <QReadWriteLock>
+
+/** @class ModelLocker
+    @brief Scoped lock on the recursive QReadWriteLock of a model, see the READ_LOCK() macro.
+    Qt does not allow a thread holding the write lock of a recursive QReadWriteLock to lock it for reading
+    (this would deadlock), which happens when an undo/redo operation queries the model it is modifying.
+    In that case the locker re-enters the write lock instead.
+    The locker lives on the stack and does not allocate.
+ */
+class ModelLocker
+{
+public:
+    enum Mode {
+        /** @brief Shared lock, any number of threads can read concurrently */
+        Read,
+        /** @brief Exclusive lock if the lock is free or already held for writing by this thread, shared otherwise */
+        PreferWrite
+    };
+
+    explicit ModelLocker(QReadWriteLock *lock, Mode mode = Read)
+        : m_lock(lock)
+    {
+        if (mode == Read && m_lock->tryLockForRead()) {
+            // No writer, or this thread already holds a read lock
+            return;
+        }
+        if (m_lock->tryLockForWrite()) {
+            // This thread already is the writer (or the lock is free)
+            return;
+        }
+        // Another thread holds the lock, wait until reading is possible
+        m_lock->lockForRead();
+    }
+    ~ModelLocker() { m_lock->unlock(); }
+    Q_DISABLE_COPY_MOVE(ModelLocker)
+
+private:
+    QReadWriteLock *m_lock;
+};
@@ -9,7 +9,10 @@
 #include "core.h"
 #include "doc/kdenlivedoc.h"
 #include "project/projectmanager.h"
+#include "utils/cachemanager.h"
+#include "utils/tracing.h"
 #include <QDir>
+#include <QFileInfo>
 #include <QMutexLocker>
 #include <list>
 
@@ -113,6 +116,7 @@ std::unique_ptr<ThumbnailCache> &ThumbnailCache::get()
 
 bool ThumbnailCache::hasThumbnail(const QString &binId, int pos, bool volatileOnly) const
 {
+    TRACE_SCOPE("cache");
     QMutexLocker locker(&m_mutex);
     bool ok = false;
     auto key = pos < 0 ? getAudioKey(binId, &ok).constFirst() : getKey(binId, pos, &ok);
@@ -129,6 +133,7 @@ bool ThumbnailCache::hasThumbnail(const QString &binId, int pos, bool volatileOn
 
 QImage ThumbnailCache::getAudioThumbnail(const QString &binId, bool volatileOnly) const
 {
+    TRACE_SCOPE("cache");
     QMutexLocker locker(&m_mutex);
     bool ok = false;
     auto key = getAudioKey(binId, &ok).constFirst();
@@ -167,6 +172,7 @@ const QList<QUrl> ThumbnailCache::getAudioThumbPath(const QString &binId) const
 
 QImage ThumbnailCache::getThumbnail(QString hash, const QString &binId, int pos, bool volatileOnly) const
 {
+    TRACE_SCOPE("cache");
     if (hash.isEmpty()) {
         return QImage();
     }
@@ -194,6 +200,7 @@ QImage ThumbnailCache::getThumbnail(QString hash, const QString &binId, int pos,
 
 QImage ThumbnailCache::getThumbnail(const QString &binId, int pos, bool volatileOnly) const
 {
+    TRACE_SCOPE("cache");
     QMutexLocker locker(&m_mutex);
     bool ok = false;
     auto key = getKey(binId, pos, &ok);
@@ -217,6 +224,7 @@ QImage ThumbnailCache::getThumbnail(const QString &binId, int pos, bool volatile
 
 void ThumbnailCache::storeThumbnail(const QString &binId, int pos, const QImage &img, bool persistent)
 {
+    TRACE_SCOPE("cache");
     if (pCore->projectItemModel()->closing) {
         return;
     }
@@ -241,8 +249,94 @@ void ThumbnailCache::storeThumbnail(const QString &binId, int pos, const QImage
                 m_storedOnDisk[binId].push_back(pos);
             }
             locker.unlock();
-            if (!img.save(thumbFolder.absoluteFilePath(key))) {
-                qDebug() << ".............\n!!!!!!!! ERROR SAVING THUMB in: " << thumbFolder.absoluteFilePath(key);
+            const QString path = thumbFolder.absoluteFilePath(key);
+            const qint64 previousSize = QFileInfo(path).size();
+            if (!img.save(path)) {
+                qDebug() << ".............\n!!!!!!!! ERROR SAVING THUMB in: " << path;
+            } else {
+                CacheManager::get()->recordWrite(path, previousSize);
+            }
+        }
+    }
+}
+
+bool ThumbnailCache::hasKeyframeThumbnail(const QString &binId, int pos, bool volatileOnly) const
+{
+    if (hasThumbnail(binId, pos, volatileOnly)) {
+        return true;
+    }
+    QMutexLocker locker(&m_mutex);
+    bool ok = false;
+    auto key = getKey(binId, pos, &ok, true);
+    if (ok && m_volatileCache->contains(key)) {
+        return true;
+    }
+    if (!ok || volatileOnly) {
+        return false;
+    }
+    locker.unlock();
+    QDir thumbFolder = getDir(false, &ok);
+    return ok && thumbFolder.exists(key);
+}
+
+QImage ThumbnailCache::getKeyframeThumbnail(const QString &binId, int pos, bool volatileOnly) const
+{
+    QImage exact = getThumbnail(binId, pos, volatileOnly);
+    if (!exact.isNull()) {
+        return exact;
+    }
+    QMutexLocker locker(&m_mutex);
+    bool ok = false;
+    auto key = getKey(binId, pos, &ok, true);
+    if (ok && m_volatileCache->contains(key)) {
+        return m_volatileCache->get(key);
+    }
+    if (!ok || volatileOnly) {
+        return QImage();
+    }
+    QDir thumbFolder = getDir(false, &ok);
+    if (ok && thumbFolder.exists(key)) {
+        std::vector<int> &stored = m_storedKeyframesOnDisk[binId];
+        if (std::find(stored.begin(), stored.end(), pos) == stored.end()) {
+            stored.push_back(pos);
+        }
+        locker.unlock();
+        return QImage(thumbFolder.absoluteFilePath(key));
+    }
+    return QImage();
+}
+
+void ThumbnailCache::storeKeyframeThumbnail(const QString &binId, int pos, const QImage &img, bool persistent)
+{
+    if (pCore->projectItemModel()->closing) {
+        return;
+    }
+    QMutexLocker locker(&m_mutex);
+    bool ok = false;
+    const QString key = getKey(binId, pos, &ok, true);
+    if (!ok) {
+        return;
+    }
+    if (m_volatileCache->contains(key)) {
+        m_volatileCache->remove(key);
+    } else {
+        m_storedKeyframes[binId].push_back(pos);
+    }
+    m_volatileCache->insert(key, img, (int)img.sizeInBytes());
+    if (persistent) {
+        QDir thumbFolder = getDir(false, &ok);
+        if (ok) {
+            std::vector<int> &stored = m_storedKeyframesOnDisk[binId];
+            if (std::find(stored.begin(), stored.end(), pos) == stored.end()) {
+                stored.push_back(pos);
+            }
+            locker.unlock();
+            const QString path = thumbFolder.absoluteFilePath(key);
+            const qint64 previousSize = QFileInfo(path).size();
+            if (!img.save(path)) {
+                qDebug() << ".............\n!!!!!!!! ERROR SAVING THUMB in: " << path;
+            } else {
+                CacheManager::get()->recordWrite(path, previousSize);
             }
         }
     }
@@ -277,6 +371,7 @@ void ThumbnailCache::saveCachedThumbs(const std::unordered_map<QString, std::vec
                         break;
                     } else {
                         m_storedOnDisk[key.first].push_back(pos);
+                        CacheManager::get()->recordWrite(thumbFolder.absoluteFilePath(thumbKey));
                     }
                 }
             }
@@ -297,6 +392,16 @@ void ThumbnailCache::invalidateThumbsForClip(const QString &binId)
         }
         m_storedVolatile.erase(binId);
     }
+    if (m_storedKeyframes.find(binId) != m_storedKeyframes.end()) {
+        bool ok = false;
+        for (int pos : m_storedKeyframes.at(binId)) {
+            auto key = getKey(binId, pos, &ok, true);
+            if (ok) {
+                m_volatileCache->remove(key);
+            }
+        }
+        m_storedKeyframes.erase(binId);
+    }
     bool ok = false;
     // Video thumbs
     QStringList files;
@@ -312,6 +417,15 @@ void ThumbnailCache::invalidateThumbsForClip(const QString &binId)
         }
         m_storedOnDisk.erase(binId);
     }
+    if (m_storedKeyframesOnDisk.find(binId) != m_storedKeyframesOnDisk.end()) {
+        for (const auto &pos : m_storedKeyframesOnDisk.at(binId)) {
+            auto key = getKey(binId, pos, &ok, true);
+            if (ok) {
+                files << key;
+            }
+        }
+        m_storedKeyframesOnDisk.erase(binId);
+    }
     // Release mutex before deleting files
     locker.unlock();
     if (!files.isEmpty()) {
@@ -329,11 +443,13 @@ void ThumbnailCache::clearCache()
     QMutexLocker locker(&m_mutex);
     m_volatileCache->clear();
     m_storedVolatile.clear();
+    m_storedKeyframes.clear();
     m_storedOnDisk.clear();
+    m_storedKeyframesOnDisk.clear();
 }
 
 // static
-QString ThumbnailCache::getKey(const QString &binId, int pos, bool *ok)
+QString ThumbnailCache::getKey(const QString &binId, int pos, bool *ok, bool keyframe)
 {
     if (binId.isEmpty()) {
         *ok = false;
@@ -344,7 +460,7 @@ QString ThumbnailCache::getKey(const QString &binId, int pos, bool *ok)
     if (!*ok) {
         return QString();
     }
-    return binClip->hashForThumbs() + QLatin1Char('#') + QString::number(pos) + QStringLiteral(".jpg");
+    return binClip->hashForThumbs() + (keyframe ? QStringLiteral("#k") : QStringLiteral("#")) + QString::number(pos) + QStringLiteral(".jpg");
 }
 
 // static
@@ -56,6 +56,16 @@ public:
     */
     void storeThumbnail(const QString &binId, int pos, const QImage &img, bool persistent = false);
 
+    /** @brief Check whether a thumbnail for a fast preview is available at a given position, see storeKeyframeThumbnail */
+    bool hasKeyframeThumbnail(const QString &binId, int pos, bool volatileOnly = false) const;
+    /** @brief Get a thumbnail for a fast preview: the exact thumbnail of the position if cached, otherwise its keyframe thumbnail */
+    QImage getKeyframeThumbnail(const QString &binId, int pos, bool volatileOnly = false) const;
+    /** @brief Store a thumbnail decoded from the keyframe nearest to @param pos instead of the exact frame
+       Keyframe thumbnails are stored under their own key and are never returned for an exact thumbnail request
+       @param persistent if true, we also store the image in the persistent cache
+    */
+    void storeKeyframeThumbnail(const QString &binId, int pos, const QImage &img, bool persistent = false);
+
     /** @brief Removes all the thumbnails for a given clip */
     void invalidateThumbsForClip(const QString &binId);
 
@@ -73,7 +83,7 @@ protected:
     ThumbnailCache();
 
     // Return the key associated to a thumbnail
-    static QString getKey(const QString &binId, int pos, bool *ok);
+    static QString getKey(const QString &binId, int pos, bool *ok, bool keyframe = false);
     static QStringList getAudioKey(const QString &binId, bool *ok);
 
     // Return the dir where the persistent cache lives
@@ -89,5 +99,7 @@ protected:
     // the following maps keeps track of the positions that we store for each clip in volatile caches.
     // Note that we don't track deletions due to items dropped from the cache. So the maps can contain more items that are currently stored.
     std::unordered_map<QString, std::vector<int>> m_storedVolatile;
+    std::unordered_map<QString, std::vector<int>> m_storedKeyframes;
     mutable std::unordered_map<QString, std::vector<int>> m_storedOnDisk;
+    mutable std::unordered_map<QString, std::vector<int>> m_storedKeyframesOnDisk;
 };
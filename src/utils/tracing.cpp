@@ -0,0 +1,176 @@
+/*
+    SPDX-FileCopyrightText: 2026 Kdenlive contributors
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#include "tracing.h"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QFile>
+#include <QMutex>
+#include <QThread>
+
+#include <chrono>
+#include <memory>
+#include <vector>
+
+std::atomic_bool Tracing::s_enabled{false};
+
+namespace {
+// Events beyond this count are dropped to keep memory bounded during long sessions
+constexpr size_t maxEventsPerThread = 1 << 20;
+
+struct TraceEvent
+{
+    const char *category;
+    const char *name;
+    char phase;
+    qint64 timestamp;
+    qint64 value; // duration for spans, argument value for counters and instant events
+    const char *argument;
+};
+
+struct ThreadBuffer
+{
+    QMutex mutex;
+    std::vector<TraceEvent> events;
+    quint64 threadId{0};
+    QString threadName;
+};
+
+QMutex registryMutex;
+std::vector<std::shared_ptr<ThreadBuffer>> &registry()
+{
+    static std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+    return buffers;
+}
+
+// Each thread appends to its own buffer, the buffer mutex is only contended while exporting
+ThreadBuffer &threadBuffer()
+{
+    thread_local std::shared_ptr<ThreadBuffer> buffer;
+    if (!buffer) {
+        buffer = std::make_shared<ThreadBuffer>();
+        buffer->threadId = quint64(reinterpret_cast<quintptr>(QThread::currentThreadId()));
+        buffer->threadName = QThread::currentThread()->objectName();
+        if (buffer->threadName.isEmpty()) {
+            const bool mainThread = qApp && QThread::currentThread() == qApp->thread();
+            buffer->threadName = mainThread ? QStringLiteral("Main") : QStringLiteral("Thread %1").arg(buffer->threadId);
+        }
+        QMutexLocker lk(&registryMutex);
+        registry().push_back(buffer);
+    }
+    return *buffer;
+}
+
+void record(const TraceEvent &event)
+{
+    ThreadBuffer &buffer = threadBuffer();
+    QMutexLocker lk(&buffer.mutex);
+    if (buffer.events.size() < maxEventsPerThread) {
+        buffer.events.push_back(event);
+    }
+}
+
+QByteArray escaped(const QByteArray &text)
+{
+    QByteArray result = text;
+    result.replace('\\', "\\\\");
+    result.replace('"', "\\\"");
+    return result;
+}
+} // namespace
+
+void Tracing::setEnabled(bool enabled)
+{
+    // Start the clock
+    timestamp();
+    s_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+qint64 Tracing::timestamp()
+{
+    static const auto origin = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - origin).count();
+}
+
+void Tracing::completeSpan(const char *category, const char *name, qint64 start)
+{
+    record({category, name, 'X', start, timestamp() - start, nullptr});
+}
+
+void Tracing::counter(const char *name, qint64 value)
+{
+    record({"counter", name, 'C', timestamp(), value, "value"});
+}
+
+void Tracing::instant(const char *category, const char *name, const char *argument, qint64 value)
+{
+    record({category, name, 'i', timestamp(), value, argument});
+}
+
+int Tracing::eventCount()
+{
+    QMutexLocker lk(&registryMutex);
+    size_t count = 0;
+    for (const auto &buffer : registry()) {
+        QMutexLocker bufferLock(&buffer->mutex);
+        count += buffer->events.size();
+    }
+    return int(count);
+}
+
+void Tracing::clear()
+{
+    QMutexLocker lk(&registryMutex);
+    for (const auto &buffer : registry()) {
+        QMutexLocker bufferLock(&buffer->mutex);
+        buffer->events.clear();
+    }
+}
+
+bool Tracing::exportChromeTrace(const QString &path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "Cannot write trace file" << path;
+        return false;
+    }
+    const qint64 pid = QCoreApplication::applicationPid();
+    file.write("{\"traceEvents\":[\n");
+    bool first = true;
+    auto writeEvent = [&file, &first](const QByteArray &json) {
+        if (!first) {
+            file.write(",\n");
+        }
+        first = false;
+        file.write(json);
+    };
+    QMutexLocker lk(&registryMutex);
+    for (const auto &buffer : registry()) {
+        QMutexLocker bufferLock(&buffer->mutex);
+        writeEvent(QStringLiteral("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%1,\"tid\":%2,\"args\":{\"name\":\"%3\"}}")
+                       .arg(pid)
+                       .arg(buffer->threadId)
+                       .arg(QString::fromUtf8(escaped(buffer->threadName.toUtf8())))
+                       .toUtf8());
+        for (const TraceEvent &event : buffer->events) {
+            QByteArray json = "{\"name\":\"" + escaped(event.name) + "\",\"cat\":\"" + escaped(event.category) + "\",\"ph\":\"" + event.phase +
+                              "\",\"pid\":" + QByteArray::number(pid) + ",\"tid\":" + QByteArray::number(buffer->threadId) +
+                              ",\"ts\":" + QByteArray::number(event.timestamp);
+            if (event.phase == 'X') {
+                json += ",\"dur\":" + QByteArray::number(event.value) + '}';
+            } else {
+                if (event.phase == 'i') {
+                    // Thread scoped instant event
+                    json += ",\"s\":\"t\"";
+                }
+                json += ",\"args\":{\"" + escaped(event.argument) + "\":" + QByteArray::number(event.value) + "}}";
+            }
+            writeEvent(json);
+        }
+    }
+    file.write("\n],\"displayTimeUnit\":\"ms\"}\n");
+    return file.error() == QFileDevice::NoError;
+}
@@ -0,0 +1,90 @@
+/*
+    SPDX-FileCopyrightText: 2026 Kdenlive contributors
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#pragma once
+
+#include <QString>
+#include <QtGlobal>
+
+#include <atomic>
+
+/** @class Tracing
+    @brief Low overhead timing of model operations, jobs, monitor and cache activity.
+    Spans and counters are recorded in per thread buffers when tracing is enabled (it is disabled by default, in which case
+    a span only costs an atomic load). The recorded session can be exported in the Chrome trace event JSON format, to be opened in
+    chrome://tracing or https://ui.perfetto.dev.
+    Tracing is enabled at startup when the KDENLIVE_TRACE_FILE environment variable is set, the trace is then written to that file on exit.
+    It can also be started and stopped from the Help menu, which exports the recorded trace when stopped.
+    Names and categories must be string literals (or have static storage), they are stored as pointers.
+ */
+class Tracing
+{
+public:
+    static void setEnabled(bool enabled);
+    static bool isEnabled() { return s_enabled.load(std::memory_order_relaxed); }
+    /** @brief Microseconds elapsed since the tracing clock was started */
+    static qint64 timestamp();
+    /** @brief Record a span that started at @param start (see timestamp()) and ends now */
+    static void completeSpan(const char *category, const char *name, qint64 start);
+    /** @brief Record the value of a counter */
+    static void counter(const char *name, qint64 value);
+    /** @brief Record an instant event, with @param value as its @param argument */
+    static void instant(const char *category, const char *name, const char *argument, qint64 value);
+    /** @brief Number of recorded events, for all threads */
+    static int eventCount();
+    /** @brief Discard all recorded events */
+    static void clear();
+    /** @brief Write the recorded events to @param path in the Chrome trace event JSON format
+     *  @returns false if the file could not be written */
+    static bool exportChromeTrace(const QString &path);
+
+private:
+    static std::atomic_bool s_enabled;
+};
+
+/** @class TraceSpan
+    @brief RAII helper recording a span from its construction to its destruction, see TRACE_SCOPE
+ */
+class TraceSpan
+{
+public:
+    TraceSpan(const char *category, const char *name)
+        : m_category(category)
+        , m_name(name)
+        , m_start(Tracing::isEnabled() ? Tracing::timestamp() : -1)
+    {
+    }
+    ~TraceSpan()
+    {
+        if (m_start >= 0) {
+            Tracing::completeSpan(m_category, m_name, m_start);
+        }
+    }
+    Q_DISABLE_COPY_MOVE(TraceSpan)
+
+private:
+    const char *m_category;
+    const char *m_name;
+    qint64 m_start;
+};
+
+/// Records the execution time of the current scope, named after the current function
+#define TRACE_SCOPE(category) TraceSpan traceSpan_(category, __FUNCTION__)
+/// Records the execution time of the current scope under the given name
+#define TRACE_SCOPE_NAMED(category, name) TraceSpan traceSpan_(category, name)
+/// Records the value of a counter
+#define TRACE_COUNTER(name, value)                                                                                                                             \
+    do {                                                                                                                                                       \
+        if (Tracing::isEnabled()) {                                                                                                                            \
+            Tracing::counter(name, value);                                                                                                                     \
+        }                                                                                                                                                      \
+    } while (false)
+/// Records an event at the current time, with a value passed as the given argument
+#define TRACE_INSTANT(category, name, argument, value)                                                                                                         \
+    do {                                                                                                                                                       \
+        if (Tracing::isEnabled()) {                                                                                                                            \
+            Tracing::instant(category, name, argument, value);                                                                                                 \
+        }                                                                                                                                                      \
+    } while (false)
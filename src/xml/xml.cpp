@@ -7,6 +7,8 @@
 #include <QDebug>
 #include <QFile>
 #include <QSaveFile>
+#include <QXmlStreamReader>
+#include <QXmlStreamWriter>
 
 // static
 bool Xml::docContentFromFile(QDomDocument &doc, const QString &fileName, bool namespaceProcessing)
@@ -246,3 +248,161 @@ void Xml::removeMetaProperties(QDomElement producer)
         }
     }
 }
+
+Xml::TagIndex::TagIndex(const QDomNode &root, const QStringList &tags)
+{
+    for (const QString &tag : tags) {
+        m_elements.insert(tag, {});
+    }
+    // Iterative pre-order walk, so that elements are listed in document order like elementsByTagName
+    QDomNode node = root.firstChild();
+    while (!node.isNull()) {
+        if (node.isElement()) {
+            QDomElement element = node.toElement();
+            const QString tag = element.tagName();
+            if (tags.isEmpty()) {
+                m_elements[tag].append(element);
+            } else {
+                auto it = m_elements.find(tag);
+                if (it != m_elements.end()) {
+                    it->append(element);
+                }
+            }
+        }
+        if (node.hasChildNodes()) {
+            node = node.firstChild();
+            continue;
+        }
+        while (!node.isNull() && node != root && node.nextSibling().isNull()) {
+            node = node.parentNode();
+        }
+        if (node.isNull() || node == root) {
+            break;
+        }
+        node = node.nextSibling();
+    }
+}
+
+const QVector<QDomElement> &Xml::TagIndex::elements(const QString &tagName) const
+{
+    static const QVector<QDomElement> empty;
+    auto it = m_elements.constFind(tagName);
+    return it == m_elements.constEnd() ? empty : it.value();
+}
+
+int Xml::TagIndex::count(const QString &tagName) const
+{
+    return elements(tagName).size();
+}
+
+Xml::StreamInfo Xml::scanDocument(QIODevice *device, bool rootOnly)
+{
+    StreamInfo info;
+    QXmlStreamReader reader(device);
+    while (!reader.atEnd()) {
+        reader.readNext();
+        if (!reader.isStartElement()) {
+            continue;
+        }
+        if (info.rootTag.isEmpty()) {
+            info.rootTag = reader.name().toString();
+            const QXmlStreamAttributes attributes = reader.attributes();
+            for (const QXmlStreamAttribute &attribute : attributes) {
+                info.rootAttributes.insert(attribute.name().toString(), attribute.value().toString());
+            }
+            if (rootOnly) {
+                break;
+            }
+        }
+        info.tagCount[reader.name().toString()]++;
+    }
+    info.valid = !reader.hasError() && !info.rootTag.isEmpty();
+    return info;
+}
+
+bool Xml::streamReplace(QIODevice *in, QIODevice *out, const QString &before, const QString &after)
+{
+    QXmlStreamReader reader(in);
+    QXmlStreamWriter writer(out);
+    while (!reader.atEnd()) {
+        reader.readNext();
+        if (reader.isStartElement()) {
+            writer.writeStartElement(reader.qualifiedName().toString());
+            const QXmlStreamAttributes attributes = reader.attributes();
+            for (const QXmlStreamAttribute &attribute : attributes) {
+                writer.writeAttribute(attribute.qualifiedName().toString(), attribute.value().toString().replace(before, after));
+            }
+        } else if (reader.isCharacters() && !reader.isCDATA()) {
+            writer.writeCharacters(reader.text().toString().replace(before, after));
+        } else if (!reader.hasError()) {
+            writer.writeCurrentToken(reader);
+        }
+    }
+    return !reader.hasError();
+}
+
+static QString replacePatterns(QString text, const QMap<QString, QString> &replacements, bool textNode)
+{
+    for (auto it = replacements.constBegin(); it != replacements.constEnd(); ++it) {
+        if (it.key().startsWith(QLatin1Char('>'))) {
+            // The pattern matches the end of a start tag followed by text
+            if (textNode && text.startsWith(QStringView(it.key()).mid(1))) {
+                text.replace(0, it.key().size() - 1, it.value().mid(1));
+            }
+        } else {
+            text.replace(it.key(), it.value());
+        }
+    }
+    return text;
+}
+
+bool Xml::streamSceneList(QIODevice *in, QIODevice *out, const QMap<QString, QString> &replacements)
+{
+    QXmlStreamReader reader(in);
+    QXmlStreamWriter writer(out);
+    int depth = 0;
+    // Depth of the main tractor, -1 until it is found
+    int mainTractorDepth = -1;
+    bool mainTractorDone = false;
+    // True if the current text directly follows a start tag, so that the '>' patterns can match it
+    bool startOfText = false;
+    while (!reader.atEnd()) {
+        reader.readNext();
+        if (reader.isStartElement()) {
+            depth++;
+            const QXmlStreamAttributes attributes = reader.attributes();
+            if (!mainTractorDone && reader.name() == QLatin1String("tractor") && attributes.hasAttribute(QLatin1String("global_feed"))) {
+                mainTractorDepth = depth;
+                mainTractorDone = true;
+            }
+            writer.writeStartElement(reader.qualifiedName().toString());
+            for (const QXmlStreamAttribute &attribute : attributes) {
+                writer.writeAttribute(attribute.qualifiedName().toString(), replacePatterns(attribute.value().toString(), replacements, false));
+            }
+            if (depth == mainTractorDepth + 1 && reader.name() == QLatin1String("property") &&
+                attributes.value(QLatin1String("name")) == QLatin1String("meta.volume")) {
+                // Set playlist audio volume to 100%
+                reader.readElementText(QXmlStreamReader::IncludeChildElements);
+                writer.writeCharacters(QStringLiteral("1"));
+                writer.writeEndElement();
+                depth--;
+                continue;
+            }
+            startOfText = true;
+            continue;
+        }
+        if (reader.isEndElement()) {
+            if (depth == mainTractorDepth) {
+                mainTractorDepth = -1;
+            }
+            depth--;
+            writer.writeEndElement();
+        } else if (reader.isCharacters() && !reader.isCDATA()) {
+            writer.writeCharacters(replacePatterns(reader.text().toString(), replacements, startOfText));
+        } else if (!reader.hasError()) {
+            writer.writeCurrentToken(reader);
+        }
+        startOfText = false;
+    }
+    return !reader.hasError();
+}
@@ -7,10 +7,13 @@
 
 #include "definitions.h"
 #include <QDomElement>
+#include <QHash>
 #include <QString>
 #include <QVector>
 #include <unordered_map>
 
+class QIODevice;
+
 /** @brief This static class provides helper functions to manipulate Dom objects easily
  */
 namespace Xml {
@@ -94,4 +97,50 @@ void renameXmlProperty(const QDomElement &effect, const QString &oldName, const
 
 QMap<QString, QString> getXmlPropertyByWildcard(const QDomElement &element, const QString &propertyName);
 
+/** @brief Snapshot of the elements of a document grouped by tag name, built in a single pass over the tree.
+   Unlike the QDomNodeList returned by elementsByTagName, it is not rebuilt by a full tree walk each time the document is
+   modified, so elements can be edited while iterating. Elements added after the index was built are not listed.
+ */
+class TagIndex
+{
+public:
+    /** @brief Index all descendants of @param root whose tag name is in @param tags (all tags if empty) */
+    explicit TagIndex(const QDomNode &root, const QStringList &tags = QStringList());
+    /** @brief Returns the elements with the given tag name, in document order */
+    const QVector<QDomElement> &elements(const QString &tagName) const;
+    int count(const QString &tagName) const;
+
+private:
+    QHash<QString, QVector<QDomElement>> m_elements;
+};
+
+/** @brief Information collected by a streaming scan of an MLT document, without building its DOM */
+struct StreamInfo
+{
+    bool valid = false;
+    /** @brief Name of the root element */
+    QString rootTag;
+    /** @brief Attributes of the root element */
+    QHash<QString, QString> rootAttributes;
+    /** @brief Number of elements for each tag name, empty when only the root element was scanned */
+    QHash<QString, int> tagCount;
+};
+
+/** @brief Scan an xml document from @param device with a QXmlStreamReader, memory use does not grow with the document size.
+    If @param rootOnly is true, the scan stops at the root element */
+StreamInfo scanDocument(QIODevice *device, bool rootOnly = false);
+
+/** @brief Copy an xml document from @param in to @param out in a single streaming pass, replacing @param before by @param after
+   in all attribute values and text nodes.
+   @returns false if the document could not be parsed
+ */
+bool streamReplace(QIODevice *in, QIODevice *out, const QString &before, const QString &after);
+
+/** @brief Copy an MLT scene from @param in to @param out in a single streaming pass, as written in a project file.
+   The volume of the main tractor (the one with a global_feed attribute) is reset to 100%. Each key of @param replacements is replaced by its
+   value in attribute values and text nodes, a key starting with '>' only matches at the start of a text node.
+   @returns false if the scene could not be parsed
+ */
+bool streamSceneList(QIODevice *in, QIODevice *out, const QMap<QString, QString> &replacements = QMap<QString, QString>());
+
 } // namespace Xml
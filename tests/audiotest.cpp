@@ -0,0 +1,125 @@
+/*
+    SPDX-FileCopyrightText: 2026 Kdenlive contributors
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#include "catch.hpp"
+#include "test_utils.hpp"
+// test specific headers
+#include "audio/audioLevels.h"
+#include "audiomixer/audiolevelbuffer.hpp"
+
+#include <atomic>
+#include <thread>
+
+TEST_CASE("Audio level buffer", "[Audio]")
+{
+    AudioLevelBuffer buffer(4, 2);
+    QVector<double> levels;
+
+    SECTION("Levels are found by frame position")
+    {
+        REQUIRE_FALSE(buffer.levels(0, levels));
+        for (int pos = 0; pos < 3; pos++) {
+            const double values[2] = {double(-pos), double(-pos - 10)};
+            buffer.push(pos, values);
+        }
+        REQUIRE(buffer.levels(1, levels));
+        REQUIRE(levels == QVector<double>({-1, -11}));
+        REQUIRE_FALSE(buffer.levels(3, levels));
+    }
+
+    SECTION("Oldest frames are overwritten")
+    {
+        for (int pos = 0; pos < 6; pos++) {
+            const double values[2] = {double(pos), double(pos)};
+            buffer.push(pos, values);
+        }
+        REQUIRE_FALSE(buffer.levels(1, levels));
+        REQUIRE(buffer.levels(2, levels));
+        REQUIRE(buffer.levels(5, levels));
+        REQUIRE(levels == QVector<double>({5, 5}));
+    }
+
+    SECTION("Clear discards stored levels")
+    {
+        const double values[2] = {1, 2};
+        buffer.push(10, values);
+        buffer.clear();
+        REQUIRE_FALSE(buffer.levels(10, levels));
+        buffer.push(11, values);
+        REQUIRE(buffer.levels(11, levels));
+    }
+
+    SECTION("Repeated positions keep their first levels")
+    {
+        const double first[2] = {1, 2};
+        const double second[2] = {3, 4};
+        REQUIRE(buffer.push(7, first));
+        REQUIRE_FALSE(buffer.push(7, second));
+        REQUIRE(buffer.levels(7, levels));
+        REQUIRE(levels == QVector<double>({1, 2}));
+        // A repeated frame does not push older frames out of the buffer
+        for (int pos = 8; pos < 11; pos++) {
+            buffer.push(pos, second);
+            REQUIRE_FALSE(buffer.push(pos, second));
+        }
+        REQUIRE(buffer.levels(7, levels));
+        buffer.clear();
+        REQUIRE(buffer.push(7, second));
+    }
+
+    SECTION("Reader never sees a partially written frame")
+    {
+        std::atomic_bool done{false};
+        std::thread producer([&]() {
+            for (int pos = 0; pos < 200000; pos++) {
+                const double values[2] = {double(pos), double(pos)};
+                buffer.push(pos % 8, values);
+            }
+            done = true;
+        });
+        while (!done) {
+            for (int pos = 0; pos < 8; pos++) {
+                if (buffer.levels(pos, levels)) {
+                    REQUIRE(levels.at(0) == levels.at(1));
+                    REQUIRE(int(levels.at(0)) % 8 == pos);
+                }
+            }
+        }
+        producer.join();
+    }
+}
+
+TEST_CASE("Audio levels are published by block", "[Audio]")
+{
+    AudioLevels levels(2);
+    REQUIRE(levels.count() == 0);
+    int published = 0;
+    for (int i = 0; i < AudioLevels::BlockSize + 10; ++i) {
+        if (levels.append(uint8_t(i % 200))) {
+            published++;
+        }
+    }
+    // Only the complete block is visible to readers
+    REQUIRE(published == 1);
+    REQUIRE(levels.count() == AudioLevels::BlockSize);
+    AudioLevels::Snapshot snapshot = levels.snapshot();
+    REQUIRE(snapshot.count() == AudioLevels::BlockSize);
+    REQUIRE(snapshot.at(250) == 50);
+    REQUIRE_FALSE(levels.isComplete());
+
+    levels.finish();
+    REQUIRE(levels.isComplete());
+    REQUIRE(levels.count() == AudioLevels::BlockSize + 10);
+    // A previous snapshot is not modified
+    REQUIRE(snapshot.count() == AudioLevels::BlockSize);
+    snapshot = levels.snapshot();
+    REQUIRE(snapshot.at(AudioLevels::BlockSize + 9) == uint8_t((AudioLevels::BlockSize + 9) % 200));
+    REQUIRE(levels.maxLevel() == 199);
+
+    auto copy = AudioLevels::fromVector({1, 2, 3}, 1);
+    REQUIRE(copy->isComplete());
+    REQUIRE(copy->count() == 3);
+    REQUIRE(copy->snapshot().at(2) == 3);
+}
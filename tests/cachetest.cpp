@@ -9,13 +9,19 @@
 #include "doc/docundostack.hpp"
 #include "doc/kdenlivedoc.h"
 #include <cmath>
+#include <cstring>
 #include <iostream>
 #include <tuple>
 #include <unordered_set>
 
 #include "core.h"
 #include "definitions.h"
+#include "kdenlivesettings.h"
+#include "monitor/framecache.h"
+#include "monitor/scopes/sharedframe.h"
+#include "utils/cachemanager.h"
 #include "utils/thumbnailcache.hpp"
+#include <QTemporaryDir>
 
 TEST_CASE("Cache insert-remove", "[Cache]")
 {
@@ -48,6 +54,40 @@ TEST_CASE("Cache insert-remove", "[Cache]")
         ThumbnailCache::get()->storeThumbnail(binId, 0, img, false);
         REQUIRE(ThumbnailCache::get()->checkIntegrity());
     }
+    SECTION("Keyframe thumbnails are not exact thumbnails")
+    {
+        QImage keyframeImg(100, 100, QImage::Format_ARGB32_Premultiplied);
+        keyframeImg.fill(Qt::blue);
+        ThumbnailCache::get()->storeKeyframeThumbnail(binId, 5, keyframeImg);
+        REQUIRE(ThumbnailCache::get()->checkIntegrity());
+        REQUIRE(ThumbnailCache::get()->hasKeyframeThumbnail(binId, 5));
+        REQUIRE_FALSE(ThumbnailCache::get()->hasThumbnail(binId, 5, true));
+        REQUIRE(ThumbnailCache::get()->getThumbnail(binId, 5, true).isNull());
+        REQUIRE(ThumbnailCache::get()->getKeyframeThumbnail(binId, 5).pixelColor(0, 0) == QColor(Qt::blue));
+
+        // An exact thumbnail is preferred for fast previews
+        QImage img(100, 100, QImage::Format_ARGB32_Premultiplied);
+        img.fill(Qt::red);
+        ThumbnailCache::get()->storeThumbnail(binId, 5, img, false);
+        REQUIRE(ThumbnailCache::get()->getKeyframeThumbnail(binId, 5).pixelColor(0, 0) == QColor(Qt::red));
+
+        ThumbnailCache::get()->invalidateThumbsForClip(binId);
+        REQUIRE_FALSE(ThumbnailCache::get()->hasKeyframeThumbnail(binId, 5));
+        REQUIRE(ThumbnailCache::get()->checkIntegrity());
+    }
+    SECTION("Keyframe thumbnails can be stored on disk")
+    {
+        QImage keyframeImg(100, 100, QImage::Format_ARGB32_Premultiplied);
+        keyframeImg.fill(Qt::blue);
+        ThumbnailCache::get()->storeKeyframeThumbnail(binId, 7, keyframeImg, true);
+        ThumbnailCache::get()->clearCache();
+        REQUIRE_FALSE(ThumbnailCache::get()->hasKeyframeThumbnail(binId, 7, true));
+        REQUIRE(ThumbnailCache::get()->hasKeyframeThumbnail(binId, 7));
+        REQUIRE_FALSE(ThumbnailCache::get()->hasThumbnail(binId, 7));
+        REQUIRE(ThumbnailCache::get()->getKeyframeThumbnail(binId, 7).pixelColor(0, 0) == QColor(Qt::blue));
+        ThumbnailCache::get()->invalidateThumbsForClip(binId);
+        REQUIRE_FALSE(ThumbnailCache::get()->hasKeyframeThumbnail(binId, 7));
+    }
     pCore->projectManager()->closeCurrentDocument(false, false);
 }
 
@@ -90,3 +130,299 @@ TEST_CASE("getAudioKey() should dereference `ok` param", "ThumbnailCache") {
     }
     pCore->projectManager()->closeCurrentDocument(false, false);
 }
+
+namespace {
+/** @brief Write a file of @param size bytes in @param root, last modified at @param date */
+void writeCacheFile(const QDir &root, const QString &path, int size, const QDateTime &date)
+{
+    root.mkpath(QFileInfo(path).path());
+    QFile file(root.absoluteFilePath(path));
+    REQUIRE(file.open(QIODevice::WriteOnly));
+    file.write(QByteArray(size, 'a'));
+    file.flush();
+    file.setFileTime(date, QFileDevice::FileModificationTime);
+    file.close();
+}
+
+/** @brief A small rendered frame, as received by the monitor */
+SharedFrame renderedFrame(int position, uint8_t value)
+{
+    const int size = mlt_image_format_size(mlt_image_rgba, 4, 4, nullptr);
+    auto *image = static_cast<uint8_t *>(mlt_pool_alloc(size));
+    memset(image, value, size_t(size));
+    Mlt::Frame frame(mlt_frame_init(nullptr));
+    mlt_frame_set_image(frame.get_frame(), image, size, mlt_pool_release);
+    frame.set("format", int(mlt_image_rgba));
+    frame.set("width", 4);
+    frame.set("height", 4);
+    frame.set("rendered", 1);
+    mlt_frame_set_position(frame.get_frame(), position);
+    // Release the reference of mlt_frame_init
+    mlt_frame_close(frame.get_frame());
+    return SharedFrame(frame);
+}
+} // namespace
+
+TEST_CASE("Monitor frame cache", "[Cache]")
+{
+    const qint64 frameSize = mlt_image_format_size(mlt_image_rgba, 4, 4, nullptr);
+    MonitorFrameCache cache(10 * frameSize);
+    cache.setCaptureRange(0, 100);
+
+    SECTION("Frames are copied and served by position")
+    {
+        for (int i = 0; i < 5; i++) {
+            cache.store(renderedFrame(i, uint8_t(i)));
+        }
+        REQUIRE(cache.count() == 5);
+        REQUIRE(cache.size() == 5 * frameSize);
+        REQUIRE(cache.covers(0, 4));
+        REQUIRE_FALSE(cache.covers(0, 5));
+        Mlt::Frame cached = cache.frame(3);
+        REQUIRE(cached.is_valid());
+        REQUIRE(mlt_frame_get_position(cached.get_frame()) == 3);
+        SharedFrame shared(cached);
+        REQUIRE(MonitorFrameCache::isCachedFrame(shared));
+        REQUIRE(shared.get_image(mlt_image_rgba)[0] == 3);
+        // A cached frame is not stored again
+        cache.store(shared);
+        REQUIRE(cache.count() == 5);
+        REQUIRE_FALSE(cache.frame(7).is_valid());
+    }
+
+    SECTION("Only frames in the capture range are stored")
+    {
+        cache.setCaptureRange(10, 20);
+        cache.store(renderedFrame(5, 0));
+        cache.store(renderedFrame(15, 0));
+        REQUIRE(cache.count() == 1);
+        cache.setCaptureRange(0, -1);
+        cache.store(renderedFrame(16, 0));
+        REQUIRE(cache.count() == 1);
+    }
+
+    SECTION("Frames farthest from the anchor are evicted first")
+    {
+        cache.setAnchor(20);
+        for (int i = 0; i < 30; i++) {
+            cache.store(renderedFrame(i, 0));
+        }
+        REQUIRE(cache.size() <= 10 * frameSize);
+        REQUIRE(cache.covers(16, 25));
+        REQUIRE_FALSE(cache.frame(0).is_valid());
+        cache.setBudget(4 * frameSize);
+        REQUIRE(cache.count() == 4);
+        REQUIRE(cache.covers(19, 22));
+        cache.setBudget(0);
+        REQUIRE_FALSE(cache.isEnabled());
+        REQUIRE(cache.count() == 0);
+    }
+
+    SECTION("Modified ranges are invalidated")
+    {
+        for (int i = 0; i < 10; i++) {
+            cache.store(renderedFrame(i, 0));
+        }
+        cache.invalidate(2, 4);
+        REQUIRE(cache.count() == 7);
+        REQUIRE(cache.covers(0, 1));
+        REQUIRE_FALSE(cache.frame(3).is_valid());
+        cache.invalidate(8, -1);
+        REQUIRE(cache.count() == 5);
+        REQUIRE(cache.covers(5, 7));
+        cache.clear();
+        REQUIRE(cache.count() == 0);
+        REQUIRE(cache.size() == 0);
+    }
+}
+
+TEST_CASE("Effect changes evict the cached monitor frames", "[Cache]")
+{
+    auto binModel = pCore->projectItemModel();
+    std::shared_ptr<DocUndoStack> undoStack = std::make_shared<DocUndoStack>(nullptr);
+    KdenliveDoc document(undoStack);
+    pCore->projectManager()->testSetDocument(&document);
+    QDateTime documentDate = QDateTime::currentDateTime();
+    KdenliveTests::updateTimeline(false, QString(), QString(), documentDate, 0);
+    auto timeline = document.getTimeline(document.uuid());
+    pCore->projectManager()->testSetActiveTimeline(timeline);
+
+    int tid1;
+    REQUIRE(timeline->requestTrackInsertion(-1, tid1));
+    QString binId = KdenliveTests::createProducer(pCore->getProjectProfile(), "red", binModel);
+    int cid1;
+    REQUIRE(timeline->requestClipInsertion(binId, tid1, 100, cid1));
+    const int clipEnd = 100 + timeline->getClipPlaytime(cid1);
+
+    // No timeline preview is enabled, the cache must be invalidated anyway
+    REQUIRE_FALSE(timeline->hasTimelinePreview());
+    const qint64 frameSize = mlt_image_format_size(mlt_image_rgba, 4, 4, nullptr);
+    MonitorFrameCache cache(300 * frameSize);
+    cache.setCaptureRange(0, 200);
+    QMetaObject::Connection connection =
+        QObject::connect(timeline.get(), &TimelineModel::invalidateFrames, [&cache](int in, int out) { cache.invalidate(in, out); });
+    auto fillCache = [&cache]() {
+        for (int i = 0; i <= 200; i++) {
+            cache.store(renderedFrame(i, 0));
+        }
+        REQUIRE(cache.covers(0, 200));
+    };
+
+    SECTION("Timeline clip effect")
+    {
+        fillCache();
+        REQUIRE(timeline->getClipEffectStackModel(cid1)->appendEffect(QStringLiteral("sepia")));
+        REQUIRE_FALSE(cache.frame(100).is_valid());
+        REQUIRE_FALSE(cache.frame(clipEnd - 1).is_valid());
+        REQUIRE(cache.covers(0, 99));
+        REQUIRE(cache.covers(clipEnd + 1, 200));
+    }
+
+    SECTION("Bin clip effect")
+    {
+        fillCache();
+        REQUIRE(binModel->getClipByBinID(binId)->getEffectStack()->appendEffect(QStringLiteral("sepia")));
+        REQUIRE_FALSE(cache.frame(110).is_valid());
+        REQUIRE(cache.covers(0, 99));
+        REQUIRE(cache.covers(clipEnd + 1, 200));
+    }
+
+    SECTION("Master effect")
+    {
+        fillCache();
+        REQUIRE(timeline->getMasterEffectStackModel()->appendEffect(QStringLiteral("sepia")));
+        REQUIRE(cache.count() == 0);
+    }
+    QObject::disconnect(connection);
+    timeline.reset();
+    pCore->projectManager()->closeCurrentDocument(false, false);
+}
+
+TEST_CASE("Cache manager quotas", "[Cache]")
+{
+    SECTION("Cache data is grouped by category folder and proxy")
+    {
+        QString key;
+        CacheType type;
+        QString owner;
+        REQUIRE(CacheManager::entryForPath(QStringLiteral("1234/preview/chunks/abcd.mp4"), key, type, owner));
+        REQUIRE(key == QLatin1String("1234/preview"));
+        REQUIRE(type == CachePreview);
+        REQUIRE(owner == QLatin1String("1234"));
+        REQUIRE(CacheManager::entryForPath(QStringLiteral("1234/.project.kdenlive"), key, type, owner));
+        REQUIRE(key == QLatin1String("1234"));
+        REQUIRE(type == CacheBase);
+        // A range limited proxy and its segments are a single entry
+        REQUIRE(CacheManager::entryForPath(QStringLiteral("proxy/abcd_25_100.mkv"), key, type, owner));
+        REQUIRE(key == QLatin1String("proxy/abcd"));
+        REQUIRE(type == CacheProxy);
+        REQUIRE(owner.isEmpty());
+        REQUIRE_FALSE(CacheManager::entryForPath(QStringLiteral("knewstuff/data"), key, type, owner));
+        // Project folders are named after the document id, other folders are not cached data
+        REQUIRE_FALSE(CacheManager::entryForPath(QStringLiteral("footage/preview/clip.mp4"), key, type, owner));
+    }
+
+    SECTION("Sizes are tracked and least recently used data is removed")
+    {
+        QTemporaryDir dir;
+        REQUIRE(dir.isValid());
+        QDir root(dir.path());
+        const QDateTime old = QDateTime::currentDateTime().addDays(-30);
+        writeCacheFile(root, QStringLiteral("1000/preview/0.mp4"), 1048576, old);
+        writeCacheFile(root, QStringLiteral("2000/preview/0.mp4"), 1048576, old);
+        writeCacheFile(root, QStringLiteral("proxy/abcd.mkv"), 5000, old);
+        auto &manager = CacheManager::get();
+        manager->setRoot(dir.path());
+        manager->waitForDone();
+        REQUIRE(manager->size(CachePreview) == 2 * 1048576);
+        REQUIRE(manager->size(CachePreview, QStringLiteral("1000")) == 1048576);
+        REQUIRE(manager->size(CacheProxy) == 5000);
+        REQUIRE(manager->usage(root.absoluteFilePath(QStringLiteral("1000"))).size == 1048576);
+
+        // Recorded writes and deletions
+        writeCacheFile(root, QStringLiteral("2000/audiothumbs/0.png"), 1000, QDateTime::currentDateTime());
+        manager->recordWrite(root.absoluteFilePath(QStringLiteral("2000/audiothumbs/0.png")));
+        REQUIRE(manager->size(CacheAudio, QStringLiteral("2000")) == 1000);
+        QFile::remove(root.absoluteFilePath(QStringLiteral("2000/audiothumbs/0.png")));
+        manager->recordDeletion(root.absoluteFilePath(QStringLiteral("2000/audiothumbs")));
+        REQUIRE(manager->size(CacheAudio) == 0);
+
+        // The data of the project opened in this session is kept
+        manager->recordAccess(root.absoluteFilePath(QStringLiteral("2000")));
+        KdenliveSettings::setPreviewcachequota(1);
+        manager->enforceQuotas();
+        manager->waitForDone();
+        REQUIRE_FALSE(root.exists(QStringLiteral("1000/preview/0.mp4")));
+        REQUIRE(root.exists(QStringLiteral("1000/preview")));
+        REQUIRE(root.exists(QStringLiteral("2000/preview/0.mp4")));
+        REQUIRE(manager->size(CachePreview) == 1048576);
+        REQUIRE(root.exists(QStringLiteral("proxy/abcd.mkv")));
+
+        KdenliveSettings::setPreviewcachequota(0);
+        manager->setRoot(QStandardPaths::writableLocation(QStandardPaths::CacheLocation));
+    }
+
+    SECTION("Custom cache folders are managed and data in use is kept")
+    {
+        QTemporaryDir mainDir;
+        QTemporaryDir projectDir;
+        REQUIRE(mainDir.isValid());
+        REQUIRE(projectDir.isValid());
+        QDir root(projectDir.path());
+        const QDateTime old = QDateTime::currentDateTime().addDays(-30);
+        writeCacheFile(root, QStringLiteral("1000/preview/0.mp4"), 1048576, old);
+        writeCacheFile(root, QStringLiteral("2000/preview/0.mp4"), 1048576, old.addDays(-10));
+        // User files stored next to the cached data
+        writeCacheFile(root, QStringLiteral("footage/preview/clip.mp4"), 1048576, old.addDays(-20));
+        auto &manager = CacheManager::get();
+        manager->setRoot(mainDir.path());
+        manager->addRoot(projectDir.path());
+        manager->waitForDone();
+        REQUIRE(manager->manages(root.absoluteFilePath(QStringLiteral("1000/preview/0.mp4"))));
+        REQUIRE_FALSE(manager->manages(QStringLiteral("/not/in/cache/clip.mp4")));
+        REQUIRE(manager->size(CachePreview, QStringLiteral("1000")) == 1048576);
+        REQUIRE(manager->size(CachePreview, QString(), projectDir.path()) == 2 * 1048576);
+        REQUIRE(manager->size(CachePreview, QString(), mainDir.path()) == 0);
+        REQUIRE(manager->totalSize(projectDir.path()) == 2 * 1048576);
+        REQUIRE(root.exists(QStringLiteral("cache.manifest")));
+
+        // Another instance wrote in the least recently used folder without us knowing, it must not be deleted
+        writeCacheFile(root, QStringLiteral("2000/preview/1.mp4"), 1000, QDateTime::currentDateTime());
+        KdenliveSettings::setPreviewcachequota(1);
+        manager->enforceQuotas();
+        manager->waitForDone();
+        REQUIRE(root.exists(QStringLiteral("2000/preview/0.mp4")));
+        REQUIRE(root.exists(QStringLiteral("2000/preview/1.mp4")));
+        REQUIRE_FALSE(root.exists(QStringLiteral("1000/preview/0.mp4")));
+        REQUIRE(root.exists(QStringLiteral("footage/preview/clip.mp4")));
+        // The entry in use was measured again
+        REQUIRE(manager->size(CachePreview, QStringLiteral("2000")) == 1048576 + 1000);
+
+        KdenliveSettings::setPreviewcachequota(0);
+        manager->setRoot(QStandardPaths::writableLocation(QStandardPaths::CacheLocation));
+    }
+
+    SECTION("Refreshing a proxy only measures its own files")
+    {
+        QTemporaryDir dir;
+        REQUIRE(dir.isValid());
+        QDir root(dir.path());
+        const QDateTime now = QDateTime::currentDateTime();
+        writeCacheFile(root, QStringLiteral("proxy/abcd.mlt"), 100, now);
+        writeCacheFile(root, QStringLiteral("proxy/efgh.mkv"), 1000, now);
+        auto &manager = CacheManager::get();
+        manager->setRoot(dir.path());
+        manager->waitForDone();
+        REQUIRE(manager->size(CacheProxy) == 1100);
+        REQUIRE_FALSE(manager->manages(QStringLiteral("/not/in/cache/clip.mp4")));
+
+        // Files written without being recorded
+        writeCacheFile(root, QStringLiteral("proxy/abcd_0_99.mkv"), 2000, now);
+        writeCacheFile(root, QStringLiteral("proxy/efgh.mkv"), 3000, now);
+        manager->refresh(root.absoluteFilePath(QStringLiteral("proxy/abcd.mlt")));
+        manager->waitForDone();
+        REQUIRE(manager->size(CacheProxy) == 100 + 2000 + 1000);
+
+        manager->setRoot(QStandardPaths::writableLocation(QStandardPaths::CacheLocation));
+    }
+}
@@ -5,7 +5,19 @@
 
 #include "test_utils.hpp"
 // test specific headers
+#include "bin/projectclip.h"
 #include "doc/documentchecker.h"
+#include "doc/documentvalidator.h"
+#include "doc/docundostack.hpp"
+#include "doc/filesearchindex.h"
+#include "doc/kdenlivedoc.h"
+#include "kdenlivesettings.h"
+#include "undohelper.hpp"
+#include "xml/xml.hpp"
+
+#include <QBuffer>
+
+#include <QTemporaryDir>
 
 TEST_CASE("Basic tests of the document checker parts", "[DocumentChecker]")
 {
@@ -60,3 +72,213 @@ TEST_CASE("Missing project items", "[DocumentChecker]")
         CHECK(results.value(DocumentChecker::MissingType::Proxy) == 1);
     }
 }
+
+TEST_CASE("Missing files search index", "[DocumentChecker]")
+{
+    QTemporaryDir root;
+    REQUIRE(root.isValid());
+    QDir dir(root.path());
+    REQUIRE(dir.mkpath(QStringLiteral("a/b")));
+    REQUIRE(dir.mkpath(QStringLiteral("c")));
+    auto writeFile = [](const QString &path, const QByteArray &data) {
+        QFile file(path);
+        REQUIRE(file.open(QIODevice::WriteOnly));
+        file.write(data);
+        file.close();
+    };
+    writeFile(dir.absoluteFilePath(QStringLiteral("a/b/clip.mp4")), QByteArray(1000, 'a'));
+    writeFile(dir.absoluteFilePath(QStringLiteral("c/renamed.mp4")), QByteArray(1000, 'b'));
+    writeFile(dir.absoluteFilePath(QStringLiteral("c/clip.mp4")), QByteArray(10, 'c'));
+    std::atomic_bool abort{false};
+    FileSearchIndex index(root.path());
+    REQUIRE(index.scan(abort));
+    CHECK(index.fileCount() == 3);
+
+    SECTION("Find by name")
+    {
+        // The least nested file wins
+        CHECK(index.findPath(QStringLiteral("clip.mp4")) == dir.absoluteFilePath(QStringLiteral("c/clip.mp4")));
+        CHECK(index.findPath(QStringLiteral("unknown.mp4")).isEmpty());
+    }
+    SECTION("Find by size and hash")
+    {
+        const QString hash = QString::fromLatin1(ProjectClip::calculateHash(dir.absoluteFilePath(QStringLiteral("c/renamed.mp4"))).first.toHex());
+        index.hashFilesWithSize({1000}, abort);
+        CHECK(index.findFile(QStringLiteral("1000"), hash, QStringLiteral("/old/path/clip.mp4")) == dir.absoluteFilePath(QStringLiteral("c/renamed.mp4")));
+        CHECK(index.findFile(QStringLiteral("1001"), hash, QStringLiteral("/old/path/clip.mp4")).isEmpty());
+        // Without size and hash, fall back to the file name
+        CHECK(index.findFile(QString(), QString(), QStringLiteral("/old/path/clip.mp4")) == dir.absoluteFilePath(QStringLiteral("c/clip.mp4")));
+    }
+    SECTION("Aborted scan")
+    {
+        FileSearchIndex aborted(root.path());
+        abort = true;
+        CHECK_FALSE(aborted.scan(abort));
+    }
+}
+
+TEST_CASE("Streaming document scan and tag index", "[DocumentChecker]")
+{
+    QString path = sourcesPath + "/dataset/test-mix.kdenlive";
+    QDomDocument doc;
+    REQUIRE(Xml::docContentFromFile(doc, path, false));
+
+    SECTION("Stream scan matches the DOM")
+    {
+        QFile file(path);
+        REQUIRE(file.open(QIODevice::ReadOnly));
+        const Xml::StreamInfo info = Xml::scanDocument(&file);
+        CHECK(info.valid);
+        CHECK(info.rootTag == QLatin1String("mlt"));
+        for (const QString &tag : {QStringLiteral("producer"), QStringLiteral("filter"), QStringLiteral("property"), QStringLiteral("entry")}) {
+            CHECK(info.tagCount.value(tag) == doc.elementsByTagName(tag).count());
+        }
+        file.seek(0);
+        const Xml::StreamInfo rootInfo = Xml::scanDocument(&file, true);
+        CHECK(rootInfo.valid);
+        CHECK(rootInfo.rootTag == QLatin1String("mlt"));
+        CHECK(rootInfo.rootAttributes == info.rootAttributes);
+        CHECK(rootInfo.tagCount.isEmpty());
+    }
+    SECTION("Tag index matches elementsByTagName")
+    {
+        const Xml::TagIndex index(doc);
+        for (const QString &tag : {QStringLiteral("producer"), QStringLiteral("playlist"), QStringLiteral("property"), QStringLiteral("tractor")}) {
+            QDomNodeList list = doc.elementsByTagName(tag);
+            REQUIRE(index.count(tag) == list.count());
+            for (int i = 0; i < list.count(); ++i) {
+                CHECK(index.elements(tag).at(i) == list.at(i).toElement());
+            }
+        }
+        const Xml::TagIndex filtered(doc, {QStringLiteral("filter")});
+        CHECK(filtered.count(QStringLiteral("filter")) == doc.elementsByTagName(QStringLiteral("filter")).count());
+        CHECK(filtered.count(QStringLiteral("producer")) == 0);
+    }
+    SECTION("Streaming replace")
+    {
+        QBuffer in;
+        in.setData(QByteArray("<mlt root=\"$CURRENTPATH\"><producer><property name=\"resource\">$CURRENTPATH/a.mp4</property></producer></mlt>"));
+        in.open(QIODevice::ReadOnly);
+        QBuffer out;
+        out.open(QIODevice::WriteOnly);
+        REQUIRE(Xml::streamReplace(&in, &out, QStringLiteral("$CURRENTPATH"), QStringLiteral("/home/user")));
+        QDomDocument result;
+        REQUIRE(result.setContent(out.data()));
+        CHECK(result.documentElement().attribute(QStringLiteral("root")) == QLatin1String("/home/user"));
+        CHECK(Xml::getXmlProperty(result.documentElement().firstChildElement(QStringLiteral("producer")), QStringLiteral("resource")) ==
+              QLatin1String("/home/user/a.mp4"));
+    }
+    SECTION("Streaming scene export")
+    {
+        QBuffer in;
+        in.setData(QByteArray("<?xml version=\"1.0\" encoding=\"utf-8\"?><mlt><producer id=\"p\"><property name=\"resource\">proxy/a.mkv</property>"
+                              "<property name=\"meta.volume\">0.5</property></producer><tractor id=\"t\" global_feed=\"1\"><property "
+                              "name=\"meta.volume\">0.2</property><track producer=\"p\"/></tractor></mlt>"));
+        in.open(QIODevice::ReadOnly);
+        QBuffer out;
+        out.open(QIODevice::WriteOnly);
+        const QMap<QString, QString> replacements = {{QStringLiteral(">proxy/"), QStringLiteral(">/new/proxy/")}};
+        REQUIRE(Xml::streamSceneList(&in, &out, replacements));
+        QDomDocument result;
+        REQUIRE(result.setContent(out.data()));
+        const QDomElement producer = result.documentElement().firstChildElement(QStringLiteral("producer"));
+        CHECK(Xml::getXmlProperty(producer, QStringLiteral("resource")) == QLatin1String("/new/proxy/a.mkv"));
+        // Only the main tractor volume is reset
+        CHECK(Xml::getXmlProperty(producer, QStringLiteral("meta.volume")) == QLatin1String("0.5"));
+        const QDomElement tractor = result.documentElement().firstChildElement(QStringLiteral("tractor"));
+        CHECK(Xml::getXmlProperty(tractor, QStringLiteral("meta.volume")) == QLatin1String("1"));
+        CHECK(tractor.firstChildElement(QStringLiteral("track")).attribute(QStringLiteral("producer")) == QLatin1String("p"));
+
+        QBuffer broken;
+        broken.setData(QByteArray("<mlt><producer></mlt>"));
+        broken.open(QIODevice::ReadOnly);
+        QBuffer discarded;
+        discarded.open(QIODevice::WriteOnly);
+        CHECK_FALSE(Xml::streamSceneList(&broken, &discarded));
+    }
+}
+
+TEST_CASE("Document validation benchmark", "[.][benchmark]")
+{
+    const QStringList projects = QDir(sourcesPath + "/dataset").entryList({QStringLiteral("*.kdenlive")}, QDir::Files);
+    for (const QString &project : projects) {
+        const QString path = sourcesPath + "/dataset/" + project;
+        BENCHMARK(QStringLiteral("Stream scan %1").arg(project).toStdString())
+        {
+            QFile file(path);
+            file.open(QIODevice::ReadOnly);
+            return Xml::scanDocument(&file).tagCount.size();
+        };
+        BENCHMARK(QStringLiteral("Validate and check %1").arg(project).toStdString())
+        {
+            QDomDocument doc;
+            Xml::docContentFromFile(doc, path, false);
+            DocumentValidator validator(doc, QUrl::fromLocalFile(path));
+            validator.validate(KdenliveDoc::getDocumentVersion());
+            DocumentChecker d(QUrl::fromLocalFile(path), doc);
+            return d.hasErrorInProject();
+        };
+    }
+}
+
+TEST_CASE("Undo history memory budget", "[DocUndoStack]")
+{
+    const int previousBudget = KdenliveSettings::undomemorybudget();
+    DocUndoStack stack(nullptr);
+    int value = 0;
+    auto pushSet = [&stack, &value](int newValue, const QString &mergeKey, qint64 cost) {
+        int oldValue = value;
+        Fun undo = [&value, oldValue]() {
+            value = oldValue;
+            return true;
+        };
+        Fun redo = [&value, newValue]() {
+            value = newValue;
+            return true;
+        };
+        redo();
+        auto *command = new FunctionalUndoCommand(undo, redo, QStringLiteral("Set value"));
+        command->setMemoryCost(cost);
+        command->setMergeKey(mergeKey);
+        stack.push(command);
+    };
+
+    SECTION("Commands with the same merge key are merged")
+    {
+        KdenliveSettings::setUndomemorybudget(0);
+        pushSet(1, QStringLiteral("value"), 100);
+        pushSet(2, QStringLiteral("value"), 100);
+        pushSet(3, QStringLiteral("value"), 100);
+        REQUIRE(stack.count() == 1);
+        pushSet(4, QString(), 100);
+        pushSet(5, QString(), 100);
+        REQUIRE(stack.count() == 3);
+        stack.undo();
+        stack.undo();
+        REQUIRE(value == 3);
+        stack.undo();
+        REQUIRE(value == 0);
+        stack.redo();
+        REQUIRE(value == 3);
+    }
+
+    SECTION("The oldest commands are discarded over budget")
+    {
+        KdenliveSettings::setUndomemorybudget(1);
+        for (int i = 1; i <= 5; ++i) {
+            pushSet(i, QString(), 400000);
+        }
+        REQUIRE(stack.count() == 5);
+        REQUIRE(stack.discardedCount() == 3);
+        REQUIRE(stack.memoryUsage() <= 1048576);
+        stack.undo();
+        stack.undo();
+        REQUIRE(value == 3);
+        // Discarded commands do nothing
+        stack.undo();
+        REQUIRE(value == 3);
+        QCoreApplication::processEvents();
+        REQUIRE(stack.index() == 3);
+    }
+    KdenliveSettings::setUndomemorybudget(previousBudget);
+}
@@ -18,6 +18,94 @@
 #include "effects/effectstack/model/effectitemmodel.hpp"
 #include "effects/effectstack/model/effectstackmodel.hpp"
 
+#include <QDir>
+#include <QFile>
+#include <QStandardPaths>
+#include <QTemporaryDir>
+
+namespace {
+/** @brief Repository reading custom assets from a folder, counting the parsed files */
+class CachedAssetsRepository : public AbstractAssetsRepository<AssetListType::AssetType>
+{
+public:
+    explicit CachedAssetsRepository(QString dir)
+        : m_dir(std::move(dir))
+    {
+        init();
+    }
+    mutable int parsedFiles{0};
+
+protected:
+    Mlt::Properties *retrieveListFromMlt() const override { return new Mlt::Properties(); }
+    Mlt::Properties *getMetadata(const QString &) const override { return nullptr; }
+    void parseType(Mlt::Properties *, Info &) override {}
+    void parseCustomAssetDocument(QDomDocument &doc, const QString &, std::unordered_map<QString, Info> &customAssets) const override
+    {
+        parsedFiles++;
+        Info info;
+        info.xml = doc.documentElement();
+        info.id = info.xml.attribute(QStringLiteral("id"));
+        info.mltId = info.xml.attribute(QStringLiteral("tag"));
+        info.name = info.xml.attribute(QStringLiteral("name"));
+        info.type = AssetListType::AssetType::Custom;
+        customAssets[info.id] = info;
+    }
+    QString assetCacheName() const override { return QStringLiteral("test_assets_cache"); }
+    QStringList assetDirs() const override { return {m_dir}; }
+    QStringList assetIncludedPath() const override { return {}; }
+    QStringList assetExcludedPath() const override { return {}; }
+    QString assetPreferredListPath() const override { return QString(); }
+
+private:
+    QString m_dir;
+};
+
+void writeAsset(const QString &path, const QString &name)
+{
+    QFile file(path);
+    REQUIRE(file.open(QIODevice::WriteOnly));
+    file.write(QStringLiteral("<effect id=\"%1\" tag=\"%1\" name=\"%2\"/>").arg(QFileInfo(path).baseName(), name).toUtf8());
+}
+} // namespace
+
+TEST_CASE("Asset repository cache", "[Effects]")
+{
+    QTemporaryDir dir;
+    REQUIRE(dir.isValid());
+    const QString cacheFile = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QStringLiteral("/assets/test_assets_cache");
+    QFile::remove(cacheFile);
+    writeAsset(dir.filePath(QStringLiteral("first.xml")), QStringLiteral("First"));
+    writeAsset(dir.filePath(QStringLiteral("second.xml")), QStringLiteral("Second"));
+
+    CachedAssetsRepository parsed(dir.path());
+    REQUIRE(parsed.parsedFiles == 2);
+    REQUIRE(parsed.getName(QStringLiteral("first")) == QStringLiteral("First"));
+
+    // Unchanged files are read from the cache
+    CachedAssetsRepository cached(dir.path());
+    REQUIRE(cached.parsedFiles == 0);
+    REQUIRE(cached.getName(QStringLiteral("second")) == QStringLiteral("Second"));
+
+    SECTION("A modified file invalidates the cache")
+    {
+        writeAsset(dir.filePath(QStringLiteral("second.xml")), QStringLiteral("Second renamed"));
+        CachedAssetsRepository modified(dir.path());
+        REQUIRE(modified.parsedFiles == 2);
+        REQUIRE(modified.getName(QStringLiteral("second")) == QStringLiteral("Second renamed"));
+    }
+
+    SECTION("A new file invalidates the cache")
+    {
+        writeAsset(dir.filePath(QStringLiteral("third.xml")), QStringLiteral("Third"));
+        CachedAssetsRepository added(dir.path());
+        REQUIRE(added.parsedFiles == 3);
+        REQUIRE(added.exists(QStringLiteral("third")));
+        CachedAssetsRepository again(dir.path());
+        REQUIRE(again.parsedFiles == 0);
+    }
+    QFile::remove(cacheFile);
+}
+
 QString anEffect;
 TEST_CASE("Effects stack", "[Effects]")
 {
@@ -73,6 +161,16 @@ TEST_CASE("Effects stack", "[Effects]")
         REQUIRE(model->rowCount() == 1);
     }
 
+    SECTION("Effect commands report the size of the effect")
+    {
+        const qint64 usage = undoStack->memoryUsage();
+        REQUIRE(model->appendEffect(anEffect));
+        const qint64 effectCost = model->memoryCost();
+        REQUIRE(effectCost > 0);
+        REQUIRE(DocUndoStack::commandCost(undoStack->command(undoStack->count() - 1)) >= effectCost);
+        REQUIRE(undoStack->memoryUsage() >= usage + effectCost);
+    }
+
     SECTION("Create cut with fade in")
     {
         auto clipModel = timeline->getClipEffectStackModel(cid1);
@@ -6,10 +6,13 @@
 #include "test_utils.hpp"
 // test specific headers
 #include "bin/binplaylist.hpp"
+#include "bin/filewatcher.hpp"
 #include "doc/kdenlivedoc.h"
 #include "timeline2/model/builders/meltBuilder.hpp"
 #include "xml/xml.hpp"
 
+#include <QDir>
+#include <QTemporaryDir>
 #include <QTemporaryFile>
 #include <QUndoGroup>
 
@@ -472,3 +475,49 @@ TEST_CASE("Opening File With Keyframes", "[OPENKFRS]")
         pCore->projectManager()->closeCurrentDocument(false, false);
     }
 }
+
+TEST_CASE("File watcher shares folder watches", "[FileWatcher]")
+{
+    QTemporaryDir dir;
+    REQUIRE(dir.isValid());
+    REQUIRE(QDir(dir.path()).mkdir(QStringLiteral("sub")));
+    const QString first = dir.filePath(QStringLiteral("a.mkv"));
+    const QString second = dir.filePath(QStringLiteral("b.mkv"));
+    const QString third = dir.filePath(QStringLiteral("sub/c.mkv"));
+    FileWatcher watcher;
+    watcher.addFile(QStringLiteral("1"), first);
+    watcher.addFile(QStringLiteral("2"), second);
+    watcher.addFile(QStringLiteral("3"), third);
+    // Two clips using the same file
+    watcher.addFile(QStringLiteral("4"), first);
+    REQUIRE(watcher.contains(first));
+    REQUIRE(watcher.contains(third));
+    REQUIRE(watcher.directoryCount() == 2);
+
+    watcher.removeFile(QStringLiteral("1"));
+    REQUIRE(watcher.contains(first));
+    watcher.removeFile(QStringLiteral("4"));
+    REQUIRE_FALSE(watcher.contains(first));
+    REQUIRE(watcher.directoryCount() == 2);
+    watcher.removeFile(QStringLiteral("3"));
+    REQUIRE(watcher.directoryCount() == 1);
+    watcher.clear();
+    REQUIRE_FALSE(watcher.contains(second));
+    REQUIRE(watcher.directoryCount() == 0);
+
+    // Paths to the same folder share the same watch
+    watcher.addFile(QStringLiteral("5"), dir.filePath(QStringLiteral("sub/../a.mkv")));
+    watcher.addFile(QStringLiteral("6"), third);
+    REQUIRE(watcher.contains(first));
+    REQUIRE(watcher.directoryCount() == 2);
+    watcher.addFile(QStringLiteral("7"), dir.filePath(QStringLiteral("sub/./d.mkv")));
+    REQUIRE(watcher.directoryCount() == 2);
+
+    // Deleting a watched folder makes all its clips missing
+    QStringList missing;
+    QObject::connect(&watcher, &FileWatcher::binClipMissing, [&missing](const QString &binId) { missing << binId; });
+    const QString subDir = QFileInfo(FileWatcher::watchedPath(third)).absolutePath();
+    REQUIRE(QMetaObject::invokeMethod(&watcher, "slotUrlMissing", Q_ARG(QString, subDir)));
+    missing.sort();
+    REQUIRE(missing == QStringList({QStringLiteral("6"), QStringLiteral("7")}));
+}
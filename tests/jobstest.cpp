@@ -0,0 +1,194 @@
+/*
+    SPDX-FileCopyrightText: 2026 Kdenlive contributors
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#include "catch.hpp"
+#include "test_utils.hpp"
+// test specific headers
+#include "jobs/keyframestask.h"
+#include "jobs/proxytask.h"
+#include "jobs/scenedetector.h"
+
+#include <QFile>
+#include <QTemporaryDir>
+#include <QTemporaryFile>
+
+#include <vector>
+
+TEST_CASE("Scene detection metrics", "[Jobs]")
+{
+    const int count = 101;
+    std::vector<uint8_t> black(count, 0);
+    std::vector<uint8_t> white(count, 255);
+    std::vector<uint8_t> grey(count, 51);
+    SceneDetector::Histogram blackHistogram;
+    SceneDetector::Histogram whiteHistogram;
+    SceneDetector::lumaHistogram(black.data(), count, blackHistogram);
+    SceneDetector::lumaHistogram(white.data(), count, whiteHistogram);
+
+    SECTION("Histogram and luma differences")
+    {
+        REQUIRE(int(blackHistogram.front()) == count);
+        REQUIRE(int(whiteHistogram.back()) == count);
+        REQUIRE(SceneDetector::histogramDistance(blackHistogram, blackHistogram, count) == 0.f);
+        REQUIRE(SceneDetector::histogramDistance(blackHistogram, whiteHistogram, count) == 1.f);
+        REQUIRE(SceneDetector::lumaDifference(black.data(), black.data(), count) == 0.f);
+        REQUIRE(SceneDetector::lumaDifference(black.data(), white.data(), count) == 1.f);
+        REQUIRE(qAbs(SceneDetector::lumaDifference(grey.data(), black.data(), count) - 0.2f) < 1e-6f);
+    }
+
+    SceneDetector::Metrics metrics;
+    metrics.luma = {0.f, 0.02f, 0.02f, 0.9f, 0.02f, 0.03f};
+    metrics.histogram = metrics.luma;
+
+    SECTION("Cuts depend on the threshold")
+    {
+        REQUIRE(SceneDetector::detectCuts(metrics, 0.3) == QVector<int>({3}));
+        REQUIRE(SceneDetector::detectCuts(metrics, 0.9).isEmpty());
+    }
+
+    SECTION("Metrics are cached for a clip length")
+    {
+        QTemporaryFile file;
+        REQUIRE(file.open());
+        file.close();
+        REQUIRE(SceneDetector::save(file.fileName(), metrics));
+        SceneDetector::Metrics cached;
+        REQUIRE_FALSE(SceneDetector::load(file.fileName(), 10, cached));
+        REQUIRE(SceneDetector::load(file.fileName(), 6, cached));
+        REQUIRE(cached.luma == metrics.luma);
+        REQUIRE(cached.histogram == metrics.histogram);
+    }
+}
+
+TEST_CASE("Range limited proxy segments", "[Jobs]")
+{
+    const QVector<QPoint> needed{{0, 99}, {200, 299}, {500, 599}};
+
+    SECTION("Nothing covered")
+    {
+        REQUIRE(ProxyTask::missingRanges(needed, {}) == needed);
+    }
+
+    SECTION("Only uncovered parts are missing")
+    {
+        const QVector<QPoint> covered{{0, 49}, {220, 249}, {280, 400}, {500, 599}};
+        REQUIRE(ProxyTask::missingRanges(needed, covered) == QVector<QPoint>({{50, 99}, {200, 219}, {250, 279}}));
+        REQUIRE(ProxyTask::missingRanges(covered, covered).isEmpty());
+    }
+
+    SECTION("Segments are listed from their file names")
+    {
+        QTemporaryDir dir;
+        REQUIRE(dir.isValid());
+        const QString playlist = dir.filePath(QStringLiteral("abc.mlt"));
+        for (const QString &name : {QStringLiteral("abc_200_299.mkv"), QStringLiteral("abc_0_99.mkv"), QStringLiteral("abcd_0_10.mkv")}) {
+            QFile file(dir.filePath(name));
+            REQUIRE(file.open(QIODevice::WriteOnly));
+        }
+        const auto segments = ProxyTask::rangeSegments(playlist);
+        REQUIRE(segments.size() == 2);
+        REQUIRE(segments.at(0).first == QPoint(0, 99));
+        REQUIRE(segments.at(1).first == QPoint(200, 299));
+        REQUIRE(segments.at(1).second == dir.filePath(QStringLiteral("abc_200_299.mkv")));
+    }
+
+    SECTION("Short segments only cover their encoded frames")
+    {
+        QTemporaryDir dir;
+        REQUIRE(dir.isValid());
+        const QString playlist = dir.filePath(QStringLiteral("abc.mlt"));
+        for (const QString &name : {QStringLiteral("abc_0_99.mkv"), QStringLiteral("abc_200_299.mkv"), QStringLiteral("abc_500_599.mkv")}) {
+            QFile file(dir.filePath(name));
+            REQUIRE(file.open(QIODevice::WriteOnly));
+        }
+        // Complete, or longer than the range
+        REQUIRE(ProxyTask::fitSegment({{0, 99}, dir.filePath(QStringLiteral("abc_0_99.mkv"))}, 101, 1000));
+        // Short segment
+        REQUIRE(ProxyTask::fitSegment({{200, 299}, dir.filePath(QStringLiteral("abc_200_299.mkv"))}, 60, 1000));
+        // Unreadable segment
+        REQUIRE_FALSE(ProxyTask::fitSegment({{500, 599}, dir.filePath(QStringLiteral("abc_500_599.mkv"))}, -1, 1000));
+        // A range past the end of the clip only needs the frames up to the end
+        QFile last(dir.filePath(QStringLiteral("abc_900_1099.mkv")));
+        REQUIRE(last.open(QIODevice::WriteOnly));
+        REQUIRE(ProxyTask::fitSegment({{900, 1099}, last.fileName()}, 100, 1000));
+
+        const auto segments = ProxyTask::rangeSegments(playlist);
+        QVector<QPoint> covered;
+        for (const auto &segment : segments) {
+            covered << segment.first;
+        }
+        REQUIRE(covered == QVector<QPoint>({{0, 99}, {200, 259}, {900, 1099}}));
+        REQUIRE_FALSE(QFile::exists(dir.filePath(QStringLiteral("abc_200_299.mkv"))));
+        // The missing frames are encoded again on the next update
+        REQUIRE(ProxyTask::missingRanges(needed, covered) == QVector<QPoint>({{260, 299}, {500, 599}}));
+    }
+}
+
+TEST_CASE("Segmented proxy", "[Jobs]")
+{
+    SECTION("Split positions")
+    {
+        // Positions snapped to the same keyframe or out of the clip are ignored
+        REQUIRE(ProxyTask::splitRanges({250, 250, 500, 1200}, 1000) == QVector<QPoint>({{0, 249}, {250, 499}, {500, -1}}));
+        REQUIRE(ProxyTask::splitRanges({0}, 1000) == QVector<QPoint>({{0, -1}}));
+        REQUIRE(ProxyTask::splitRanges({}, 1000) == QVector<QPoint>({{0, -1}}));
+    }
+
+    SECTION("Parts are not range segments")
+    {
+        QTemporaryDir dir;
+        REQUIRE(dir.isValid());
+        QFile file(dir.filePath(QStringLiteral("abc_part0.mkv")));
+        REQUIRE(file.open(QIODevice::WriteOnly));
+        REQUIRE(ProxyTask::rangeSegments(dir.filePath(QStringLiteral("abc.mlt"))).isEmpty());
+    }
+
+    SECTION("Parallel encodes share the threads")
+    {
+        const QStringList parameters = {QStringLiteral("-threads"), QStringLiteral("0"), QStringLiteral("-i"), QStringLiteral("src.mp4"),
+                                        QStringLiteral("-vcodec"), QStringLiteral("libx264"), QStringLiteral("-threads"), QStringLiteral("0"),
+                                        QStringLiteral("dest.mkv")};
+        const QStringList limited = ProxyTask::limitThreads(parameters, 3, 2);
+        REQUIRE(limited.size() == parameters.size());
+        REQUIRE(limited.at(1) == QStringLiteral("2"));
+        REQUIRE(limited.at(7) == QStringLiteral("2"));
+        REQUIRE(limited.last() == QStringLiteral("dest.mkv"));
+        // Without encoder threads in the preset, they are added before the destination
+        const QStringList added = ProxyTask::limitThreads(parameters.mid(0, 6) << QStringLiteral("dest.mkv"), 3, 4);
+        REQUIRE(added.mid(6) == QStringList({QStringLiteral("-threads"), QStringLiteral("4"), QStringLiteral("dest.mkv")}));
+        REQUIRE(added.at(1) == QStringLiteral("4"));
+    }
+
+    SECTION("FFmpeg stats")
+    {
+        REQUIRE(ProxyTask::ffmpegStatsTime(QStringLiteral("frame=  100 fps=50 q=28.0 size=1kB time=00:01:02.60 bitrate=1kbits/s")) == 63);
+        REQUIRE(ProxyTask::ffmpegStatsTime(QStringLiteral("Press [q] to stop")) == -1);
+    }
+}
+
+TEST_CASE("Video keyframe index", "[Jobs]")
+{
+    SECTION("Keyframe packets are relative to the stream start")
+    {
+        const QString output = QStringLiteral("packet,0.500000,K__\npacket,0.540000,___\npacket,2.500000,K__\nstream,0.500000\n");
+        const QVector<double> times = KeyframesTask::parseProbe(output);
+        REQUIRE(times.size() == 2);
+        REQUIRE(qFuzzyIsNull(times.at(0)));
+        REQUIRE(qFuzzyCompare(times.at(1), 2.));
+    }
+
+    SECTION("The index is stored and read back")
+    {
+        QTemporaryDir dir;
+        REQUIRE(dir.isValid());
+        const QString path = dir.filePath(QStringLiteral("clip.keyframes"));
+        QVector<double> times;
+        REQUIRE_FALSE(KeyframesTask::readIndex(path, times));
+        REQUIRE(KeyframesTask::writeIndex(path, {0., 2., 4.04}));
+        REQUIRE(KeyframesTask::readIndex(path, times));
+        REQUIRE(times.size() == 3);
+        REQUIRE(qFuzzyCompare(times.at(2), 4.04));
+    }
+}
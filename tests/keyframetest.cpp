@@ -260,6 +260,34 @@ TEST_CASE("Keyframe model", "[KeyframeModel]")
         undoStack->undo();
         state1(6.1);
     }
+    SECTION("Interpolation matches the MLT animation")
+    {
+        // Alternate keyframe types so that smooth curves, which use 2 keyframes on each side, are covered
+        const QList<KeyframeType::KeyframeEnum> types = {KeyframeType::Linear, KeyframeType::CurveSmooth, KeyframeType::Discrete, KeyframeType::Curve,
+                                                         KeyframeType::CubicIn};
+        double fps = pCore->getCurrentFps();
+        for (int i = 1; i < 40; i++) {
+            REQUIRE(KdenliveTests::addKeyframe(model, GenTime(i * 10, fps), types.at(i % types.size()), (i * 37) % 100 / 100.));
+        }
+        REQUIRE(model->rowCount() == 40);
+        REQUIRE(check_anim_identity(model));
+        const QString animData = effect->data(index, AssetParameterModel::ValueRole).toString();
+        Mlt::Properties mlt_prop;
+        effect->passProperties(mlt_prop);
+        mlt_prop.set("key", animData.toUtf8().constData());
+        (void)mlt_prop.anim_get_double("key", 0, 500);
+        for (int frame = 0; frame < 420; frame += 3) {
+            CHECK(model->getInterpolatedValue(frame).toDouble() == Approx(mlt_prop.anim_get_double("key", frame)));
+        }
+        // Moving a keyframe only updates the asset once
+        int changes = 0;
+        QObject::connect(effect.get(), &AssetParameterModel::updateChildren, [&changes]() { changes++; });
+        REQUIRE(model->moveKeyframe(GenTime(100, fps), GenTime(105, fps), -1, true));
+        CHECK(changes == 1);
+        CHECK(model->getInterpolatedValue(105) == model->getInterpolatedValue(GenTime(105, fps)));
+        CHECK(effect->data(index, AssetParameterModel::ValueRole).toString().contains(QStringLiteral("105")));
+    }
+
     clip.reset();
     timeline.reset();
     pCore->projectManager()->closeCurrentDocument(false, false);
@@ -7,8 +7,14 @@
 #include "test_utils.hpp"
 // test specific headers
 #include "doc/kdenlivedoc.h"
+#include "macros.hpp"
+#include "undohelper.hpp"
 #include <QUndoGroup>
 
+#include <atomic>
+#include <thread>
+#include <vector>
+
 using namespace fakeit;
 std::default_random_engine g(42);
 
@@ -345,6 +351,73 @@ TEST_CASE("Clip manipulation", "[ClipModel]")
         state(l, pos);
     }
 
+    SECTION("Ids of the items intersecting a range")
+    {
+        int length = timeline->getClipPlaytime(cid1);
+        REQUIRE(timeline->requestClipMove(cid3, tid1, 4 * length));
+        REQUIRE(timeline->requestClipMove(cid1, tid1, 0));
+        REQUIRE(timeline->requestClipMove(cid2, tid1, 2 * length));
+        REQUIRE(timeline->checkConsistency());
+        REQUIRE(timeline->getItemIdsInRange(tid1, 0, 5 * length) == QList<int>({cid1, cid2, cid3}));
+        REQUIRE(timeline->getItemIdsInRange(tid1, length, 2 * length) == QList<int>({cid2}));
+        REQUIRE(timeline->getItemIdsInRange(tid1, length - 1, 2 * length - 1) == QList<int>({cid1}));
+        REQUIRE(timeline->getItemIdsInRange(tid1, length, 2 * length - 1).isEmpty());
+        REQUIRE(timeline->getItemIdsInRange(tid2, 0, 5 * length).isEmpty());
+        REQUIRE(timeline->getItemIdsInRange(cid1, 0, 5 * length).isEmpty());
+        // A clip starting before the range is found
+        REQUIRE(timeline->getItemIdsInRange(tid1, 2 * length + 1, 2 * length + 2) == QList<int>({cid2}));
+        // Moving and resizing keeps the positions in sync
+        REQUIRE(timeline->requestClipMove(cid2, tid2, 2 * length));
+        REQUIRE(timeline->getItemIdsInRange(tid1, 0, 5 * length) == QList<int>({cid1, cid3}));
+        REQUIRE(timeline->getItemIdsInRange(tid2, 0, 5 * length) == QList<int>({cid2}));
+        REQUIRE(timeline->requestItemResize(cid3, length - 2, false) == length - 2);
+        REQUIRE(timeline->checkConsistency());
+        REQUIRE(timeline->getItemIdsInRange(tid1, 4 * length, 4 * length + 1).isEmpty());
+        REQUIRE(timeline->getItemIdsInRange(tid1, 4 * length + 2, 4 * length + 2) == QList<int>({cid3}));
+        // Model indexes
+        REQUIRE(timeline->getItemIndex(cid1) == timeline->makeClipIndexFromID(cid1));
+        REQUIRE_FALSE(timeline->getItemIndex(tid1).isValid());
+        // Only position and duration changes move items in or out of the visible range
+        REQUIRE(timeline->changesItemRange({}));
+        REQUIRE(timeline->changesItemRange({TimelineModel::SelectedRole, TimelineModel::StartRole}));
+        REQUIRE_FALSE(timeline->changesItemRange({TimelineModel::SelectedRole, TimelineModel::NameRole}));
+    }
+
+    SECTION("Display data follows clip changes")
+    {
+        REQUIRE(timeline->requestClipMove(cid1, tid1, 0));
+        int length = timeline->getClipPlaytime(cid1);
+        QModelIndex ix = timeline->makeClipIndexFromID(cid1);
+        REQUIRE(timeline->data(ix, TimelineModel::StartRole).toInt() == 0);
+        REQUIRE(timeline->data(ix, TimelineModel::DurationRole).toInt() == length);
+        int notifications = 0;
+        auto connection = QObject::connect(timeline.get(), &QAbstractItemModel::dataChanged, [&notifications]() { notifications++; });
+        // Unchanged roles are not signaled
+        timeline->notifyChange(ix, ix, {TimelineModel::StartRole, TimelineModel::DurationRole});
+        REQUIRE(notifications == 0);
+        // Roles that are not part of the display snapshot are always signaled
+        timeline->notifyChange(ix, ix, {TimelineModel::SelectedRole});
+        REQUIRE(notifications == 1);
+
+        REQUIRE(timeline->requestClipMove(cid1, tid1, 10));
+        REQUIRE(timeline->data(ix, TimelineModel::StartRole).toInt() == 10);
+        REQUIRE(timeline->requestItemResize(cid1, length - 2, true) == length - 2);
+        REQUIRE(timeline->data(ix, TimelineModel::DurationRole).toInt() == length - 2);
+        undoStack->undo();
+        REQUIRE(timeline->data(ix, TimelineModel::DurationRole).toInt() == length);
+        undoStack->undo();
+        REQUIRE(timeline->data(ix, TimelineModel::StartRole).toInt() == 0);
+        QObject::disconnect(connection);
+
+        // A change signaled from another thread discards the snapshot before the emitter returns
+        REQUIRE(KdenliveTests::hasDisplaySnapshot(timeline, cid1));
+        std::thread worker([&timeline, ix]() { Q_EMIT timeline->dataChanged(ix, ix, {TimelineModel::StartRole}); });
+        worker.join();
+        REQUIRE_FALSE(KdenliveTests::hasDisplaySnapshot(timeline, cid1));
+        REQUIRE(timeline->data(ix, TimelineModel::StartRole).toInt() == 0);
+        REQUIRE(KdenliveTests::hasDisplaySnapshot(timeline, cid1));
+    }
+
     SECTION("Insert a clip in a track and change track")
     {
         REQUIRE(timeline->checkConsistency());
@@ -2238,3 +2311,123 @@ TEST_CASE("New KdenliveDoc activeTrack", "KdenliveDoc")
         pCore->projectManager()->closeCurrentDocument(false, false);
     }
 }
+
+namespace {
+/** @brief Minimal model guarded like the model layer classes */
+class LockedValue
+{
+public:
+    int value() const
+    {
+        READ_LOCK();
+        return m_value;
+    }
+    /** @brief The READ_LOCK implementation that was used before ModelLocker */
+    int legacyValue() const
+    {
+        std::unique_ptr<QReadLocker> rlocker(new QReadLocker(nullptr));
+        std::unique_ptr<QWriteLocker> wlocker(new QWriteLocker(nullptr));
+        if (m_lock.tryLockForWrite()) {
+            m_lock.unlock();
+            wlocker.reset(new QWriteLocker(&m_lock));
+        } else {
+            rlocker.reset(new QReadLocker(&m_lock));
+        }
+        return m_value;
+    }
+    bool setValue(int value)
+    {
+        Fun operation = [this, value]() {
+            m_value = value;
+            // Querying the model from an undo lambda re-enters the write lock
+            return this->value() == value;
+        };
+        LOCK_IN_LAMBDA(operation);
+        return operation();
+    }
+    mutable QReadWriteLock m_lock{QReadWriteLock::Recursive};
+
+private:
+    int m_value{0};
+};
+
+void readConcurrently(int threadCount, int reads, const std::function<void()> &read)
+{
+    std::vector<std::thread> threads;
+    for (int i = 0; i < threadCount; ++i) {
+        threads.emplace_back([reads, &read]() {
+            for (int j = 0; j < reads; ++j) {
+                read();
+            }
+        });
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+}
+} // namespace
+
+TEST_CASE("Model read lock", "[ModelLocker]")
+{
+    LockedValue model;
+
+    SECTION("Reading while holding the write lock does not deadlock")
+    {
+        REQUIRE(model.setValue(5));
+        REQUIRE(model.value() == 5);
+    }
+
+    SECTION("Readers share the lock")
+    {
+        ModelLocker locker(&model.m_lock);
+        bool acquired = false;
+        std::thread other([&model, &acquired]() {
+            acquired = model.m_lock.tryLockForRead();
+            if (acquired) {
+                model.m_lock.unlock();
+            }
+        });
+        other.join();
+        REQUIRE(acquired);
+    }
+
+    SECTION("Writers are exclusive")
+    {
+        ModelLocker locker(&model.m_lock, ModelLocker::PreferWrite);
+        bool acquired = true;
+        std::thread other([&model, &acquired]() {
+            acquired = model.m_lock.tryLockForRead();
+            if (acquired) {
+                model.m_lock.unlock();
+            }
+        });
+        other.join();
+        REQUIRE_FALSE(acquired);
+    }
+
+    SECTION("Concurrent readers see consistent values")
+    {
+        REQUIRE(model.setValue(42));
+        std::atomic_int mismatches{0};
+        readConcurrently(4, 10000, [&model, &mismatches]() {
+            if (model.value() != 42) {
+                mismatches++;
+            }
+        });
+        REQUIRE(mismatches == 0);
+    }
+}
+
+TEST_CASE("Model read lock contention benchmark", "[.][benchmark]")
+{
+    LockedValue model;
+    const int threadCount = int(std::max(2u, std::thread::hardware_concurrency()));
+    BENCHMARK("Legacy READ_LOCK")
+    {
+        readConcurrently(threadCount, 20000, [&model]() { model.legacyValue(); });
+    };
+    BENCHMARK("Shared READ_LOCK")
+    {
+        readConcurrently(threadCount, 20000, [&model]() { model.value(); });
+    };
+}
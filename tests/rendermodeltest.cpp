@@ -8,6 +8,11 @@
 #include "render/renderrequest.h"
 #include "renderpresets/renderpresetmodel.hpp"
 #include "renderpresets/renderpresetrepository.hpp"
+#include "xml/xml.hpp"
+
+#include <QTemporaryDir>
+#include <mlt++/MltFilter.h>
+#include <mlt++/MltFrame.h>
 
 TEST_CASE("Basic tests of the render preset model", "[RenderPresets]")
 {
@@ -279,3 +284,164 @@ TEST_CASE("Tests of the render functions to use guides for sections", "[RenderRe
         CHECK(sections.at(2).second == out);
     }
 }
+
+TEST_CASE("Single pass audio stems", "[RenderRequestStems]")
+{
+    const QUuid uuid = QUuid::createUuid();
+    QDomDocument doc;
+    doc.setContent(QStringLiteral("<mlt><consumer vn=\"1\" f=\"mp3\" channels=\"2\"/>"
+                                  "<tractor id=\"tractor0\"><property name=\"kdenlive:audio_track\">1</property>"
+                                  "<property name=\"kdenlive:track_name\">Voice</property>"
+                                  "<track producer=\"playlist0\"/><track producer=\"playlist1\"/>"
+                                  "<filter id=\"filter0\"><property name=\"mlt_service\">volume</property>"
+                                  "<property name=\"internal_added\">237</property><property name=\"level\">-6</property></filter></tractor>"
+                                  "<tractor id=\"tractor1\"><property name=\"kdenlive:audio_track\">1</property>"
+                                  "<track producer=\"playlist2\"/><track producer=\"playlist3\"/></tractor>"
+                                  "<tractor id=\"tractor2\"><track producer=\"playlist4\"/><track producer=\"playlist5\"/></tractor>"
+                                  "<tractor id=\"main\"><property name=\"kdenlive:uuid\">%1</property>"
+                                  "<track producer=\"tractor0\"/><track producer=\"tractor1\"/><track producer=\"tractor2\"/></tractor></mlt>")
+                       .arg(uuid.toString()));
+    QTemporaryDir dir;
+    REQUIRE(dir.isValid());
+    const QString playlist = dir.filePath(QStringLiteral("render.mlt"));
+    const QString target = dir.filePath(QStringLiteral("out.mp3"));
+    auto loadPlaylist = [](const QString &path) {
+        QDomDocument result;
+        QFile file(path);
+        if (file.open(QIODevice::ReadOnly)) {
+            result.setContent(&file);
+        }
+        return result;
+    };
+    auto trackFilters = [](const QDomDocument &document, const QString &trackId) {
+        QDomNodeList tractors = document.elementsByTagName(QStringLiteral("tractor"));
+        for (int i = 0; i < tractors.size(); i++) {
+            QDomElement tractor = tractors.at(i).toElement();
+            if (tractor.attribute(QStringLiteral("id")) == trackId) {
+                return tractor.elementsByTagName(QStringLiteral("filter"));
+            }
+        }
+        return QDomNodeList();
+    };
+
+    SECTION("Routing")
+    {
+        CHECK(RenderRequest::stemRouting(2, 6, 2, {1., 1.}) == QStringLiteral("6c|c0=c0|c1=c1|c4=c0|c5=c1"));
+        CHECK(RenderRequest::stemRouting(2, 6, 0, {1., 1.}) == QStringLiteral("6c|c0=c0|c1=c1"));
+        CHECK(RenderRequest::stemRouting(1, 3, 1, {}) == QStringLiteral("3c|c1=c0"));
+        CHECK(RenderRequest::stemRouting(2, 4, 1, {0.5, 1.}) == QStringLiteral("4c|c0=0.500000*c0|c1=c1|c2=c0|c3=c1"));
+    }
+
+    SECTION("Extracted files use the preset codec")
+    {
+        QDomDocument consumerDoc;
+        consumerDoc.setContent(
+            QStringLiteral("<consumer f=\"matroska\" acodec=\"flac\" ab=\"192k\" frequency=\"48000\" ar=\"44100\" vn=\"1\" channels=\"2\"/>"));
+        CHECK(RenderRequest::stemCodecArgs(consumerDoc.documentElement()) ==
+              QStringList({QStringLiteral("-f"), QStringLiteral("matroska"), QStringLiteral("-c:a"), QStringLiteral("flac"), QStringLiteral("-b:a"),
+                           QStringLiteral("192k"), QStringLiteral("-ar"), QStringLiteral("44100")}));
+    }
+
+    SECTION("Post fader stems are rendered in a single pass")
+    {
+        auto jobs = KdenliveTests::prepareStemFiles(doc, playlist, target, uuid, 2, false);
+        REQUIRE(jobs.size() == 1);
+        const auto &job = jobs.front();
+        CHECK(job.stemChannels == 2);
+        CHECK(job.stemMaster == target);
+        CHECK(job.stemPaths == QStringList({dir.filePath(QStringLiteral("out_A1.mp3")), dir.filePath(QStringLiteral("out_A2-Voice.mp3"))}));
+        CHECK(job.stemCodecArgs == QStringList({QStringLiteral("-f"), QStringLiteral("mp3")}));
+        QDomDocument result = loadPlaylist(job.playlistPath);
+        QDomElement consumer = result.documentElement().firstChildElement(QStringLiteral("consumer"));
+        CHECK(consumer.attribute(QStringLiteral("channels")) == QLatin1String("6"));
+        CHECK(consumer.attribute(QStringLiteral("target")) == job.outputPath);
+        // The routing is applied after the track volume
+        QDomNodeList filters = trackFilters(result, QStringLiteral("tractor0"));
+        REQUIRE(filters.size() == 2);
+        CHECK(Xml::getXmlProperty(filters.at(1).toElement(), QStringLiteral("av.args")) == QStringLiteral("6c|c0=c0|c1=c1|c4=c0|c5=c1"));
+        CHECK(Xml::getXmlProperty(filters.at(0).toElement(), QStringLiteral("disable")).isEmpty());
+        // Video tracks are only routed to the mix
+        filters = trackFilters(result, QStringLiteral("tractor2"));
+        REQUIRE(filters.size() == 1);
+        CHECK(Xml::getXmlProperty(filters.at(0).toElement(), QStringLiteral("av.args")) == QStringLiteral("6c|c0=c0|c1=c1"));
+    }
+
+    SECTION("Pre fader stems apply the volume to the mix only")
+    {
+        auto jobs = KdenliveTests::prepareStemFiles(doc, playlist, target, uuid, 2, true);
+        REQUIRE(jobs.size() == 1);
+        QDomNodeList filters = trackFilters(loadPlaylist(jobs.front().playlistPath), QStringLiteral("tractor0"));
+        REQUIRE(filters.size() == 2);
+        CHECK(Xml::getXmlProperty(filters.at(0).toElement(), QStringLiteral("av.args")) == QStringLiteral("6c|c0=0.501187*c0|c1=0.501187*c1|c4=c0|c5=c1"));
+        CHECK(Xml::getXmlProperty(filters.at(1).toElement(), QStringLiteral("disable")) == QLatin1String("1"));
+    }
+
+    SECTION("Tracks over the channel limit use another pass")
+    {
+        auto jobs = KdenliveTests::prepareStemFiles(doc, playlist, target, uuid, RenderRequest::MaxStemPassChannels / 2, false);
+        REQUIRE(jobs.size() == 2);
+        CHECK(jobs.at(0).stemMaster == target);
+        CHECK(jobs.at(0).stemPaths.size() == 1);
+        CHECK(jobs.at(1).stemMaster.isEmpty());
+        CHECK(jobs.at(1).stemPaths == QStringList({dir.filePath(QStringLiteral("out_A2-Voice.mp3"))}));
+    }
+}
+
+TEST_CASE("Stem render delivers each track in its channels", "[RenderRequestStems]")
+{
+    // Play a stem render playlist with MLT, the first audio track is silent and the second one plays a tone
+    Mlt::Profile &profile = pCore->getProjectProfile();
+    Mlt::Filter pan(profile, "avfilter.pan");
+    Mlt::Producer tone(profile, "tone");
+    if (!pan.is_valid() || !tone.is_valid()) {
+        WARN("The MLT avfilter module or tone producer is not available");
+        return;
+    }
+    const QUuid uuid = QUuid::createUuid();
+    QDomDocument doc;
+    doc.setContent(QStringLiteral("<mlt><consumer vn=\"1\" f=\"wav\" channels=\"2\" frequency=\"48000\"/>"
+                                  "<producer id=\"tone\" in=\"0\" out=\"49\"><property name=\"mlt_service\">tone</property>"
+                                  "<property name=\"length\">50</property></producer>"
+                                  "<playlist id=\"playlist0\"><entry producer=\"tone\" in=\"0\" out=\"49\"/></playlist>"
+                                  "<playlist id=\"playlist1\"><blank length=\"50\"/></playlist>"
+                                  "<tractor id=\"tractor0\" in=\"0\" out=\"49\"><property name=\"kdenlive:audio_track\">1</property>"
+                                  "<track producer=\"playlist0\" hide=\"video\"/></tractor>"
+                                  "<tractor id=\"tractor1\" in=\"0\" out=\"49\"><property name=\"kdenlive:audio_track\">1</property>"
+                                  "<track producer=\"playlist1\" hide=\"video\"/></tractor>"
+                                  "<tractor id=\"main\" in=\"0\" out=\"49\"><property name=\"kdenlive:uuid\">%1</property>"
+                                  "<track producer=\"tractor0\"/><track producer=\"tractor1\"/>"
+                                  "<transition><property name=\"mlt_service\">mix</property><property name=\"a_track\">0</property>"
+                                  "<property name=\"b_track\">1</property><property name=\"always_active\">1</property>"
+                                  "<property name=\"sum\">1</property></transition></tractor></mlt>")
+                       .arg(uuid.toString()));
+    QTemporaryDir dir;
+    REQUIRE(dir.isValid());
+    auto jobs = KdenliveTests::prepareStemFiles(doc, dir.filePath(QStringLiteral("render.mlt")), dir.filePath(QStringLiteral("out.wav")), uuid, 2, false);
+    REQUIRE(jobs.size() == 1);
+    // The stems are listed from the top track, tractor1 uses the channels 2 and 3, tractor0 the channels 4 and 5
+    Mlt::Producer playlist(profile, "xml", jobs.front().playlistPath.toUtf8().constData());
+    REQUIRE(playlist.is_valid());
+    playlist.seek(10);
+    std::unique_ptr<Mlt::Frame> frame(playlist.get_frame());
+    REQUIRE(frame->is_valid());
+    mlt_audio_format format = mlt_audio_f32le;
+    int frequency = 48000;
+    int channels = 6;
+    int samples = mlt_audio_calculate_frame_samples(float(playlist.get_fps()), frequency, 10);
+    auto *data = static_cast<float *>(frame->get_audio(format, frequency, channels, samples));
+    REQUIRE(data != nullptr);
+    REQUIRE(format == mlt_audio_f32le);
+    REQUIRE(channels == 6);
+    QVector<double> peaks(channels, 0.);
+    for (int i = 0; i < samples; ++i) {
+        for (int c = 0; c < channels; ++c) {
+            peaks[c] = qMax(peaks.at(c), double(qAbs(data[i * channels + c])));
+        }
+    }
+    CHECK(peaks.at(0) > 0.01);
+    CHECK(peaks.at(1) > 0.01);
+    CHECK(peaks.at(2) < 0.0001);
+    CHECK(peaks.at(3) < 0.0001);
+    CHECK(peaks.at(4) == Approx(peaks.at(0)).epsilon(0.01));
+    CHECK(peaks.at(5) == Approx(peaks.at(1)).epsilon(0.01));
+}
@@ -11,6 +11,9 @@
 #include "doc/docundostack.hpp"
 #include "doc/kdenlivedoc.h"
 
+#include <QTemporaryFile>
+#include <QTextStream>
+
 using namespace fakeit;
 
 TEST_CASE("Read subtitle file", "[Subtitles]")
@@ -212,6 +215,137 @@ TEST_CASE("Read subtitle file", "[Subtitles]")
         REQUIRE(subtitleModel->rowCount() == 0);
     }
 
+    SECTION("Indexed id, position and range lookups")
+    {
+        double fps = pCore->getCurrentFps();
+        subtitleModel->setMaxLayer(1);
+        int subId = KdenliveTests::getNextId();
+        int subId2 = KdenliveTests::getNextId();
+        int subId3 = KdenliveTests::getNextId();
+        // A long subtitle on layer 0 must still be found when the range starts after its start
+        REQUIRE(subtitleModel->addSubtitle(subId, {0, GenTime(10, fps)},
+                                           SubtitleEvent(true, GenTime(200, fps), "Default", "", 0, 0, 0, "", QStringLiteral("Long")), false, false));
+        REQUIRE(subtitleModel->addSubtitle(subId2, {0, GenTime(250, fps)},
+                                           SubtitleEvent(true, GenTime(260, fps), "Default", "", 0, 0, 0, "", QStringLiteral("Short")), false, false));
+        REQUIRE(subtitleModel->addSubtitle(subId3, {1, GenTime(10, fps)},
+                                           SubtitleEvent(true, GenTime(20, fps), "Default", "", 0, 0, 0, "", QStringLiteral("Other layer")), false, false));
+        CHECK(subtitleModel->getIdForStartPos(0, GenTime(10, fps)) == subId);
+        CHECK(subtitleModel->getIdForStartPos(1, GenTime(10, fps)) == subId3);
+        CHECK(subtitleModel->getIdForStartPos(-1, GenTime(250, fps)) == subId2);
+        CHECK(subtitleModel->getIdForStartPos(0, GenTime(11, fps)) == -1);
+        CHECK(subtitleModel->getSubtitleIdByPosition(1, 10) == subId3);
+        CHECK(subtitleModel->getItemsInRange(0, 150, 160) == std::unordered_set<int>({subId}));
+        CHECK(subtitleModel->getItemsInRange(0, 150, 255) == std::unordered_set<int>({subId, subId2}));
+        CHECK(subtitleModel->getItemsInRange(0, 201, -1) == std::unordered_set<int>({subId2}));
+        CHECK(subtitleModel->getItemsInRange(-1, 15, 15) == std::unordered_set<int>({subId, subId3}));
+        CHECK(subtitleModel->getNextSub(subId) == subId2);
+        CHECK(subtitleModel->getPreviousSub(subId2) == subId);
+        CHECK(subtitleModel->getNextSub(subId2) == -1);
+        // Rows follow the item ids
+        CHECK(subtitleModel->getSubtitleIndex(subId) == 0);
+        CHECK(subtitleModel->getSubtitleIndex(subId3) == 2);
+        CHECK(subtitleModel->getSubtitleIdFromIndex(1).first == subId2);
+        // Moving and resizing keeps the indexes in sync
+        REQUIRE(subtitleModel->moveSubtitle(subId3, 0, GenTime(300, fps), false, false));
+        CHECK(subtitleModel->getIdForStartPos(1, GenTime(10, fps)) == -1);
+        CHECK(subtitleModel->getIdForStartPos(0, GenTime(300, fps)) == subId3);
+        REQUIRE(subtitleModel->requestResize(subId2, 100, false));
+        CHECK(subtitleModel->getIdForStartPos(0, GenTime(160, fps)) == subId2);
+        CHECK(subtitleModel->getItemsInRange(0, 155, 155) == std::unordered_set<int>({subId}));
+        REQUIRE(subtitleModel->removeSubtitle(subId));
+        CHECK(subtitleModel->getItemsInRange(0, 150, 170) == std::unordered_set<int>({subId2}));
+        CHECK(subtitleModel->getSubtitleIndex(subId) == -1);
+        CHECK(subtitleModel->getSubtitleIndex(subId3) == 1);
+        subtitleModel->removeAllSubtitles();
+        REQUIRE(subtitleModel->rowCount() == 0);
+    }
+
+    SECTION("A long subtitle does not widen the range lookups")
+    {
+        double fps = pCore->getCurrentFps();
+        int longId = KdenliveTests::getNextId();
+        REQUIRE(subtitleModel->addSubtitle(longId, {0, GenTime(0, fps)},
+                                           SubtitleEvent(true, GenTime(2000, fps), "Default", "", 0, 0, 0, "", QStringLiteral("Long")), false, false));
+        std::vector<int> shortIds;
+        for (int i = 0; i < 200; i++) {
+            int subId = KdenliveTests::getNextId();
+            REQUIRE(subtitleModel->addSubtitle(subId, {0, GenTime(5 + 10 * i, fps)},
+                                               SubtitleEvent(true, GenTime(10 + 10 * i, fps), "Default", "", 0, 0, 0, "", QStringLiteral("Short")), false,
+                                               false));
+            shortIds.push_back(subId);
+        }
+        // Only the long subtitle and the short ones next to the range are visited
+        CHECK(subtitleModel->getItemsInRange(0, 1506, 1508) == std::unordered_set<int>({longId, shortIds[150]}));
+        CHECK(KdenliveTests::subtitleRangeCandidates(subtitleModel, 0, 1506, 1508) <= 4);
+        CHECK(subtitleModel->getItemsInRange(0, 1501, 1504) == std::unordered_set<int>({longId}));
+        // Stretching a short subtitle and shrinking it back restores the lookup cost
+        REQUIRE(subtitleModel->requestResize(shortIds[10], 1800, true));
+        CHECK(subtitleModel->getItemsInRange(0, 1501, 1504) == std::unordered_set<int>({longId, shortIds[10]}));
+        REQUIRE(subtitleModel->requestResize(shortIds[10], 5, true));
+        CHECK(subtitleModel->getItemsInRange(0, 1501, 1504) == std::unordered_set<int>({longId}));
+        CHECK(KdenliveTests::subtitleRangeCandidates(subtitleModel, 0, 1501, 1504) <= 4);
+        // Removing the long subtitle leaves only the short ones
+        REQUIRE(subtitleModel->removeSubtitle(longId));
+        CHECK(subtitleModel->getItemsInRange(0, 1506, 1508) == std::unordered_set<int>({shortIds[150]}));
+        CHECK(subtitleModel->getItemsInRange(0, 1501, 1504).empty());
+        CHECK(KdenliveTests::subtitleRangeCandidates(subtitleModel, 0, 1506, 1508) <= 3);
+        // Rows and ids stay consistent after the removal
+        REQUIRE(subtitleModel->rowCount() == 200);
+        for (int row = 0; row < subtitleModel->rowCount(); row++) {
+            CHECK(subtitleModel->getSubtitleIdFromIndex(row).first == shortIds[size_t(row)]);
+            CHECK(subtitleModel->getSubtitleIndex(shortIds[size_t(row)]) == row);
+        }
+        subtitleModel->removeAllSubtitles();
+        REQUIRE(subtitleModel->rowCount() == 0);
+    }
+
+    SECTION("Work file updates are coalesced")
+    {
+        double fps = pCore->getCurrentFps();
+        const QString workPath = document.subTitlePath(timeline->uuid(), 0, false);
+        auto fileContent = [&workPath]() {
+            QFile file(workPath);
+            return file.open(QIODevice::ReadOnly) ? QString::fromUtf8(file.readAll()) : QString();
+        };
+        int subId = KdenliveTests::getNextId();
+        REQUIRE(subtitleModel->addSubtitle(subId, {0, GenTime(10, fps)},
+                                           SubtitleEvent(true, GenTime(50, fps), "Default", "", 0, 0, 0, "", QStringLiteral("Initial")), false, true));
+        subtitleModel->flushSubtitleFile();
+        CHECK(fileContent().contains(QStringLiteral("Initial")));
+        CHECK_FALSE(subtitleModel->hasPendingFileUpdate());
+
+        // Two edits in the debounce window are written once, with the last text, when the update timer fires
+        QFile::remove(workPath);
+        REQUIRE(subtitleModel->editSubtitle(subId, QStringLiteral("First")));
+        REQUIRE(subtitleModel->editSubtitle(subId, QStringLiteral("Second")));
+        CHECK(subtitleModel->hasPendingFileUpdate());
+        CHECK_FALSE(QFile::exists(workPath));
+        subtitleModel->flushSubtitleFile();
+        CHECK_FALSE(subtitleModel->hasPendingFileUpdate());
+        CHECK(fileContent().contains(QStringLiteral("Second")));
+        CHECK_FALSE(fileContent().contains(QStringLiteral("First")));
+
+        // Nothing is pending, flushing again does not write
+        QFile::remove(workPath);
+        subtitleModel->flushSubtitleFile();
+        CHECK_FALSE(QFile::exists(workPath));
+
+        // Unchanged content is written again if the work file was deleted
+        Q_EMIT subtitleModel->modelChanged();
+        CHECK(subtitleModel->hasPendingFileUpdate());
+        subtitleModel->flushSubtitleFile();
+        CHECK(fileContent().contains(QStringLiteral("Second")));
+
+        // Paths requested by the document match the model
+        REQUIRE(subtitleModel->editSubtitle(subId, QStringLiteral("Third")));
+        CHECK(subtitleModel->hasPendingFileUpdate());
+        document.getAllSubtitlesPath(false);
+        CHECK_FALSE(subtitleModel->hasPendingFileUpdate());
+        CHECK(fileContent().contains(QStringLiteral("Third")));
+        subtitleModel->removeAllSubtitles();
+        REQUIRE(subtitleModel->rowCount() == 0);
+    }
+
     SECTION("Read start/end time of the subtitles")
     {
         // srt
@@ -274,3 +408,60 @@ TEST_CASE("Read subtitle file", "[Subtitles]")
     binModel->clean();
     pCore->projectManager()->closeCurrentDocument(false, false);
 }
+
+TEST_CASE("Subtitle lookup benchmark", "[.][benchmark]")
+{
+    auto binModel = pCore->projectItemModel();
+    binModel->clean();
+    std::shared_ptr<DocUndoStack> undoStack = std::make_shared<DocUndoStack>(nullptr);
+    KdenliveDoc document(undoStack);
+    pCore->projectManager()->testSetDocument(&document);
+    QDateTime documentDate = QDateTime::currentDateTime();
+    KdenliveTests::updateTimeline(false, QString(), QString(), documentDate, 0);
+    auto timeline = document.getTimeline(document.uuid());
+    pCore->projectManager()->testSetActiveTimeline(timeline);
+    KdenliveTests::resetNextId();
+    std::shared_ptr<SubtitleModel> subtitleModel = timeline->createSubtitleModel();
+
+    // Write a 10000 events transcript, one second per event
+    QTemporaryFile file(QDir::tempPath() + QStringLiteral("/XXXXXX.srt"));
+    REQUIRE(file.open());
+    QTextStream stream(&file);
+    auto timeCode = [](int seconds) { return QStringLiteral("%1:%2:%3,000").arg(seconds / 3600, 2, 10, QLatin1Char('0')).arg(seconds / 60 % 60, 2, 10, QLatin1Char('0')).arg(seconds % 60, 2, 10, QLatin1Char('0')); };
+    for (int i = 0; i < 10000; i++) {
+        stream << i + 1 << '\n' << timeCode(i) << QStringLiteral(" --> ") << timeCode(i + 1) << '\n' << QStringLiteral("Event %1").arg(i) << QStringLiteral("\n\n");
+    }
+    stream.flush();
+    file.close();
+    subtitleModel->importSubtitle(file.fileName());
+    REQUIRE(subtitleModel->rowCount() == 10000);
+    const int fps = qRound(pCore->getCurrentFps());
+
+    BENCHMARK("Id for start position")
+    {
+        int found = 0;
+        for (int i = 0; i < 10000; i += 10) {
+            found += subtitleModel->getIdForStartPos(0, GenTime(i * fps, pCore->getCurrentFps())) > -1 ? 1 : 0;
+        }
+        return found;
+    };
+    BENCHMARK("Items in range")
+    {
+        size_t found = 0;
+        for (int i = 0; i < 10000; i += 10) {
+            found += subtitleModel->getItemsInRange(0, i * fps, (i + 5) * fps).size();
+        }
+        return found;
+    };
+    BENCHMARK("Model data for all rows")
+    {
+        int total = 0;
+        for (int row = 0; row < subtitleModel->rowCount(); row++) {
+            total += subtitleModel->data(subtitleModel->index(row), SubtitleModel::StartFrameRole).toInt();
+        }
+        return total;
+    };
+
+    binModel->clean();
+    pCore->projectManager()->closeCurrentDocument(false, false);
+}
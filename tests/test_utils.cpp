@@ -10,6 +10,8 @@
 #include "src/renderpresets/renderpresetrepository.hpp"
 #include "src/utils/thumbnailcache.hpp"
 
+#include <limits>
+
 QString KdenliveTests::createProducer(Mlt::Profile &prof, std::string color, std::shared_ptr<ProjectItemModel> binModel, int length, bool limited)
 {
     std::shared_ptr<Mlt::Producer> producer = std::make_shared<Mlt::Producer>(prof, "color", color.c_str());
@@ -265,12 +267,38 @@ void KdenliveTests::makeFiniteClipEnd(std::shared_ptr<TimelineItemModel> timelin
     timeline->m_allClips[cid]->m_endlessResize = false;
 }
 
+bool KdenliveTests::hasDisplaySnapshot(std::shared_ptr<TimelineItemModel> timeline, int itemId)
+{
+    return timeline->publishedSnapshot(itemId) != nullptr;
+}
+
+size_t KdenliveTests::subtitleRangeCandidates(std::shared_ptr<SubtitleModel> model, int layer, int startFrame, int endFrame)
+{
+    const GenTime startTime = GenTime::fromFrames(startFrame);
+    const GenTime endTime = GenTime::fromFrames(endFrame);
+    size_t visited = 0;
+    for (auto bin = model->m_durationBins.lower_bound({layer, 0}); bin != model->m_durationBins.end() && bin->first.first == layer; ++bin) {
+        auto first = bin->second.lower_bound({startTime - GenTime::fromTicks(qint64(1) << bin->first.second), -1});
+        auto last = bin->second.upper_bound({endTime, std::numeric_limits<int>::max()});
+        visited += size_t(std::distance(first, last));
+    }
+    return visited;
+}
+
 void KdenliveTests::setRenderRequestBounds(RenderRequest *r, int in, int out)
 {
     r->m_boundingIn = in;
     r->m_boundingOut = out;
 }
 
+std::vector<RenderRequest::RenderJob> KdenliveTests::prepareStemFiles(const QDomDocument &doc, const QString &playlistFile, const QString &targetFile,
+                                                                      const QUuid &uuid, int channels, bool preFader)
+{
+    std::vector<RenderRequest::RenderJob> jobs;
+    RenderRequest::prepareStemFiles(jobs, doc, playlistFile, targetFile, uuid, channels, preFader);
+    return jobs;
+}
+
 void KdenliveTests::initRenderRepository()
 {
     RenderPresetRepository::m_acodecsList = QStringList(QStringLiteral("libvorbis"));
@@ -138,7 +138,12 @@ public:
     static bool requestClipCreation(std::shared_ptr<TimelineItemModel> timeline, const QString &binClipId, int &id, PlaylistState::ClipState state,
                                     int audioStream, double speed, bool warp_pitch, Fun &undo, Fun &redo);
     static void makeFiniteClipEnd(std::shared_ptr<TimelineItemModel> timeline, int cid);
+    static bool hasDisplaySnapshot(std::shared_ptr<TimelineItemModel> timeline, int itemId);
+    /** @brief Returns the number of indexed subtitles a range lookup on this layer has to visit */
+    static size_t subtitleRangeCandidates(std::shared_ptr<SubtitleModel> model, int layer, int startFrame, int endFrame);
     static void setRenderRequestBounds(RenderRequest *r, int in, int out);
+    static std::vector<RenderRequest::RenderJob> prepareStemFiles(const QDomDocument &doc, const QString &playlistFile, const QString &targetFile,
+                                                                  const QUuid &uuid, int channels, bool preFader);
     static void initRenderRepository();
     static bool checkModelConsistency(std::shared_ptr<AbstractTreeModel> model);
     static int modelSize(std::shared_ptr<AbstractTreeModel> model);
@@ -15,10 +15,12 @@
 #include <chrono>
 #include <thread>
 
+#include "assets/keyframes/model/keyframemodellist.hpp"
 #include "bin/binplaylist.hpp"
 #include "definitions.h"
 #include "doc/kdenlivedoc.h"
 #include "timeline2/model/builders/meltBuilder.hpp"
+#include "timeline2/view/previewchunkset.h"
 #include "timeline2/view/previewmanager.h"
 #include "xml/xml.hpp"
 
@@ -67,11 +69,12 @@ TEST_CASE("Timeline preview insert-remove", "[TimelinePreview]")
         qDebug() << ":::: WAITING FOR PROGRESS...";
         qApp->processEvents();
     }
-    QFileInfoList list = dir.entryInfoList(QDir::Files, QDir::Time);
+    QDir chunksDir(dir.absoluteFilePath(QStringLiteral("chunks")));
+    QFileInfoList list = chunksDir.entryInfoList(QDir::Files, QDir::Time);
     for (auto &file : list) {
-        qDebug() << "::: FOUND FILE: " << dir.absoluteFilePath(file.fileName());
+        qDebug() << "::: FOUND FILE: " << chunksDir.absoluteFilePath(file.fileName());
     }
-    if (list.size() != 3) {
+    if (list.size() != 1) {
         QProcess p;
         const QString ffpath = QStandardPaths::findExecutable(QStringLiteral("melt"));
         p.start(ffpath, {QStringLiteral("-query"), QStringLiteral("formats")});
@@ -80,8 +83,9 @@ TEST_CASE("Timeline preview insert-remove", "[TimelinePreview]")
                  << p.readAllStandardOutput() << "\n----------\n"
                  << p.readAllStandardError();
     }
-    // This should create 3 output chunks
-    REQUIRE(list.size() == 3);
+    // This should render 3 chunks, with the same content since the timeline is empty, so a single chunk is stored
+    REQUIRE(timeline->previewManager()->previewChunks().first == QStringList{QStringLiteral("0-50")});
+    REQUIRE(list.size() == 1);
 
     // Create and insert clip
     int cid1 = -1;
@@ -92,14 +96,138 @@ TEST_CASE("Timeline preview insert-remove", "[TimelinePreview]")
     REQUIRE(timeline->requestClipInsertion(binId, tid3, 50, cid1, true, true, false));
     REQUIRE(timeline->getClipsCount() == 1);
     timeline->previewManager()->invalidatePreviews();
-    list = dir.entryInfoList(QDir::Files, QDir::Time);
-    for (auto &file : list) {
-        qDebug() << "::: FOUND FILE AFTER: " << file.fileName();
-    }
     // 2 chunks should remain
-    REQUIRE(list.size() == 2);
+    REQUIRE(timeline->previewManager()->previewChunks().first == QStringList{QStringLiteral("0-25")});
+    REQUIRE(timeline->previewManager()->previewChunks().second == QStringList{QStringLiteral("50")});
+    timeline->previewManager()->startPreviewRender();
+    while (timeline->previewManager()->isRunning()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+        qApp->processEvents();
+    }
+    REQUIRE(timeline->previewManager()->previewChunks().first == QStringList{QStringLiteral("0-50")});
+    REQUIRE(chunksDir.entryList(QDir::Files).size() == 2);
+
+    // Undo the insertion, the empty chunk is reused from the store without rendering
+    undoStack->undo();
+    REQUIRE(timeline->getClipsCount() == 0);
+    timeline->previewManager()->invalidatePreviews();
+    REQUIRE_FALSE(timeline->previewManager()->isRunning());
+    REQUIRE(timeline->previewManager()->previewChunks().first == QStringList{QStringLiteral("0-50")});
+    REQUIRE(timeline->previewManager()->previewChunks().second.isEmpty());
     timeline->resetPreviewManager();
     // Ensure preview project folder is deleted on close
     REQUIRE(dir.exists() == false);
     pCore->projectManager()->closeCurrentDocument(false, false);
 }
+
+TEST_CASE("Preview chunk hashes", "[TimelinePreview]")
+{
+    std::shared_ptr<DocUndoStack> undoStack = std::make_shared<DocUndoStack>(nullptr);
+    KdenliveDoc document(undoStack);
+    pCore->projectManager()->testSetDocument(&document);
+    QDateTime documentDate = QDateTime::currentDateTime();
+    KdenliveTests::updateTimeline(false, QString(), QString(), documentDate, 0);
+    auto timeline = document.getTimeline(document.uuid());
+    pCore->projectManager()->testSetActiveTimeline(timeline);
+    int tid = timeline->getTrackIndexFromPosition(2);
+
+    // An empty timeline renders the same content everywhere
+    QMap<int, QByteArray> hashes = timeline->chunkHashes({0, 25}, 25);
+    REQUIRE(hashes.value(0) == hashes.value(25));
+
+    auto animate = [&timeline](const std::shared_ptr<EffectStackModel> &stack) {
+        REQUIRE(stack->appendEffect(QStringLiteral("brightness")));
+        QMap<int, QByteArray> fixed = timeline->chunkHashes({0, 25}, 25);
+        REQUIRE(fixed.value(0) == fixed.value(25));
+        REQUIRE_FALSE(stack->hasKeyframes());
+        auto effect = std::dynamic_pointer_cast<EffectItemModel>(stack->getEffectStackRow(0));
+        effect->prepareKeyframes();
+        REQUIRE(effect->getKeyframeModel()->addKeyframe(GenTime(40, pCore->getCurrentFps()), KeyframeType::Linear));
+        REQUIRE(stack->hasKeyframes());
+    };
+
+    SECTION("Animated track effects depend on the chunk position")
+    {
+        animate(timeline->getTrackEffectStackModel(tid));
+        hashes = timeline->chunkHashes({0, 25}, 25);
+        REQUIRE(hashes.value(0) != hashes.value(25));
+    }
+
+    SECTION("Animated master effects depend on the chunk position")
+    {
+        animate(timeline->getMasterEffectStackModel());
+        hashes = timeline->chunkHashes({0, 25}, 25);
+        REQUIRE(hashes.value(0) != hashes.value(25));
+    }
+
+    SECTION("Subtitle edits change the hash of the chunks they cover")
+    {
+        std::shared_ptr<SubtitleModel> subtitleModel = timeline->createSubtitleModel();
+        const double fps = pCore->getCurrentFps();
+        int subId = KdenliveTests::getNextId();
+        REQUIRE(subtitleModel->addSubtitle(subId, {0, GenTime(30, fps)},
+                                           SubtitleEvent(true, GenTime(40, fps), "Default", "", 0, 0, 0, "", QStringLiteral("First")), false, false));
+        const QMap<int, QByteArray> before = timeline->chunkHashes({0, 25, 50}, 25);
+        REQUIRE(before.value(0) == before.value(50));
+        REQUIRE(before.value(25) != before.value(50));
+        REQUIRE(subtitleModel->editSubtitle(subId, QStringLiteral("Second")));
+        hashes = timeline->chunkHashes({0, 25, 50}, 25);
+        REQUIRE(hashes.value(25) != before.value(25));
+        REQUIRE(hashes.value(0) == before.value(0));
+        // Style changes apply to every chunk
+        SubtitleStyle style = subtitleModel->getSubtitleStyle(QStringLiteral("Default"));
+        style.setFontSize(style.fontSize() + 10);
+        subtitleModel->setSubtitleStyle(QStringLiteral("Default"), style);
+        const QMap<int, QByteArray> styled = timeline->chunkHashes({0, 25, 50}, 25);
+        REQUIRE(styled.value(0) != hashes.value(0));
+        REQUIRE(styled.value(25) != hashes.value(25));
+    }
+    pCore->projectManager()->closeCurrentDocument(false, false);
+}
+
+TEST_CASE("Preview chunk set", "[TimelinePreview]")
+{
+    PreviewChunkSet chunks(25);
+    REQUIRE(chunks.isEmpty());
+    REQUIRE_FALSE(chunks.intersects(0, 100));
+
+    SECTION("Consecutive chunks are merged")
+    {
+        for (int chunk : {50, 0, 100, 25, 200}) {
+            REQUIRE(chunks.insert(chunk));
+        }
+        REQUIRE_FALSE(chunks.insert(25));
+        REQUIRE(chunks.count() == 5);
+        REQUIRE(chunks.toStringList() == QStringList({QStringLiteral("0-50"), QStringLiteral("100"), QStringLiteral("200")}));
+        REQUIRE(chunks.chunks() == QList<int>({0, 25, 50, 100, 200}));
+        REQUIRE_FALSE(chunks.contains(75));
+        // Filling the gap joins both ranges
+        REQUIRE(chunks.insert(75));
+        REQUIRE(chunks.toStringList() == QStringList({QStringLiteral("0-100"), QStringLiteral("200")}));
+        REQUIRE(chunks.count() == 6);
+    }
+
+    SECTION("Removing a chunk splits its range")
+    {
+        for (int chunk = 0; chunk <= 200; chunk += 25) {
+            chunks.insert(chunk);
+        }
+        REQUIRE(chunks.toStringList() == QStringList({QStringLiteral("0-200")}));
+        REQUIRE(chunks.remove(100));
+        REQUIRE_FALSE(chunks.remove(100));
+        REQUIRE(chunks.remove(0));
+        REQUIRE(chunks.remove(200));
+        REQUIRE(chunks.toStringList() == QStringList({QStringLiteral("25-75"), QStringLiteral("125-175")}));
+        REQUIRE(chunks.count() == 6);
+        REQUIRE(chunks.contains(150));
+        REQUIRE_FALSE(chunks.contains(100));
+        REQUIRE_FALSE(chunks.contains(160));
+        REQUIRE(chunks.intersects(100, 125));
+        REQUIRE_FALSE(chunks.intersects(100, 100));
+        REQUIRE_FALSE(chunks.intersects(200, 500));
+        REQUIRE(chunks.toVariantList().size() == 6);
+        chunks.clear();
+        REQUIRE(chunks.isEmpty());
+        REQUIRE(chunks.count() == 0);
+    }
+}
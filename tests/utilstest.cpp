@@ -6,7 +6,17 @@
 #include "catch.hpp"
 #include "test_utils.hpp"
 // test specific headers
+#include "utils/gentime.h"
 #include "utils/qstringutils.h"
+#include "utils/tracing.h"
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTemporaryFile>
+
+#include <map>
+#include <thread>
 
 TEST_CASE("Testing for different utils", "[Utils]")
 {
@@ -30,3 +40,145 @@ TEST_CASE("Testing for different utils", "[Utils]")
         REQUIRE(names.removeDuplicates() == 0);
     }
 }
+
+TEST_CASE("Tracing spans and counters", "[Utils]")
+{
+    Tracing::clear();
+
+    SECTION("Nothing is recorded while disabled")
+    {
+        Tracing::setEnabled(false);
+        {
+            TRACE_SCOPE("test");
+            TRACE_COUNTER("test counter", 1);
+        }
+        REQUIRE(Tracing::eventCount() == 0);
+    }
+
+    SECTION("Export to the Chrome trace format")
+    {
+        Tracing::setEnabled(true);
+        {
+            TRACE_SCOPE_NAMED("test", "outer");
+            TRACE_SCOPE_NAMED("test", "inner");
+            TRACE_COUNTER("test counter", 42);
+            TRACE_INSTANT("test", "test instant", "position", 12);
+        }
+        std::thread other([]() { TRACE_SCOPE_NAMED("test", "thread"); });
+        other.join();
+        Tracing::setEnabled(false);
+        REQUIRE(Tracing::eventCount() == 5);
+
+        QTemporaryFile file;
+        REQUIRE(file.open());
+        REQUIRE(Tracing::exportChromeTrace(file.fileName()));
+        QJsonParseError error;
+        const QJsonDocument doc = QJsonDocument::fromJson(file.readAll(), &error);
+        REQUIRE(error.error == QJsonParseError::NoError);
+        QMap<QString, QJsonObject> events;
+        QSet<qint64> threads;
+        for (const auto &value : doc.object().value(QStringLiteral("traceEvents")).toArray()) {
+            const QJsonObject event = value.toObject();
+            if (event.value(QStringLiteral("ph")).toString() != QLatin1String("M")) {
+                events.insert(event.value(QStringLiteral("name")).toString(), event);
+                threads.insert(event.value(QStringLiteral("tid")).toVariant().toLongLong());
+            }
+        }
+        REQUIRE(events.size() == 5);
+        REQUIRE(threads.size() == 2);
+        const QJsonObject outer = events.value(QStringLiteral("outer"));
+        const QJsonObject inner = events.value(QStringLiteral("inner"));
+        REQUIRE(outer.value(QStringLiteral("ph")).toString() == QLatin1String("X"));
+        REQUIRE(outer.value(QStringLiteral("cat")).toString() == QLatin1String("test"));
+        // Inner span is nested in the outer one
+        REQUIRE(inner.value(QStringLiteral("ts")).toDouble() >= outer.value(QStringLiteral("ts")).toDouble());
+        REQUIRE(inner.value(QStringLiteral("dur")).toDouble() <= outer.value(QStringLiteral("dur")).toDouble());
+        const QJsonObject counter = events.value(QStringLiteral("test counter"));
+        REQUIRE(counter.value(QStringLiteral("ph")).toString() == QLatin1String("C"));
+        REQUIRE(counter.value(QStringLiteral("args")).toObject().value(QStringLiteral("value")).toInt() == 42);
+        const QJsonObject instant = events.value(QStringLiteral("test instant"));
+        REQUIRE(instant.value(QStringLiteral("ph")).toString() == QLatin1String("i"));
+        REQUIRE(instant.value(QStringLiteral("s")).toString() == QLatin1String("t"));
+        REQUIRE(instant.value(QStringLiteral("args")).toObject().value(QStringLiteral("position")).toInt() == 12);
+    }
+    Tracing::clear();
+}
+
+TEST_CASE("Exact time", "[Utils]")
+{
+    GenTime::setFps(30000, 1001);
+
+    SECTION("Frames are exact at NTSC rates")
+    {
+        for (int frame : {0, 1, 29, 30, 1798, 107892, 1000000}) {
+            REQUIRE(GenTime::fromFrames(frame).frames() == frame);
+            REQUIRE(GenTime(frame, 30000. / 1001.).frames() == frame);
+        }
+        // Accumulating frames does not drift
+        GenTime sum;
+        for (int i = 0; i < 100000; ++i) {
+            sum += GenTime::fromFrames(1);
+        }
+        REQUIRE(sum.ticks() == GenTime::fromFrames(100000).ticks());
+        REQUIRE(sum.frames() == 100000);
+        REQUIRE(GenTime::fromFrames(-3).frames() == -3);
+    }
+
+    SECTION("Times in the same frame are equal")
+    {
+        GenTime frame = GenTime::fromFrames(10);
+        GenTime delta = GenTime::fromTicks(GenTime::fromFrames(1).ticks() / 3);
+        REQUIRE(frame + delta == frame);
+        REQUIRE(frame - delta == frame);
+        REQUIRE_FALSE(frame + delta < frame);
+        REQUIRE(frame + delta + delta == GenTime::fromFrames(11));
+        REQUIRE(GenTime::fromFrames(9) < frame);
+        REQUIRE(GenTime(frame.seconds()) == frame);
+    }
+
+    SECTION("Frame rate changes")
+    {
+        GenTime::setFps(25.);
+        REQUIRE(GenTime(1.).frames() == 25);
+        GenTime::setFps(24000. / 1001.);
+        REQUIRE(GenTime::fromFrames(24).ticks() == GenTime(24, 24000. / 1001.).ticks());
+        REQUIRE(GenTime(1001.).frames() == 24000);
+    }
+
+    static_assert((GenTime::fromTicks(5) + GenTime::fromTicks(3) - GenTime::fromTicks(1)).ticks() == 7);
+    static_assert((-GenTime::fromTicks(2)).ticks() == -2);
+    GenTime::setFps(pCore->getCurrentProfile()->frame_rate_num(), pCore->getCurrentProfile()->frame_rate_den());
+}
+
+TEST_CASE("Exact time benchmark", "[.][benchmark]")
+{
+    GenTime::setFps(pCore->getCurrentProfile()->frame_rate_num(), pCore->getCurrentProfile()->frame_rate_den());
+    std::map<GenTime, int> keyframes;
+    for (int i = 0; i < 2000; ++i) {
+        keyframes.emplace(GenTime::fromFrames(i * 5), i);
+    }
+    BENCHMARK("Keyframe lookups converting with the profile fps")
+    {
+        int found = 0;
+        for (int frame = 0; frame < 10000; ++frame) {
+            found += keyframes.count(GenTime(frame, pCore->getCurrentFps())) > 0 ? 1 : 0;
+        }
+        return found;
+    };
+    BENCHMARK("Keyframe lookups converting with the cached fps")
+    {
+        int found = 0;
+        for (int frame = 0; frame < 10000; ++frame) {
+            found += keyframes.count(GenTime::fromFrames(frame)) > 0 ? 1 : 0;
+        }
+        return found;
+    };
+    BENCHMARK("Keyframe positions in frames")
+    {
+        int sum = 0;
+        for (const auto &keyframe : keyframes) {
+            sum += keyframe.first.frames();
+        }
+        return sum;
+    };
+}